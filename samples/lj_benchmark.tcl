@@ -85,6 +85,12 @@ set min_dist     0.87
 set int_steps    1000
 set int_n_times  5
 
+# particle data layouts used in the force loop: "aos" works directly on
+# the particle structs, "soa" on the structure-of-arrays cell mirrors
+# (cellsystem domain_decomposition -soa). Each layout is timed separately.
+set particle_layouts { aos soa }
+if { [llength $argv] > 0 } { set particle_layouts $argv }
+
 # Other parameters
 #############################################################
 set tcl_precision 6
@@ -202,26 +208,44 @@ polyBlockWrite "$name$ident.set" {box_l time_step skin} ""
 
 inter ljforcecap 0
 
-puts "\nStart integration: run $int_n_times times $int_steps steps"
+puts "\nStart integration: run $int_n_times times $int_steps steps per layout"
 
 # write start configuration
 polyBlockWrite "$name$ident.start" {time box_l} {id pos type}
 
-set j 0
-for {set i 0} { $i < $int_n_times } { incr i} {
-    puts -nonewline "run $i at time=[setmd time] \r"
-    flush stdout
-
-    integrate $int_steps
-#    if { $vmd_output=="yes" } { imd positions }
-
-#   write observables
-#    puts $obs_file "{ time [setmd time] }"
-#   write intermediate configuration
-    if { $i%10==0 } {
-#	polyBlockWrite "$name$ident.[format %04d $j]" {time box_l} {id pos type}
-	incr j
+foreach layout $particle_layouts {
+    switch $layout {
+	aos { cellsystem domain_decomposition }
+	soa { cellsystem domain_decomposition -soa }
+	default { error "unknown particle layout $layout, should be aos or soa" }
+    }
+    # make sure forces are recalculated with the new layout before timing
+    integrate 0
+
+    set j 0
+    set start [clock clicks -milliseconds]
+    for {set i 0} { $i < $int_n_times } { incr i} {
+	puts -nonewline "$layout: run $i at time=[setmd time] \r"
+	flush stdout
+
+	integrate $int_steps
+#	if { $vmd_output=="yes" } { imd positions }
+
+#	write observables
+#	puts $obs_file "{ time [setmd time] }"
+#	write intermediate configuration
+	if { $i%10==0 } {
+#	    polyBlockWrite "$name$ident.[format %04d $j]" {time box_l} {id pos type}
+	    incr j
+	}
     }
+    set elapsed [expr [clock clicks -milliseconds] - $start]
+    set timing($layout) [expr $elapsed/double($int_n_times*$int_steps)]
+    puts "$layout: [format %.3f $timing($layout)] ms per step, [format %.3f [expr 1e3*$timing($layout)/$n_part]] us per particle step"
+}
+
+if { [info exists timing(aos)] && [info exists timing(soa)] } {
+    puts "speedup soa vs. aos: [format %.2f [expr $timing(aos)/$timing(soa)]]"
 }
 
 puts "verlet_reuse  [setmd verlet_reuse]" 
@@ -0,0 +1,140 @@
+#############################################################
+#                                                           #
+#  Thread scaling of the force loops                        #
+#                                                           #
+#############################################################
+#
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Times a Lennard-Jones liquid with bead-spring polymers for an
+# increasing number of OpenMP threads per MPI task (setmd n_threads).
+# Requires compilation with configure --with-openmp. Usage:
+#
+#   Espresso openmp_scaling.tcl [<thread counts>...]
+#
+# e.g. "mpiexec -n 2 Espresso openmp_scaling.tcl 1 2 4 8" for a hybrid
+# run with two MPI tasks. The thread counts default to 1 2 4 ... 64,
+# counts larger than the number of cores are not useful.
+
+puts " "
+puts "======================================================="
+puts "=                openmp_scaling.tcl                   ="
+puts "======================================================="
+puts " "
+
+puts "Program Information: \n[code_info]\n"
+
+#############################################################
+#  Parameters                                               #
+#############################################################
+
+set density 0.8442
+# 10 000  Particles, 20 % of them in chains of 10
+set box_l   22.796
+set chain_fraction 0.2
+set chain_length   10
+
+setmd time_step 0.01
+setmd skin      0.3
+
+set lj_cut 1.12246
+
+# warmup integration (with capped LJ potential)
+set warm_steps   200
+set warm_n_times 30
+set min_dist     0.87
+
+# integration
+set int_steps    500
+set int_n_times  3
+
+set thread_counts { 1 2 4 8 16 32 64 }
+if { [llength $argv] > 0 } { set thread_counts $argv }
+
+#############################################################
+#  Setup System                                             #
+#############################################################
+
+setmd box_l $box_l $box_l $box_l
+inter 0 0 lennard-jones 1.0 1.0 $lj_cut auto 0
+inter 0 fene 30.0 1.5
+
+set n_part [expr int($box_l*$box_l*$box_l*$density)]
+set n_chains [expr int($chain_fraction*$n_part/$chain_length)]
+polymer $n_chains $chain_length 0.97 mode SAW 0.8 types 0 0 FENE 0
+for {set i [setmd n_part]} { $i < $n_part } {incr i} {
+    part $i pos [expr $box_l*[t_random]] [expr $box_l*[t_random]] [expr $box_l*[t_random]] type 0
+}
+
+puts "Simulate $n_part particles ($n_chains chains of $chain_length) in a cubic box [setmd box_l]"
+puts "on [setmd n_nodes] MPI tasks"
+
+#############################################################
+#  Warmup Integration                                       #
+#############################################################
+
+thermostat langevin 1.0 1.0
+set cap 20
+inter ljforcecap $cap
+set act_min_dist [analyze mindist]
+set i 0
+while { $i < $warm_n_times && $act_min_dist < $min_dist } {
+    integrate $warm_steps
+    set act_min_dist [analyze mindist]
+    puts -nonewline "warmup run $i: minimal distance = $act_min_dist\r"
+    flush stdout
+    set cap [expr $cap+10]
+    inter ljforcecap $cap
+    incr i
+}
+inter ljforcecap 0
+puts ""
+
+#############################################################
+#      Integration                                          #
+#############################################################
+
+# the Langevin forces are drawn on a single thread, so time the
+# microcanonical dynamics
+thermostat off
+
+foreach threads $thread_counts {
+    if { [catch { setmd n_threads $threads } err] } {
+	puts "cannot use $threads threads: $err"
+	break
+    }
+    integrate 0
+
+    set start [clock clicks -milliseconds]
+    for {set i 0} { $i < $int_n_times } { incr i} {
+	integrate $int_steps
+    }
+    set elapsed [expr [clock clicks -milliseconds] - $start]
+    set timing($threads) [expr $elapsed/double($int_n_times*$int_steps)]
+    set line "$threads threads: [format %.3f $timing($threads)] ms per step"
+    if { [info exists timing(1)] } {
+	set speedup [expr $timing(1)/$timing($threads)]
+	append line ", speedup [format %.2f $speedup], efficiency [format %.2f [expr $speedup/$threads]]"
+    }
+    puts $line
+}
+setmd n_threads 1
+
+puts "verlet_reuse  [setmd verlet_reuse]"
+puts "\nFinished"
+exit
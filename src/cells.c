@@ -40,6 +40,8 @@
 #include "domain_decomposition.h"
 #include "nsquare.h"
 #include "layered.h"
+#include "soa.h"
+#include "timers.h"
 
 /* Variables */
 
@@ -167,7 +169,7 @@ static void topology_init(int cs, CellPList *local) {
 int tclcommand_cellsystem(ClientData data, Tcl_Interp *interp,
 	       int argc, char **argv)
 {
-  int err = 0;
+  int i, err = 0;
 
   if (argc <= 1) {
     Tcl_AppendResult(interp, "usage: cellsystem <system> <params>", (char *)NULL);
@@ -175,25 +177,59 @@ int tclcommand_cellsystem(ClientData data, Tcl_Interp *interp,
   }
 
   if (ARG1_IS_S("domain_decomposition")) {
-    if (argc > 2) {
-      if (ARG_IS_S(2,"-verlet_list"))
+    /** by default use verlet list */
+    dd.use_vList = 1;
+    dd.async_ghosts = 0;
+    dd.float_ghosts = 0;
+    soa_enabled = 0;
+    for (i = 2; i < argc; i++) {
+      if (ARG_IS_S(i,"-verlet_list"))
 	dd.use_vList = 1;
-      else if(ARG_IS_S(2,"-no_verlet_list")) 
+      else if(ARG_IS_S(i,"-no_verlet_list")) 
 	dd.use_vList = 0;
+      else if(ARG_IS_S(i,"-soa")) 
+	soa_enabled = 1;
+      else if(ARG_IS_S(i,"-async_ghosts")) {
+#ifdef VIRTUAL_SITES
+	Tcl_AppendResult(interp, "-async_ghosts is not possible with virtual sites", (char *) NULL);
+	return (TCL_ERROR);
+#else
+	dd.async_ghosts = 1;
+#endif
+      }
+      else if(ARG_IS_S(i,"-float_ghosts")) {
+	if (i+1 >= argc || !ARG_IS_D(i+1, dd.float_ghosts) || dd.float_ghosts <= 0) {
+	  Tcl_ResetResult(interp);
+	  Tcl_AppendResult(interp, "-float_ghosts needs a positive maximal position error", (char *) NULL);
+	  dd.float_ghosts = 0;
+	  return (TCL_ERROR);
+	}
+	i++;
+      }
       else{
 	Tcl_AppendResult(interp, "wrong flag to",argv[0],
-			 " : should be \" -verlet_list or -no_verlet_list \"",
+			 " : should be \" -verlet_list or -no_verlet_list or -soa or -async_ghosts or -float_ghosts <max_error> \"",
 			 (char *) NULL);
 	return (TCL_ERROR);
       }
     }
-    /** by default use verlet list */
-    else dd.use_vList = 1;
     mpi_bcast_cell_structure(CELL_STRUCTURE_DOMDEC);
   }
-  else if (ARG1_IS_S("nsquare"))
+  else if (ARG1_IS_S("nsquare")) {
+    soa_enabled = 0;
+    if (argc > 2) {
+      if (ARG_IS_S(2,"-soa"))
+	soa_enabled = 1;
+      else {
+	Tcl_AppendResult(interp, "wrong flag to",argv[0],
+			 " : should be \" -soa \"", (char *) NULL);
+	return (TCL_ERROR);
+      }
+    }
     mpi_bcast_cell_structure(CELL_STRUCTURE_NSQUARE);
+  }
   else if (ARG1_IS_S("layered")) {
+    soa_enabled = 0;
     if (argc > 2) {
       if (!ARG_IS_I(2, n_layers))
 	return TCL_ERROR;
@@ -365,6 +401,7 @@ void cells_resort_particles(int global_flag)
   particle_invalidate_part_node();
   n_verlet_updates++;
 
+  timer_start(TIMER_RESORT);
   switch (cell_structure.type) {
   case CELL_STRUCTURE_LAYERED:
     layered_exchange_and_sort_particles(global_flag);
@@ -376,6 +413,7 @@ void cells_resort_particles(int global_flag)
     dd_exchange_and_sort_particles(global_flag);
     break;
   }
+  timer_stop(TIMER_RESORT);
 
 #ifdef ADDITIONAL_CHECKS
   /* at the end of the day, everything should be consistent again */
@@ -385,6 +423,10 @@ void cells_resort_particles(int global_flag)
   ghost_communicator(&cell_structure.ghost_cells_comm);
   ghost_communicator(&cell_structure.exchange_ghosts_comm);
 
+  /* new particle layout, also for the structure-of-arrays mirrors */
+  soa_update_layout();
+  cells_release_ghost_requests();
+
   on_resort_particles();
 
   rebuild_verletlist = 1;
@@ -428,6 +470,28 @@ void cells_update_ghosts()
   }
 }
 
+void cells_release_ghost_requests()
+{
+  ghost_release_persistent(&cell_structure.update_ghost_pos_comm);
+  ghost_release_persistent(&cell_structure.collect_ghost_force_comm);
+}
+
+int cells_async_ghosts()
+{
+  /* never set with virtual sites, which are updated on the ghosts
+     after the communication */
+  return cell_structure.type == CELL_STRUCTURE_DOMDEC &&
+    dd.async_ghosts && dd.use_vList && !soa_enabled;
+}
+
+void cells_start_update_ghosts()
+{
+  if (cells_async_ghosts() && rebuild_verletlist != 1)
+    ghost_communicator_start(&cell_structure.update_ghost_pos_comm);
+  else
+    cells_update_ghosts();
+}
+
 /*************************************************/
 
 void print_ghost_positions()
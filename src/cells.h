@@ -215,6 +215,22 @@ void cells_resort_particles(int global_flag);
     resorting of the particles takes place. */
 void cells_update_ghosts();
 
+/** release the persistent requests of the ghost position and force
+    communicators, since the particle arrays have changed, see \ref
+    ghost_release_persistent. */
+void cells_release_ghost_requests();
+
+/** whether the ghost communication can be overlapped with the force
+    calculation, i. e. whether the domain decomposition with Verlet
+    lists is used and \ref DomainDecomposition::async_ghosts is set. */
+int cells_async_ghosts();
+
+/** like \ref cells_update_ghosts, but if the ghost positions are
+    updated without resorting and \ref cells_async_ghosts, the update
+    is only started by \ref ghost_communicator_start. It is completed
+    by the force calculation. */
+void cells_start_update_ghosts();
+
 /** Calculate and return the total number of particles on this
     node. */
 int cells_get_n_particles();
@@ -28,6 +28,7 @@
 #include "particle_data.h"
 #include "integrate.h"
 #include "cells.h"
+#include "soa.h"
 #include "global.h"
 #include "grid.h"
 #include "initialize.h"
@@ -62,6 +63,9 @@
 #include "errorhandling.h"
 #include "molforces.h"
 #include "mdlc_correction.h"
+#include "trajectory.h"
+#include "timers.h"
+#include "correlation.h"
 
 int this_node = -1;
 int n_nodes = -1;
@@ -88,11 +92,20 @@ typedef void (SlaveCallback)(int node, int param);
   CB(mpi_bcast_ia_params_slave) \
   CB(mpi_bcast_n_particle_types_slave) \
   CB(mpi_gather_stats_slave) \
+  CB(mpi_local_observable_slave) \
+  CB(mpi_rdf_configs_slave) \
+  CB(mpi_structure_factor_slave) \
+  CB(mpi_cluster_analysis_slave) \
+  CB(mpi_bcast_correlation_slave) \
+  CB(mpi_correlation_sample_slave) \
   CB(mpi_set_time_step_slave) \
   CB(mpi_get_particles_slave) \
+  CB(mpi_gather_trajectory_frame_slave) \
+  CB(mpi_timers_slave) \
   CB(mpi_bcast_coulomb_params_slave) \
   CB(mpi_send_ext_slave) \
   CB(mpi_place_new_particle_slave) \
+  CB(mpi_place_particles_bulk_slave) \
   CB(mpi_remove_particle_slave) \
   CB(mpi_bcast_constraint_slave) \
   CB(mpi_random_seed_slave) \
@@ -184,7 +197,13 @@ void mpi_init(int *argc, char ***argv)
   MPI_Errhandler mpi_errh;
 #endif
 
+#ifdef _OPENMP
+  /* only the master thread communicates */
+  int provided;
+  MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &provided);
+#else
   MPI_Init(argc, argv);
+#endif
   MPI_Comm_rank(MPI_COMM_WORLD, &this_node);
   MPI_Comm_size(MPI_COMM_WORLD, &n_nodes);
 
@@ -448,6 +467,73 @@ void mpi_place_new_particle_slave(int pnode, int part)
   on_particle_change();
 }
 
+/****************** REQ_PLACE_BULK ************/
+
+void mpi_place_particles_bulk(int n, int props, ParticleBulkData *data,
+			      int *pnode, int n_new, int max_part)
+{
+  int i, n_local, info[2];
+  int *counts = malloc(n_nodes*sizeof(int));
+  int *displs = malloc(n_nodes*sizeof(int));
+  int *fill   = malloc(n_nodes*sizeof(int));
+  ParticleBulkData *sorted = malloc(n*sizeof(ParticleBulkData));
+
+  mpi_call(mpi_place_particles_bulk_slave, -1, props);
+
+  info[0] = n_new;
+  info[1] = max_part;
+  MPI_Bcast(info, 2, MPI_INT, 0, MPI_COMM_WORLD);
+  added_particles(n_new, max_part);
+
+  /* sort by node, keeping the order of the particles of each node */
+  for (i = 0; i < n_nodes; i++)
+    counts[i] = 0;
+  for (i = 0; i < n; i++)
+    counts[pnode[i]]++;
+  displs[0] = fill[0] = 0;
+  for (i = 1; i < n_nodes; i++)
+    displs[i] = fill[i] = displs[i-1] + counts[i-1];
+  for (i = 0; i < n; i++)
+    sorted[fill[pnode[i]]++] = data[i];
+
+  MPI_Scatter(counts, 1, MPI_INT, &n_local, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  for (i = 0; i < n_nodes; i++) {
+    counts[i] *= sizeof(ParticleBulkData);
+    displs[i] *= sizeof(ParticleBulkData);
+  }
+  MPI_Scatterv(sorted, counts, displs, MPI_BYTE,
+	       MPI_IN_PLACE, 0, MPI_BYTE, 0, MPI_COMM_WORLD);
+
+  /* the particles of the master come first */
+  local_place_particles_bulk(n_local, props, sorted);
+
+  free(sorted);
+  free(fill);
+  free(displs);
+  free(counts);
+
+  on_particle_change();
+}
+
+void mpi_place_particles_bulk_slave(int node, int props)
+{
+  int n_local, info[2] = { 0, 0 };
+  ParticleBulkData *data;
+
+  MPI_Bcast(info, 2, MPI_INT, 0, MPI_COMM_WORLD);
+  added_particles(info[0], info[1]);
+
+  MPI_Scatter(NULL, 1, MPI_INT, &n_local, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  data = malloc(n_local*sizeof(ParticleBulkData));
+  MPI_Scatterv(NULL, NULL, NULL, MPI_BYTE,
+	       data, n_local*sizeof(ParticleBulkData), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+  local_place_particles_bulk(n_local, props, data);
+  free(data);
+
+  on_particle_change();
+}
+
 /****************** REQ_SET_V ************/
 void mpi_send_v(int pnode, int part, double v[3])
 {
@@ -1393,6 +1479,134 @@ void mpi_gather_stats_slave(int ana_num, int job)
   }
 }
 
+/*************** REQ_LOCAL_OBSERVABLE ************/
+int mpi_local_observable(int code, LocalObservableParams *par, double **result)
+{
+  mpi_call(mpi_local_observable_slave, -1, code);
+  MPI_Bcast(par, sizeof(LocalObservableParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  return local_observable_calc(code, par, result);
+}
+
+void mpi_local_observable_slave(int pnode, int code)
+{
+  LocalObservableParams par;
+  MPI_Bcast(&par, sizeof(LocalObservableParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  local_observable_calc(code, &par, NULL);
+}
+
+/*************** REQ_RDF_CONFIGS ************/
+void mpi_rdf_configs(RdfParams *par, int *types, int *mol, double *rdf)
+{
+  int c, i, node;
+
+  mpi_call(mpi_rdf_configs_slave, -1, 0);
+  MPI_Bcast(par, sizeof(RdfParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  MPI_Bcast(types, par->n_part, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(mol, par->n_part, MPI_INT, 0, MPI_COMM_WORLD);
+
+  for (i = 0; i < par->bins; i++)
+    rdf[i] = 0;
+  /* configuration c, counted from the last one, goes to node c % n_nodes */
+  for (c = 0; c < par->n_conf; c++) {
+    node = c % n_nodes;
+    if (node == 0)
+      rdf_add_configs(par, types, mol, configs[n_configs - 1 - c], 1, rdf);
+    else
+      MPI_Send(configs[n_configs - 1 - c], 3*par->n_part, MPI_DOUBLE, node,
+	       SOME_TAG, MPI_COMM_WORLD);
+  }
+
+  MPI_Reduce(MPI_IN_PLACE, rdf, par->bins, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+}
+
+void mpi_rdf_configs_slave(int pnode, int dummy)
+{
+  int c, *types, *mol;
+  double *conf, *rdf;
+  RdfParams par;
+  MPI_Status status;
+
+  memset(&par, 0, sizeof(RdfParams));
+  MPI_Bcast(&par, sizeof(RdfParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  types = malloc(par.n_part*sizeof(int));
+  mol   = malloc(par.n_part*sizeof(int));
+  MPI_Bcast(types, par.n_part, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(mol, par.n_part, MPI_INT, 0, MPI_COMM_WORLD);
+
+  conf = malloc(3*par.n_part*sizeof(double));
+  rdf  = calloc(par.bins, sizeof(double));
+  for (c = this_node; c < par.n_conf; c += n_nodes) {
+    MPI_Recv(conf, 3*par.n_part, MPI_DOUBLE, 0, SOME_TAG, MPI_COMM_WORLD, &status);
+    rdf_add_configs(&par, types, mol, conf, 1, rdf);
+  }
+
+  MPI_Reduce(rdf, NULL, par.bins, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  free(rdf);
+  free(conf);
+  free(mol);
+  free(types);
+}
+
+/*************** REQ_STRUCTURE_FACTOR ************/
+void mpi_structure_factor(SfParams *par, double *sf)
+{
+#ifdef P3M
+  mpi_call(mpi_structure_factor_slave, -1, 0);
+  MPI_Bcast(par, sizeof(SfParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  sf_calc(par, sf);
+#endif
+}
+
+void mpi_structure_factor_slave(int pnode, int dummy)
+{
+#ifdef P3M
+  SfParams par;
+  MPI_Bcast(&par, sizeof(SfParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  sf_calc(&par, NULL);
+#endif
+}
+
+/*************** REQ_CLUSTER_ANALYSIS ************/
+int mpi_cluster_analysis(ClusterParams *par, int **sizes, int **members)
+{
+  mpi_call(mpi_cluster_analysis_slave, -1, 0);
+  MPI_Bcast(par, sizeof(ClusterParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  return cluster_calc(par, sizes, members);
+}
+
+void mpi_cluster_analysis_slave(int pnode, int dummy)
+{
+  ClusterParams par;
+  MPI_Bcast(&par, sizeof(ClusterParams), MPI_BYTE, 0, MPI_COMM_WORLD);
+  cluster_calc(&par, NULL, NULL);
+}
+
+/*************** REQ_BCAST_CORRELATION ************/
+void mpi_bcast_correlation(int id)
+{
+  mpi_call(mpi_bcast_correlation_slave, -1, id);
+  MPI_Bcast(&correlations[id].def, sizeof(CorrDefinition), MPI_BYTE, 0, MPI_COMM_WORLD);
+}
+
+void mpi_bcast_correlation_slave(int pnode, int id)
+{
+  correlation_realloc(id);
+  MPI_Bcast(&correlations[id].def, sizeof(CorrDefinition), MPI_BYTE, 0, MPI_COMM_WORLD);
+}
+
+/*************** REQ_CORRELATION_SAMPLE ************/
+void mpi_correlation_sample(int id)
+{
+  mpi_call(mpi_correlation_sample_slave, -1, id);
+  correlation_sample(id);
+}
+
+void mpi_correlation_sample_slave(int pnode, int id)
+{
+  correlation_sample(id);
+}
+
 /*************** REQ_GET_LOCAL_STRESS_TENSOR ************/
 void mpi_local_stress_tensor(DoubleList *TensorInBin, int bins[3], int periodic[3], double range_start[3], double range[3]) {
   
@@ -1582,6 +1796,67 @@ void mpi_get_particles(Particle *result, IntList *bi)
   free(sizes);
 }
 
+/*************** REQ_GETTRAJ ************/
+
+int mpi_gather_trajectory_frame(int columns, int flags, char **data)
+{
+  int i, size, tot_size;
+  int *sizes, *displs;
+  char *local;
+
+  mpi_call(mpi_gather_trajectory_frame_slave, -1, columns | (flags << TRAJ_N_CODES));
+
+  size = traj_pack_local(columns, flags, &local);
+
+  sizes  = malloc(sizeof(int)*n_nodes);
+  displs = malloc(sizeof(int)*n_nodes);
+  MPI_Gather(&size, 1, MPI_INT, sizes, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  tot_size = 0;
+  for (i = 0; i < n_nodes; i++) {
+    displs[i] = tot_size;
+    tot_size += sizes[i];
+  }
+
+  *data = malloc(tot_size);
+  MPI_Gatherv(local, size, MPI_BYTE, *data, sizes, displs, MPI_BYTE, 0, MPI_COMM_WORLD);
+
+  free(displs);
+  free(sizes);
+  free(local);
+
+  return tot_size;
+}
+
+void mpi_gather_trajectory_frame_slave(int pnode, int param)
+{
+  int size;
+  char *local;
+
+  size = traj_pack_local(param & ((1 << TRAJ_N_CODES) - 1), param >> TRAJ_N_CODES, &local);
+  MPI_Gather(&size, 1, MPI_INT, NULL, 0, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Gatherv(local, size, MPI_BYTE, NULL, NULL, NULL, MPI_BYTE, 0, MPI_COMM_WORLD);
+  free(local);
+}
+
+/*************** REQ_TIMERS ************/
+
+void mpi_timers(int job, double *result)
+{
+  mpi_call(mpi_timers_slave, -1, job);
+  if (job == 1)
+    timers_reset();
+  else
+    timers_reduce(result);
+}
+
+void mpi_timers_slave(int pnode, int job)
+{
+  if (job == 1)
+    timers_reset();
+  else
+    timers_reduce(NULL);
+}
+
 void mpi_get_particles_slave(int pnode, int bi)
 {
   int n_part;
@@ -2169,6 +2444,7 @@ void mpi_bcast_cell_structure(int cs)
 
 void mpi_bcast_cell_structure_slave(int pnode, int cs)
 {
+  MPI_Bcast(&soa_enabled, 1, MPI_INT, 0, MPI_COMM_WORLD);
   cells_re_init(cs);
   on_cell_structure_change();
 }
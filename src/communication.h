@@ -56,6 +56,10 @@
 #include "particle_data.h"
 #include "random.h"
 #include "topology.h"
+#include "statistics_local.h"
+#include "statistics_rdf.h"
+#include "statistics_sf.h"
+#include "statistics_uf.h"
 
 /**************************************************
  * exported variables
@@ -126,6 +130,19 @@ void mpi_place_particle(int node, int id, double pos[3]);
 */
 void mpi_place_new_particle(int node, int id, double pos[3]);
 
+/** Issue REQ_PLACE_BULK: create or modify many particles in one go.
+    The particles are scattered to their nodes in a single collective.
+    Also calls \ref on_particle_change once.
+    \param n        the number of particles.
+    \param props    the properties to set, see \ref place_particles_bulk.
+    \param data     the particles.
+    \param pnode    the node of each particle.
+    \param n_new    how many of the particles are new.
+    \param max_part the largest identity of the particles.
+*/
+void mpi_place_particles_bulk(int n, int props, ParticleBulkData *data,
+			      int *pnode, int n_new, int max_part);
+
 /** Issue REQ_SET_V: send particle velocity.
     Also calls \ref on_particle_change.
     \param part the particle.
@@ -355,6 +372,54 @@ void mpi_bcast_n_particle_types(int s);
 */
 void mpi_gather_stats(int job, void *result, void *result_t, void *result_nb, void *result_t_nb);
 
+/** Issue REQ_LOCAL_OBSERVABLE: calculate an observable of \ref
+    statistics_local.h "statistics_local.h" on all nodes and reduce it
+    on the master. Only the parameters and the reduced data are
+    communicated, not the particles.
+    \param code   the observable code, \ref LOCAL_OBS_COM...
+    \param par    its parameters.
+    \param result where to store the malloced result.
+    \return the number of values in result.
+*/
+int mpi_local_observable(int code, LocalObservableParams *par, double **result);
+
+/** Issue REQ_RDF_CONFIGS: calculate the sum of the RDFs of the last
+    stored configurations. The configurations are distributed round
+    robin over the nodes, which each sum up the RDFs of theirs.
+    \param par   the parameters.
+    \param types the types of the particles.
+    \param mol   the molecule ids of the particles.
+    \param rdf   where to store the sum of the RDFs.
+*/
+void mpi_rdf_configs(RdfParams *par, int *types, int *mol, double *rdf);
+
+/** Issue REQ_STRUCTURE_FACTOR: calculate a structure factor via a
+    mesh, see \ref sf_calc. Only available with P3M.
+    \param par the parameters.
+    \param sf  where to store the structure factor.
+*/
+void mpi_structure_factor(SfParams *par, double *sf);
+
+/** Issue REQ_CLUSTER_ANALYSIS: find the clusters of particles or
+    molecules, see \ref cluster_calc.
+    \param par     the parameters.
+    \param sizes   where to store the malloced cluster sizes.
+    \param members where to store the malloced members of the clusters.
+    \return the number of clusters.
+*/
+int mpi_cluster_analysis(ClusterParams *par, int **sizes, int **members);
+
+/** Issue REQ_BCAST_CORRELATION: send the definition of a correlation
+    to the other nodes, which take its samples during the integration.
+    \param id the identity of the correlation.
+*/
+void mpi_bcast_correlation(int id);
+
+/** Issue REQ_CORRELATION_SAMPLE: take a sample of a correlation now.
+    \param id the identity of the correlation.
+*/
+void mpi_correlation_sample(int id);
+
 /** Issue GET_LOCAL_STRESS_TENSOR: gather the contribution to the local stress tensors from
     each node.
  */
@@ -373,6 +438,23 @@ void mpi_local_stress_tensor(DoubleList *TensorInBin, int bins[3], int periodic[
 */
 void mpi_get_particles(Particle *result, IntList *il);
 
+/** Issue REQ_GETTRAJ: gather the particle data of a trajectory frame.
+    Every node packs its particles with \ref traj_pack_local, and the
+    packed data is collected with a single gather, in node order.
+    \param columns or of (1 << column code) of the columns to pack.
+    \param flags   the \ref TrajHeader::flags of the file.
+    \param data    where to store the malloced data.
+    \return the size of the data in bytes.
+*/
+int mpi_gather_trajectory_frame(int columns, int flags, char **data);
+
+/** Issue REQ_TIMERS: reduce or reset the timers of all nodes.
+    \param job    0 to reduce the timers via \ref timers_reduce, 1 to
+                  reset them.
+    \param result where to store the reduced timers for job 0.
+*/
+void mpi_timers(int job, double *result);
+
 /** Issue REQ_SET_TIME_STEP: send new \ref time_step and rescale the
     velocities accordingly. 
 */
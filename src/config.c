@@ -77,6 +77,9 @@ int tclcallback_compilation(Tcl_Interp *interp)
 #ifdef CUDA
   Tcl_AppendResult(interp, "{ CUDA } ", (char *) NULL);
 #endif
+#ifdef _OPENMP
+  Tcl_AppendResult(interp, "{ OPENMP } ", (char *) NULL);
+#endif
 #ifdef TK
   Tcl_AppendResult(interp, "{ TK } ", (char *) NULL);
 #endif
@@ -224,6 +227,9 @@ int tclcallback_compilation(Tcl_Interp *interp)
 #ifdef METADYNAMICS
   Tcl_AppendResult(interp, "{ METADYNAMICS } ", (char *) NULL);
 #endif
+#ifdef TIMERS
+  Tcl_AppendResult(interp, "{ TIMERS } ", (char *) NULL);
+#endif
 #ifdef MOL_CUT
   Tcl_AppendResult(interp, "{ MOL_CUT } ", (char *) NULL);
 #endif
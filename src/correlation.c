@@ -0,0 +1,737 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file correlation.c
+    Implementation of \ref correlation.h "correlation.h".
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "utils.h"
+#include "parser.h"
+#include "communication.h"
+#include "errorhandling.h"
+#include "integrate.h"
+#include "pressure.h"
+#include "correlation.h"
+
+Correlation *correlations = NULL;
+int n_correlations = 0;
+
+/** the Tcl names of the observables, indexed by their codes */
+static char *corr_obs_names[CORR_OBS_N_CODES] = {
+  "particle_positions", "particle_velocities", "com_position",
+  "com_velocity", "stress_tensor", "tcl"
+};
+
+/** the Tcl names of the operations, indexed by their codes */
+static char *corr_op_names[CORR_OP_N_CODES] = {
+  "scalar_product", "componentwise_product", "square_distance",
+  "square_distance_componentwise"
+};
+
+/** the Tcl names of the compressions, indexed by their codes */
+static char *corr_compress_names[2] = { "linear", "discard" };
+
+/************************************************
+ * helpers
+ ************************************************/
+
+/** whether an observable has 3 values per particle. */
+MDINLINE int corr_particle_observable(int code)
+{
+  return code == CORR_OBS_POSITIONS || code == CORR_OBS_VELOCITIES;
+}
+
+static int corr_compare_int(const void *a, const void *b)
+{
+  return *(const int *)a - *(const int *)b;
+}
+
+/** index of the lag j*2^level in \ref Correlation::result. */
+MDINLINE int corr_tau_index(Correlation *corr, int level, int j)
+{
+  if (level == 0)
+    return j;
+  return corr->tau_lin + (level - 1)*(corr->tau_lin/2) + j - corr->tau_lin/2;
+}
+
+/** apply the operation to an older value a and a newer value b and
+    add the result to res. */
+MDINLINE void corr_apply_op(int op, double *a, double *b, int dim, double *res)
+{
+  int i;
+  switch (op) {
+  case CORR_OP_SCALAR_PRODUCT:
+    for (i = 0; i < dim; i++)
+      res[0] += a[i]*b[i];
+    break;
+  case CORR_OP_COMPONENTWISE_PRODUCT:
+    for (i = 0; i < dim; i++)
+      res[i] += a[i]*b[i];
+    break;
+  case CORR_OP_SQUARE_DISTANCE:
+    for (i = 0; i < dim; i++)
+      res[0] += SQR(a[i] - b[i]);
+    break;
+  case CORR_OP_SQUARE_DISTANCE_COMPONENTWISE:
+    for (i = 0; i < dim; i++)
+      res[i % 3] += SQR(a[i] - b[i]);
+    break;
+  }
+}
+
+/************************************************
+ * the correlations
+ ************************************************/
+
+void correlation_realloc(int id)
+{
+  if (id < n_correlations)
+    return;
+  correlations = realloc(correlations, (id + 1)*sizeof(Correlation));
+  memset(correlations + n_correlations, 0, (id + 1 - n_correlations)*sizeof(Correlation));
+  n_correlations = id + 1;
+}
+
+void correlation_free(int id)
+{
+  Correlation *corr = &correlations[id];
+  int o, k;
+
+  for (o = 0; o < 2; o++) {
+    if (corr->A[o]) {
+      for (k = 0; k < corr->n_levels; k++)
+	free(corr->A[o][k]);
+      free(corr->A[o]);
+    }
+    free(corr->slot[o]);
+    free(corr->sample[o]);
+  }
+  free(corr->tau);
+  free(corr->newest);
+  free(corr->n_vals);
+  free(corr->result);
+  free(corr->n_sweeps);
+  memset(corr, 0, sizeof(Correlation));
+}
+
+/** calculate an observable. Called on all nodes.
+    @param corr   the correlation
+    @param o      the observable, 0 or 1
+    @return on the master 1 if the particles do not match the ones
+    at the creation, otherwise 0 */
+static int corr_observable_calc(Correlation *corr, int o)
+{
+  CorrObservable *obs = &corr->def.obs[o];
+  double *values = corr->sample[o], *data = NULL;
+  double **res = (this_node == 0) ? &data : NULL;
+  int i, d, n, id, err = 0;
+
+  switch (obs->code) {
+  case CORR_OBS_POSITIONS:
+  case CORR_OBS_VELOCITIES:
+    n = local_observable_calc(obs->code == CORR_OBS_POSITIONS ? LOCAL_OBS_POSITIONS : LOCAL_OBS_VELOCITIES,
+			      &obs->par, res)/4;
+    if (this_node != 0)
+      break;
+    if (3*n != obs->dim)
+      err = 1;
+    for (i = 0; i < n && !err; i++) {
+      id = (int)data[4*i];
+      if (id < 0 || id >= corr->n_slots[o] || corr->slot[o][id] < 0) {
+	err = 1;
+	break;
+      }
+      for (d = 0; d < 3; d++)
+	values[3*corr->slot[o][id] + d] = data[4*i + 1 + d];
+    }
+    /* velocities are stored scaled by the time step */
+    if (obs->code == CORR_OBS_VELOCITIES)
+      for (i = 0; i < obs->dim; i++)
+	values[i] /= time_step;
+    break;
+  case CORR_OBS_COM_POSITION:
+    local_observable_calc(LOCAL_OBS_COM, &obs->par, res);
+    if (this_node == 0)
+      for (d = 0; d < 3; d++)
+	values[d] = (data[3] > 0) ? data[d]/data[3] : 0;
+    break;
+  case CORR_OBS_COM_VELOCITY:
+    local_observable_calc(LOCAL_OBS_COM_VEL, &obs->par, res);
+    if (this_node == 0)
+      for (d = 0; d < 3; d++)
+	values[d] = (data[3] > 0) ? data[d]/(data[3]*time_step) : 0;
+    break;
+  case CORR_OBS_STRESS_TENSOR:
+    stress_tensor_calc(values);
+    break;
+  }
+
+  free(data);
+  return err;
+}
+
+void correlation_sample(int id)
+{
+  Correlation *corr = &correlations[id];
+  int o, err = 0;
+
+  for (o = 0; o < corr->def.n_obs; o++)
+    err |= corr_observable_calc(corr, o);
+
+  if (this_node != 0)
+    return;
+  if (err) {
+    char *errtxt = runtime_error(128 + TCL_INTEGER_SPACE);
+    ERROR_SPRINTF(errtxt, "{310 correlation %d: the selected particles have changed} ", id);
+    return;
+  }
+  correlation_add_sample(corr, corr->sample);
+}
+
+/** correlate the newest sample of a level with the older ones. */
+static void corr_correlate_level(Correlation *corr, int level)
+{
+  int p = corr->tau_lin, dim = corr->def.obs[0].dim;
+  double *newer = corr->A[corr->def.n_obs - 1][level] + dim*corr->newest[level];
+  int j, idx;
+
+  for (j = (level == 0) ? 0 : p/2; j < corr->n_vals[level]; j++) {
+    idx = corr_tau_index(corr, level, j);
+    corr_apply_op(corr->op, corr->A[0][level] + dim*((corr->newest[level] - j + p) % p),
+		  newer, dim, corr->result + idx*corr->dim_corr);
+    corr->n_sweeps[idx]++;
+  }
+}
+
+/** advance a level to its next sample. */
+MDINLINE void corr_advance_level(Correlation *corr, int level)
+{
+  corr->newest[level] = (corr->newest[level] + 1) % corr->tau_lin;
+  if (corr->n_vals[level] < corr->tau_lin)
+    corr->n_vals[level]++;
+}
+
+void correlation_add_sample(Correlation *corr, double *values[2])
+{
+  int p = corr->tau_lin, dim = corr->def.obs[0].dim;
+  int o, i, k, top;
+  double *older, *newer, *next;
+
+  corr->t++;
+
+  corr_advance_level(corr, 0);
+  for (o = 0; o < corr->def.n_obs; o++)
+    memcpy(corr->A[o][0] + dim*corr->newest[0], values[o], dim*sizeof(double));
+
+  /* level k+1 gets a new sample every 2^(k+1) samples, from the two
+     newest ones of level k */
+  for (top = 0; top + 1 < corr->n_levels && corr->t % (2LL << top) == 0; top++) {
+    corr_advance_level(corr, top + 1);
+    for (o = 0; o < corr->def.n_obs; o++) {
+      newer = corr->A[o][top] + dim*corr->newest[top];
+      older = corr->A[o][top] + dim*((corr->newest[top] + p - 1) % p);
+      next  = corr->A[o][top + 1] + dim*corr->newest[top + 1];
+      if (corr->compress == CORR_COMPRESS_LINEAR)
+	for (i = 0; i < dim; i++)
+	  next[i] = 0.5*(older[i] + newer[i]);
+      else
+	memcpy(next, older, dim*sizeof(double));
+    }
+  }
+
+  for (k = 0; k <= top; k++)
+    corr_correlate_level(corr, k);
+}
+
+void correlation_integration_step()
+{
+  CorrDefinition *def;
+  int id;
+
+  for (id = 0; id < n_correlations; id++) {
+    def = &correlations[id].def;
+    if (!def->used || !def->autoupdate)
+      continue;
+    if (++def->steps >= def->stride) {
+      def->steps = 0;
+      correlation_sample(id);
+    }
+  }
+}
+
+int correlation_stress_due()
+{
+  CorrDefinition *def;
+  int id, o;
+
+  for (id = 0; id < n_correlations; id++) {
+    def = &correlations[id].def;
+    if (!def->used || !def->autoupdate || def->steps + 1 < def->stride)
+      continue;
+    for (o = 0; o < def->n_obs; o++)
+      if (def->obs[o].code == CORR_OBS_STRESS_TENSOR)
+	return 1;
+  }
+  return 0;
+}
+
+/************************************************
+ * creation
+ ************************************************/
+
+/** determine the number of values of an observable and, for particle
+    observables, the slots of the particles. Only on the master.
+    @return 0 if ok, 1 if no particles are selected */
+static int corr_init_observable(Correlation *corr, int o)
+{
+  CorrObservable *obs = &corr->def.obs[o];
+  double *data;
+  int *ids, i, n;
+
+  switch (obs->code) {
+  case CORR_OBS_POSITIONS:
+  case CORR_OBS_VELOCITIES:
+    n = mpi_local_observable(LOCAL_OBS_POSITIONS, &obs->par, &data)/4;
+    if (n == 0) {
+      free(data);
+      return 1;
+    }
+    ids = malloc(n*sizeof(int));
+    for (i = 0; i < n; i++)
+      ids[i] = (int)data[4*i];
+    free(data);
+    /* the particles are stored in the order of their identities */
+    qsort(ids, n, sizeof(int), corr_compare_int);
+    corr->n_slots[o] = ids[n - 1] + 1;
+    corr->slot[o] = malloc(corr->n_slots[o]*sizeof(int));
+    for (i = 0; i < corr->n_slots[o]; i++)
+      corr->slot[o][i] = -1;
+    for (i = 0; i < n; i++)
+      corr->slot[o][ids[i]] = i;
+    free(ids);
+    obs->dim = 3*n;
+    break;
+  case CORR_OBS_COM_POSITION:
+  case CORR_OBS_COM_VELOCITY:
+    obs->dim = 3;
+    break;
+  case CORR_OBS_STRESS_TENSOR:
+    obs->dim = 9;
+    break;
+  }
+  return 0;
+}
+
+/** allocate the sample hierarchy and the results. Only on the master.
+    @param tau_max the maximal lag in samples */
+static void corr_init_hierarchy(Correlation *corr, int tau_max)
+{
+  int p = corr->tau_lin, dim = corr->def.obs[0].dim;
+  int o, k, j;
+
+  for (corr->n_levels = 1; corr->n_levels < CORR_MAX_LEVELS &&
+	 (p - 1)*(1LL << (corr->n_levels - 1)) < tau_max; corr->n_levels++);
+
+  switch (corr->op) {
+  case CORR_OP_COMPONENTWISE_PRODUCT: corr->dim_corr = dim; break;
+  case CORR_OP_SQUARE_DISTANCE_COMPONENTWISE: corr->dim_corr = 3; break;
+  default: corr->dim_corr = 1;
+  }
+  /* the reducing operations average over the particles */
+  corr->norm = 1.0;
+  if (corr->op != CORR_OP_COMPONENTWISE_PRODUCT &&
+      corr_particle_observable(corr->def.obs[0].code))
+    corr->norm = 3.0/dim;
+
+  for (o = 0; o < corr->def.n_obs; o++) {
+    corr->A[o] = malloc(corr->n_levels*sizeof(double *));
+    for (k = 0; k < corr->n_levels; k++)
+      corr->A[o][k] = malloc(p*dim*sizeof(double));
+    corr->sample[o] = malloc(dim*sizeof(double));
+  }
+  corr->newest = malloc(corr->n_levels*sizeof(int));
+  corr->n_vals = malloc(corr->n_levels*sizeof(int));
+  for (k = 0; k < corr->n_levels; k++) {
+    corr->newest[k] = p - 1;
+    corr->n_vals[k] = 0;
+  }
+
+  corr->n_tau = p + (corr->n_levels - 1)*(p/2);
+  corr->tau = malloc(corr->n_tau*sizeof(int));
+  for (j = 0; j < p; j++)
+    corr->tau[j] = j;
+  for (k = 1; k < corr->n_levels; k++)
+    for (j = p/2; j < p; j++)
+      corr->tau[corr_tau_index(corr, k, j)] = j << k;
+  corr->result   = calloc(corr->n_tau*corr->dim_corr, sizeof(double));
+  corr->n_sweeps = calloc(corr->n_tau, sizeof(long long));
+  corr->t = 0;
+}
+
+/************************************************
+ * parser
+ ************************************************/
+
+/** parse an observable, either <name> [types <type_list>] or tcl <dim>.
+    argc and argv are advanced behind it. */
+static int corr_parse_observable(Tcl_Interp *interp, int *argc_p, char ***argv_p, CorrObservable *obs)
+{
+  int argc = *argc_p, c;
+  char **argv = *argv_p;
+  IntList types;
+
+  if (argc < 1) {
+    Tcl_AppendResult(interp, "observable expected", (char *)NULL);
+    return TCL_ERROR;
+  }
+  for (c = 0; c < CORR_OBS_N_CODES; c++)
+    if (!strcmp(argv[0], corr_obs_names[c]))
+      break;
+  if (c == CORR_OBS_N_CODES) {
+    Tcl_AppendResult(interp, "unknown observable \"", argv[0], "\"", (char *)NULL);
+    return TCL_ERROR;
+  }
+  obs->code = c;
+  init_local_observable_params(&obs->par);
+  argc--; argv++;
+
+  if (c == CORR_OBS_TCL) {
+    if (argc < 1 || !ARG0_IS_I(obs->dim) || obs->dim < 1) {
+      Tcl_ResetResult(interp);
+      Tcl_AppendResult(interp, "usage: tcl <dim>", (char *)NULL);
+      return TCL_ERROR;
+    }
+    argc--; argv++;
+  }
+  else if (c != CORR_OBS_STRESS_TENSOR && argc > 0 && ARG0_IS_S("types")) {
+    init_intlist(&types);
+    if (argc < 2 || !ARG1_IS_INTLIST(types)) {
+      Tcl_ResetResult(interp);
+      Tcl_AppendResult(interp, "usage: ", corr_obs_names[c], " [types <type_list>]", (char *)NULL);
+      realloc_intlist(&types, 0);
+      return TCL_ERROR;
+    }
+    if (local_observable_select_types(&obs->par, 0, types.e, types.n)) {
+      Tcl_AppendResult(interp, "too many types", (char *)NULL);
+      realloc_intlist(&types, 0);
+      return TCL_ERROR;
+    }
+    realloc_intlist(&types, 0);
+    argc -= 2; argv += 2;
+  }
+
+  *argc_p = argc;
+  *argv_p = argv;
+  return TCL_OK;
+}
+
+/** parse correlation new ... and create the correlation. */
+static int corr_parse_new(Tcl_Interp *interp, int argc, char **argv)
+{
+  Correlation corr;
+  char buffer[TCL_INTEGER_SPACE];
+  double tau_max = -1;
+  int id, o, have_obs2 = 0, c, err = 0;
+
+  memset(&corr, 0, sizeof(Correlation));
+  corr.def.n_obs = 0;
+  corr.def.stride = 1;
+  corr.op = -1;
+  corr.tau_lin = 16;
+  corr.compress = CORR_COMPRESS_LINEAR;
+  corr.dt = -1;
+
+  while (argc > 0) {
+    if (ARG0_IS_S("obs1") || ARG0_IS_S("obs2")) {
+      o = ARG0_IS_S("obs1") ? 0 : 1;
+      argc--; argv++;
+      if (corr_parse_observable(interp, &argc, &argv, &corr.def.obs[o]) == TCL_ERROR)
+	return TCL_ERROR;
+      if (o == 0) corr.def.n_obs = 1; else have_obs2 = 1;
+      continue;
+    }
+    if (argc < 2) {
+      Tcl_AppendResult(interp, "correlation new: ", argv[0], " needs a value", (char *)NULL);
+      return TCL_ERROR;
+    }
+    if (ARG0_IS_S("corr_operation")) {
+      for (c = 0; c < CORR_OP_N_CODES; c++)
+	if (!strcmp(argv[1], corr_op_names[c]))
+	  break;
+      if (c == CORR_OP_N_CODES) {
+	Tcl_AppendResult(interp, "unknown correlation operation \"", argv[1], "\"", (char *)NULL);
+	return TCL_ERROR;
+      }
+      corr.op = c;
+    }
+    else if (ARG0_IS_S("compress")) {
+      if (!strcmp(argv[1], "linear"))
+	corr.compress = CORR_COMPRESS_LINEAR;
+      else if (!strcmp(argv[1], "discard"))
+	corr.compress = CORR_COMPRESS_DISCARD;
+      else {
+	Tcl_AppendResult(interp, "unknown compression \"", argv[1], "\"", (char *)NULL);
+	return TCL_ERROR;
+      }
+    }
+    else if (ARG0_IS_S("tau_lin")) {
+      if (!ARG1_IS_I(corr.tau_lin) || corr.tau_lin < 2 || corr.tau_lin % 2) {
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, "tau_lin must be an even number of at least 2", (char *)NULL);
+	return TCL_ERROR;
+      }
+    }
+    else if (ARG0_IS_S("tau_max")) {
+      if (!ARG1_IS_D(tau_max) || tau_max <= 0) {
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, "tau_max must be positive", (char *)NULL);
+	return TCL_ERROR;
+      }
+    }
+    else if (ARG0_IS_S("stride")) {
+      if (!ARG1_IS_I(corr.def.stride) || corr.def.stride < 1) {
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, "stride must be positive", (char *)NULL);
+	return TCL_ERROR;
+      }
+    }
+    else if (ARG0_IS_S("dt")) {
+      if (!ARG1_IS_D(corr.dt) || corr.dt <= 0) {
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, "dt must be positive", (char *)NULL);
+	return TCL_ERROR;
+      }
+    }
+    else {
+      Tcl_AppendResult(interp, "unknown correlation parameter \"", argv[0], "\"", (char *)NULL);
+      return TCL_ERROR;
+    }
+    argc -= 2; argv += 2;
+  }
+
+  if (corr.def.n_obs == 0 || corr.op < 0 || tau_max < 0) {
+    Tcl_AppendResult(interp, "usage: correlation new obs1 <observable> [obs2 <observable>] "
+		     "corr_operation <operation> tau_max <tau> [tau_lin <n>] [stride <steps>] "
+		     "[dt <time>] [compress linear|discard]", (char *)NULL);
+    return TCL_ERROR;
+  }
+  if (have_obs2)
+    corr.def.n_obs = 2;
+  if (corr.def.n_obs == 2 &&
+      (corr.def.obs[0].code == CORR_OBS_TCL) != (corr.def.obs[1].code == CORR_OBS_TCL)) {
+    Tcl_AppendResult(interp, "observables given in Tcl cannot be mixed with others", (char *)NULL);
+    return TCL_ERROR;
+  }
+  if (corr.dt < 0)
+    corr.dt = corr.def.stride*time_step;
+
+  for (o = 0; o < corr.def.n_obs && !err; o++)
+    if (corr_init_observable(&corr, o)) {
+      Tcl_AppendResult(interp, "observable ", corr_obs_names[corr.def.obs[o].code],
+		       " selects no particles", (char *)NULL);
+      err = 1;
+    }
+  if (!err && corr.def.n_obs == 2 && corr.def.obs[0].dim != corr.def.obs[1].dim) {
+    Tcl_AppendResult(interp, "the observables have a different number of values", (char *)NULL);
+    err = 1;
+  }
+  if (!err && corr.op == CORR_OP_SQUARE_DISTANCE_COMPONENTWISE && corr.def.obs[0].dim % 3) {
+    Tcl_AppendResult(interp, "square_distance_componentwise requires 3d vectors", (char *)NULL);
+    err = 1;
+  }
+  if (err) {
+    for (o = 0; o < 2; o++)
+      free(corr.slot[o]);
+    return TCL_ERROR;
+  }
+
+  corr_init_hierarchy(&corr, (int)ceil(tau_max/corr.dt - ROUND_ERROR_PREC));
+  corr.def.used = 1;
+
+  for (id = 0; id < n_correlations; id++)
+    if (!correlations[id].def.used)
+      break;
+  correlation_realloc(id);
+  correlations[id] = corr;
+  mpi_bcast_correlation(id);
+
+  sprintf(buffer, "%d", id);
+  Tcl_AppendResult(interp, buffer, (char *)NULL);
+  return TCL_OK;
+}
+
+/** print the definition of a correlation. */
+static void corr_print_params(Tcl_Interp *interp, Correlation *corr)
+{
+  char buffer[TCL_DOUBLE_SPACE + TCL_INTEGER_SPACE];
+  CorrObservable *obs;
+  int o, t;
+
+  for (o = 0; o < corr->def.n_obs; o++) {
+    obs = &corr->def.obs[o];
+    Tcl_AppendResult(interp, o ? " obs2 " : "obs1 ", corr_obs_names[obs->code], (char *)NULL);
+    if (obs->code == CORR_OBS_TCL) {
+      sprintf(buffer, " %d", obs->dim);
+      Tcl_AppendResult(interp, buffer, (char *)NULL);
+    }
+    else if (obs->par.n_types[0] > 0) {
+      Tcl_AppendResult(interp, " types {", (char *)NULL);
+      for (t = 0; t < obs->par.n_types[0]; t++) {
+	sprintf(buffer, t ? " %d" : "%d", obs->par.types[0][t]);
+	Tcl_AppendResult(interp, buffer, (char *)NULL);
+      }
+      Tcl_AppendResult(interp, "}", (char *)NULL);
+    }
+  }
+  Tcl_AppendResult(interp, " corr_operation ", corr_op_names[corr->op], (char *)NULL);
+  sprintf(buffer, " tau_lin %d", corr->tau_lin);
+  Tcl_AppendResult(interp, buffer, (char *)NULL);
+  Tcl_PrintDouble(interp, corr->tau[corr->n_tau - 1]*corr->dt, buffer);
+  Tcl_AppendResult(interp, " tau_max ", buffer, (char *)NULL);
+  sprintf(buffer, " stride %d", corr->def.stride);
+  Tcl_AppendResult(interp, buffer, (char *)NULL);
+  Tcl_PrintDouble(interp, corr->dt, buffer);
+  Tcl_AppendResult(interp, " dt ", buffer, " compress ", corr_compress_names[corr->compress],
+		   corr->def.autoupdate ? " autoupdate" : "", (char *)NULL);
+  sprintf(buffer, " samples %lld", corr->t);
+  Tcl_AppendResult(interp, buffer, (char *)NULL);
+}
+
+/** print the results of a correlation as {tau n_samples values...}. */
+static void corr_print_results(Tcl_Interp *interp, Correlation *corr)
+{
+  char buffer[TCL_DOUBLE_SPACE + 2];
+  int i, k;
+  double *res;
+
+  for (i = 0; i < corr->n_tau; i++) {
+    if (corr->n_sweeps[i] == 0)
+      continue;
+    Tcl_PrintDouble(interp, corr->tau[i]*corr->dt, buffer);
+    Tcl_AppendResult(interp, "{ ", buffer, (char *)NULL);
+    sprintf(buffer, " %lld", corr->n_sweeps[i]);
+    Tcl_AppendResult(interp, buffer, (char *)NULL);
+    res = corr->result + i*corr->dim_corr;
+    for (k = 0; k < corr->dim_corr; k++) {
+      Tcl_PrintDouble(interp, res[k]*corr->norm/corr->n_sweeps[i], buffer);
+      Tcl_AppendResult(interp, " ", buffer, (char *)NULL);
+    }
+    Tcl_AppendResult(interp, " }\n", (char *)NULL);
+  }
+}
+
+/** parse correlation <id> update [<values> [<values>]]. */
+static int corr_parse_update(Tcl_Interp *interp, int id, int argc, char **argv)
+{
+  Correlation *corr = &correlations[id];
+  DoubleList values;
+  int o;
+
+  if (corr->def.obs[0].code != CORR_OBS_TCL) {
+    if (argc != 0) {
+      Tcl_AppendResult(interp, "the observables are calculated, update takes no values", (char *)NULL);
+      return TCL_ERROR;
+    }
+    mpi_correlation_sample(id);
+    return mpi_gather_runtime_errors(interp, TCL_OK);
+  }
+
+  if (argc != corr->def.n_obs) {
+    Tcl_AppendResult(interp, "usage: correlation <id> update <values>",
+		     corr->def.n_obs == 2 ? " <values>" : "", (char *)NULL);
+    return TCL_ERROR;
+  }
+  init_doublelist(&values);
+  for (o = 0; o < corr->def.n_obs; o++) {
+    if (!ARG_IS_DOUBLELIST(o, values) || values.n != corr->def.obs[o].dim) {
+      char buffer[TCL_INTEGER_SPACE];
+      Tcl_ResetResult(interp);
+      sprintf(buffer, "%d", corr->def.obs[o].dim);
+      Tcl_AppendResult(interp, "correlation update: expected a list of ", buffer, " values",
+		       (char *)NULL);
+      realloc_doublelist(&values, 0);
+      return TCL_ERROR;
+    }
+    memcpy(corr->sample[o], values.e, values.n*sizeof(double));
+  }
+  realloc_doublelist(&values, 0);
+  correlation_add_sample(corr, corr->sample);
+  return TCL_OK;
+}
+
+int tclcommand_correlation(ClientData data, Tcl_Interp *interp, int argc, char **argv)
+{
+  char buffer[TCL_INTEGER_SPACE + 2];
+  Correlation *corr;
+  int id;
+
+  if (argc == 1) {
+    for (id = 0; id < n_correlations; id++)
+      if (correlations[id].def.used) {
+	sprintf(buffer, "%d ", id);
+	Tcl_AppendResult(interp, buffer, (char *)NULL);
+      }
+    return TCL_OK;
+  }
+
+  if (ARG1_IS_S("new"))
+    return corr_parse_new(interp, argc - 2, argv + 2);
+
+  if (!ARG1_IS_I(id) || id < 0 || id >= n_correlations || !correlations[id].def.used) {
+    Tcl_ResetResult(interp);
+    Tcl_AppendResult(interp, "correlation \"", argv[1], "\" does not exist", (char *)NULL);
+    return TCL_ERROR;
+  }
+  corr = &correlations[id];
+  argc -= 2; argv += 2;
+
+  if (argc == 0) {
+    corr_print_params(interp, corr);
+    return TCL_OK;
+  }
+  if (ARG0_IS_S("print")) {
+    corr_print_results(interp, corr);
+    return TCL_OK;
+  }
+  if (ARG0_IS_S("update"))
+    return corr_parse_update(interp, id, argc - 1, argv + 1);
+  if (ARG0_IS_S("autoupdate")) {
+    if (argc != 2 || !(ARG1_IS_S("start") || ARG1_IS_S("stop"))) {
+      Tcl_AppendResult(interp, "usage: correlation <id> autoupdate start|stop", (char *)NULL);
+      return TCL_ERROR;
+    }
+    if (corr->def.obs[0].code == CORR_OBS_TCL) {
+      Tcl_AppendResult(interp, "observables given in Tcl cannot be updated automatically", (char *)NULL);
+      return TCL_ERROR;
+    }
+    corr->def.autoupdate = ARG1_IS_S("start");
+    corr->def.steps = 0;
+    mpi_bcast_correlation(id);
+    return TCL_OK;
+  }
+  if (ARG0_IS_S("free")) {
+    correlation_free(id);
+    mpi_bcast_correlation(id);
+    return TCL_OK;
+  }
+
+  Tcl_AppendResult(interp, "unknown correlation command \"", argv[0], "\"", (char *)NULL);
+  return TCL_ERROR;
+}
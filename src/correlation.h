@@ -0,0 +1,222 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef CORRELATION_H
+#define CORRELATION_H
+/** \file correlation.h
+    Time correlation functions, which are calculated on the fly.
+
+    In contrast to the analysis of the \ref statistics.h "stored
+    configurations", a correlation only keeps a hierarchy of blocks of
+    past samples (multiple tau correlator, see Ramirez et
+    al., J. Chem. Phys. 133, 154103 (2010)). Level 0 holds the last
+    \ref Correlation::tau_lin samples. Every second sample of a level
+    is combined with its predecessor into one sample of the next
+    level, either by averaging (\ref CORR_COMPRESS_LINEAR) or by
+    keeping the older one (\ref CORR_COMPRESS_DISCARD). The new sample
+    of a level is correlated with the older ones of the same level, so
+    that level k yields the lags j*2^k with tau_lin/2 <= j < tau_lin
+    (0 <= j < tau_lin on level 0). Therefore, lags up to T samples
+    need O(tau_lin log(T)) stored samples, and a sample costs
+    O(tau_lin) operations on average.
+
+    The samples are either taken during the integration every \ref
+    CorrDefinition::stride steps, or on demand. Observables of the
+    particles are calculated as \ref statistics_local.h "local
+    observables" and collected on the master, where the sample
+    hierarchy and the results are kept. The other nodes only know the
+    \ref CorrDefinition, which is broadcasted by \ref
+    mpi_bcast_correlation.
+*/
+
+#include <tcl.h>
+#include "statistics_local.h"
+
+/************************************************
+ * defines
+ ************************************************/
+
+/** \name Observable codes */
+/*@{*/
+/** unfolded positions of the selected particles, 3 values per
+    particle in the order of their identities */
+#define CORR_OBS_POSITIONS     0
+/** velocities of the selected particles, 3 values per particle in
+    the order of their identities */
+#define CORR_OBS_VELOCITIES    1
+/** center of mass of the selected particles, 3 values */
+#define CORR_OBS_COM_POSITION  2
+/** mean velocity of the selected particles, 3 values */
+#define CORR_OBS_COM_VELOCITY  3
+/** total stress tensor, 9 values */
+#define CORR_OBS_STRESS_TENSOR 4
+/** values given by the user, see \ref correlation_add_sample */
+#define CORR_OBS_TCL           5
+/** number of observable codes */
+#define CORR_OBS_N_CODES       6
+/*@}*/
+
+/** \name Correlation operations, applied to an older value A and a
+    newer value B */
+/*@{*/
+/** sum of A_i B_i, 1 value */
+#define CORR_OP_SCALAR_PRODUCT                0
+/** A_i B_i, as many values as the observable */
+#define CORR_OP_COMPONENTWISE_PRODUCT         1
+/** sum of (A_i - B_i)^2, 1 value */
+#define CORR_OP_SQUARE_DISTANCE               2
+/** sum of (A_i - B_i)^2 separately for the x, y and z components of
+    3d vectors, 3 values */
+#define CORR_OP_SQUARE_DISTANCE_COMPONENTWISE 3
+/** number of operations */
+#define CORR_OP_N_CODES                       4
+/*@}*/
+
+/** \name Compression of two samples into one of the next level */
+/*@{*/
+/** the mean of both samples */
+#define CORR_COMPRESS_LINEAR  0
+/** the older sample */
+#define CORR_COMPRESS_DISCARD 1
+/*@}*/
+
+/** maximal number of levels */
+#define CORR_MAX_LEVELS 30
+
+/************************************************
+ * data types
+ ************************************************/
+
+/** An observable that is sampled. */
+typedef struct {
+  /** the observable code, \ref CORR_OBS_POSITIONS... */
+  int code;
+  /** the selected particles */
+  LocalObservableParams par;
+  /** number of values */
+  int dim;
+} CorrObservable;
+
+/** The part of a correlation that is known on all nodes. */
+typedef struct {
+  /** whether the correlation exists */
+  int used;
+  /** 1 for an autocorrelation, 2 for a cross correlation */
+  int n_obs;
+  /** the observables A and B */
+  CorrObservable obs[2];
+  /** whether samples are taken during the integration */
+  int autoupdate;
+  /** integration steps between two samples */
+  int stride;
+  /** integration steps since the last sample */
+  int steps;
+} CorrDefinition;
+
+/** A correlation. Except for \ref def, only used on the master. */
+typedef struct {
+  /** the definition, which is broadcasted */
+  CorrDefinition def;
+  /** the operation, \ref CORR_OP_SCALAR_PRODUCT... */
+  int op;
+  /** the compression, \ref CORR_COMPRESS_LINEAR or \ref CORR_COMPRESS_DISCARD */
+  int compress;
+  /** number of samples per level, even */
+  int tau_lin;
+  /** number of levels */
+  int n_levels;
+  /** time between two samples */
+  double dt;
+  /** number of values of the operation */
+  int dim_corr;
+  /** factor of the results, i.e. one over the number of particles
+      for averages over particles */
+  double norm;
+  /** number of lags */
+  int n_tau;
+  /** the lags in samples */
+  int *tau;
+  /** number of samples so far */
+  long long t;
+  /** the sample hierarchy of the observables, tau_lin*dim values per
+      level, used as ring buffers */
+  double **A[2];
+  /** the index of the newest sample of each level */
+  int *newest;
+  /** the number of samples in each level, at most tau_lin */
+  int *n_vals;
+  /** the sums of the operation for each lag */
+  double *result;
+  /** the number of summands of \ref result for each lag */
+  long long *n_sweeps;
+  /** for particle observables, the slot of each particle identity in
+      the values or -1; n_slots entries */
+  int *slot[2];
+  /** number of entries of \ref slot */
+  int n_slots[2];
+  /** buffers for the current values */
+  double *sample[2];
+} Correlation;
+
+/************************************************
+ * exported variables
+ ************************************************/
+
+/** the correlations */
+extern Correlation *correlations;
+/** number of correlations, including freed ones */
+extern int n_correlations;
+
+/************************************************
+ * functions
+ ************************************************/
+
+/** make sure that a correlation with this id exists on this node.
+    Called by \ref mpi_bcast_correlation. */
+void correlation_realloc(int id);
+
+/** free the sample hierarchy of a correlation on the master and mark
+    it unused. */
+void correlation_free(int id);
+
+/** take a sample of a correlation. Called on all nodes, e.g. by \ref
+    mpi_correlation_sample, and only for correlations of observables
+    other than \ref CORR_OBS_TCL. */
+void correlation_sample(int id);
+
+/** add the values of a sample of the observables to a correlation.
+    Only called on the master.
+    @param corr   the correlation
+    @param values the values of A and, for cross correlations, B */
+void correlation_add_sample(Correlation *corr, double *values[2]);
+
+/** take the samples that are due after an integration step. Called
+    on all nodes by \ref integrate_vv. */
+void correlation_integration_step();
+
+/** whether \ref correlation_integration_step will sample the stress
+    tensor after the next integration step, i.e. whether its force
+    calculation should accumulate the observables, see \ref obs_fused. */
+int correlation_stress_due();
+
+/** Implementation of the Tcl command \ref tclcommand_correlation. This
+    command allows to calculate time correlation functions on the fly.
+*/
+int tclcommand_correlation(ClientData data, Tcl_Interp *interp, int argc, char **argv);
+
+#endif
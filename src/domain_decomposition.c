@@ -23,29 +23,24 @@
  *  See also \ref domain_decomposition.h
  */
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "domain_decomposition.h"
 #include "errorhandling.h"
 #include "forces.h"
 #include "pressure.h"
 #include "energy.h"
 #include "constraint.h"
-
-/************************************************/
-/** \name Defines */
-/************************************************/
-/*@{*/
-
-/** half the number of cell neighbors in 3 Dimensions. */
-#define CELLS_MAX_NEIGHBORS 14
-
-/*@}*/
+#include "soa.h"
+#include "threads.h"
 
 /************************************************/
 /** \name Variables */
 /************************************************/
 /*@{*/
 
-DomainDecomposition dd = { 1, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, NULL };
+DomainDecomposition dd = { 1, 0, 0.0, {0,0,0}, {0,0,0}, {0,0,0}, {0,0,0}, NULL, NULL, {0}, NULL };
 
 int max_num_cells = CELLS_MAX_NUM_CELLS;
 int min_num_cells = 1;
@@ -70,6 +65,13 @@ double max_skin   = 0.0;
     for(n=1; n<dd.cell_grid[1]+1; n++) \
       for(m=1; m<dd.cell_grid[0]+1; m++)
 
+/** Colour of the cell at grid position m,n,o, see \ref DomainDecomposition::color_cells */
+#define DD_CELL_COLOR(m,n,o) ((m)%3 + 3*((n)%3) + 9*((o)%3))
+
+/** Colour of the local cell c at grid position m,n,o, including its class. */
+#define DD_CELL_CLASS_COLOR(c,m,n,o) \
+  (DD_CELL_COLOR(m,n,o) + (dd.cell_class[c] == DD_CELLS_BORDER ? DD_N_COLORS : 0))
+
 /** Convenient replace for inner cell check. usage: if(DD_IS_LOCAL_CELL(m,n,o)) {...} */
 #define DD_IS_LOCAL_CELL(m,n,o) \
   ( m > 0 && m < dd.ghost_cell_grid[0] - 1 && \
@@ -378,6 +380,7 @@ void dd_revert_comm_order(GhostCommunicator *comm)
       }
     }
   }
+  comm->phases_valid = 0;
 }
 
 /** Of every two communication rounds, set the first receivers to prefetch and poststore */
@@ -400,13 +403,15 @@ void dd_assign_prefetches(GhostCommunicator *comm)
  */
 void dd_init_cell_interactions()
 {
-  int m,n,o,p,q,r,ind1,ind2,c_cnt=0,n_cnt;
+  int m,n,o,p,q,r,ind1,ind2,c_cnt=0,n_cnt,col;
  
   /* initialize cell neighbor structures */
   dd.cell_inter = (IA_Neighbor_List *) realloc(dd.cell_inter,local_cells.n*sizeof(IA_Neighbor_List));
+  dd.cell_class = (int *) realloc(dd.cell_class,local_cells.n*sizeof(int));
   for(m=0; m<local_cells.n; m++) { 
     dd.cell_inter[m].nList = NULL; 
     dd.cell_inter[m].n_neighbors=0; 
+    init_pairList(&dd.cell_inter[m].vList);
   }
 
   /* loop all local cells */
@@ -415,6 +420,7 @@ void dd_init_cell_interactions()
     dd.cell_inter[c_cnt].n_neighbors = CELLS_MAX_NEIGHBORS;
  
     n_cnt=0;
+    dd.cell_class[c_cnt] = DD_CELLS_INNER;
     ind1 = get_linear_index(m,n,o,dd.ghost_cell_grid);
     /* loop all neighbor cells */
     for(p=o-1; p<=o+1; p++)	
@@ -424,12 +430,32 @@ void dd_init_cell_interactions()
 	  if(ind2 >= ind1) {
 	    dd.cell_inter[c_cnt].nList[n_cnt].cell_ind = ind2;
 	    dd.cell_inter[c_cnt].nList[n_cnt].pList    = &cells[ind2];
-	    init_pairList(&dd.cell_inter[c_cnt].nList[n_cnt].vList);
+	    if(DD_IS_GHOST_CELL(r,q,p))
+	      dd.cell_class[c_cnt] = DD_CELLS_BORDER;
 	    n_cnt++;
 	  }
 	}
     c_cnt++;
   }
+
+  /* sort the cells by class and colour, counting sort */
+  dd.color_cells = (int *) realloc(dd.color_cells,local_cells.n*sizeof(int));
+  for(col=0; col<=2*DD_N_COLORS; col++)
+    dd.color_start[col] = 0;
+  c_cnt = 0;
+  DD_LOCAL_CELLS_LOOP(m,n,o)
+    dd.color_start[DD_CELL_CLASS_COLOR(c_cnt++,m,n,o) + 1]++;
+  for(col=0; col<2*DD_N_COLORS; col++)
+    dd.color_start[col+1] += dd.color_start[col];
+  c_cnt = 0;
+  DD_LOCAL_CELLS_LOOP(m,n,o) {
+    col = DD_CELL_CLASS_COLOR(c_cnt,m,n,o);
+    dd.color_cells[dd.color_start[col]++] = c_cnt++;
+  }
+  /* now color_start[i] is the end of colour i */
+  for(col=2*DD_N_COLORS; col>0; col--)
+    dd.color_start[col] = dd.color_start[col-1];
+  dd.color_start[0] = 0;
 }
 
 /*************************************************/
@@ -646,6 +672,8 @@ void dd_topology_init(CellPList *old)
 
   /** broadcast the flag for using verlet list */
   MPI_Bcast(&dd.use_vList, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&dd.async_ghosts, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  MPI_Bcast(&dd.float_ghosts, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
  
   cell_structure.type             = CELL_STRUCTURE_DOMDEC;
   cell_structure.position_to_node = map_position_node_array;
@@ -672,6 +700,9 @@ void dd_topology_init(CellPList *old)
   dd_assign_prefetches(&cell_structure.update_ghost_pos_comm);
   dd_assign_prefetches(&cell_structure.collect_ghost_force_comm);
 
+  cell_structure.update_ghost_pos_comm.float_error    = dd.float_ghosts;
+  cell_structure.collect_ghost_force_comm.float_error = dd.float_ghosts;
+
 #ifdef LB
   dd_prepare_comm(&cell_structure.ghost_lbcoupling_comm, GHOSTTRANS_COUPLING) ;
   dd_assign_prefetches(&cell_structure.ghost_lbcoupling_comm) ;
@@ -702,15 +733,16 @@ void dd_topology_init(CellPList *old)
 /************************************************************/
 void dd_topology_release()
 {
-  int i,j;
+  int i;
   CELL_TRACE(fprintf(stderr,"%d: dd_topology_release:\n",this_node));
   /* release cell interactions */
   for(i=0; i<local_cells.n; i++) {
-    for(j=0; j<dd.cell_inter[i].n_neighbors; j++) 
-      free_pairList(&dd.cell_inter[i].nList[j].vList);
+    free_pairList(&dd.cell_inter[i].vList);
     dd.cell_inter[i].nList = (IA_Neighbor *) realloc(dd.cell_inter[i].nList,0);
   }
   dd.cell_inter = (IA_Neighbor_List *) realloc(dd.cell_inter,0);
+  dd.color_cells = (int *) realloc(dd.color_cells,0);
+  dd.cell_class = (int *) realloc(dd.cell_class,0);
   /* free ghost cell pointer list */
   realloc_cellplist(&ghost_cells, ghost_cells.n = 0);
   /* free ghost communicators */
@@ -941,56 +973,144 @@ int tclcallback_min_num_cells(Tcl_Interp *interp, void *_data)
   return (TCL_OK);
 }
 
-void calc_link_cell()
+void dd_loop_cells_colored(void (*cell_ia)(int c), int classes)
+{
+  int c;
+
+  if (!threads_active()) {
+    for (c = 0; c < local_cells.n; c++)
+      if (dd.cell_class[c] & classes) {
+	cell_ia(c);
+	if (ghost_comm_pending)
+	  ghost_communicator_progress();
+#ifdef P3M
+	if (p3m_gather_pending)
+	  P3M_gather_progress();
+#endif
+      }
+    return;
+  }
+
+#ifdef _OPENMP
+  {
+    int col, i;
+    int col_begin = (classes & DD_CELLS_INNER)  ? 0 : DD_N_COLORS;
+    int col_end   = (classes & DD_CELLS_BORDER) ? 2*DD_N_COLORS : DD_N_COLORS;
+#pragma omp parallel private(col, i)
+    for (col = col_begin; col < col_end; col++) {
+      /* the implicit barrier at the end of the loop separates the colours */
+#pragma omp for schedule(dynamic)
+      for (i = dd.color_start[col]; i < dd.color_start[col+1]; i++) {
+	cell_ia(dd.color_cells[i]);
+	/* MPI is only called from the master thread */
+	if (omp_get_thread_num() == 0 && ghost_comm_pending)
+	  ghost_communicator_progress();
+#ifdef P3M
+	if (omp_get_thread_num() == 0 && p3m_gather_pending)
+	  P3M_gather_progress();
+#endif
+      }
+    }
+  }
+#endif
+}
+
+/** non bonded forces of local cell c and its neighbors, link-cell
+    method. */
+static void calc_link_cell_ia(int c)
 {
-  int c, np1, n, np2, i ,j, j_start;
+  int np1, n, np2, i ,j, j_start;
   Cell *cell;
   IA_Neighbor *neighbor;
   Particle *p1, *p2;
   double dist2, vec21[3];
 
+  cell = local_cells.cell[c];
+  p1   = cell->part;
+  np1  = cell->n;
+  /* Loop cell neighbors */
+  for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
+    neighbor = &dd.cell_inter[c].nList[n];
+    p2  = neighbor->pList->part;
+    np2 = neighbor->pList->n;
+    /* Loop cell particles */
+    for(i=0; i < np1; i++) {
+      /* avoid double counting within the cell */
+      j_start = (n == 0) ? i+1 : 0;
+      /* Loop neighbor cell particles */
+      for(j = j_start; j < np2; j++) {
+#ifdef EXCLUSIONS
+	if(do_nonbonded(&p1[i], &p2[j]))
+#endif
+	  {
+	    dist2 = distance2vec(p1[i].r.p, p2[j].r.p, vec21);
+	    if(dist2 <= max_range_non_bonded2) {
+	      /* calc non bonded interactions */
+	      add_non_bonded_pair_force(&(p1[i]), &(p2[j]), vec21, sqrt(dist2), dist2);
+	    }
+	  }
+      }
+    }
+  }
+}
+
+void calc_link_cell()
+{
   EWALD_TRACE(fprintf(stderr,"%d: EWALD: calc_link_cell\n",this_node));
- 
-  /* Loop local cells */
-  for (c = 0; c < local_cells.n; c++) {
 
-    cell = local_cells.cell[c];
-    p1   = cell->part;
-    np1  = cell->n;
-    /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      neighbor = &dd.cell_inter[c].nList[n];
-      p2  = neighbor->pList->part;
-      np2 = neighbor->pList->n;
-      /* Loop cell particles */
-      for(i=0; i < np1; i++) {
-	j_start = 0;
-	/* Tasks within cell: bonded forces */
-	if(n == 0) {
-	  add_bonded_force(&p1[i]);
-#ifdef CONSTRAINTS
-	  add_constraints_forces(&p1[i]);
-#endif
-	  j_start = i+1;
-	}
-	/* Loop neighbor cell particles */
-	for(j = j_start; j < np2; j++) {
+  calc_local_bonded_forces();
+  dd_loop_cells_colored(calc_link_cell_ia, DD_CELLS_ALL);
+}
+
+/** Variant of \ref calc_link_cell_ia working on the cell mirrors. */
+static void calc_link_cell_soa_ia(int c)
+{
+  int np1, n, np2, i ,j, j_start;
+  Cell *cell;
+  CellSoA *s1, *s2;
+  IA_Neighbor *neighbor;
+  Particle *p1, *p2;
+  double dist2, vec21[3], x1, y1, z1;
+
+  cell = local_cells.cell[c];
+  p1   = cell->part;
+  np1  = cell->n;
+  s1   = cell_soa(cell);
+  /* Loop cell neighbors */
+  for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
+    neighbor = &dd.cell_inter[c].nList[n];
+    p2  = neighbor->pList->part;
+    np2 = neighbor->pList->n;
+    s2  = cell_soa(neighbor->pList);
+    /* Loop cell particles */
+    for(i=0; i < np1; i++) {
+      /* avoid double counting within the cell */
+      j_start = (n == 0) ? i+1 : 0;
+      x1 = s1->x[i]; y1 = s1->y[i]; z1 = s1->z[i];
+      /* Loop neighbor cell particles */
+      for(j = j_start; j < np2; j++) {
+	vec21[0] = x1 - s2->x[j];
+	vec21[1] = y1 - s2->y[j];
+	vec21[2] = z1 - s2->z[j];
+	dist2 = SQR(vec21[0]) + SQR(vec21[1]) + SQR(vec21[2]);
+	if(dist2 <= max_range_non_bonded2) {
 #ifdef EXCLUSIONS
-          if(do_nonbonded(&p1[i], &p2[j]))
+	  if(s1->n_excl[i] > 0 && !do_nonbonded(&p1[i], &p2[j]))
+	    continue;
 #endif
-	    {
-	      dist2 = distance2vec(p1[i].r.p, p2[j].r.p, vec21);
-	      if(dist2 <= max_range_non_bonded2) {
-		/* calc non bonded interactions */
-		add_non_bonded_pair_force(&(p1[i]), &(p2[j]), vec21, sqrt(dist2), dist2);
-	      }
-	    }
+	  add_non_bonded_pair_force_soa(&p1[i], s1, i, &p2[j], s2, j, vec21, dist2);
 	}
       }
     }
   }
 }
 
+void calc_link_cell_soa()
+{
+  calc_local_bonded_forces();
+  dd_loop_cells_colored(calc_link_cell_soa_ia, DD_CELLS_ALL);
+}
+
 /************************************************************/
 
 void calculate_link_cell_energies()
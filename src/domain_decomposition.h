@@ -68,10 +68,25 @@ typedef struct {
   int cell_ind;
   /** Pointer to particle list of neighbor cell. */
   ParticleList *pList;
-  /** Verlet list for non bonded interactions of a cell with a neighbor cell. */
-  PairList vList;
 } IA_Neighbor;
 
+/** Maximal number of interacting neighbor cells of a cell (including itself). */
+#define CELLS_MAX_NEIGHBORS 14
+
+/** Number of colours of the local cells, see \ref
+    DomainDecomposition::color_cells. */
+#define DD_N_COLORS 27
+
+/** \name Cell classes for \ref dd_loop_cells_colored */
+/*@{*/
+/** local cells that do not interact with ghost cells. */
+#define DD_CELLS_INNER  1
+/** local cells that interact with ghost cells. */
+#define DD_CELLS_BORDER 2
+/** all local cells. */
+#define DD_CELLS_ALL    (DD_CELLS_INNER | DD_CELLS_BORDER)
+/*@}*/
+
 
 typedef struct {
   /** number of interacting neighbor cells . 
@@ -95,12 +110,32 @@ typedef struct {
   int n_neighbors;
   /** Interacting neighbor cell list  */
   IA_Neighbor *nList;
+  /** Verlet list for non bonded interactions of the cell with its
+      neighbor cells. The partners are given as neighbor cell number
+      in nList and index in that cell. */
+  PairList vList;
 } IA_Neighbor_List;
 
+/** get the partner particle of an entry of the verlet list of a cell.
+    @param nl   the interacting neighbor cell list of the cell.
+    @param pair the verlet list entry.
+*/
+MDINLINE Particle *dd_verlet_partner(IA_Neighbor_List *nl, unsigned int pair)
+{
+  return &nl->nList[VERLET_PAIR_CELL(pair)].pList->part[VERLET_PAIR_INDEX(pair)];
+}
+
 /** Structure containing the information about the cell grid used for domain decomposition. */
 typedef struct {
   /** flag for using Verlet List */
   int use_vList;
+  /** flag for overlapping the ghost communication with the force
+      calculation of the inner cells, see \ref ghost_communicator_start. */
+  int async_ghosts;
+  /** if positive, the ghost positions and forces are communicated in
+      single precision with this maximal position error, see \ref
+      GhostCommunicator::float_error. */
+  double float_ghosts;
   /** linked cell grid in nodes spatial domain. */
   int cell_grid[3];
   /** linked cell grid with ghost frame. */
@@ -112,6 +147,18 @@ typedef struct {
   double inv_cell_size[3];
   /** Array containing information about the interactions between the cells. */
   IA_Neighbor_List *cell_inter;
+  /** The local cells (as indices into \ref local_cells) sorted by
+      colour. The colour of a cell is given by its grid position modulo
+      3 in each direction, so that the interacting neighbor cells of
+      two cells of the same colour never overlap. The inner cells come
+      first, i. e. border cells have colours DD_N_COLORS and above. */
+  int *color_cells;
+  /** the cells of colour i are color_cells[color_start[i]] to
+      color_cells[color_start[i+1]-1]. */
+  int color_start[2*DD_N_COLORS + 1];
+  /** class of each local cell, \ref DD_CELLS_INNER or \ref
+      DD_CELLS_BORDER. */
+  int *cell_class;
 }  DomainDecomposition;
 
 /************************************************************/
@@ -201,11 +248,28 @@ int tclcallback_min_num_cells(Tcl_Interp *interp, void *_data);
 /** calculate physical (processor) minimal number of cells */
 int calc_processor_min_num_cells();
 
+/** Call a function for all local cells of the given classes. If \ref
+    threads_active, the cells are distributed over the threads colour
+    by colour (see \ref DomainDecomposition::color_cells), so that the
+    function may write to the particles of the cell and its interacting
+    neighbor cells without locking. While a ghost communication is
+    pending, it is progressed in between the cells.
+    @param cell_ia function to call, with the index of the cell in
+    \ref local_cells as argument.
+    @param classes the cells to loop over, \ref DD_CELLS_INNER, \ref
+    DD_CELLS_BORDER or \ref DD_CELLS_ALL.
+*/
+void dd_loop_cells_colored(void (*cell_ia)(int c), int classes);
+
 /** Calculate nonbonded and bonded forces with link-cell 
     method (without Verlet lists)
 */
 void calc_link_cell();
 
+/** Variant of \ref calc_link_cell working on the cell mirrors, see
+    \ref soa.h. */
+void calc_link_cell_soa();
+
 /** Nonbonded and bonded energy calculation using link-cell method */
 void calculate_link_cell_energies();
 
@@ -26,6 +26,7 @@
 */
 
 #include "utils.h"
+#include "random.h"
 #include "thermostat.h"
 #include "interaction_data.h"
 #include "virtual_sites.h"
@@ -44,6 +45,38 @@ extern double dpd_tr_cut;
 /** trans DPD thermostat weight function */
 extern int dpd_twf;
 
+#if defined(DPD) || defined(INTER_DPD)
+/** draw the random number of the longitudinal noise of the pair p1,
+    p2. It multiplies the distance vector p1 - p2, which already changes
+    sign under exchange of p1 and p2, so with the counter based
+    generator the number is drawn for the ordered pair and is the same
+    for both orders. */
+MDINLINE void dpd_pair_noise(int stream, Particle *p1, Particle *p2, double *u)
+{
+  if (random_backend == RANDOM_BACKEND_PHILOX && p1->p.identity > p2->p.identity)
+    noise_uniform(stream, p2->p.identity, p1->p.identity, 1, u);
+  else
+    noise_uniform(stream, p1->p.identity, p2->p.identity, 1, u);
+}
+
+/** draw the random vector of the transversal noise of the pair p1, p2.
+    The projection it is multiplied with does not change under exchange
+    of p1 and p2, so with the counter based generator the vector is
+    antisymmetric under this exchange, like the force. */
+MDINLINE void dpd_pair_noise_vec(int stream, Particle *p1, Particle *p2, double *u)
+{
+  int j;
+
+  if (random_backend == RANDOM_BACKEND_PHILOX && p1->p.identity > p2->p.identity) {
+    noise_uniform(stream, p2->p.identity, p1->p.identity, 3, u);
+    for (j = 0; j < 3; j++)
+      u[j] = -u[j];
+  }
+  else
+    noise_uniform(stream, p1->p.identity, p2->p.identity, 3, u);
+}
+#endif
+
 #ifdef DPD
 extern double dpd_r_cut_inv;
 extern double dpd_pref1;
@@ -80,7 +113,7 @@ MDINLINE void add_dpd_thermo_pair_force(Particle *p1, Particle *p2, double d[3],
   double dist_inv;
   // weighting functions for friction and random force
   double omega,omega2;// omega = w_R/dist
-  double friction, noise;
+  double friction, noise, rnd;
   //Projection martix
 #ifdef TRANS_DPD
   int i;
@@ -132,7 +165,8 @@ MDINLINE void add_dpd_thermo_pair_force(Particle *p1, Particle *p2, double d[3],
     for(j=0; j<3; j++)  vel12_dot_d12 += (p1->m.v[j] - p2->m.v[j]) * d[j];
     friction = dpd_pref1 * omega2 * vel12_dot_d12;
     // random force prefactor
-    noise    = dpd_pref2 * omega      * (d_random()-0.5);
+    dpd_pair_noise(PHILOX_STREAM_DPD, p1, p2, &rnd);
+    noise    = dpd_pref2 * omega      * rnd;
     for(j=0; j<3; j++) {
        p1->f.f[j] += ( tmp = (noise - friction)*d[j] );
        p2->f.f[j] -= tmp;
@@ -153,9 +187,8 @@ MDINLINE void add_dpd_thermo_pair_force(Particle *p1, Particle *p2, double d[3],
       omega*=sqrt(massf);
 #endif
       omega2   = SQR(omega);
+      dpd_pair_noise_vec(PHILOX_STREAM_TRANS_DPD, p1, p2, noise_vec);
       for (i=0;i<3;i++){
-        //noise vector
-        noise_vec[i]=d_random()-0.5;
         // Projection Matrix
         for (j=0;j<3;j++){
           P_times_dist_sqr[i][j]-=d[i]*d[j];
@@ -211,7 +244,7 @@ MDINLINE void add_inter_dpd_pair_force(Particle *p1, Particle *p2, IA_parameters
   double dist_inv;
   // weighting functions for friction and random force
   double omega,omega2;// omega = w_R/dist
-  double friction, noise;
+  double friction, noise, rnd;
   //Projection martix
   int i;
   double P_times_dist_sqr[3][3]={{0,0,0},{0,0,0},{0,0,0}},noise_vec[3];
@@ -258,7 +291,8 @@ MDINLINE void add_inter_dpd_pair_force(Particle *p1, Particle *p2, IA_parameters
     for(j=0; j<3; j++)  vel12_dot_d12 += (p1->m.v[j] - p2->m.v[j]) * d[j];
     friction = ia_params->dpd_pref1 * omega2 * vel12_dot_d12;
     // random force prefactor
-    noise    = ia_params->dpd_pref2 * omega      * (d_random()-0.5);
+    dpd_pair_noise(PHILOX_STREAM_INTER_DPD, p1, p2, &rnd);
+    noise    = ia_params->dpd_pref2 * omega      * rnd;
     for(j=0; j<3; j++) {
        p1->f.f[j] += ( tmp = (noise - friction)*d[j] );
        p2->f.f[j] -= tmp;
@@ -278,9 +312,8 @@ MDINLINE void add_inter_dpd_pair_force(Particle *p1, Particle *p2, IA_parameters
       omega*=sqrt(massf);
 #endif
       omega2   = SQR(omega);
+      dpd_pair_noise_vec(PHILOX_STREAM_INTER_TRANS_DPD, p1, p2, noise_vec);
       for (i=0;i<3;i++){
-        //noise vector
-        noise_vec[i]=d_random()-0.5;
         // Projection Matrix
         for (j=0;j<3;j++){
           P_times_dist_sqr[i][j]-=d[i]*d[j];
@@ -1476,7 +1476,7 @@ void ELC_P3M_charge_assign_both()
   /* charged particle counter, charge fraction counter */
   int cp_cnt=0;
   /* prepare local FFT mesh */
-  for(i=0; i<lm.size; i++) rs_mesh[i] = 0.0;
+  P3M_clear_charge_grid();
 
   for (c = 0; c < local_cells.n; c++) {
     cell = local_cells.cell[c];
@@ -1512,7 +1512,7 @@ void ELC_P3M_charge_assign_image()
   double pos[3];
   int i,c,np;
   /* prepare local FFT mesh */
-  for(i=0; i<lm.size; i++) rs_mesh[i] = 0.0;
+  P3M_clear_charge_grid();
 
   for (c = 0; c < local_cells.n; c++) {
     cell = local_cells.cell[c];
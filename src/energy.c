@@ -31,10 +31,15 @@
 #include "elc.h"
 #include "magnetic_non_p3m_methods.h"
 #include "mdlc_correction.h"
+#include "forces.h"
 
 Observable_stat energy = {0, {NULL,0,0}, 0,0,0};
 Observable_stat total_energy = {0, {NULL,0,0}, 0,0,0};
 
+/** the energies of this node from the last fused force calculation,
+    without the kinetic energy */
+static DoubleList fused_energy = {NULL, 0, 0};
+
 /************************************************************/
 /* local prototypes                                         */
 /************************************************************/
@@ -52,14 +57,28 @@ void master_energy_calc();
 
 void energy_calc(double *result)
 {
+  int fused, c, np, i;
+  Particle *p;
+
   if (!check_obs_calc_initialized())
     return;
 
   init_energies(&energy);
 
   on_observable_calc();
-  
-  switch (cell_structure.type) {
+
+  fused = obs_fused_cached(fused_energy.n == energy.data.n);
+  if (fused) {
+    /* only the kinetic energy is missing */
+    memcpy(energy.data.e, fused_energy.e, energy.data.n*sizeof(double));
+    for (c = 0; c < local_cells.n; c++) {
+      p  = local_cells.cell[c]->part;
+      np = local_cells.cell[c]->n;
+      for (i = 0; i < np; i++)
+	add_kinetic_energy(&p[i]);
+    }
+  }
+  else switch (cell_structure.type) {
   case CELL_STRUCTURE_LAYERED:
     layered_calculate_energies();
     break;
@@ -78,7 +97,8 @@ void energy_calc(double *result)
   /* rescale kinetic energy */
   energy.data.e[0] /= (2.0*time_step*time_step);
 
-  calc_long_range_energies();
+  if (!fused || !obs_fused_kspace())
+    calc_long_range_energies();
   
   /* gather data */
   MPI_Reduce(energy.data.e, result, energy.data.n, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
@@ -209,6 +229,19 @@ void init_energies(Observable_stat *stat)
 
 /************************************************************/
 
+void energy_fused_init()
+{
+  init_energies(&energy);
+}
+
+void energy_fused_store()
+{
+  realloc_doublelist(&fused_energy, fused_energy.n = energy.data.n);
+  memcpy(fused_energy.e, energy.data.e, energy.data.n*sizeof(double));
+}
+
+/************************************************************/
+
 void master_energy_calc() {
   mpi_gather_stats(1, total_energy.data.e, NULL, NULL, NULL);
 
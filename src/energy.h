@@ -77,6 +77,14 @@ extern Observable_stat energy, total_energy;
     @param result non-zero only on master node; will contain the cumulative over all nodes. */
 void energy_calc(double *result);
 
+/** clear the energies of this node before a fused force calculation,
+    which accumulates them, see \ref obs_fused. */
+void energy_fused_init();
+
+/** keep the energies of this node accumulated by a fused force
+    calculation for \ref energy_calc. */
+void energy_fused_store();
+
 /** Calculate non bonded energies between a pair of particles.
     @param p1        pointer to particle 1.
     @param p2        pointer to particle 2.
@@ -91,6 +99,7 @@ MDINLINE double calc_non_bonded_pair_energy(Particle *p1, Particle *p2,
 					    double d[3], double dist, double dist2)
 {
   double ret = 0;
+  int pot = ia_params->nb_potentials;
 
 #ifdef NO_INTRA_NB
   if (p1->p.mol_id==p2->p.mol_id) return 0;
@@ -101,78 +110,145 @@ MDINLINE double calc_non_bonded_pair_energy(Particle *p1, Particle *p2,
   if (checkIfParticlesInteractViaMolCut(p1,p2,ia_params)==0) return 0;
 #endif
 
+  /* only the potentials switched on for the two types */
+  if (ia_params->nb_kernel == NB_KERNEL_NONE) return 0;
+
 #ifdef LENNARD_JONES
   /* lennard jones */
-  ret += lj_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_LJ)
+    ret += lj_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef LENNARD_JONES_GENERIC
   /* Generic lennard jones */
-  ret += ljgen_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_LJGEN)
+    ret += ljgen_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef LJ_ANGLE
   /* Directional LJ */
-  ret += ljangle_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_LJANGLE)
+    ret += ljangle_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef SMOOTH_STEP
   /* smooth step */
-  ret += SmSt_pair_energy(p1,p2,ia_params,d,dist,dist2);
+  if (pot & NB_POT_SMOOTH_STEP)
+    ret += SmSt_pair_energy(p1,p2,ia_params,d,dist,dist2);
 #endif
 
 #ifdef HERTZIAN
   /* Hertzian potential */
-  ret += hertzian_pair_energy(p1,p2,ia_params,d,dist,dist2);
+  if (pot & NB_POT_HERTZIAN)
+    ret += hertzian_pair_energy(p1,p2,ia_params,d,dist,dist2);
 #endif
 
 #ifdef BMHTF_NACL
   /* BMHTF NaCl */
-  ret += BMHTF_pair_energy(p1,p2,ia_params,d,dist,dist2);
+  if (pot & NB_POT_BMHTF)
+    ret += BMHTF_pair_energy(p1,p2,ia_params,d,dist,dist2);
 #endif
 
 #ifdef MORSE
   /* morse */
-  ret +=morse_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_MORSE)
+    ret +=morse_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef BUCKINGHAM
   /* lennard jones */
-  ret  += buck_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_BUCKINGHAM)
+    ret  += buck_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef SOFT_SPHERE
   /* soft-sphere */
-  ret  += soft_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_SOFT_SPHERE)
+    ret  += soft_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef LJCOS2
   /* lennard jones */
-  ret += ljcos2_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_LJCOS2)
+    ret += ljcos2_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef TABULATED
   /* tabulated */
-  ret += tabulated_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_TABULATED)
+    ret += tabulated_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef LJCOS
   /* lennard jones cosine */
-  ret += ljcos_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_LJCOS)
+    ret += ljcos_pair_energy(p1,p2,ia_params,d,dist);
 #endif
   
 #ifdef GAY_BERNE
   /* Gay-Berne */
-  ret += gb_pair_energy(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_GAY_BERNE)
+    ret += gb_pair_energy(p1,p2,ia_params,d,dist);
 #endif
 
 #ifdef INTER_RF
-  ret += interrf_pair_energy(p1,p2,ia_params,dist);
+  if (pot & NB_POT_INTER_RF)
+    ret += interrf_pair_energy(p1,p2,ia_params,dist);
 #endif
 
   return ret;
 }
 
+#ifdef ELECTROSTATICS
+/** Calculate the real space coulomb energy between a pair of particles.
+    @param p1        pointer to particle 1.
+    @param p2        pointer to particle 2.
+    @param d         vector between p1 and p2. 
+    @param dist      distance between p1 and p2.
+    @param dist2     distance squared between p1 and p2.
+    @return the real space coulomb energy of the current method */
+MDINLINE double calc_coulomb_pair_energy(Particle *p1, Particle *p2, double d[3],
+					 double dist, double dist2)
+{
+  double ret = 0;
+
+  switch (coulomb.method) {
+#ifdef P3M
+  case COULOMB_P3M:
+    ret = p3m_coulomb_pair_energy(p1->p.q*p2->p.q,d,dist2,dist);
+    break;
+  case COULOMB_ELC_P3M:
+    ret = p3m_coulomb_pair_energy(p1->p.q*p2->p.q,d,dist2,dist);
+    if (elc_params.dielectric_contrast_on)
+      ret += 0.5*ELC_P3M_dielectric_layers_energy_contribution(p1,p2);
+    break;
+#endif
+  case COULOMB_EWALD:
+    ret = ewald_coulomb_pair_energy(p1,p2,d,dist2,dist);
+    break;
+  case COULOMB_DH:
+    ret = dh_coulomb_pair_energy(p1,p2,dist);
+    break;
+  case COULOMB_RF:
+    ret = rf_coulomb_pair_energy(p1,p2,dist);
+    break;
+  case COULOMB_INTER_RF:
+    //this is done above as interaction
+    ret = 0;
+    break;
+  case COULOMB_MMM1D:
+    ret = mmm1d_coulomb_pair_energy(p1,p2,d,dist2,dist);
+    break;
+  case COULOMB_MMM2D:
+    ret = mmm2d_coulomb_pair_energy(p1->p.q*p2->p.q,d,dist2,dist);
+    break;
+  default :
+    ret = 0.;
+  }
+  return ret;
+}
+#endif
+
 /** Add non bonded energies and short range coulomb between a pair of particles.
     @param p1        pointer to particle 1.
     @param p2        pointer to particle 2.
@@ -184,7 +260,7 @@ MDINLINE void add_non_bonded_pair_energy(Particle *p1, Particle *p2, double d[3]
 {
   IA_parameters *ia_params = get_ia_param(p1->p.type,p2->p.type);
 
-#if defined(ELECTROSTATICS) || defined(MAGNETOSTATICS)
+#ifdef MAGNETOSTATICS
   double ret = 0;
 #endif
 
@@ -192,43 +268,9 @@ MDINLINE void add_non_bonded_pair_energy(Particle *p1, Particle *p2, double d[3]
     calc_non_bonded_pair_energy(p1, p2, ia_params, d, dist, dist2);
 
 #ifdef ELECTROSTATICS
-  if (coulomb.method != COULOMB_NONE) {
-    /* real space coulomb */
-    switch (coulomb.method) {
-#ifdef P3M
-    case COULOMB_P3M:
-      ret = p3m_coulomb_pair_energy(p1->p.q*p2->p.q,d,dist2,dist);
-      break;
-    case COULOMB_ELC_P3M:
-      ret = p3m_coulomb_pair_energy(p1->p.q*p2->p.q,d,dist2,dist);
-      if (elc_params.dielectric_contrast_on)
-      ret += 0.5*ELC_P3M_dielectric_layers_energy_contribution(p1,p2);
-    break;
-#endif
-    case COULOMB_EWALD:
-      ret = ewald_coulomb_pair_energy(p1,p2,d,dist2,dist);
-      break;
-    case COULOMB_DH:
-      ret = dh_coulomb_pair_energy(p1,p2,dist);
-      break;
-    case COULOMB_RF:
-      ret = rf_coulomb_pair_energy(p1,p2,dist);
-      break;
-    case COULOMB_INTER_RF:
-      //this is done above as interaction
-      ret = 0;
-      break;
-    case COULOMB_MMM1D:
-      ret = mmm1d_coulomb_pair_energy(p1,p2,d,dist2,dist);
-      break;
-    case COULOMB_MMM2D:
-      ret = mmm2d_coulomb_pair_energy(p1->p.q*p2->p.q,d,dist2,dist);
-      break;
-    default :
-      ret = 0.;
-    }
-    energy.coulomb[0] += ret;
-  }
+  /* real space coulomb */
+  if (coulomb.method != COULOMB_NONE)
+    energy.coulomb[0] += calc_coulomb_pair_energy(p1, p2, d, dist, dist2);
 #endif
 
 #ifdef MAGNETOSTATICS
@@ -22,6 +22,9 @@
 */
 #include <mpi.h>
 #include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "utils.h"
 #include "errorhandling.h"
 
@@ -30,13 +33,40 @@
 char *error_msg;
 int n_error_msg = 0;
 
+/******************* local variables **********************/
+
+#ifdef _OPENMP
+/** error messages left by threads in a parallel region. Since the
+    threads cannot resize \ref error_msg while others write to it, each
+    message gets its own buffer, which is appended to \ref error_msg by
+    \ref check_runtime_errors. */
+static char **thread_error_msg = NULL;
+static int n_thread_error_msg = 0;
+#endif
+
 /******************* exported functions **********************/
 
 char *runtime_error(int errlen)
 {
+  int curend;
+
+#ifdef _OPENMP
+  if (omp_in_parallel()) {
+    char *msg = malloc(errlen + 1);
+    msg[0] = 0;
+#pragma omp critical(runtime_error)
+    {
+      thread_error_msg = realloc(thread_error_msg, (n_thread_error_msg + 1)*sizeof(char *));
+      thread_error_msg[n_thread_error_msg++] = msg;
+      n_error_msg += errlen + 1;
+    }
+    return msg;
+  }
+#endif
+
   /* the true length of the string will be in general shorter than n_error_msg,
      at least if numbers are involved */
-  int curend = error_msg ? strlen(error_msg) : 0;
+  curend = error_msg ? strlen(error_msg) : 0;
   n_error_msg = curend + errlen + 1;
  
   error_msg = realloc(error_msg, n_error_msg);
@@ -46,6 +76,15 @@ char *runtime_error(int errlen)
 int check_runtime_errors()
 {
   int n_all_error_msg;
+#ifdef _OPENMP
+  int i;
+
+  for (i = 0; i < n_thread_error_msg; i++) {
+    strcpy(runtime_error(strlen(thread_error_msg[i])), thread_error_msg[i]);
+    free(thread_error_msg[i]);
+  }
+  n_thread_error_msg = 0;
+#endif
   MPI_Allreduce(&n_error_msg, &n_all_error_msg, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
   return n_all_error_msg;
 }
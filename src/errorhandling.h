@@ -35,7 +35,8 @@ extern int n_error_msg;
 /* request space for leaving an error message to be passed to the master node.
    Also takes care of the error counter.
    @param errlen maximal length of the error message. If you use sprintf to create the error
-   message, remember to use TCL_INTEGER/DOUBLE_SPACE as usual
+   message, remember to use TCL_INTEGER/DOUBLE_SPACE as usual. Can also be called
+   from several threads within an OpenMP parallel region.
    @return where to put the (null-terminated) string */
 char *runtime_error(int errlen);
 
@@ -47,6 +47,7 @@ void *fftw_malloc(size_t n);
 #include "fft.h"
 #include "p3m.h"
 #include "p3m-magnetostatics.h"
+#include "timers.h"
 
 /************************************************
  * DEFINES
@@ -55,10 +56,6 @@ void *fftw_malloc(size_t n);
 /* MPI tags for the fft communications: */
 /** Tag for communication in fft_init() */
 #define REQ_FFT_INIT   300
-/** Tag for communication in forw_grid_comm() */
-#define REQ_FFT_FORW   301
-/** Tag for communication in back_grid_comm() */
-#define REQ_FFT_BACK   302
 /* Tag for wisdom file I/O */
 #  define FFTW_FAILURE 0
 
@@ -127,9 +124,9 @@ static fftw_complex *Dc_data_buf;
  *  with the node identities for grid1. The linear list (node_list2)
  *  for the second grid is calculated. For the communication group of
  *  the calling node it calculates a list (group) with the node
- *  identities and the positions (pos1, pos2) of that nodes in grid1
- *  and grid2. The return value is the size of the communication
- *  group. It gives -1 if the two grids do not fit to each other
+ *  identities, sorted by identity, and the positions (pos1, pos2) of
+ *  that nodes in grid1 and grid2. The return value is the size of the
+ *  communication group. It gives -1 if the two grids do not fit to each other
  *  (grid1 and grid2 have to be component wise multiples of each
  *  other. see e.g. \ref calc_2d_grid in \ref grid.c for how to do
  *  this.).
@@ -189,8 +186,20 @@ int calc_local_mesh(int n_pos[3], int n_grid[3], int mesh[3], double mesh_off[3]
 int calc_send_block(int pos1[3], int grid1[3], int pos2[3], int grid2[3], 
 		    int mesh[3], double mesh_off[3], int block[6]);
 
+/** Set up the communicator of the communication group of a plan and
+ *  the offsets of the send and recv blocks in the communication
+ *  buffers, which are needed by the all-to-all in \ref
+ *  forw_grid_comm. The group and the block sizes have to be
+ *  calculated before. Has to be called on all nodes.
+ *
+ *  \return      size of the communication buffers needed by the plan.
+ *  \param  plan communication plan (see \ref fft_forw_plan).
+*/
+int fft_init_group_comm(fft_forw_plan *plan);
+
 #ifdef  P3M
-/** communicate the grid data according to the given fft_forw_plan. 
+/** communicate the grid data according to the given fft_forw_plan,
+ *  by one all-to-all of the packed blocks within the communication group.
  * \param plan communication plan (see \ref fft_forw_plan).
  * \param in   input mesh.
  * \param out  output mesh.
@@ -207,7 +216,8 @@ void back_grid_comm(fft_forw_plan plan_f, fft_back_plan plan_b, double *in, doub
 #endif
 
 #ifdef  DP3M
-/** communicate the grid data according to the given fft_forw_plan. 
+/** communicate the grid data according to the given fft_forw_plan,
+ *  by one all-to-all of the packed blocks within the communication group.
  * \param plan communication plan (see \ref fft_forw_plan).
  * \param in   input mesh.
  * \param out  output mesh.
@@ -243,6 +253,8 @@ void fft_pre_init()
     fft_plan[i].send_size  = NULL;
     fft_plan[i].recv_block = NULL;
     fft_plan[i].recv_size  = NULL;
+    fft_plan[i].send_disp  = NULL;
+    fft_plan[i].recv_disp  = NULL;
   }
 #endif
 
@@ -253,13 +265,26 @@ void fft_pre_init()
     Dfft_plan[i].send_size  = NULL;
     Dfft_plan[i].recv_block = NULL;
     Dfft_plan[i].recv_size  = NULL;
+    Dfft_plan[i].send_disp  = NULL;
+    Dfft_plan[i].recv_disp  = NULL;
   }
 #endif
 
 }
 
 #ifdef P3M
-int fft_init(double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum)
+/** Initialize a set of plans for the 3D-FFT of a mesh, see \ref fft_init.
+ * \param plan     the forward plans (output).
+ * \param back     the backward plans (output).
+ * \param init_tag whether the FFTW plans of plan and back exist.
+ * \param mesh     global mesh dimensions.
+ * \param mesh_off global mesh offset (see \ref p3m_struct).
+ * \param flags    FFTW planner flags. Estimated plans do not use the wisdom files.
+ * \return size of the local fft mesh, see \ref fft_init.
+ */
+static int fft_init_plans(fft_forw_plan *plan, fft_back_plan *back, int *init_tag,
+			  int mesh[3], double mesh_off[3], unsigned flags,
+			  double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum)
 {
   int i,j;
   /* helpers */
@@ -273,11 +298,13 @@ int fft_init(double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum)
   char wisdom_file_name[255];
   FILE *wisdom_file;
   int wisdom_status;
+  /* sizes of the communication buffers and of the local fft mesh */
+  int comm_size=0, mesh_size;
+  /* global mesh in k-space, and the global mesh of the current plan */
+  int ks_mesh[3], *g_mesh;
 
-  FFT_TRACE(fprintf(stderr,"%d: fft_init():\n",this_node));
+  FFT_TRACE(fprintf(stderr,"%d: fft_init_plans():\n",this_node));
 
-
-  max_comm_size=0; max_mesh_size=0;
   for(i=0;i<4;i++) {
     n_id[i]  = malloc(1*n_nodes*sizeof(int));
     n_pos[i] = malloc(3*n_nodes*sizeof(int));
@@ -298,128 +325,141 @@ int fft_init(double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum)
   /* FFT node grids (n_grid[1 - 3]) */
   calc_2d_grid(n_nodes,n_grid[1]);
   /* resort n_grid[1] dimensions if necessary */
-  fft_plan[1].row_dir = map_3don2d_grid(n_grid[0], n_grid[1], mult);
-  fft_plan[0].n_permute = 0;
-  for(i=1;i<4;i++) fft_plan[i].n_permute = (fft_plan[1].row_dir+i)%3;
+  plan[1].row_dir = map_3don2d_grid(n_grid[0], n_grid[1], mult);
+  plan[0].n_permute = 0;
+  for(i=1;i<4;i++) plan[i].n_permute = (plan[1].row_dir+i)%3;
   for(i=0;i<3;i++) {
     n_grid[2][i] = n_grid[1][(i+1)%3];
     n_grid[3][i] = n_grid[1][(i+2)%3];
   }
-  fft_plan[2].row_dir = (fft_plan[1].row_dir-1)%3;
-  fft_plan[3].row_dir = (fft_plan[1].row_dir-2)%3;
+  plan[2].row_dir = (plan[1].row_dir-1)%3;
+  plan[3].row_dir = (plan[1].row_dir-2)%3;
 
+  /* the real to complex FFT of the first direction only keeps the
+     frequencies 0..mesh/2 of that direction */
+  for(i=0;i<3;i++) ks_mesh[i] = mesh[i];
+  ks_mesh[plan[1].row_dir] = mesh[plan[1].row_dir]/2 + 1;
 
 
   /* === communication groups === */
   /* copy local mesh off real space charge assignment grid */
-  for(i=0;i<3;i++) fft_plan[0].new_mesh[i] = ca_mesh_dim[i];
+  for(i=0;i<3;i++) plan[0].new_mesh[i] = ca_mesh_dim[i];
   for(i=1; i<4;i++) {
-    fft_plan[i].g_size=find_comm_groups(n_grid[i-1], n_grid[i], n_id[i-1], n_id[i], 
-					fft_plan[i].group, n_pos[i], my_pos[i]);
-    if(fft_plan[i].g_size==-1) {
+    g_mesh = (i==1) ? mesh : ks_mesh;
+    if(!plan[i].group) plan[i].group = malloc(1*n_nodes*sizeof(int));
+    plan[i].g_size=find_comm_groups(n_grid[i-1], n_grid[i], n_id[i-1], n_id[i], 
+					plan[i].group, n_pos[i], my_pos[i]);
+    if(plan[i].g_size==-1) {
       /* try permutation */
-      j = n_grid[i][(fft_plan[i].row_dir+1)%3];
-      n_grid[i][(fft_plan[i].row_dir+1)%3] = n_grid[i][(fft_plan[i].row_dir+2)%3];
-      n_grid[i][(fft_plan[i].row_dir+2)%3] = j;
-      fft_plan[i].g_size=find_comm_groups(n_grid[i-1], n_grid[i], n_id[i-1], n_id[i], 
-					  fft_plan[i].group, n_pos[i], my_pos[i]);
-      if(fft_plan[i].g_size==-1) {
+      j = n_grid[i][(plan[i].row_dir+1)%3];
+      n_grid[i][(plan[i].row_dir+1)%3] = n_grid[i][(plan[i].row_dir+2)%3];
+      n_grid[i][(plan[i].row_dir+2)%3] = j;
+      plan[i].g_size=find_comm_groups(n_grid[i-1], n_grid[i], n_id[i-1], n_id[i], 
+					  plan[i].group, n_pos[i], my_pos[i]);
+      if(plan[i].g_size==-1) {
 	fprintf(stderr,"%d: INTERNAL ERROR: find_comm_groups error\n", this_node);
 	errexit();
       }
     }
 
-    fft_plan[i].send_block = (int *)realloc(fft_plan[i].send_block, 6*fft_plan[i].g_size*sizeof(int));
-    fft_plan[i].send_size  = (int *)realloc(fft_plan[i].send_size, 1*fft_plan[i].g_size*sizeof(int));
-    fft_plan[i].recv_block = (int *)realloc(fft_plan[i].recv_block, 6*fft_plan[i].g_size*sizeof(int));
-    fft_plan[i].recv_size  = (int *)realloc(fft_plan[i].recv_size, 1*fft_plan[i].g_size*sizeof(int));
+    plan[i].send_block = (int *)realloc(plan[i].send_block, 6*plan[i].g_size*sizeof(int));
+    plan[i].send_size  = (int *)realloc(plan[i].send_size, 1*plan[i].g_size*sizeof(int));
+    plan[i].recv_block = (int *)realloc(plan[i].recv_block, 6*plan[i].g_size*sizeof(int));
+    plan[i].recv_size  = (int *)realloc(plan[i].recv_size, 1*plan[i].g_size*sizeof(int));
 
-    fft_plan[i].new_size = calc_local_mesh(my_pos[i], n_grid[i], p3m.mesh,
-					   p3m.mesh_off, fft_plan[i].new_mesh, 
-					   fft_plan[i].start);  
-    permute_ifield(fft_plan[i].new_mesh,3,-(fft_plan[i].n_permute));
-    permute_ifield(fft_plan[i].start,3,-(fft_plan[i].n_permute));
-    fft_plan[i].n_ffts = fft_plan[i].new_mesh[0]*fft_plan[i].new_mesh[1];
+    plan[i].new_size = calc_local_mesh(my_pos[i], n_grid[i], g_mesh,
+					   mesh_off, plan[i].new_mesh, 
+					   plan[i].start);  
+    permute_ifield(plan[i].new_mesh,3,-(plan[i].n_permute));
+    permute_ifield(plan[i].start,3,-(plan[i].n_permute));
+    plan[i].n_ffts = plan[i].new_mesh[0]*plan[i].new_mesh[1];
 
     /* === send/recv block specifications === */
-    for(j=0; j<fft_plan[i].g_size; j++) {
+    for(j=0; j<plan[i].g_size; j++) {
       int k, node;
       /* send block: this_node to comm-group-node i (identity: node) */
-      node = fft_plan[i].group[j];
-      fft_plan[i].send_size[j] 
+      node = plan[i].group[j];
+      plan[i].send_size[j] 
 	= calc_send_block(my_pos[i-1], n_grid[i-1], &(n_pos[i][3*node]), n_grid[i],
-			  p3m.mesh, p3m.mesh_off, &(fft_plan[i].send_block[6*j]));
-      permute_ifield(&(fft_plan[i].send_block[6*j]),3,-(fft_plan[i-1].n_permute));
-      permute_ifield(&(fft_plan[i].send_block[6*j+3]),3,-(fft_plan[i-1].n_permute));
-      if(fft_plan[i].send_size[j] > max_comm_size) 
-	max_comm_size = fft_plan[i].send_size[j];
+			  g_mesh, mesh_off, &(plan[i].send_block[6*j]));
+      permute_ifield(&(plan[i].send_block[6*j]),3,-(plan[i-1].n_permute));
+      permute_ifield(&(plan[i].send_block[6*j+3]),3,-(plan[i-1].n_permute));
       /* First plan send blocks have to be adjusted, since the CA grid
 	 may have an additional margin outside the actual domain of the
 	 node */
       if(i==1) {
 	for(k=0;k<3;k++) 
-	  fft_plan[1].send_block[6*j+k  ] += ca_mesh_margin[2*k];
+	  plan[1].send_block[6*j+k  ] += ca_mesh_margin[2*k];
       }
       /* recv block: this_node from comm-group-node i (identity: node) */
-      fft_plan[i].recv_size[j] 
+      plan[i].recv_size[j] 
 	= calc_send_block(my_pos[i], n_grid[i], &(n_pos[i-1][3*node]), n_grid[i-1],
-			  p3m.mesh,p3m.mesh_off,&(fft_plan[i].recv_block[6*j]));
-      permute_ifield(&(fft_plan[i].recv_block[6*j]),3,-(fft_plan[i].n_permute));
-      permute_ifield(&(fft_plan[i].recv_block[6*j+3]),3,-(fft_plan[i].n_permute));
-      if(fft_plan[i].recv_size[j] > max_comm_size) 
-	max_comm_size = fft_plan[i].recv_size[j];
+			  g_mesh,mesh_off,&(plan[i].recv_block[6*j]));
+      permute_ifield(&(plan[i].recv_block[6*j]),3,-(plan[i].n_permute));
+      permute_ifield(&(plan[i].recv_block[6*j+3]),3,-(plan[i].n_permute));
     }
 
-    for(j=0;j<3;j++) fft_plan[i].old_mesh[j] = fft_plan[i-1].new_mesh[j];
+    for(j=0;j<3;j++) plan[i].old_mesh[j] = plan[i-1].new_mesh[j];
+    /* the first FFT halves the row direction */
+    if(i==2) plan[2].old_mesh[2] = plan[1].new_mesh[2]/2 + 1;
     if(i==1) 
-      fft_plan[i].element = 1; 
+      plan[i].element = 1; 
     else {
-      fft_plan[i].element = 2;
-      for(j=0; j<fft_plan[i].g_size; j++) {
-	fft_plan[i].send_size[j] *= 2;
-	fft_plan[i].recv_size[j] *= 2;
+      plan[i].element = 2;
+      for(j=0; j<plan[i].g_size; j++) {
+	plan[i].send_size[j] *= 2;
+	plan[i].recv_size[j] *= 2;
       }
     }
+    j = fft_init_group_comm(&plan[i]);
+    if(j > comm_size) comm_size = j;
     /* DEBUG */
     for(j=0;j<n_nodes;j++) {
       /* MPI_Barrier(MPI_COMM_WORLD); */
-      if(j==this_node) FFT_TRACE(print_fft_plan(fft_plan[i]));
+      if(j==this_node) FFT_TRACE(print_fft_plan(plan[i]));
     }
   }
 
-  /* Factor 2 for complex fields */
-  max_comm_size *= 2;
-  max_mesh_size = (ca_mesh_dim[0]*ca_mesh_dim[1]*ca_mesh_dim[2]);
+  mesh_size = (ca_mesh_dim[0]*ca_mesh_dim[1]*ca_mesh_dim[2]);
   for(i=1;i<4;i++) 
-    if(2*fft_plan[i].new_size > max_mesh_size) max_mesh_size = 2*fft_plan[i].new_size;
+    if(2*plan[i].new_size > mesh_size) mesh_size = 2*plan[i].new_size;
+  /* output of the real to complex FFT */
+  if(2*plan[1].n_ffts*(plan[1].new_mesh[2]/2+1) > mesh_size)
+    mesh_size = 2*plan[1].n_ffts*(plan[1].new_mesh[2]/2+1);
 
-  FFT_TRACE(fprintf(stderr,"%d: max_comm_size = %d, max_mesh_size = %d\n",
-		    this_node,max_comm_size,max_mesh_size));
+  FFT_TRACE(fprintf(stderr,"%d: comm_size = %d, mesh_size = %d\n",
+		    this_node,comm_size,mesh_size));
 
   /* === pack function === */
   for(i=1;i<4;i++) {
-    fft_plan[i].pack_function = pack_block_permute2; 
+    plan[i].pack_function = pack_block_permute2; 
     FFT_TRACE(fprintf(stderr,"%d: forw plan[%d] permute 2 \n",this_node,i));
   }
   (*ks_pnum)=6;
-  if(fft_plan[1].row_dir==2) {
-    fft_plan[1].pack_function = pack_block;
+  if(plan[1].row_dir==2) {
+    plan[1].pack_function = pack_block;
     FFT_TRACE(fprintf(stderr,"%d: forw plan[%d] permute 0 \n",this_node,1));
     (*ks_pnum)=4;
   }
-  else if(fft_plan[1].row_dir==1) {
-    fft_plan[1].pack_function = pack_block_permute1;
+  else if(plan[1].row_dir==1) {
+    plan[1].pack_function = pack_block_permute1;
     FFT_TRACE(fprintf(stderr,"%d: forw plan[%d] permute 1 \n",this_node,1));
     (*ks_pnum)=5;
   }
   
-  /* Factor 2 for complex numbers */
-  send_buf = (double *)realloc(send_buf, max_comm_size*sizeof(double));
-  recv_buf = (double *)realloc(recv_buf, max_comm_size*sizeof(double));
+  /* the buffers are shared by all plans and therefore only grow */
+  if(comm_size > max_comm_size) {
+    max_comm_size = comm_size;
+    send_buf = (double *)realloc(send_buf, max_comm_size*sizeof(double));
+    recv_buf = (double *)realloc(recv_buf, max_comm_size*sizeof(double));
+  }
   if (*data) fftw_free(*data);
-  (*data)  = (double *)fftw_malloc(max_mesh_size*sizeof(double));
-  if (data_buf) fftw_free(data_buf);
-  data_buf = (double *)fftw_malloc(max_mesh_size*sizeof(double));
+  (*data)  = (double *)fftw_malloc(mesh_size*sizeof(double));
+  if(mesh_size > max_mesh_size) {
+    max_mesh_size = mesh_size;
+    if (data_buf) fftw_free(data_buf);
+    data_buf = (double *)fftw_malloc(max_mesh_size*sizeof(double));
+  }
   if(!(*data) || !data_buf || !recv_buf || !send_buf) {
     fprintf(stderr,"%d: Could not allocate FFT data arays\n",this_node);
     errexit();
@@ -430,75 +470,108 @@ int fft_init(double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum)
 
   /* === FFT Routines (Using FFTW / RFFTW package)=== */
   for(i=1;i<4;i++) {
-    fft_plan[i].dir = FFTW_FORWARD;   
+    plan[i].dir = FFTW_FORWARD;   
     /* FFT plan creation. 
        Attention: destroys contents of c_data/data and c_data_buf/data_buf. */
     wisdom_status   = FFTW_FAILURE;
-    sprintf(wisdom_file_name,"fftw3_1d_wisdom_forw_n%d.file",
-	    fft_plan[i].new_mesh[2]);
-    if( (wisdom_file=fopen(wisdom_file_name,"r"))!=NULL ) {
+    sprintf(wisdom_file_name,"fftw3_1d_wisdom_%s_n%d.file",
+	    (i==1) ? "r2c" : "forw", plan[i].new_mesh[2]);
+    if( flags != FFTW_ESTIMATE && (wisdom_file=fopen(wisdom_file_name,"r"))!=NULL ) {
       wisdom_status = fftw_import_wisdom_from_file(wisdom_file);
       fclose(wisdom_file);
     }
-    if(fft_init_tag==1) fftw_destroy_plan(fft_plan[i].fft_plan);
-//printf("fft_plan[%d].n_ffts=%d\n",i,fft_plan[i].n_ffts);
-    fft_plan[i].fft_plan =
-      fftw_plan_many_dft(1,&fft_plan[i].new_mesh[2],fft_plan[i].n_ffts,
-                         c_data,NULL,1,fft_plan[i].new_mesh[2],
-                         c_data,NULL,1,fft_plan[i].new_mesh[2],
-                         fft_plan[i].dir,FFTW_PATIENT);
-    if( wisdom_status == FFTW_FAILURE && 
+    if((*init_tag)==1) fftw_destroy_plan(plan[i].fft_plan);
+//printf("plan[%d].n_ffts=%d\n",i,plan[i].n_ffts);
+    if(i==1)
+      /* real to complex, out of place from data_buf to data */
+      plan[i].fft_plan =
+	fftw_plan_many_dft_r2c(1,&plan[i].new_mesh[2],plan[i].n_ffts,
+			       data_buf,NULL,1,plan[i].new_mesh[2],
+			       c_data,NULL,1,plan[i].new_mesh[2]/2+1,
+			       flags);
+    else
+      plan[i].fft_plan =
+	fftw_plan_many_dft(1,&plan[i].new_mesh[2],plan[i].n_ffts,
+			   c_data,NULL,1,plan[i].new_mesh[2],
+			   c_data,NULL,1,plan[i].new_mesh[2],
+			   plan[i].dir,flags);
+    if( flags != FFTW_ESTIMATE && wisdom_status == FFTW_FAILURE && 
 	(wisdom_file=fopen(wisdom_file_name,"w"))!=NULL ) {
       fftw_export_wisdom_to_file(wisdom_file);
       fclose(wisdom_file);
     }
-    fft_plan[i].fft_function = fftw_execute;       
+    plan[i].fft_function = fftw_execute;       
   }
 
   /* === The BACK Direction === */
   /* this is needed because slightly different functions are used */
   for(i=1;i<4;i++) {
-    fft_back[i].dir = FFTW_BACKWARD;
+    back[i].dir = FFTW_BACKWARD;
     wisdom_status   = FFTW_FAILURE;
-    sprintf(wisdom_file_name,"fftw3_1d_wisdom_back_n%d.file",
-	    fft_plan[i].new_mesh[2]);
-    if( (wisdom_file=fopen(wisdom_file_name,"r"))!=NULL ) {
+    sprintf(wisdom_file_name,"fftw3_1d_wisdom_%s_n%d.file",
+	    (i==1) ? "c2r" : "back", plan[i].new_mesh[2]);
+    if( flags != FFTW_ESTIMATE && (wisdom_file=fopen(wisdom_file_name,"r"))!=NULL ) {
       wisdom_status = fftw_import_wisdom_from_file(wisdom_file);
       fclose(wisdom_file);
     }    
-    if(fft_init_tag==1) fftw_destroy_plan(fft_back[i].fft_plan);
-    fft_back[i].fft_plan =
-      fftw_plan_many_dft(1,&fft_plan[i].new_mesh[2],fft_plan[i].n_ffts,
-                         c_data,NULL,1,fft_plan[i].new_mesh[2],
-                         c_data,NULL,1,fft_plan[i].new_mesh[2],
-                         fft_back[i].dir,FFTW_PATIENT);
-    if( wisdom_status == FFTW_FAILURE && 
+    if((*init_tag)==1) fftw_destroy_plan(back[i].fft_plan);
+    if(i==1)
+      /* complex to real, out of place from data to data_buf */
+      back[i].fft_plan =
+	fftw_plan_many_dft_c2r(1,&plan[i].new_mesh[2],plan[i].n_ffts,
+			       c_data,NULL,1,plan[i].new_mesh[2]/2+1,
+			       data_buf,NULL,1,plan[i].new_mesh[2],
+			       flags);
+    else
+      back[i].fft_plan =
+	fftw_plan_many_dft(1,&plan[i].new_mesh[2],plan[i].n_ffts,
+			   c_data,NULL,1,plan[i].new_mesh[2],
+			   c_data,NULL,1,plan[i].new_mesh[2],
+			   back[i].dir,flags);
+    if( flags != FFTW_ESTIMATE && wisdom_status == FFTW_FAILURE && 
 	(wisdom_file=fopen(wisdom_file_name,"w"))!=NULL ) {
       fftw_export_wisdom_to_file(wisdom_file);
       fclose(wisdom_file);
     }
-    fft_back[i].fft_function = fftw_execute;
-    fft_back[i].pack_function = pack_block_permute1;
+    back[i].fft_function = fftw_execute;
+    back[i].pack_function = pack_block_permute1;
     FFT_TRACE(fprintf(stderr,"%d: back plan[%d] permute 1 \n",this_node,i));
   }
-  if(fft_plan[1].row_dir==2) {
-    fft_back[1].pack_function = pack_block;
+  if(plan[1].row_dir==2) {
+    back[1].pack_function = pack_block;
     FFT_TRACE(fprintf(stderr,"%d: back plan[%d] permute 0 \n",this_node,1));
   }
-  else if(fft_plan[1].row_dir==1) {
-    fft_back[1].pack_function = pack_block_permute2;
+  else if(plan[1].row_dir==1) {
+    back[1].pack_function = pack_block_permute2;
     FFT_TRACE(fprintf(stderr,"%d: back plan[%d] permute 2 \n",this_node,1));
   }
-  fft_init_tag=1;
+  (*init_tag)=1;
   /* free(data); */
   for(i=0;i<4;i++) { free(n_id[i]); free(n_pos[i]); }
-  return max_mesh_size; 
+  return mesh_size; 
 }
 
-void fft_perform_forw(double *data)
+int fft_init(double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum)
 {
-  int i;
-  /* int m,n,o; */
+  return fft_init_plans(fft_plan, fft_back, &fft_init_tag, p3m.mesh, p3m.mesh_off, FFTW_PATIENT,
+			data, ca_mesh_dim, ca_mesh_margin, ks_pnum);
+}
+
+int fft_mesh_init(fft_mesh_plans *plans, int mesh[3], double mesh_off[3],
+		  double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum)
+{
+  return fft_init_plans(plans->plan, plans->back, &plans->init_tag, mesh, mesh_off, FFTW_ESTIMATE,
+			data, ca_mesh_dim, ca_mesh_margin, ks_pnum);
+}
+
+/** perform the forward 3D FFT of a mesh, see \ref fft_perform_forw.
+    \param plan the forward plans.
+    \param data Mesh.
+*/
+static void fft_perform_forw_plans(fft_forw_plan *plan, double *data)
+{
+  /* int i,m,n,o; */
+  timer_start(TIMER_FFT);
   /* ===== first direction  ===== */
   FFT_TRACE(fprintf(stderr,"%d: fft_perform_forw: dir 1:\n",this_node));
 
@@ -506,7 +579,7 @@ void fft_perform_forw(double *data)
   c_data_buf = (fftw_complex *) data_buf;
 
   /* communication to current dir row format (in is data) */
-  forw_grid_comm(fft_plan[1], data, data_buf);
+  forw_grid_comm(plan[1], data, data_buf);
 
 
   /*
@@ -523,34 +596,39 @@ void fft_perform_forw(double *data)
     }
   */
 
-  /* complexify the real data array (in is data_buf) */
-  for(i=0;i<fft_plan[1].new_size;i++) {
-    data[2*i]     = data_buf[i];     /* real value */
-    data[(2*i)+1] = 0;       /* complex value */
-  }
-  /* perform FFT (in/out is data)*/
-  fftw_execute_dft(fft_plan[1].fft_plan,c_data,c_data);
+  /* perform real to complex FFT (in is data_buf, out is data) */
+  fftw_execute_dft_r2c(plan[1].fft_plan,data_buf,c_data);
   /* ===== second direction ===== */
   FFT_TRACE(fprintf(stderr,"%d: fft_perform_forw: dir 2:\n",this_node));
   /* communication to current dir row format (in is data) */
-  forw_grid_comm(fft_plan[2], data, data_buf);
+  forw_grid_comm(plan[2], data, data_buf);
   /* perform FFT (in/out is data_buf)*/
-  fftw_execute_dft(fft_plan[2].fft_plan,c_data_buf,c_data_buf);
+  fftw_execute_dft(plan[2].fft_plan,c_data_buf,c_data_buf);
   /* ===== third direction  ===== */
   FFT_TRACE(fprintf(stderr,"%d: fft_perform_forw: dir 3:\n",this_node));
   /* communication to current dir row format (in is data_buf) */
-  forw_grid_comm(fft_plan[3], data_buf, data);
+  forw_grid_comm(plan[3], data_buf, data);
   /* perform FFT (in/out is data)*/
-  fftw_execute_dft(fft_plan[3].fft_plan,c_data,c_data);
-  //print_global_fft_mesh(fft_plan[3],data,1,0);
+  fftw_execute_dft(plan[3].fft_plan,c_data,c_data);
+  //print_global_fft_mesh(plan[3],data,1,0);
 
+  timer_stop(TIMER_FFT);
   /* REMARK: Result has to be in data. */
 }
 
+void fft_perform_forw(double *data)
+{
+  fft_perform_forw_plans(fft_plan, data);
+}
+
+void fft_mesh_perform_forw(fft_mesh_plans *plans, double *data)
+{
+  fft_perform_forw_plans(plans->plan, data);
+}
+
 void fft_perform_back(double *data)
 {
-  int i;
-  
+  timer_start(TIMER_FFT);
 //The next 4 lines were added by Vincent:
 
   c_data     = (fftw_complex *) data;
@@ -574,21 +652,13 @@ void fft_perform_back(double *data)
 
   /* ===== first direction  ===== */
   FFT_TRACE(fprintf(stderr,"%d: fft_perform_back: dir 1:\n",this_node));
-  /* perform FFT (in is data) */
-  fftw_execute_dft(fft_back[1].fft_plan,c_data,c_data);
-  /* throw away the (hopefully) empty complex component (in is data)*/
-  for(i=0;i<fft_plan[1].new_size;i++) {
-    data_buf[i] = data[2*i]; /* real value */
-    //Vincent:
-    if (data[2*i+1]>1e-5) {
-      printf("Complex value is not zero (i=%d,data=%g)!!!\n",i,data[2*i+1]);
-      if (i>100) exit(-1);
-      } 
-  }
+  /* perform complex to real FFT (in is data, out is data_buf) */
+  fftw_execute_dft_c2r(fft_back[1].fft_plan,c_data,data_buf);
   /* communicate (in is data_buf) */
   back_grid_comm(fft_plan[1],fft_back[1],data_buf,data);
 
 
+  timer_stop(TIMER_FFT);
   /* REMARK: Result has to be in data. */
 }
 
@@ -609,6 +679,8 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
   char wisdom_file_name[255];
   FILE *wisdom_file;
   int wisdom_status;
+  /* global mesh in k-space, and the global mesh of the current plan */
+  int ks_mesh[3], *g_mesh;
 
   FFT_TRACE(fprintf(stderr,"%d: dipolar Dfft_init():\n",this_node));
 
@@ -644,12 +716,17 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
   Dfft_plan[2].row_dir = (Dfft_plan[1].row_dir-1)%3;
   Dfft_plan[3].row_dir = (Dfft_plan[1].row_dir-2)%3;
 
+  /* the real to complex FFT of the first direction only keeps the
+     frequencies 0..mesh/2 of that direction */
+  for(i=0;i<3;i++) ks_mesh[i] = Dp3m.mesh[i];
+  ks_mesh[Dfft_plan[1].row_dir] = Dp3m.mesh[Dfft_plan[1].row_dir]/2 + 1;
 
 
   /* === communication groups === */
   /* copy local mesh off real space charge assignment grid */
   for(i=0;i<3;i++) Dfft_plan[0].new_mesh[i] = Dca_mesh_dim[i];
   for(i=1; i<4;i++) {
+    g_mesh = (i==1) ? Dp3m.mesh : ks_mesh;
     Dfft_plan[i].g_size=find_comm_groups(n_grid[i-1], n_grid[i], n_id[i-1], n_id[i], 
 					Dfft_plan[i].group, n_pos[i], my_pos[i]);
     if(Dfft_plan[i].g_size==-1) {
@@ -670,7 +747,7 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
     Dfft_plan[i].recv_block = (int *)realloc(Dfft_plan[i].recv_block, 6*Dfft_plan[i].g_size*sizeof(int));
     Dfft_plan[i].recv_size  = (int *)realloc(Dfft_plan[i].recv_size, 1*Dfft_plan[i].g_size*sizeof(int));
 
-    Dfft_plan[i].new_size = calc_local_mesh(my_pos[i], n_grid[i], Dp3m.mesh,
+    Dfft_plan[i].new_size = calc_local_mesh(my_pos[i], n_grid[i], g_mesh,
 					   Dp3m.mesh_off, Dfft_plan[i].new_mesh, 
 					   Dfft_plan[i].start);  
     permute_ifield(Dfft_plan[i].new_mesh,3,-(Dfft_plan[i].n_permute));
@@ -684,11 +761,9 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
       node = Dfft_plan[i].group[j];
       Dfft_plan[i].send_size[j] 
 	= calc_send_block(my_pos[i-1], n_grid[i-1], &(n_pos[i][3*node]), n_grid[i],
-			  Dp3m.mesh, Dp3m.mesh_off, &(Dfft_plan[i].send_block[6*j]));
+			  g_mesh, Dp3m.mesh_off, &(Dfft_plan[i].send_block[6*j]));
       permute_ifield(&(Dfft_plan[i].send_block[6*j]),3,-(Dfft_plan[i-1].n_permute));
       permute_ifield(&(Dfft_plan[i].send_block[6*j+3]),3,-(Dfft_plan[i-1].n_permute));
-      if(Dfft_plan[i].send_size[j] > Dmax_comm_size) 
-	Dmax_comm_size = Dfft_plan[i].send_size[j];
       /* First plan send blocks have to be adjusted, since the CA grid
 	 may have an additional margin outside the actual domain of the
 	 node */
@@ -699,14 +774,14 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
       /* recv block: this_node from comm-group-node i (identity: node) */
       Dfft_plan[i].recv_size[j] 
 	= calc_send_block(my_pos[i], n_grid[i], &(n_pos[i-1][3*node]), n_grid[i-1],
-			  Dp3m.mesh,Dp3m.mesh_off,&(Dfft_plan[i].recv_block[6*j]));
+			  g_mesh,Dp3m.mesh_off,&(Dfft_plan[i].recv_block[6*j]));
       permute_ifield(&(Dfft_plan[i].recv_block[6*j]),3,-(Dfft_plan[i].n_permute));
       permute_ifield(&(Dfft_plan[i].recv_block[6*j+3]),3,-(Dfft_plan[i].n_permute));
-      if(Dfft_plan[i].recv_size[j] > Dmax_comm_size) 
-	Dmax_comm_size = Dfft_plan[i].recv_size[j];
     }
 
     for(j=0;j<3;j++) Dfft_plan[i].old_mesh[j] = Dfft_plan[i-1].new_mesh[j];
+    /* the first FFT halves the row direction */
+    if(i==2) Dfft_plan[2].old_mesh[2] = Dfft_plan[1].new_mesh[2]/2 + 1;
     if(i==1) 
       Dfft_plan[i].element = 1; 
     else {
@@ -716,6 +791,8 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
 	Dfft_plan[i].recv_size[j] *= 2;
       }
     }
+    j = fft_init_group_comm(&Dfft_plan[i]);
+    if(j > Dmax_comm_size) Dmax_comm_size = j;
     /* DEBUG */
     for(j=0;j<n_nodes;j++) {
       /* MPI_Barrier(MPI_COMM_WORLD); */
@@ -723,11 +800,12 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
     }
   }
 
-  /* Factor 2 for complex fields */
-  Dmax_comm_size *= 2;
   Dmax_mesh_size = (Dca_mesh_dim[0]*Dca_mesh_dim[1]*Dca_mesh_dim[2]);
   for(i=1;i<4;i++) 
     if(2*Dfft_plan[i].new_size > Dmax_mesh_size) Dmax_mesh_size = 2*Dfft_plan[i].new_size;
+  /* output of the real to complex FFT */
+  if(2*Dfft_plan[1].n_ffts*(Dfft_plan[1].new_mesh[2]/2+1) > Dmax_mesh_size)
+    Dmax_mesh_size = 2*Dfft_plan[1].n_ffts*(Dfft_plan[1].new_mesh[2]/2+1);
 
   FFT_TRACE(fprintf(stderr,"%d: Dmax_comm_size = %d, Dmax_mesh_size = %d\n",
 		    this_node,Dmax_comm_size,Dmax_mesh_size));
@@ -749,7 +827,6 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
     (*ks_pnum)=5;
   }
   
-  /* Factor 2 for complex numbers */
   Dsend_buf = (double *)realloc(Dsend_buf, Dmax_comm_size*sizeof(double));
   Drecv_buf = (double *)realloc(Drecv_buf, Dmax_comm_size*sizeof(double));
   (*Ddata)  = (double *)realloc((*Ddata), Dmax_mesh_size*sizeof(double));
@@ -768,19 +845,27 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
     /* FFT plan creation. 
        Attention: destroys contents of c_data/data and c_data_buf/data_buf. */
     wisdom_status   = FFTW_FAILURE;
-    sprintf(wisdom_file_name,"Dfftw3_1d_wisdom_forw_n%d.file",
-	    Dfft_plan[i].new_mesh[2]);
+    sprintf(wisdom_file_name,"Dfftw3_1d_wisdom_%s_n%d.file",
+	    (i==1) ? "r2c" : "forw", Dfft_plan[i].new_mesh[2]);
     if( (wisdom_file=fopen(wisdom_file_name,"r"))!=NULL ) {
       wisdom_status = fftw_import_wisdom_from_file(wisdom_file);
       fclose(wisdom_file);
     }
     if(Dfft_init_tag==1) fftw_destroy_plan(Dfft_plan[i].fft_plan);
 //printf("Dfft_plan[%d].n_ffts=%d\n",i,Dfft_plan[i].n_ffts);
-    Dfft_plan[i].fft_plan =
-      fftw_plan_many_dft(1,&Dfft_plan[i].new_mesh[2],Dfft_plan[i].n_ffts,
-                         Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
-                         Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
-                         Dfft_plan[i].dir,FFTW_PATIENT);
+    if(i==1)
+      /* real to complex, out of place from Ddata_buf to Ddata */
+      Dfft_plan[i].fft_plan =
+	fftw_plan_many_dft_r2c(1,&Dfft_plan[i].new_mesh[2],Dfft_plan[i].n_ffts,
+			       Ddata_buf,NULL,1,Dfft_plan[i].new_mesh[2],
+			       Dc_data,NULL,1,Dfft_plan[i].new_mesh[2]/2+1,
+			       FFTW_PATIENT);
+    else
+      Dfft_plan[i].fft_plan =
+	fftw_plan_many_dft(1,&Dfft_plan[i].new_mesh[2],Dfft_plan[i].n_ffts,
+			   Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
+			   Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
+			   Dfft_plan[i].dir,FFTW_PATIENT);
     if( wisdom_status == FFTW_FAILURE && 
 	(wisdom_file=fopen(wisdom_file_name,"w"))!=NULL ) {
       fftw_export_wisdom_to_file(wisdom_file);
@@ -794,18 +879,26 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
   for(i=1;i<4;i++) {
     Dfft_back[i].dir = FFTW_BACKWARD;
     wisdom_status   = FFTW_FAILURE;
-    sprintf(wisdom_file_name,"Dfftw3_1d_wisdom_back_n%d.file",
-	    Dfft_plan[i].new_mesh[2]);
+    sprintf(wisdom_file_name,"Dfftw3_1d_wisdom_%s_n%d.file",
+	    (i==1) ? "c2r" : "back", Dfft_plan[i].new_mesh[2]);
     if( (wisdom_file=fopen(wisdom_file_name,"r"))!=NULL ) {
       wisdom_status = fftw_import_wisdom_from_file(wisdom_file);
       fclose(wisdom_file);
     }    
     if(Dfft_init_tag==1) fftw_destroy_plan(Dfft_back[i].fft_plan);
-    Dfft_back[i].fft_plan =
-      fftw_plan_many_dft(1,&Dfft_plan[i].new_mesh[2],Dfft_plan[i].n_ffts,
-                         Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
-                         Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
-                         Dfft_back[i].dir,FFTW_PATIENT);
+    if(i==1)
+      /* complex to real, out of place from Ddata to Ddata_buf */
+      Dfft_back[i].fft_plan =
+	fftw_plan_many_dft_c2r(1,&Dfft_plan[i].new_mesh[2],Dfft_plan[i].n_ffts,
+			       Dc_data,NULL,1,Dfft_plan[i].new_mesh[2]/2+1,
+			       Ddata_buf,NULL,1,Dfft_plan[i].new_mesh[2],
+			       FFTW_PATIENT);
+    else
+      Dfft_back[i].fft_plan =
+	fftw_plan_many_dft(1,&Dfft_plan[i].new_mesh[2],Dfft_plan[i].n_ffts,
+			   Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
+			   Dc_data,NULL,1,Dfft_plan[i].new_mesh[2],
+			   Dfft_back[i].dir,FFTW_PATIENT);
     if( wisdom_status == FFTW_FAILURE && 
 	(wisdom_file=fopen(wisdom_file_name,"w"))!=NULL ) {
       fftw_export_wisdom_to_file(wisdom_file);
@@ -832,8 +925,8 @@ int Dfft_init(double **Ddata, int *Dca_mesh_dim, int *Dca_mesh_margin, int *ks_p
 
 void Dfft_perform_forw(double *Ddata)
 {
-  int i;
-  /* int m,n,o; */
+  /* int i,m,n,o; */
+  timer_start(TIMER_FFT);
   /* ===== first direction  ===== */
   FFT_TRACE(fprintf(stderr,"%d: dipolar fft_perform_forw: dir 1:\n",this_node));
 
@@ -858,13 +951,8 @@ void Dfft_perform_forw(double *Ddata)
     }
   */
 
-  /* complexify the real data array (in is data_buf) */
-  for(i=0;i<Dfft_plan[1].new_size;i++) {
-    Ddata[2*i]     = Ddata_buf[i];     /* real value */
-    Ddata[(2*i)+1] = 0;       /* complex value */
-  }
-  /* perform FFT (in/out is data)*/
-  fftw_execute_dft(Dfft_plan[1].fft_plan,Dc_data,Dc_data);
+  /* perform real to complex FFT (in is data_buf, out is data) */
+  fftw_execute_dft_r2c(Dfft_plan[1].fft_plan,Ddata_buf,Dc_data);
   /* ===== second direction ===== */
   FFT_TRACE(fprintf(stderr,"%d: dipolar fft_perform_forw: dir 2:\n",this_node));
   /* communication to current dir row format (in is data) */
@@ -879,13 +967,13 @@ void Dfft_perform_forw(double *Ddata)
   fftw_execute_dft(Dfft_plan[3].fft_plan,Dc_data,Dc_data);
   //print_global_fft_mesh(Dfft_plan[3],data,1,0);
 
+  timer_stop(TIMER_FFT);
   /* REMARK: Result has to be in data. */
 }
 
 void Dfft_perform_back(double *Ddata)
 {
-  int i;
-
+  timer_start(TIMER_FFT);
   Dc_data     = (fftw_complex *) Ddata;
   Dc_data_buf = (fftw_complex *) Ddata_buf;
   
@@ -907,21 +995,13 @@ void Dfft_perform_back(double *Ddata)
 
   /* ===== first direction  ===== */
   FFT_TRACE(fprintf(stderr,"%d: fft_perform_back: dir 1:\n",this_node));
-  /* perform FFT (in is data) */
-  fftw_execute_dft(Dfft_back[1].fft_plan,Dc_data,Dc_data);
-  /* throw away the (hopefully) empty complex component (in is data)*/
-  for(i=0;i<Dfft_plan[1].new_size;i++) {
-    Ddata_buf[i] = Ddata[2*i]; /* real value */
-    //Vincent:
-    if (Ddata[2*i+1]>1e-5) {
-      printf("dipoar fft - Complex value is not zero (i=%d,data=%g)!!!\n",i,Ddata[2*i+1]);
-      if (i>100) exit(-1);
-    }
-  }
+  /* perform complex to real FFT (in is data, out is data_buf) */
+  fftw_execute_dft_c2r(Dfft_back[1].fft_plan,Dc_data,Ddata_buf);
   /* communicate (in is data_buf) */
   Dback_grid_comm(Dfft_plan[1],Dfft_back[1],Ddata_buf,Ddata);
 
 
+  timer_stop(TIMER_FFT);
   /* REMARK: Result has to be in data. */
 }
 
@@ -1059,7 +1139,7 @@ void unpack_block(double *in, double *out, int start[3], int size[3],
 int find_comm_groups(int grid1[3], int grid2[3], int *node_list1, int *node_list2, 
 		     int *group, int *pos, int *my_pos)
 {
-  int i;
+  int i,j;
   /* communication group cell size on grid1 and grid2 */
   int s1[3], s2[3];
   /* The communication group cells build the same super grid on grid1 and grid2 */
@@ -1072,8 +1152,6 @@ int find_comm_groups(int grid1[3], int grid2[3], int *node_list1, int *node_list
   int p1[3], p2[3];
   /* node identity */
   int n;
-  /* this_node position in the communication group. */
-  int c_pos=-1;
   /* flag for group identification */
   int my_group=0;
 
@@ -1118,7 +1196,6 @@ int find_comm_groups(int grid1[3], int grid2[3], int *node_list1, int *node_list
 	  if(my_group==1) group[i] = n;
 	  if(n==this_node && my_group==0) { 
 	    my_group = 1; 
-	    c_pos = i;
 	    my_pos[0] = p2[0]; my_pos[1] = p2[1]; my_pos[2] = p2[2];
 	    i=-1; /* restart the loop */ 
 	  }
@@ -1126,13 +1203,12 @@ int find_comm_groups(int grid1[3], int grid2[3], int *node_list1, int *node_list
 	my_group=0;
       }
 
-  /* permute comm. group according to the nodes position in the group */
-  /* This is necessary to have matching node pairs during communication! */
-  while( c_pos>0 ) {
-    n=group[g_size-1];
-    for(i=g_size-1; i>0; i--) group[i] = group[i-1];
-    group[0] = n;
-    c_pos--;
+  /* sort comm. group by node identity, which is the rank order of the
+     group communicator, see fft_init_group_comm() */
+  for(i=1; i<g_size; i++) {
+    n = group[i];
+    for(j=i; j>0 && group[j-1]>n; j--) group[j] = group[j-1];
+    group[j] = n;
   }
   return g_size;
 }
@@ -1175,74 +1251,77 @@ int calc_send_block(int pos1[3], int grid1[3], int pos2[3], int grid2[3],
   return size;
 }
 
+int fft_init_group_comm(fft_forw_plan *plan)
+{
+  int j, send_total=0, recv_total=0;
+
+  /* the offsets are allocated together with the communicator */
+  if(plan->send_disp) MPI_Comm_free(&plan->comm);
+  plan->send_disp = (int *)realloc(plan->send_disp, plan->g_size*sizeof(int));
+  plan->recv_disp = (int *)realloc(plan->recv_disp, plan->g_size*sizeof(int));
+  for(j=0; j<plan->g_size; j++) {
+    plan->send_disp[j] = send_total;
+    send_total += plan->send_size[j];
+    plan->recv_disp[j] = recv_total;
+    recv_total += plan->recv_size[j];
+  }
+
+  /* all members of a group share its smallest node identity, and the
+     ranks follow the node identities as the group does */
+  MPI_Comm_split(MPI_COMM_WORLD, plan->group[0], this_node, &plan->comm);
+
+  return imax(send_total, recv_total);
+}
+
 #ifdef P3M
 void forw_grid_comm(fft_forw_plan plan, double *in, double *out)
 {
   int i;
-  MPI_Status status;
   double *tmp_ptr;
 
-  for(i=0;i<plan.g_size;i++) {   
-    plan.pack_function(in, send_buf, &(plan.send_block[6*i]), 
+  for(i=0;i<plan.g_size;i++)
+    plan.pack_function(in, send_buf + plan.send_disp[i], &(plan.send_block[6*i]), 
 		       &(plan.send_block[6*i+3]), plan.old_mesh, plan.element);
 
-    if(plan.group[i]<this_node) {       /* send first, receive second */
-      MPI_Send(send_buf, plan.send_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD);
-      MPI_Recv(recv_buf, plan.recv_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD, &status); 	
-    }
-    else if(plan.group[i]>this_node) {  /* receive first, send second */
-      MPI_Recv(recv_buf, plan.recv_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD, &status); 	
-      MPI_Send(send_buf, plan.send_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD);      
-    }
-    else {                              /* Self communication... */   
-      tmp_ptr  = send_buf;
-      send_buf = recv_buf;
-      recv_buf = tmp_ptr;
-    }
-    unpack_block(recv_buf, out, &(plan.recv_block[6*i]), 
-		 &(plan.recv_block[6*i+3]), plan.new_mesh, plan.element);
+  if(plan.g_size > 1)
+    MPI_Alltoallv(send_buf, plan.send_size, plan.send_disp, MPI_DOUBLE,
+		  recv_buf, plan.recv_size, plan.recv_disp, MPI_DOUBLE, plan.comm);
+  else {                                /* Self communication... */
+    tmp_ptr = send_buf;
+    send_buf = recv_buf;
+    recv_buf = tmp_ptr;
   }
+
+  for(i=0;i<plan.g_size;i++)
+    unpack_block(recv_buf + plan.recv_disp[i], out, &(plan.recv_block[6*i]), 
+		 &(plan.recv_block[6*i+3]), plan.new_mesh, plan.element);
 }
 
 void back_grid_comm(fft_forw_plan plan_f,  fft_back_plan plan_b, double *in, double *out)
 {
   int i;
-  MPI_Status status;
   double *tmp_ptr;
 
   /* Back means: Use the send/recieve stuff from the forward plan but
      replace the recieve blocks by the send blocks and vice
      versa. Attention then also new_mesh and old_mesh are exchanged */
 
-  for(i=0;i<plan_f.g_size;i++) {
-    
-    plan_b.pack_function(in, send_buf, &(plan_f.recv_block[6*i]), 
-		       &(plan_f.recv_block[6*i+3]), plan_f.new_mesh, plan_f.element);
-
-    if(plan_f.group[i]<this_node) {       /* send first, receive second */
-      MPI_Send(send_buf, plan_f.recv_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD);
-      MPI_Recv(recv_buf, plan_f.send_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD, &status); 	
-    }
-    else if(plan_f.group[i]>this_node) {  /* receive first, send second */
-      MPI_Recv(recv_buf, plan_f.send_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD, &status); 	
-      MPI_Send(send_buf, plan_f.recv_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD);      
-    }
-    else {                                /* Self communication... */   
-      tmp_ptr  = send_buf;
-      send_buf = recv_buf;
-      recv_buf = tmp_ptr;
-    }
-    unpack_block(recv_buf, out, &(plan_f.send_block[6*i]), 
-		 &(plan_f.send_block[6*i+3]), plan_f.old_mesh, plan_f.element);
+  for(i=0;i<plan_f.g_size;i++)
+    plan_b.pack_function(in, send_buf + plan_f.recv_disp[i], &(plan_f.recv_block[6*i]), 
+			 &(plan_f.recv_block[6*i+3]), plan_f.new_mesh, plan_f.element);
+
+  if(plan_f.g_size > 1)
+    MPI_Alltoallv(send_buf, plan_f.recv_size, plan_f.recv_disp, MPI_DOUBLE,
+		  recv_buf, plan_f.send_size, plan_f.send_disp, MPI_DOUBLE, plan_f.comm);
+  else {                                /* Self communication... */
+    tmp_ptr = send_buf;
+    send_buf = recv_buf;
+    recv_buf = tmp_ptr;
   }
+
+  for(i=0;i<plan_f.g_size;i++)
+    unpack_block(recv_buf + plan_f.send_disp[i], out, &(plan_f.send_block[6*i]), 
+		 &(plan_f.send_block[6*i+3]), plan_f.old_mesh, plan_f.element);
 }
 
 #endif
@@ -1251,70 +1330,51 @@ void back_grid_comm(fft_forw_plan plan_f,  fft_back_plan plan_b, double *in, dou
 void Dforw_grid_comm(fft_forw_plan plan, double *in, double *out)
 {
   int i;
-  MPI_Status status;
   double *tmp_ptr;
 
-  for(i=0;i<plan.g_size;i++) {   
-    plan.pack_function(in, Dsend_buf, &(plan.send_block[6*i]), 
+  for(i=0;i<plan.g_size;i++)
+    plan.pack_function(in, Dsend_buf + plan.send_disp[i], &(plan.send_block[6*i]), 
 		       &(plan.send_block[6*i+3]), plan.old_mesh, plan.element);
 
-    if(plan.group[i]<this_node) {       /* send first, receive second */
-      MPI_Send(Dsend_buf, plan.send_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD);
-      MPI_Recv(Drecv_buf, plan.recv_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD, &status); 	
-    }
-    else if(plan.group[i]>this_node) {  /* receive first, send second */
-      MPI_Recv(Drecv_buf, plan.recv_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD, &status); 	
-      MPI_Send(Dsend_buf, plan.send_size[i], MPI_DOUBLE, 
-	       plan.group[i], REQ_FFT_FORW, MPI_COMM_WORLD);      
-    }
-    else {                              /* Self communication... */   
-      tmp_ptr  = Dsend_buf;
-      Dsend_buf = Drecv_buf;
-      Drecv_buf = tmp_ptr;
-    }
-    unpack_block(Drecv_buf, out, &(plan.recv_block[6*i]), 
-		 &(plan.recv_block[6*i+3]), plan.new_mesh, plan.element);
+  if(plan.g_size > 1)
+    MPI_Alltoallv(Dsend_buf, plan.send_size, plan.send_disp, MPI_DOUBLE,
+		  Drecv_buf, plan.recv_size, plan.recv_disp, MPI_DOUBLE, plan.comm);
+  else {                                /* Self communication... */
+    tmp_ptr = Dsend_buf;
+    Dsend_buf = Drecv_buf;
+    Drecv_buf = tmp_ptr;
   }
+
+  for(i=0;i<plan.g_size;i++)
+    unpack_block(Drecv_buf + plan.recv_disp[i], out, &(plan.recv_block[6*i]), 
+		 &(plan.recv_block[6*i+3]), plan.new_mesh, plan.element);
 }
 
 void Dback_grid_comm(fft_forw_plan plan_f,  fft_back_plan plan_b, double *in, double *out)
 {
   int i;
-  MPI_Status status;
   double *tmp_ptr;
 
   /* Back means: Use the send/recieve stuff from the forward plan but
      replace the recieve blocks by the send blocks and vice
      versa. Attention then also new_mesh and old_mesh are exchanged */
 
-  for(i=0;i<plan_f.g_size;i++) {
-    
-    plan_b.pack_function(in, Dsend_buf, &(plan_f.recv_block[6*i]), 
-		       &(plan_f.recv_block[6*i+3]), plan_f.new_mesh, plan_f.element);
-
-    if(plan_f.group[i]<this_node) {       /* send first, receive second */
-      MPI_Send(Dsend_buf, plan_f.recv_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD);
-      MPI_Recv(Drecv_buf, plan_f.send_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD, &status); 	
-    }
-    else if(plan_f.group[i]>this_node) {  /* receive first, send second */
-      MPI_Recv(Drecv_buf, plan_f.send_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD, &status); 	
-      MPI_Send(Dsend_buf, plan_f.recv_size[i], MPI_DOUBLE, 
-	       plan_f.group[i], REQ_FFT_BACK, MPI_COMM_WORLD);      
-    }
-    else {                                /* Self communication... */   
-      tmp_ptr  = Dsend_buf;
-      Dsend_buf = Drecv_buf;
-      Drecv_buf = tmp_ptr;
-    }
-    unpack_block(Drecv_buf, out, &(plan_f.send_block[6*i]), 
-		 &(plan_f.send_block[6*i+3]), plan_f.old_mesh, plan_f.element);
+  for(i=0;i<plan_f.g_size;i++)
+    plan_b.pack_function(in, Dsend_buf + plan_f.recv_disp[i], &(plan_f.recv_block[6*i]), 
+			 &(plan_f.recv_block[6*i+3]), plan_f.new_mesh, plan_f.element);
+
+  if(plan_f.g_size > 1)
+    MPI_Alltoallv(Dsend_buf, plan_f.recv_size, plan_f.recv_disp, MPI_DOUBLE,
+		  Drecv_buf, plan_f.send_size, plan_f.send_disp, MPI_DOUBLE, plan_f.comm);
+  else {                                /* Self communication... */
+    tmp_ptr = Dsend_buf;
+    Dsend_buf = Drecv_buf;
+    Drecv_buf = tmp_ptr;
   }
+
+  for(i=0;i<plan_f.g_size;i++)
+    unpack_block(Drecv_buf + plan_f.send_disp[i], out, &(plan_f.send_block[6*i]), 
+		 &(plan_f.send_block[6*i+3]), plan_f.old_mesh, plan_f.element);
 }
 
 #endif
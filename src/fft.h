@@ -28,11 +28,17 @@
  *  distributed in such a way, that for the actual direction of the
  *  FFT each node has a certain number of rows for which it performs a
  *  1D-FFT. After performing the FFT on theat direction the data is
- *  redistributed.
+ *  redistributed. The nodes only exchange data within small
+ *  communication groups, each of which has its own communicator, so
+ *  that a redistribution is a single all-to-all per group.
  *
- *  For simplicity at the moment I have implemented a full complex to
- *  complex FFT (even though a real to complex FFT would be
- *  sufficient)
+ *  Since the meshes are real, the FFT of the first direction is a real
+ *  to complex one, which only keeps the frequencies 0..mesh/2 of that
+ *  direction, the negative frequencies being the complex conjugates
+ *  of the positive ones. The remaining two directions are complex to
+ *  complex FFTs of the halved mesh. The backward FFT accordingly ends
+ *  with a complex to real FFT. See \ref fft_ks_half_dir for where the
+ *  halved direction ends up in k-space.
  *
  *  \todo Combine the forward and backward structures.
  *  \todo The packing routines could be moved to utils.h when they are needed elsewhere.
@@ -40,6 +46,7 @@
  *  For more information about FFT usage, see \ref fft.c "fft.c".  
 */
 
+#include <mpi.h>
 #include "utils.h"
 
 #if defined(P3M) || defined(DP3M)
@@ -78,8 +85,11 @@ typedef struct {
 
   /** number of nodes which have to communicate with each other. */ 
   int g_size;
-  /** group of nodes which have to communicate with each other. */ 
+  /** group of nodes which have to communicate with each other,
+      sorted by node identity. */ 
   int *group;
+  /** communicator of the group. The ranks are the positions in group. */
+  MPI_Comm comm;
 
   /** packing function for send blocks. */
   void (*pack_function)();
@@ -91,6 +101,10 @@ typedef struct {
   int *recv_block;
   /** Recv block communication sizes. */ 
   int *recv_size;
+  /** Offsets of the send blocks in the send buffer. */
+  int *send_disp;
+  /** Offsets of the recv blocks in the recv buffer. */
+  int *recv_disp;
   /** size of send block elements. */
   int element;
 } fft_forw_plan;
@@ -108,6 +122,20 @@ typedef struct {
   void (*pack_function)(); 
 } fft_back_plan;
 
+#ifdef P3M
+/** The plans for the 3D-FFT of a mesh other than the P3M mesh, see
+    \ref fft_mesh_init. The communication buffers are shared with the
+    P3M plans. */
+typedef struct {
+  /** the forward plans, see \ref fft_plan. */
+  fft_forw_plan plan[4];
+  /** the backward plans. */
+  fft_back_plan back[4];
+  /** whether the FFTW plans have been created. */
+  int init_tag;
+} fft_mesh_plans;
+#endif
+
 
 /** \name Exported Variables */
 /************************************************************/
@@ -150,18 +178,44 @@ void  fft_pre_init();
 int fft_init(double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum);
 
 /** perform the forward 3D FFT.
-    The assigned charges are in \a data. The result is also stored in \a data.
+    The assigned charges are in \a data. The result is also stored in \a data,
+    as the complex k-space mesh of fft_plan[3], halved along \ref fft_ks_half_dir.
     \warning The content of \a data is overwritten.
     \param data Mesh.
 */
 void fft_perform_forw(double *data);
 
-/** perform the backward 3D FFT.
+/** perform the backward 3D FFT of a halved k-space mesh, see \ref fft_perform_forw.
+    The k-space mesh has to be the transform of a real mesh.
     \warning The content of \a data is overwritten.
     \param data Mesh.
 */
 void fft_perform_back(double *data);
 
+/** Initialize the plans for the 3D-FFT of a mesh other than the P3M
+    mesh, e.g. for \ref statistics_sf.h "structure factors". Like
+    \ref fft_init, but the plans are only estimated, and the global
+    mesh is given explicitly.
+
+ * \return Maximal size of local fft mesh (needed for allocation of ca_mesh).
+ * \param plans          The plans, which have to be zero initially.
+ * \param mesh           The global mesh dimensions.
+ * \param mesh_off       The global mesh offset (see \ref p3m_struct).
+ * \param data           Pointer Pounter to data array.
+ * \param ca_mesh_dim    Pointer to CA mesh dimensions.
+ * \param ca_mesh_margin Pointer to CA mesh margins.
+ * \param ks_pnum        Pointer to number of permutations in k-space.
+ */
+int fft_mesh_init(fft_mesh_plans *plans, int mesh[3], double mesh_off[3],
+		  double **data, int *ca_mesh_dim, int *ca_mesh_margin, int *ks_pnum);
+
+/** perform the forward 3D FFT of a mesh initialized by \ref fft_mesh_init.
+    \warning The content of \a data is overwritten.
+    \param plans The plans.
+    \param data  Mesh.
+*/
+void fft_mesh_perform_forw(fft_mesh_plans *plans, double *data);
+
 #endif
 
 #ifdef DP3M
@@ -291,6 +345,25 @@ void unpack_block(double *in, double *out, int start[3], int size[3],
 */
 void print_global_fft_mesh(fft_forw_plan plan, double *data, int element, int num);
 
+/** position of the halved direction in the k-space mesh (plan[3].new_mesh),
+    along which only the frequencies 0..mesh/2 are stored.
+    \param plan the forward plans of the mesh. */
+MDINLINE int fft_ks_half_dir(fft_forw_plan *plan)
+{
+  /* the real space direction d is at position (d + n_permute)%3 */
+  return (plan[1].row_dir + plan[3].n_permute)%3;
+}
+
+/** weight of a mode of the halved k-space mesh in sums over all modes.
+    The frequencies 0 < n < mesh/2 along the halved direction also stand
+    for their complex conjugates at -n, and count twice.
+    \param plan the forward plans of the mesh.
+    \param n    global frequency index along the halved direction. */
+MDINLINE double fft_ks_weight(fft_forw_plan *plan, int n)
+{
+  return (n == 0 || 2*n == plan[1].new_mesh[2]) ? 1.0 : 2.0;
+}
+
 /*@}*/
 #endif
 
@@ -50,6 +50,22 @@
 #include "virtual_sites.h"
 #include "constraint.h"
 #include "lbgpu.h"
+#include "soa.h"
+#include "threads.h"
+#include "energy.h"
+#include "timers.h"
+
+int obs_fused = 0;
+int obs_fused_step = 0;
+int kspace_overlap = 0;
+
+/** whether the fused observables of the last force calculation are
+    still valid on this node */
+static int obs_fused_valid = 0;
+
+/** whether the charges of the long range forces have been assigned
+    before the short ranged forces, see \ref kspace_overlap. */
+static int kspace_started = 0;
 
 /************************************************************/
 /* local prototypes                                         */
@@ -58,41 +74,152 @@
 /** Calculate long range forces (P3M, MMM2d...). */
 void calc_long_range_forces();
 
+/** whether the force contributions after the short ranged ones act
+    only on real particles, i. e. the ghost forces can be collected
+    before. */
+static int long_range_forces_local()
+{
+#ifdef ELECTROSTATICS
+  if (coulomb.method == COULOMB_MAGGS)
+    return 0;
+#endif
+#ifdef LB
+  if (lattice_switch & LATTICE_LB)
+    return 0;
+#endif
+  return 1;
+}
+
 /** initialize real particle forces with thermostat forces and
     ghost particle forces with zero. */
 void init_forces();
 
+/** whether the observables can be accumulated during the force
+    calculation. The real space dipolar methods have no virials. */
+static int obs_fused_supported()
+{
+#ifdef MAGNETOSTATICS
+  if (coulomb.Dmethod != DIPOLAR_NONE)
+    return 0;
+#endif
+  return 1;
+}
+
+/** whether the mesh part of the long range forces can be started
+    before the short ranged forces, see \ref kspace_overlap. ELC
+    modifies the charge assignment. */
+static int kspace_overlap_supported()
+{
+#if defined(ELECTROSTATICS) && defined(P3M)
+  if (coulomb.method == COULOMB_P3M)
+    return 1;
+#endif
+  return 0;
+}
+
+/** add the bonded energies and virials of the local particles, for
+    the fused observables. */
+static void calc_local_bonded_observables()
+{
+  Cell *cell;
+  Particle *p;
+  int np, c, i;
+
+  for (c = 0; c < local_cells.n; c++) {
+    cell = local_cells.cell[c];
+    p  = cell->part;
+    np = cell->n;
+    for (i = 0; i < np; i++) {
+      add_bonded_energy(&p[i]);
+#ifdef CONSTRAINTS
+      add_constraints_energy(&p[i]);
+#endif
+      add_bonded_virials(&p[i]);
+#ifdef BOND_ANGLE
+      add_three_body_bonded_stress(&p[i]);
+#endif
+    }
+  }
+}
+
 /************************************************************/
 
 void force_calc()
 {
+  timer_start(TIMER_FORCE_CALC);
+
+  obs_fused_valid = 0;
+  if (obs_fused_step && !obs_fused_supported())
+    obs_fused_step = 0;
+  if (obs_fused_step) {
+    energy_fused_init();
+    pressure_fused_init();
+  }
 
 #ifdef LB_GPU
   if (lattice_switch & LATTICE_LB_GPU) lb_calc_particle_lattice_ia_gpu();
 #endif
 
+  /* new random numbers for the counter based thermostat noise */
+  philox_counter++;
+
    init_forces();
+
+  /* the charge mesh is gathered during the short range loops */
+  kspace_started = kspace_overlap && kspace_overlap_supported();
+#if defined(ELECTROSTATICS) && defined(P3M)
+  if (kspace_started)
+    P3M_charge_assign_start();
+#endif
   
-  switch (cell_structure.type) {
-  case CELL_STRUCTURE_LAYERED:
-    layered_calculate_ia();
-    break;
-  case CELL_STRUCTURE_DOMDEC:
-    if(dd.use_vList) {
-      if (rebuild_verletlist)
-	build_verlet_lists_and_calc_verlet_ia();
+  /* the observables are only accumulated by the loops over the particles */
+  if (soa_enabled && !obs_fused_step && cell_structure.type != CELL_STRUCTURE_LAYERED) {
+    /* short range loops on the structure-of-arrays cell mirrors */
+    soa_update_positions();
+    if (cell_structure.type == CELL_STRUCTURE_DOMDEC) {
+      if(dd.use_vList) {
+	if (rebuild_verletlist)
+	  build_verlet_lists_and_calc_verlet_ia_soa();
+	else
+	  calculate_verlet_ia_soa();
+      }
       else
-	calculate_verlet_ia();
+	calc_link_cell_soa();
     }
     else
-      calc_link_cell();
-    break;
-  case CELL_STRUCTURE_NSQUARE:
-    nsq_calculate_ia();
-    
+      nsq_calculate_ia_soa();
+    soa_flush_forces();
+  }
+  else {
+    switch (cell_structure.type) {
+    case CELL_STRUCTURE_LAYERED:
+      layered_calculate_ia();
+      break;
+    case CELL_STRUCTURE_DOMDEC:
+      if(dd.use_vList) {
+	if (rebuild_verletlist)
+	  build_verlet_lists_and_calc_verlet_ia();
+	else
+	  calculate_verlet_ia();
+      }
+      else
+	calc_link_cell();
+      break;
+    case CELL_STRUCTURE_NSQUARE:
+      nsq_calculate_ia();
+    }
   }
 
+  if (obs_fused_step)
+    calc_local_bonded_observables();
+
+  /* the ghost forces are complete, send them back while the long
+     range forces are calculated */
+  if (cells_async_ghosts() && long_range_forces_local())
+    ghost_communicator_start(&cell_structure.collect_ghost_force_comm);
+
   calc_long_range_forces();
+  kspace_started = 0;
 
 #ifdef LB
   if (lattice_switch & LATTICE_LB) calc_particle_lattice_ia() ;
@@ -116,6 +243,72 @@ void force_calc()
   calc_comfixed();
 #endif
 
+  if (obs_fused_step) {
+    energy_fused_store();
+    pressure_fused_store();
+    obs_fused_valid = 1;
+    obs_fused_step = 0;
+  }
+
+  timer_stop(TIMER_FORCE_CALC);
+}
+
+/************************************************************/
+
+int obs_fused_cached(int local_ok)
+{
+  int ok = obs_fused_valid && local_ok, all_ok;
+
+  if (!obs_fused)
+    return 0;
+  MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+  return all_ok;
+}
+
+int obs_fused_kspace()
+{
+#if defined(ELECTROSTATICS) && defined(P3M)
+  if (coulomb.method == COULOMB_P3M)
+    return 1;
+#endif
+  return 0;
+}
+
+void obs_fused_invalidate()
+{
+  obs_fused_valid = 0;
+}
+
+int tclcallback_obs_fused(Tcl_Interp *interp, void *_data)
+{
+  int data = *(int *)_data;
+
+  if (data != 0 && data != 1) {
+    Tcl_AppendResult(interp, "obs_fused must be 0 or 1", (char *) NULL);
+    return (TCL_ERROR);
+  }
+#ifdef ADRESS
+  if (data) {
+    Tcl_AppendResult(interp, "obs_fused is not available with ADRESS", (char *) NULL);
+    return (TCL_ERROR);
+  }
+#endif
+  obs_fused = data;
+  mpi_bcast_parameter(FIELD_OBS_FUSED);
+  return (TCL_OK);
+}
+
+int tclcallback_kspace_overlap(Tcl_Interp *interp, void *_data)
+{
+  int data = *(int *)_data;
+
+  if (data != 0 && data != 1) {
+    Tcl_AppendResult(interp, "kspace_overlap must be 0 or 1", (char *) NULL);
+    return (TCL_ERROR);
+  }
+  kspace_overlap = data;
+  mpi_bcast_parameter(FIELD_KSPACE_OVERLAP);
+  return (TCL_OK);
 }
 
 /************************************************************/
@@ -144,7 +337,21 @@ void calc_long_range_forces()
 
     break;
   case COULOMB_P3M:
-    P3M_charge_assign();
+    if (!kspace_started)
+      P3M_charge_assign();
+    if (obs_fused_step) {
+      /* energy and stress from the same mesh as the forces */
+      int k;
+      double eng = P3M_calc_kspace_forces_and_stress(1, 1, p_tensor.coulomb);
+      energy.coulomb[1] = virials.coulomb[1] = eng;
+      for(k=0;k<3;k++)
+	p_tensor.coulomb[9+ k*3 + k] = eng/3.;
+#ifdef NPT
+      if(integ_switch == INTEG_METHOD_NPT_ISO)
+	nptiso.p_vir[0] += eng;
+#endif
+    }
+    else
 #ifdef NPT
     if(integ_switch == INTEG_METHOD_NPT_ISO)
       nptiso.p_vir[0] += P3M_calc_kspace_forces_for_charges(1,1);
@@ -359,6 +566,9 @@ void init_forces()
      or zero depending on the thermostat
      set torque to zero for all and rescale quaternions
   */
+#ifdef _OPENMP
+#pragma omp parallel for private(cell, p, np, i) if(threads_active() && !(thermo_switch & THERMO_LANGEVIN && random_backend == RANDOM_BACKEND_RAN1))
+#endif
   for (c = 0; c < local_cells.n; c++) {
     cell = local_cells.cell[c];
     p  = cell->part;
@@ -376,15 +586,12 @@ void init_forces()
 #endif
 
   /* initialize ghost forces with zero
-     set torque to zero for all and rescale quaternions
+     set torque to zero for all and rescale quaternions.
+     If the ghost positions are still in flight, this is done by
+     calculate_verlet_ia after they have arrived.
   */
-  for (c = 0; c < ghost_cells.n; c++) {
-    cell = ghost_cells.cell[c];
-    p  = cell->part;
-    np = cell->n;
-    for (i = 0; i < np; i++)
-      init_ghost_force(&p[i]);
-  }
+  if (!cell_structure.update_ghost_pos_comm.started)
+    init_forces_ghosts();
    
 #ifdef CONSTRAINTS
   init_constraint_forces();
@@ -406,4 +613,40 @@ void init_forces_ghosts()
   }
 }
 
+void calc_local_bonded_forces()
+{
+  Cell *cell;
+  Particle *p;
+  int np, c, i;
+
+#ifdef _OPENMP
+  if (threads_active()) {
+#pragma omp parallel for private(cell, p, np, i) schedule(dynamic)
+    for (c = 0; c < local_cells.n; c++) {
+      cell = local_cells.cell[c];
+      p  = cell->part;
+      np = cell->n;
+      for (i = 0; i < np; i++)
+	add_bonded_force_generic(&p[i], 1);
+    }
+  }
+  else
+#endif
+  for (c = 0; c < local_cells.n; c++) {
+    cell = local_cells.cell[c];
+    p  = cell->part;
+    np = cell->n;
+    for (i = 0; i < np; i++)
+      add_bonded_force(&p[i]);
+  }
 
+#ifdef CONSTRAINTS
+  for (c = 0; c < local_cells.n; c++) {
+    cell = local_cells.cell[c];
+    p  = cell->part;
+    np = cell->n;
+    for (i = 0; i < np; i++)
+      add_constraints_forces(&p[i]);
+  }
+#endif
+}
@@ -30,6 +30,7 @@
 #include "utils.h"
 #include "thermostat.h"
 #include "communication.h"
+#include "soa.h"
 #ifdef MOLFORCES
 #include "topology.h"
 #endif
@@ -73,6 +74,44 @@
 #include "morse.h"
 #include "elc.h"
 /* end of force files */
+/* the pair energies for the fused observables */
+#include "energy.h"
+
+/** \name Exported Variables */
+/************************************************************/
+/*@{*/
+
+/** If set, the force calculation after which an observation is due,
+    i.e. the last one of an integration or one that precedes a sample
+    of the stress tensor (see \ref correlation.h), also accumulates
+    the energies, virials and stress tensors of the node in the same
+    loops (fused observables). The analyze commands then only add the
+    kinetic parts, see \ref energy_calc and \ref pressure_calc. The
+    pair observables are obtained from the force of the pair
+    potentials, see \ref add_non_bonded_pair_observables, the k-space
+    part of P3M from the mesh of the forces, see \ref
+    P3M_calc_kspace_forces_and_stress. Set via setmd obs_fused. */
+extern int obs_fused;
+
+/** set while a force calculation accumulates the fused observables,
+    on all nodes. */
+extern int obs_fused_step;
+
+/** If set, the mesh part of P3M is started before the short ranged
+    forces: the charges are assigned, and the charge mesh is gathered
+    with nonblocking communication while the pair forces are
+    calculated, see \ref P3M_charge_assign_start. The FFTs and the
+    force interpolation follow the short ranged forces as
+    usual. Only used for P3M without ELC, otherwise ignored. Set via
+    setmd kspace_overlap. */
+extern int kspace_overlap;
+
+/** the accumulators of the pressure, see \ref pressure.h, which
+    includes this file. */
+extern Observable_stat virials, p_tensor;
+extern Observable_stat_non_bonded virials_non_bonded, p_tensor_non_bonded;
+
+/*@}*/
 
 /** \name Exported Functions */
 /************************************************************/
@@ -107,71 +146,134 @@ void force_calc();
 */
 void init_forces_ghosts();
 
+/** whether the fused observables of the last force calculation are
+    still valid on all nodes. Called on all nodes.
+    @param local_ok whether the stored observables of this node fit the
+                    current layout of the observables
+    @return 1 if the observables can be taken from the last force
+    calculation */
+int obs_fused_cached(int local_ok);
+
+/** whether the fused observables include the k-space part, i.e. the
+    long range observables need not be calculated separately. */
+int obs_fused_kspace();
+
+/** mark the fused observables of the last force calculation as
+    outdated on this node, see \ref invalidate_obs. */
+void obs_fused_invalidate();
+
+/** callback for \ref obs_fused */
+int tclcallback_obs_fused(Tcl_Interp *interp, void *_data);
+
+/** callback for \ref kspace_overlap */
+int tclcallback_kspace_overlap(Tcl_Interp *interp, void *_data);
+
+/** Calculate the bonded and constraint forces of all local particles
+    of the domain decomposition. The bonded forces are distributed over
+    the threads if \ref threads_active, the constraints always run on
+    one thread, since their forces are also accumulated in the
+    constraints themselves. */
+void calc_local_bonded_forces();
+
+/** Calculate the non bonded pair potentials between a pair of
+    particles. Only the potentials switched on for the two types are
+    evaluated, and plain Lennard-Jones pairs take a shortcut, see \ref
+    IA_parameters::nb_kernel. */
 MDINLINE void calc_non_bonded_pair_force_parts(Particle *p1, Particle *p2, IA_parameters *ia_params,double d[3],
 					 double dist, double dist2, double force[3],double torgue1[3],double torgue2[3])
 {
+  int pot = ia_params->nb_potentials;
+
 #ifdef NO_INTRA_NB
   if (p1->p.mol_id==p2->p.mol_id) return;
 #endif
+
+  switch (ia_params->nb_kernel) {
+  case NB_KERNEL_NONE:
+    return;
+#ifdef LENNARD_JONES
+  case NB_KERNEL_LJ:
+    add_lj_pair_force(p1,p2,ia_params,d,dist, force);
+    return;
+#endif
+  default:
+    break;
+  }
+
   /* lennard jones */
 #ifdef LENNARD_JONES
-  add_lj_pair_force(p1,p2,ia_params,d,dist, force);
+  if (pot & NB_POT_LJ)
+    add_lj_pair_force(p1,p2,ia_params,d,dist, force);
 #endif
   /* lennard jones generic */
 #ifdef LENNARD_JONES_GENERIC
-  add_ljgen_pair_force(p1,p2,ia_params,d,dist, force);
+  if (pot & NB_POT_LJGEN)
+    add_ljgen_pair_force(p1,p2,ia_params,d,dist, force);
 #endif
   /* Directional LJ */
 #ifdef LJ_ANGLE
   /* The forces are propagated within the function */
-  add_ljangle_pair_force(p1,p2,ia_params,d,dist);
+  if (pot & NB_POT_LJANGLE)
+    add_ljangle_pair_force(p1,p2,ia_params,d,dist);
 #endif
   /* smooth step */
 #ifdef SMOOTH_STEP
-  add_SmSt_pair_force(p1,p2,ia_params,d,dist,dist2, force);
+  if (pot & NB_POT_SMOOTH_STEP)
+    add_SmSt_pair_force(p1,p2,ia_params,d,dist,dist2, force);
 #endif
   /* Hertzian force */
 #ifdef HERTZIAN
-  add_hertzian_pair_force(p1,p2,ia_params,d,dist,dist2, force);
+  if (pot & NB_POT_HERTZIAN)
+    add_hertzian_pair_force(p1,p2,ia_params,d,dist,dist2, force);
 #endif
   /* BMHTF NaCl */
 #ifdef BMHTF_NACL
-  add_BMHTF_pair_force(p1,p2,ia_params,d,dist,dist2, force);
+  if (pot & NB_POT_BMHTF)
+    add_BMHTF_pair_force(p1,p2,ia_params,d,dist,dist2, force);
 #endif
   /* buckingham*/
 #ifdef BUCKINGHAM
-  add_buck_pair_force(p1,p2,ia_params,d,dist,force);
+  if (pot & NB_POT_BUCKINGHAM)
+    add_buck_pair_force(p1,p2,ia_params,d,dist,force);
 #endif
   /* morse*/
 #ifdef MORSE
-  add_morse_pair_force(p1,p2,ia_params,d,dist,force);
+  if (pot & NB_POT_MORSE)
+    add_morse_pair_force(p1,p2,ia_params,d,dist,force);
 #endif
  /*soft-sphere potential*/
 #ifdef SOFT_SPHERE
-  add_soft_pair_force(p1,p2,ia_params,d,dist,force);
+  if (pot & NB_POT_SOFT_SPHERE)
+    add_soft_pair_force(p1,p2,ia_params,d,dist,force);
 #endif
   /* lennard jones cosine */
 #ifdef LJCOS
-  add_ljcos_pair_force(p1,p2,ia_params,d,dist,force);
+  if (pot & NB_POT_LJCOS)
+    add_ljcos_pair_force(p1,p2,ia_params,d,dist,force);
 #endif
   /* lennard jones cosine */
 #ifdef LJCOS2
-  add_ljcos2_pair_force(p1,p2,ia_params,d,dist,force);
+  if (pot & NB_POT_LJCOS2)
+    add_ljcos2_pair_force(p1,p2,ia_params,d,dist,force);
 #endif
   /* tabulated */
 #ifdef TABULATED
-  add_tabulated_pair_force(p1,p2,ia_params,d,dist,force);
+  if (pot & NB_POT_TABULATED)
+    add_tabulated_pair_force(p1,p2,ia_params,d,dist,force);
 #endif
   /* Gay-Berne */
 #ifdef GAY_BERNE
-  add_gb_pair_force(p1,p2,ia_params,d,dist,force,torgue1,torgue2);
+  if (pot & NB_POT_GAY_BERNE)
+    add_gb_pair_force(p1,p2,ia_params,d,dist,force,torgue1,torgue2);
 #endif
 #ifdef INTER_RF
-  add_interrf_pair_force(p1,p2,ia_params,d,dist, force);
+  if (pot & NB_POT_INTER_RF)
+    add_interrf_pair_force(p1,p2,ia_params,d,dist, force);
 #endif
 #ifdef ADRESS
 #ifdef INTERFACE_CORRECTION
-  add_adress_tab_pair_force(p1,p2,ia_params,d,dist,force);
+  if (pot & NB_POT_ADRESS_TAB)
+    add_adress_tab_pair_force(p1,p2,ia_params,d,dist,force);
 #endif
 #endif
 }
@@ -218,6 +320,92 @@ MDINLINE void calc_non_bonded_pair_force_from_partcfg_simple(Particle *p1,Partic
    calc_non_bonded_pair_force_from_partcfg(p1,p2,ia_params,d,dist,dist2,force,t1,t2);
 }
 
+/** Add the energy, virial and stress tensor of the non bonded pair
+    potentials to the observables of the node during a fused force
+    calculation. The virials are the same as in \ref
+    add_non_bonded_pair_virials, but reuse the force.
+    @param p1        pointer to particle 1.
+    @param p2        pointer to particle 2.
+    @param ia_params the interaction parameters between the two particles
+    @param d         vector between p1 and p2. 
+    @param dist      distance between p1 and p2.
+    @param dist2     distance squared between p1 and p2.
+    @param force     the force of the pair potentials on p1. */
+MDINLINE void add_non_bonded_pair_observables(Particle *p1, Particle *p2, IA_parameters *ia_params,
+					      double d[3], double dist, double dist2, double force[3])
+{
+  double vir = d[0]*force[0] + d[1]*force[1] + d[2]*force[2];
+  double *stress, *stress_nb;
+  int k, l;
+
+  *obsstat_nonbonded(&energy, p1->p.type, p2->p.type) +=
+    calc_non_bonded_pair_energy(p1, p2, ia_params, d, dist, dist2);
+
+  *obsstat_nonbonded(&virials, p1->p.type, p2->p.type) += vir;
+  stress = obsstat_nonbonded(&p_tensor, p1->p.type, p2->p.type);
+  if (p1->p.mol_id == p2->p.mol_id) {
+    *obsstat_nonbonded_intra(&virials_non_bonded, p1->p.type, p2->p.type) += vir;
+    stress_nb = obsstat_nonbonded_intra(&p_tensor_non_bonded, p1->p.type, p2->p.type);
+  }
+  else {
+    *obsstat_nonbonded_inter(&virials_non_bonded, p1->p.type, p2->p.type) += vir;
+    stress_nb = obsstat_nonbonded_inter(&p_tensor_non_bonded, p1->p.type, p2->p.type);
+  }
+  for(k=0;k<3;k++)
+    for(l=0;l<3;l++) {
+      stress[k*3 + l] += force[k]*d[l];
+      stress_nb[k*3 + l] += force[k]*d[l];
+    }
+}
+
+#ifdef ELECTROSTATICS
+/** Add the real space coulomb energy, virial and stress tensor to
+    the observables of the node during a fused force calculation, as
+    \ref add_non_bonded_pair_energy and \ref add_non_bonded_pair_virials.
+    @param p1        pointer to particle 1.
+    @param p2        pointer to particle 2.
+    @param d         vector between p1 and p2. 
+    @param dist      distance between p1 and p2.
+    @param dist2     distance squared between p1 and p2.
+    @param p3m_eng   the real space energy of P3M as returned by the force. */
+MDINLINE void add_coulomb_pair_observables(Particle *p1, Particle *p2, double d[3],
+					   double dist, double dist2, double p3m_eng)
+{
+  double eng, force[3] = { 0., 0., 0. };
+  int k, l;
+
+  if (coulomb.method == COULOMB_NONE)
+    return;
+
+  if (coulomb.method == COULOMB_P3M)
+    eng = p3m_eng;
+  else
+    eng = calc_coulomb_pair_energy(p1, p2, d, dist, dist2);
+  energy.coulomb[0] += eng;
+
+  switch (coulomb.method) {
+  case COULOMB_P3M:
+  case COULOMB_DH:
+  case COULOMB_RF:
+  case COULOMB_MMM1D:
+    virials.coulomb[0] += eng;
+    break;
+  default:
+    return;
+  }
+
+  if (coulomb.method == COULOMB_DH)
+    add_dh_coulomb_pair_force(p1,p2,d,dist,force);
+  else if (coulomb.method == COULOMB_RF)
+    add_rf_coulomb_pair_force(p1,p2,d,dist,force);
+  else
+    return;
+  for(k=0;k<3;k++)
+    for(l=0;l<3;l++)
+      p_tensor.coulomb[k*3 + l] += force[k]*d[l];
+}
+#endif
+
 /** Calculate non bonded forces between a pair of particles.
     @param p1        pointer to particle 1.
     @param p2        pointer to particle 2.
@@ -232,6 +420,9 @@ MDINLINE void add_non_bonded_pair_force(Particle *p1, Particle *p2,
   double torque1[3] = { 0., 0., 0. };
   double torque2[3] = { 0., 0., 0. };
   int j;
+#ifdef ELECTROSTATICS
+  double coulomb_eng = 0;
+#endif
   
 #ifdef ADRESS
   double tmp,force_weight=adress_non_bonded_force_weight(p1,p2);
@@ -259,6 +450,9 @@ MDINLINE void add_non_bonded_pair_force(Particle *p1, Particle *p2,
 
    calc_non_bonded_pair_force(p1,p2,ia_params,d,dist,dist2,force,torque1,torque2);
 
+  if (obs_fused_step)
+    add_non_bonded_pair_observables(p1, p2, ia_params, d, dist, dist2, force);
+
   /***********************************************/
   /* short range electrostatics                  */
   /***********************************************/
@@ -300,12 +494,10 @@ MDINLINE void add_non_bonded_pair_force(Particle *p1, Particle *p2,
     break;
   }
   case COULOMB_P3M: {
+    coulomb_eng = add_p3m_coulomb_pair_force(p1->p.q*p2->p.q,d,dist2,dist,force);
 #ifdef NPT
-    double eng = add_p3m_coulomb_pair_force(p1->p.q*p2->p.q,d,dist2,dist,force);
     if(integ_switch == INTEG_METHOD_NPT_ISO)
-      nptiso.p_vir[0] += eng;
-#else
-    add_p3m_coulomb_pair_force(p1->p.q*p2->p.q,d,dist2,dist,force); 
+      nptiso.p_vir[0] += coulomb_eng;
 #endif
     break;
   }
@@ -330,6 +522,9 @@ MDINLINE void add_non_bonded_pair_force(Particle *p1, Particle *p2,
     break;
   }
 
+  if (obs_fused_step)
+    add_coulomb_pair_observables(p1, p2, d, dist, dist2, coulomb_eng);
+
 #endif /*ifdef ELECTROSTATICS */
 
 
@@ -378,10 +573,73 @@ MDINLINE void add_non_bonded_pair_force(Particle *p1, Particle *p2,
   }
 }
 
+/** Calculate non bonded forces between a pair of particles using the
+    cell mirrors (see \ref soa.h). If the pair can be evaluated on the
+    mirror alone, the force is accumulated in the mirrors, otherwise
+    this falls back to \ref add_non_bonded_pair_force.
+    @param p1        pointer to particle 1.
+    @param s1        mirror of the cell of particle 1.
+    @param i         index of particle 1 in its cell.
+    @param p2        pointer to particle 2.
+    @param s2        mirror of the cell of particle 2.
+    @param j         index of particle 2 in its cell.
+    @param d         vector between p1 and p2.
+    @param dist2     distance squared between p1 and p2. */
+MDINLINE void add_non_bonded_pair_force_soa(Particle *p1, CellSoA *s1, int i,
+					    Particle *p2, CellSoA *s2, int j,
+					    double d[3], double dist2)
+{
+  double force[3] = { 0., 0., 0. };
+  double dist = sqrt(dist2);
+#if defined(ELECTROSTATICS) && defined(P3M)
+  double q1q2;
+#endif
+
+  if (!soa_simple_types(s1->type[i], s2->type[j])) {
+    add_non_bonded_pair_force(p1, p2, d, dist, dist2);
+    return;
+  }
+
+  /* the particle pointers are only used for tracing */
+#ifdef LENNARD_JONES
+  add_lj_pair_force(p1, p2, get_ia_param(s1->type[i], s2->type[j]), d, dist, force);
+#endif
+
+#if defined(ELECTROSTATICS) && defined(P3M)
+  if (coulomb.method == COULOMB_P3M) {
+    q1q2 = s1->q[i]*s2->q[j];
+    if (q1q2 != 0.0)
+      add_p3m_coulomb_pair_force(q1q2, d, dist2, dist, force);
+  }
+#endif
+
+  s1->fx[i] += force[0];
+  s1->fy[i] += force[1];
+  s1->fz[i] += force[2];
+  s2->fx[j] -= force[0];
+  s2->fy[j] -= force[1];
+  s2->fz[j] -= force[2];
+}
+
+/** add a bonded force contribution to a force component of a
+    particle. The bonded forces of several particles can be calculated
+    concurrently (see \ref calc_local_bonded_forces), and the bond
+    partners may be shared, so then the update has to be atomic. Uses
+    the parameter atomic of \ref add_bonded_force_generic, which is
+    a constant after inlining. */
+#ifdef _OPENMP
+#define BONDED_FORCE_ADD(var, val) \
+  do { if (atomic) { _Pragma("omp atomic") (var) += (val); } else (var) += (val); } while (0)
+#else
+#define BONDED_FORCE_ADD(var, val) (var) += (val)
+#endif
+
 /** Calculate bonded forces for one particle.
     @param p1 particle for which to calculate forces
+    @param atomic whether the forces have to be added atomically, since
+    other threads calculate bonded forces at the same time
 */
-MDINLINE void add_bonded_force(Particle *p1)
+MDINLINE void add_bonded_force_generic(Particle *p1, int atomic)
 {
   double dx[3]     = { 0., 0., 0. };
   double force[3]  = { 0., 0., 0. };
@@ -550,23 +808,23 @@ MDINLINE void add_bonded_force(Particle *p1)
       for (j = 0; j < 3; j++) {
 #ifdef ADRESS
         tmp=force_weight*force[j];
-	p1->f.f[j] += tmp;
-	p2->f.f[j] -= tmp;
+	BONDED_FORCE_ADD(p1->f.f[j], tmp);
+	BONDED_FORCE_ADD(p2->f.f[j], -tmp);
 #else // ADRESS
 
 	switch (type) {
 #ifdef BOND_ENDANGLEDIST
 	case BONDED_IA_ENDANGLEDIST:
-          p1->f.f[j] += force[j];
-          p2->f.f[j] += force2[j];
+          BONDED_FORCE_ADD(p1->f.f[j], force[j]);
+          BONDED_FORCE_ADD(p2->f.f[j], force2[j]);
 	  break;
 #endif // BOND_ENDANGLEDIST
 	default:
-	  p1->f.f[j] += force[j];
-	  p2->f.f[j] -= force[j];
+	  BONDED_FORCE_ADD(p1->f.f[j], force[j]);
+	  BONDED_FORCE_ADD(p2->f.f[j], -force[j]);
 #ifdef ROTATION
-	  p1->f.torque[j] += torque1[j];
-	  p2->f.torque[j] += torque2[j];
+	  BONDED_FORCE_ADD(p1->f.torque[j], torque1[j]);
+	  BONDED_FORCE_ADD(p2->f.torque[j], torque2[j]);
 #endif
 	}
 #endif // NOT ADRESS
@@ -590,13 +848,13 @@ MDINLINE void add_bonded_force(Particle *p1)
 #endif
       for (j = 0; j < 3; j++) {
 #ifdef ADRESS
-	p1->f.f[j] += force_weight*force[j];
-	p2->f.f[j] += force_weight*force2[j];
-	p3->f.f[j] -= force_weight*(force[j] + force2[j]);
+	BONDED_FORCE_ADD(p1->f.f[j], force_weight*force[j]);
+	BONDED_FORCE_ADD(p2->f.f[j], force_weight*force2[j]);
+	BONDED_FORCE_ADD(p3->f.f[j], -force_weight*(force[j] + force2[j]));
 #else
-	p1->f.f[j] += force[j];
-	p2->f.f[j] += force2[j];
-	p3->f.f[j] -= (force[j] + force2[j]);
+	BONDED_FORCE_ADD(p1->f.f[j], force[j]);
+	BONDED_FORCE_ADD(p2->f.f[j], force2[j]);
+	BONDED_FORCE_ADD(p3->f.f[j], -(force[j] + force2[j]));
 #endif
       }
       break;
@@ -612,15 +870,15 @@ MDINLINE void add_bonded_force(Particle *p1)
 #endif 
       for (j = 0; j < 3; j++) {
 #ifdef ADRESS
-	p1->f.f[j] += force_weight*force[j];
-	p2->f.f[j] += force_weight*force2[j];
-	p3->f.f[j] += force_weight*force3[j];
-	p4->f.f[j] -= force_weight*(force[j] + force2[j] + force3[j]);
+	BONDED_FORCE_ADD(p1->f.f[j], force_weight*force[j]);
+	BONDED_FORCE_ADD(p2->f.f[j], force_weight*force2[j]);
+	BONDED_FORCE_ADD(p3->f.f[j], force_weight*force3[j]);
+	BONDED_FORCE_ADD(p4->f.f[j], -force_weight*(force[j] + force2[j] + force3[j]));
 #else
-	p1->f.f[j] += force[j];
-	p2->f.f[j] += force2[j];
-	p3->f.f[j] += force3[j];
-	p4->f.f[j] -= (force[j] + force2[j] + force3[j]);
+	BONDED_FORCE_ADD(p1->f.f[j], force[j]);
+	BONDED_FORCE_ADD(p2->f.f[j], force2[j]);
+	BONDED_FORCE_ADD(p3->f.f[j], force3[j]);
+	BONDED_FORCE_ADD(p4->f.f[j], -(force[j] + force2[j] + force3[j]));
 #endif
       }
       break;
@@ -628,6 +886,14 @@ MDINLINE void add_bonded_force(Particle *p1)
   }
 }  
 
+/** Calculate bonded forces for one particle, on a single thread.
+    @param p1 particle for which to calculate forces
+*/
+MDINLINE void add_bonded_force(Particle *p1)
+{
+  add_bonded_force_generic(p1, 0);
+}
+
 /** add force to another. This is used when collecting ghost forces. */
 MDINLINE void add_force(ParticleForce *F_to, ParticleForce *F_add)
 {
@@ -26,6 +26,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include <float.h>
 #include "utils.h"
 #include "ghosts.h"
 #include "global.h"
@@ -34,9 +36,15 @@
 #include "grid.h"
 #include "particle_data.h"
 #include "forces.h"
+#include "errorhandling.h"
+#include "timers.h"
 
 /** Tag for communication in ghost_comm. */
 #define REQ_GHOST_SEND 100
+/** Tag for communication in ghost_communicator_start. Transfers
+    between the same nodes match in the order they are posted, as in
+    \ref ghost_communicator. */
+#define REQ_GHOST_ASYNC 200
 
 static int n_s_buffer = 0;
 static int max_s_buffer = 0;
@@ -56,6 +64,11 @@ static MPI_Op MPI_FORCES_SUM;
 */
 int ghosts_have_v = 0;
 
+GhostCommunicator *ghost_comm_pending = NULL;
+
+static void complete_pending_comm();
+static int use_persistent_comm(GhostCommunicator *gc);
+
 /************************************************************
  * Exported Functions
  ************************************************************/
@@ -76,15 +89,30 @@ void prepare_comm(GhostCommunicator *comm, int data_parts, int num)
   comm->comm = malloc(num*sizeof(GhostCommunication));
   for(i=0; i<num; i++) {
     comm->comm[i].shift[0]=comm->comm[i].shift[1]=comm->comm[i].shift[2]=0.0;
+    comm->comm[i].buffer = NULL;
+    comm->comm[i].n_buffer = comm->comm[i].max_buffer = 0;
+    comm->comm[i].request = MPI_REQUEST_NULL;
+    comm->comm[i].datatype = MPI_DATATYPE_NULL;
   }
+  comm->phases_valid = comm->started = comm->persistent = 0;
+  comm->float_error = 0;
+  comm->requests = malloc(num*sizeof(MPI_Request));
+  comm->phase_begin = comm->phase_end = 0;
 }
 
 void free_comm(GhostCommunicator *comm)
 {
   int n;
   GHOST_TRACE(fprintf(stderr,"%d: free_comm: %p has %d ghost communications\n",this_node,comm,comm->num));
-  for (n = 0; n < comm->num; n++) free(comm->comm[n].part_lists);
+  if (ghost_comm_pending == comm)
+    complete_pending_comm();
+  ghost_release_persistent(comm);
+  for (n = 0; n < comm->num; n++) {
+    free(comm->comm[n].part_lists);
+    free(comm->comm[n].buffer);
+  }
   free(comm->comm);
+  free(comm->requests);
 }
 
 int calc_transmit_size(GhostCommunication *gc, int data_parts)
@@ -116,24 +144,16 @@ int calc_transmit_size(GhostCommunication *gc, int data_parts)
   return n_buffer_new;
 }
 
-void prepare_send_buffer(GhostCommunication *gc, int data_parts)
+/** pack the data of the cells of gc into buffer, which has to be
+    large enough. */
+static void pack_send_buffer(GhostCommunication *gc, int data_parts, char *buffer, int n_buffer)
 {
   char *insert;
   int pl, p, np;
   Particle *part, *pt;
 
-  GHOST_TRACE(fprintf(stderr, "%d: prepare sending to/bcast from %d\n", this_node, gc->node));
-
-  /* reallocate send buffer */
-  n_s_buffer = calc_transmit_size(gc, data_parts);
-  if (n_s_buffer > max_s_buffer) {
-    max_s_buffer = n_s_buffer;
-    s_buffer = realloc(s_buffer, max_s_buffer);
-  }
-  GHOST_TRACE(fprintf(stderr, "%d: will send %d\n", this_node, n_s_buffer));
-
   /* put in data */
-  insert = s_buffer;
+  insert = buffer;
   for (pl = 0; pl < gc->n_part_lists; pl++) {
     np   = gc->part_lists[pl]->n;
     if (data_parts == GHOSTTRANS_PARTNUM) {
@@ -182,13 +202,28 @@ void prepare_send_buffer(GhostCommunication *gc, int data_parts)
     }
   }
 #ifdef ADDITIONAL_CHECKS
-  if (insert - s_buffer != n_s_buffer) {
-    fprintf(stderr, "%d: INTERNAL ERROR: send buffer size %d differs from what I put in %d\n", this_node, n_s_buffer, insert - s_buffer);
+  if (insert - buffer != n_buffer) {
+    fprintf(stderr, "%d: INTERNAL ERROR: send buffer size %d differs from what I put in %d\n", this_node, n_buffer, insert - buffer);
     errexit();
   }
 #endif
 }
 
+void prepare_send_buffer(GhostCommunication *gc, int data_parts)
+{
+  GHOST_TRACE(fprintf(stderr, "%d: prepare sending to/bcast from %d\n", this_node, gc->node));
+
+  /* reallocate send buffer */
+  n_s_buffer = calc_transmit_size(gc, data_parts);
+  if (n_s_buffer > max_s_buffer) {
+    max_s_buffer = n_s_buffer;
+    s_buffer = realloc(s_buffer, max_s_buffer);
+  }
+  GHOST_TRACE(fprintf(stderr, "%d: will send %d\n", this_node, n_s_buffer));
+
+  pack_send_buffer(gc, data_parts, s_buffer, n_s_buffer);
+}
+
 void prepare_recv_buffer(GhostCommunication *gc, int data_parts)
 {
   GHOST_TRACE(fprintf(stderr, "%d: prepare receiving from %d\n", this_node, gc->node));
@@ -201,14 +236,14 @@ void prepare_recv_buffer(GhostCommunication *gc, int data_parts)
   GHOST_TRACE(fprintf(stderr, "%d: will get %d\n", this_node, n_r_buffer));
 }
 
-void put_recv_buffer(GhostCommunication *gc, int data_parts)
+void put_recv_buffer(GhostCommunication *gc, int data_parts, char *buffer, int n_buffer)
 {
   int pl, p, np;
   Particle *part, *pt;
   char *retrieve;
 
   /* put back data */
-  retrieve = r_buffer;
+  retrieve = buffer;
   for (pl = 0; pl < gc->n_part_lists; pl++) {
     if (data_parts == GHOSTTRANS_PARTNUM) {
       GHOST_TRACE(fprintf(stderr, "%d: reallocating cell %p to size %d, assigned to node %d\n",
@@ -266,21 +301,21 @@ void put_recv_buffer(GhostCommunication *gc, int data_parts)
     }
   }
 #ifdef ADDITIONAL_CHECKS
-  if (retrieve - r_buffer != n_r_buffer) {
-    fprintf(stderr, "%d: recv buffer size %d differs from what I put in %d\n", this_node, n_r_buffer, retrieve - r_buffer);
+  if (retrieve - buffer != n_buffer) {
+    fprintf(stderr, "%d: recv buffer size %d differs from what I put in %d\n", this_node, n_buffer, retrieve - buffer);
     errexit();
   }
 #endif
 }
 
-void add_forces_from_recv_buffer(GhostCommunication *gc)
+void add_forces_from_recv_buffer(GhostCommunication *gc, char *buffer, int n_buffer)
 {
   int pl, p, np;
   Particle *part, *pt;
   char *retrieve;
 
   /* put back data */
-  retrieve = r_buffer;
+  retrieve = buffer;
   for (pl = 0; pl < gc->n_part_lists; pl++) {
     np   = gc->part_lists[pl]->n;
     part = gc->part_lists[pl]->part;
@@ -291,8 +326,8 @@ void add_forces_from_recv_buffer(GhostCommunication *gc)
     }
   }
 #ifdef ADDITIONAL_CHECKS
-  if (retrieve - r_buffer != n_r_buffer) {
-    fprintf(stderr, "%d: recv buffer size %d differs from what I put in %d\n", this_node, n_r_buffer, retrieve - r_buffer);
+  if (retrieve - buffer != n_buffer) {
+    fprintf(stderr, "%d: recv buffer size %d differs from what I put in %d\n", this_node, n_buffer, retrieve - buffer);
     errexit();
   }
 #endif
@@ -389,6 +424,20 @@ void ghost_communicator(GhostCommunicator *gc)
 
   GHOST_TRACE(fprintf(stderr, "%d: ghost_comm %p, data_parts %d\n", this_node, gc, data_parts));
 
+  timer_start(TIMER_GHOSTS);
+
+  /* the cells might still be in flight */
+  complete_pending_comm();
+
+  /* the phases of the nonblocking communication are as blocking as
+     this function, but overlap the transfers of a phase */
+  if (use_persistent_comm(gc)) {
+    ghost_communicator_start(gc);
+    ghost_communicator_wait(gc);
+    timer_stop(TIMER_GHOSTS);
+    return;
+  }
+
   for (n = 0; n < gc->num; n++) {
     GhostCommunication *gcn = &gc->comm[n];
     int comm_type = gcn->type & GHOST_JOBMASK;
@@ -473,9 +522,9 @@ void ghost_communicator(GhostCommunicator *gc)
 	  /* forces have to be added, the rest overwritten. Exception is RDCE, where the addition
 	     is integrated into the communication. */
 	  if (data_parts == GHOSTTRANS_FORCE && comm_type != GHOST_RDCE)
-	    add_forces_from_recv_buffer(gcn);
+	    add_forces_from_recv_buffer(gcn, r_buffer, n_r_buffer);
 	  else
-	    put_recv_buffer(gcn, data_parts);
+	    put_recv_buffer(gcn, data_parts, r_buffer, n_r_buffer);
 	}
 	else {
 	  GHOST_TRACE(fprintf(stderr, "%d: ghost_comm delaying operation %d, recv from %d\n", this_node, n, node));
@@ -500,9 +549,9 @@ void ghost_communicator(GhostCommunicator *gc)
 #endif
 	      /* as above */
 	      if (data_parts == GHOSTTRANS_FORCE && comm_type != GHOST_RDCE)
-		add_forces_from_recv_buffer(gcn2);
+		add_forces_from_recv_buffer(gcn2, r_buffer, n_r_buffer);
 	      else
-		put_recv_buffer(gcn2, data_parts);
+		put_recv_buffer(gcn2, data_parts, r_buffer, n_r_buffer);
 	      break;
 	    }
 	  }
@@ -510,6 +559,553 @@ void ghost_communicator(GhostCommunicator *gc)
       }
     }
   }
+
+  timer_stop(TIMER_GHOSTS);
+}
+
+/** whether some part list of the lists [b1,e1) occurs in [b2,e2). */
+static int lists_overlap(ParticleList **b1, ParticleList **e1,
+			 ParticleList **b2, ParticleList **e2)
+{
+  ParticleList **l1, **l2;
+  for (l1 = b1; l1 < e1; l1++)
+    for (l2 = b2; l2 < e2; l2++)
+      if (*l1 == *l2)
+	return 1;
+  return 0;
+}
+
+/** determine \ref GhostCommunication::new_phase for all
+    communications of gc. A communication starts a new phase if it
+    reads a cell that is written by a communication of the current
+    phase, since the transfers of a phase are done concurrently. */
+static void find_comm_phases(GhostCommunicator *gc)
+{
+  int n, m, begin = 0;
+
+  for (n = 0; n < gc->num; n++) {
+    GhostCommunication *gcn = &gc->comm[n];
+    int comm_type = gcn->type & GHOST_JOBMASK;
+    /* cells read by this communication */
+    ParticleList **rb = gcn->part_lists, **re = rb;
+
+    if (comm_type == GHOST_SEND)
+      re = rb + gcn->n_part_lists;
+    else if (comm_type == GHOST_LOCL)
+      re = rb + gcn->n_part_lists/2;
+
+    gcn->new_phase = (n == 0);
+    for (m = begin; m < n && !gcn->new_phase; m++) {
+      GhostCommunication *gcm = &gc->comm[m];
+      int comm_type2 = gcm->type & GHOST_JOBMASK;
+      if (comm_type2 == GHOST_RECV)
+	gcn->new_phase = lists_overlap(rb, re, gcm->part_lists,
+				       gcm->part_lists + gcm->n_part_lists);
+      else if (comm_type2 == GHOST_LOCL)
+	gcn->new_phase = lists_overlap(rb, re, gcm->part_lists + gcm->n_part_lists/2,
+				       gcm->part_lists + gcm->n_part_lists);
+    }
+    if (gcn->new_phase)
+      begin = n;
+  }
+  gc->phases_valid = 1;
+}
+
+/** \name single precision transfers, see \ref GhostCommunicator::float_error */
+/*@{*/
+
+/** number of doubles of \ref ParticlePosition sent as floats. The
+    old positions of RATTLE are not shifted, and therefore cannot be
+    sent relative to the new ones. */
+#ifdef BOND_CONSTRAINT
+#define POS_N_FLOAT (offsetof(ParticlePosition, p_old)/sizeof(double))
+#else
+#define POS_N_FLOAT (sizeof(ParticlePosition)/sizeof(double))
+#endif
+/** number of doubles of \ref ParticlePosition sent as doubles. */
+#define POS_N_DOUBLE (sizeof(ParticlePosition)/sizeof(double) - POS_N_FLOAT)
+/** number of doubles of \ref ParticleMomentum. */
+#define MOM_N_FLOAT (sizeof(ParticleMomentum)/sizeof(double))
+/** number of doubles of \ref ParticleForce. */
+#define FORCE_N_FLOAT (sizeof(ParticleForce)/sizeof(double))
+
+/** size of the single precision transfer of gc, see \ref calc_transmit_size. */
+static int calc_float_transmit_size(GhostCommunication *gc, int data_parts)
+{
+  int p, count = 0, n_lists = 0, n_buffer = 0;
+
+  for (p = 0; p < gc->n_part_lists; p++) {
+    count += gc->part_lists[p]->n;
+    if (gc->part_lists[p]->n > 0)
+      n_lists++;
+  }
+  if (data_parts & GHOSTTRANS_POSITION) {
+    /* reference position of each cell */
+    n_buffer += n_lists*3*sizeof(double);
+    n_buffer += count*(POS_N_FLOAT*sizeof(float) + POS_N_DOUBLE*sizeof(double));
+  }
+  if (data_parts & GHOSTTRANS_MOMENTUM)
+    n_buffer += count*MOM_N_FLOAT*sizeof(float);
+  if (data_parts & GHOSTTRANS_FORCE)
+    n_buffer += count*FORCE_N_FLOAT*sizeof(float);
+  return n_buffer;
+}
+
+/** single precision variant of \ref pack_send_buffer. Raises a
+    runtime error if a relative position is too large for max_error. */
+static void pack_float_buffer(GhostCommunication *gc, int data_parts, double max_error,
+			      char *buffer, int n_buffer)
+{
+  char *insert = buffer;
+  int pl, p, np, i;
+  double ref[3], max_rel = 0;
+
+  for (pl = 0; pl < gc->n_part_lists; pl++) {
+    Particle *part = gc->part_lists[pl]->part;
+    np = gc->part_lists[pl]->n;
+    if (np == 0)
+      continue;
+
+    if (data_parts & GHOSTTRANS_POSITION) {
+      for (i = 0; i < 3; i++) {
+	ref[i] = part[0].r.p[i];
+	if (data_parts & GHOSTTRANS_POSSHFTD)
+	  ref[i] += gc->shift[i];
+      }
+      memcpy(insert, ref, 3*sizeof(double));
+      insert += 3*sizeof(double);
+    }
+
+    for (p = 0; p < np; p++) {
+      if (data_parts & GHOSTTRANS_POSITION) {
+	double *d = (double *)&part[p].r;
+	float *fl = (float *)insert;
+	/* the shift cancels against the one of the reference */
+	for (i = 0; i < 3; i++) {
+	  double rel = d[i] - part[0].r.p[i];
+	  fl[i] = rel;
+	  if (fabs(rel) > max_rel)
+	    max_rel = fabs(rel);
+	}
+	for (i = 3; i < POS_N_FLOAT; i++)
+	  fl[i] = d[i];
+	insert += POS_N_FLOAT*sizeof(float);
+	memcpy(insert, d + POS_N_FLOAT, POS_N_DOUBLE*sizeof(double));
+	insert += POS_N_DOUBLE*sizeof(double);
+      }
+      if (data_parts & GHOSTTRANS_MOMENTUM) {
+	double *d = (double *)&part[p].m;
+	float *fl = (float *)insert;
+	for (i = 0; i < MOM_N_FLOAT; i++)
+	  fl[i] = d[i];
+	insert += MOM_N_FLOAT*sizeof(float);
+      }
+      if (data_parts & GHOSTTRANS_FORCE) {
+	double *d = (double *)&part[p].f;
+	float *fl = (float *)insert;
+	for (i = 0; i < FORCE_N_FLOAT; i++)
+	  fl[i] = d[i];
+	insert += FORCE_N_FLOAT*sizeof(float);
+      }
+    }
+  }
+
+  /* worst case rounding error of the relative positions */
+  if (max_rel*0.5*FLT_EPSILON > max_error) {
+    char *errtext = runtime_error(2*TCL_DOUBLE_SPACE + 128);
+    ERROR_SPRINTF(errtext, "{123 single precision ghost positions have an error of up to %g, more than the allowed %g} ",
+		  max_rel*0.5*FLT_EPSILON, max_error);
+  }
+
+#ifdef ADDITIONAL_CHECKS
+  if (insert - buffer != n_buffer) {
+    fprintf(stderr, "%d: INTERNAL ERROR: send buffer size %d differs from what I put in %d\n", this_node, n_buffer, insert - buffer);
+    errexit();
+  }
+#endif
+}
+
+/** single precision variant of \ref put_recv_buffer and \ref
+    add_forces_from_recv_buffer. */
+static void unpack_float_buffer(GhostCommunication *gc, int data_parts, char *buffer, int n_buffer)
+{
+  char *retrieve = buffer;
+  int pl, p, np, i;
+  double ref[3];
+
+  for (pl = 0; pl < gc->n_part_lists; pl++) {
+    Particle *part = gc->part_lists[pl]->part;
+    np = gc->part_lists[pl]->n;
+    if (np == 0)
+      continue;
+
+    if (data_parts & GHOSTTRANS_POSITION) {
+      memcpy(ref, retrieve, 3*sizeof(double));
+      retrieve += 3*sizeof(double);
+    }
+
+    for (p = 0; p < np; p++) {
+      if (data_parts & GHOSTTRANS_POSITION) {
+	double *d = (double *)&part[p].r;
+	float *fl = (float *)retrieve;
+	for (i = 0; i < 3; i++)
+	  d[i] = ref[i] + fl[i];
+	for (i = 3; i < POS_N_FLOAT; i++)
+	  d[i] = fl[i];
+	retrieve += POS_N_FLOAT*sizeof(float);
+	memcpy(d + POS_N_FLOAT, retrieve, POS_N_DOUBLE*sizeof(double));
+	retrieve += POS_N_DOUBLE*sizeof(double);
+      }
+      if (data_parts & GHOSTTRANS_MOMENTUM) {
+	double *d = (double *)&part[p].m;
+	float *fl = (float *)retrieve;
+	for (i = 0; i < MOM_N_FLOAT; i++)
+	  d[i] = fl[i];
+	retrieve += MOM_N_FLOAT*sizeof(float);
+      }
+      if (data_parts & GHOSTTRANS_FORCE) {
+	/* forces are always added */
+	double *d = (double *)&part[p].f;
+	float *fl = (float *)retrieve;
+	for (i = 0; i < FORCE_N_FLOAT; i++)
+	  d[i] += fl[i];
+	retrieve += FORCE_N_FLOAT*sizeof(float);
+      }
+    }
+  }
+
+#ifdef ADDITIONAL_CHECKS
+  if (retrieve - buffer != n_buffer) {
+    fprintf(stderr, "%d: recv buffer size %d differs from what I put in %d\n", this_node, n_buffer, retrieve - buffer);
+    errexit();
+  }
+#endif
+}
+
+/*@}*/
+
+/** make the buffer of gcn large enough for n_buffer bytes. */
+static void realloc_comm_buffer(GhostCommunication *gcn, int n_buffer)
+{
+  gcn->n_buffer = n_buffer;
+  if (n_buffer > gcn->max_buffer) {
+    gcn->max_buffer = n_buffer;
+    gcn->buffer = realloc(gcn->buffer, gcn->max_buffer);
+  }
+}
+
+/** single precision variant of \ref cell_cell_transfer. The data goes
+    through the buffer of gcn as if it was sent, so that the ghosts
+    have the same precision as for a transfer to another node. */
+static void float_cell_cell_transfer(GhostCommunication *gcn, int data_parts, double max_error)
+{
+  GhostCommunication from = *gcn, to = *gcn;
+
+  from.n_part_lists = to.n_part_lists = gcn->n_part_lists/2;
+  to.part_lists = gcn->part_lists + from.n_part_lists;
+  realloc_comm_buffer(gcn, calc_float_transmit_size(&from, data_parts));
+  pack_float_buffer(&from, data_parts, max_error, gcn->buffer, gcn->n_buffer);
+  unpack_float_buffer(&to, data_parts, gcn->buffer, gcn->n_buffer);
+}
+
+/** post the transfers of the next phases of gc, until a phase
+    actually has to wait for other nodes. Local transfers are done
+    immediately.
+    @return 0 if there is nothing left to post, i. e. the
+    communication is complete. */
+static int post_comm_phase(GhostCommunicator *gc)
+{
+  int n, data_parts = gc->data_parts, pending = 0;
+
+  while (!pending && gc->phase_end < gc->num) {
+    gc->phase_begin = n = gc->phase_end;
+    do {
+      GhostCommunication *gcn = &gc->comm[n];
+      int comm_type = gcn->type & GHOST_JOBMASK;
+
+      gc->requests[n] = MPI_REQUEST_NULL;
+      switch (comm_type) {
+      case GHOST_LOCL:
+	if (gc->float_error > 0)
+	  float_cell_cell_transfer(gcn, data_parts, gc->float_error);
+	else
+	  cell_cell_transfer(gcn, data_parts);
+	break;
+      case GHOST_SEND:
+	if (gc->persistent) {
+	  if (gc->float_error > 0)
+	    pack_float_buffer(gcn, data_parts, gc->float_error, gcn->buffer, gcn->n_buffer);
+	  else if (gcn->datatype == MPI_DATATYPE_NULL)
+	    pack_send_buffer(gcn, data_parts, gcn->buffer, gcn->n_buffer);
+	  MPI_Start(&gcn->request);
+	  gc->requests[n] = gcn->request;
+	}
+	else {
+	  realloc_comm_buffer(gcn, calc_transmit_size(gcn, data_parts));
+	  pack_send_buffer(gcn, data_parts, gcn->buffer, gcn->n_buffer);
+	  GHOST_TRACE(fprintf(stderr, "%d: ghost_comm_start send to %d (%d bytes)\n", this_node, gcn->node, gcn->n_buffer));
+	  MPI_Isend(gcn->buffer, gcn->n_buffer, MPI_BYTE, gcn->node, REQ_GHOST_ASYNC,
+		    MPI_COMM_WORLD, &gc->requests[n]);
+	}
+	pending = 1;
+	break;
+      case GHOST_RECV:
+	if (gc->persistent) {
+	  MPI_Start(&gcn->request);
+	  gc->requests[n] = gcn->request;
+	}
+	else {
+	  realloc_comm_buffer(gcn, calc_transmit_size(gcn, data_parts));
+	  GHOST_TRACE(fprintf(stderr, "%d: ghost_comm_start receive from %d (%d bytes)\n", this_node, gcn->node, gcn->n_buffer));
+	  MPI_Irecv(gcn->buffer, gcn->n_buffer, MPI_BYTE, gcn->node, REQ_GHOST_ASYNC,
+		    MPI_COMM_WORLD, &gc->requests[n]);
+	}
+	pending = 1;
+	break;
+      }
+      n++;
+    } while (n < gc->num && !gc->comm[n].new_phase);
+    gc->phase_end = n;
+  }
+  return pending;
+}
+
+/** whether gc can use persistent requests, see \ref
+    GhostCommunicator::persistent. The particle properties and cell
+    sizes are only transferred once after a resort. */
+static int use_persistent_comm(GhostCommunicator *gc)
+{
+  int n;
+
+  if (gc->data_parts & ~(GHOSTTRANS_POSITION | GHOSTTRANS_POSSHFTD |
+			 GHOSTTRANS_MOMENTUM | GHOSTTRANS_FORCE))
+    return 0;
+  for (n = 0; n < gc->num; n++) {
+    int comm_type = gc->comm[n].type & GHOST_JOBMASK;
+    if (comm_type == GHOST_BCST || comm_type == GHOST_RDCE)
+      return 0;
+  }
+  return 1;
+}
+
+/** create a datatype for the particles of gcn, which addresses the
+    positions and momenta or the forces of the particles directly. */
+static void create_particle_datatype(GhostCommunication *gcn, int data_parts)
+{
+  int pl, p, np, cnt = 0, max_blocks = 0;
+  int *lens;
+  MPI_Aint *disps;
+
+  for (pl = 0; pl < gcn->n_part_lists; pl++)
+    max_blocks += 2*gcn->part_lists[pl]->n;
+  lens  = malloc((max_blocks + 1)*sizeof(int));
+  disps = malloc((max_blocks + 1)*sizeof(MPI_Aint));
+
+  for (pl = 0; pl < gcn->n_part_lists; pl++) {
+    Particle *part = gcn->part_lists[pl]->part;
+    np = gcn->part_lists[pl]->n;
+    for (p = 0; p < np; p++) {
+      /* same order as in prepare_send_buffer */
+      if (data_parts & GHOSTTRANS_POSITION) {
+	MPI_Get_address(&part[p].r, &disps[cnt]);
+	lens[cnt++] = sizeof(ParticlePosition);
+      }
+      if (data_parts & GHOSTTRANS_MOMENTUM) {
+	MPI_Get_address(&part[p].m, &disps[cnt]);
+	lens[cnt++] = sizeof(ParticleMomentum);
+      }
+      if (data_parts & GHOSTTRANS_FORCE) {
+	MPI_Get_address(&part[p].f, &disps[cnt]);
+	lens[cnt++] = sizeof(ParticleForce);
+      }
+    }
+  }
+  MPI_Type_create_hindexed(cnt, lens, disps, MPI_BYTE, &gcn->datatype);
+  MPI_Type_commit(&gcn->datatype);
+
+  free(lens);
+  free(disps);
+}
+
+/** set up the persistent requests of gc. Shifted positions have to
+    be modified and received forces added, so these go through \ref
+    GhostCommunication::buffer, everything else is transferred
+    directly from or into the particles. The particle arrays must not
+    be reallocated until \ref ghost_release_persistent. */
+static void init_persistent_comm(GhostCommunicator *gc)
+{
+  int n, data_parts = gc->data_parts;
+
+  for (n = 0; n < gc->num; n++) {
+    GhostCommunication *gcn = &gc->comm[n];
+    int comm_type = gcn->type & GHOST_JOBMASK;
+
+    if (gc->float_error > 0) {
+      /* everything has to be converted */
+      if (comm_type != GHOST_SEND && comm_type != GHOST_RECV)
+	continue;
+      realloc_comm_buffer(gcn, calc_float_transmit_size(gcn, data_parts));
+      if (comm_type == GHOST_SEND)
+	MPI_Send_init(gcn->buffer, gcn->n_buffer, MPI_BYTE, gcn->node, REQ_GHOST_ASYNC,
+		      MPI_COMM_WORLD, &gcn->request);
+      else
+	MPI_Recv_init(gcn->buffer, gcn->n_buffer, MPI_BYTE, gcn->node, REQ_GHOST_ASYNC,
+		      MPI_COMM_WORLD, &gcn->request);
+    }
+    else if (comm_type == GHOST_SEND) {
+      /* only the sign of the shift is fixed, the box might change */
+      if ((data_parts & GHOSTTRANS_POSSHFTD) &&
+	  (gcn->shift[0] != 0 || gcn->shift[1] != 0 || gcn->shift[2] != 0)) {
+	realloc_comm_buffer(gcn, calc_transmit_size(gcn, data_parts));
+	MPI_Send_init(gcn->buffer, gcn->n_buffer, MPI_BYTE, gcn->node, REQ_GHOST_ASYNC,
+		      MPI_COMM_WORLD, &gcn->request);
+      }
+      else {
+	create_particle_datatype(gcn, data_parts);
+	MPI_Send_init(MPI_BOTTOM, 1, gcn->datatype, gcn->node, REQ_GHOST_ASYNC,
+		      MPI_COMM_WORLD, &gcn->request);
+      }
+    }
+    else if (comm_type == GHOST_RECV) {
+      if (data_parts & GHOSTTRANS_FORCE) {
+	realloc_comm_buffer(gcn, calc_transmit_size(gcn, data_parts));
+	MPI_Recv_init(gcn->buffer, gcn->n_buffer, MPI_BYTE, gcn->node, REQ_GHOST_ASYNC,
+		      MPI_COMM_WORLD, &gcn->request);
+      }
+      else {
+	create_particle_datatype(gcn, data_parts);
+	MPI_Recv_init(MPI_BOTTOM, 1, gcn->datatype, gcn->node, REQ_GHOST_ASYNC,
+		      MPI_COMM_WORLD, &gcn->request);
+      }
+    }
+  }
+  gc->persistent = 1;
+}
+
+void ghost_release_persistent(GhostCommunicator *gc)
+{
+  int n;
+
+  if (!gc->persistent)
+    return;
+  if (ghost_comm_pending == gc)
+    complete_pending_comm();
+
+  for (n = 0; n < gc->num; n++) {
+    GhostCommunication *gcn = &gc->comm[n];
+    if (gcn->request != MPI_REQUEST_NULL)
+      MPI_Request_free(&gcn->request);
+    if (gcn->datatype != MPI_DATATYPE_NULL)
+      MPI_Type_free(&gcn->datatype);
+  }
+  gc->persistent = 0;
+}
+
+/** store the data received in the current phase of gc. */
+static void finish_comm_phase(GhostCommunicator *gc)
+{
+  int n;
+
+  for (n = gc->phase_begin; n < gc->phase_end; n++) {
+    GhostCommunication *gcn = &gc->comm[n];
+    /* with a datatype, the data is already in place */
+    if ((gcn->type & GHOST_JOBMASK) != GHOST_RECV || gcn->datatype != MPI_DATATYPE_NULL)
+      continue;
+    if (gc->float_error > 0)
+      unpack_float_buffer(gcn, gc->data_parts, gcn->buffer, gcn->n_buffer);
+    else if (gc->data_parts == GHOSTTRANS_FORCE)
+      add_forces_from_recv_buffer(gcn, gcn->buffer, gcn->n_buffer);
+    else
+      put_recv_buffer(gcn, gc->data_parts, gcn->buffer, gcn->n_buffer);
+  }
+}
+
+void ghost_communicator_start(GhostCommunicator *gc)
+{
+  int n;
+
+  GHOST_TRACE(fprintf(stderr, "%d: ghost_comm_start %p, data_parts %d\n", this_node, gc, gc->data_parts));
+
+  timer_start(TIMER_GHOSTS);
+
+  complete_pending_comm();
+  gc->started = 1;
+
+  /* collective operations cannot be split into phases */
+  for (n = 0; n < gc->num; n++) {
+    int comm_type = gc->comm[n].type & GHOST_JOBMASK;
+    if (comm_type == GHOST_BCST || comm_type == GHOST_RDCE) {
+      ghost_communicator(gc);
+      timer_stop(TIMER_GHOSTS);
+      return;
+    }
+  }
+
+  if (!gc->phases_valid)
+    find_comm_phases(gc);
+  if (!gc->persistent && use_persistent_comm(gc))
+    init_persistent_comm(gc);
+
+  gc->phase_end = 0;
+  if (post_comm_phase(gc))
+    ghost_comm_pending = gc;
+
+  timer_stop(TIMER_GHOSTS);
+}
+
+int ghost_communicator_progress()
+{
+  GhostCommunicator *gc = ghost_comm_pending;
+  int flag;
+
+  if (!gc)
+    return 1;
+
+  MPI_Testall(gc->phase_end - gc->phase_begin, gc->requests + gc->phase_begin,
+	      &flag, MPI_STATUSES_IGNORE);
+  if (!flag)
+    return 0;
+
+  finish_comm_phase(gc);
+  if (post_comm_phase(gc))
+    return 0;
+
+  ghost_comm_pending = NULL;
+  return 1;
+}
+
+/** finish \ref ghost_comm_pending, if any. */
+static void complete_pending_comm()
+{
+  GhostCommunicator *gc = ghost_comm_pending;
+
+  if (!gc)
+    return;
+
+  GHOST_TRACE(fprintf(stderr, "%d: ghost_comm_wait %p\n", this_node, gc));
+
+  do {
+    MPI_Waitall(gc->phase_end - gc->phase_begin, gc->requests + gc->phase_begin,
+		MPI_STATUSES_IGNORE);
+    finish_comm_phase(gc);
+  } while (post_comm_phase(gc));
+
+  ghost_comm_pending = NULL;
+}
+
+void ghost_communicator_wait(GhostCommunicator *gc)
+{
+  if (!gc->started) {
+    ghost_communicator(gc);
+    return;
+  }
+  gc->started = 0;
+
+  if (ghost_comm_pending == gc) {
+    timer_start(TIMER_GHOSTS);
+    complete_pending_comm();
+    timer_stop(TIMER_GHOSTS);
+  }
 }
 
 void ghost_init()
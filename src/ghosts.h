@@ -157,6 +157,27 @@ typedef struct {
   /** if \ref GhostCommunicator::data_parts has \ref GHOSTTRANS_POSSHFTD, then this is the shift vector.
       Normally this a integer multiple of the box length. The shift is done on the sender side */
   double shift[3];
+
+  /** send or receive buffer of this communication in \ref
+      ghost_communicator_start. Just grows, like the buffers of the
+      blocking communicator. */
+  char *buffer;
+  /** used size of \ref GhostCommunication::buffer. */
+  int n_buffer;
+  /** allocated size of \ref GhostCommunication::buffer. */
+  int max_buffer;
+  /** set if this communication reads data that an earlier
+      communication of the same phase writes, i.e. it has to wait
+      for that one to finish, see \ref ghost_communicator_start. */
+  int new_phase;
+
+  /** persistent request of this communication, see \ref
+      GhostCommunicator::persistent. */
+  MPI_Request request;
+  /** if not MPI_DATATYPE_NULL, the persistent request transfers
+      directly from or to the particles with this datatype instead of
+      using \ref GhostCommunication::buffer. */
+  MPI_Datatype datatype;
 } GhostCommunication;
 
 /** Properties for a ghost communication. A ghost communication is defined */
@@ -171,6 +192,35 @@ typedef struct {
   /** List of ghost communications. */
   GhostCommunication *comm;
 
+  /** whether \ref GhostCommunication::new_phase has been determined. */
+  int phases_valid;
+  /** set by \ref ghost_communicator_start until \ref
+      ghost_communicator_wait is called. */
+  int started;
+  /** requests of the communications in flight, one per communication. */
+  MPI_Request *requests;
+  /** first communication of the current phase in \ref
+      ghost_communicator_start. */
+  int phase_begin;
+  /** first communication after the current phase. */
+  int phase_end;
+
+  /** whether the persistent requests \ref GhostCommunication::request
+      are set up. Communicators of positions, momenta and forces that
+      use only point-to-point communication always use persistent
+      requests, which are created at the first communication after the
+      particles have been resorted. Except for shifted positions and
+      received forces, the particle data is transferred directly with
+      derived datatypes. */
+  int persistent;
+
+  /** if positive, positions, momenta and forces are transferred in
+      single precision (only with \ref GhostCommunicator::persistent).
+      The positions are sent relative to the first particle of each
+      cell, and a runtime error is raised if their rounding error can
+      exceed this value. The local copies are converted the same way. */
+  double float_error;
+
 } GhostCommunicator;
 
 /*@}*/
@@ -191,6 +241,43 @@ void ghost_init();
 /** do a ghost communication */
 void ghost_communicator(GhostCommunicator *gc);
 
+/** release the persistent requests of gc (see \ref
+    GhostCommunicator::persistent). This has to be called whenever
+    the particle arrays of the cells of gc might have been
+    reallocated. */
+void ghost_release_persistent(GhostCommunicator *gc);
+
+/** start a ghost communication without waiting for it. All transfers
+    of a phase are posted at once with nonblocking MPI calls into
+    buffers owned by the single communications. A phase ends where a
+    communication needs data that is received in the same phase, for
+    the domain decomposition this is the case for every direction,
+    since the edge and corner ghosts are forwarded. The next phase is
+    started by \ref ghost_communicator_progress or \ref
+    ghost_communicator_wait, which has to be called in any case. Only
+    one communicator can be in flight, it is \ref ghost_comm_pending.
+    Communicators with broadcasts or reductions are executed blocking.
+
+    The data of the transferred cells must not be touched until \ref
+    ghost_communicator_wait returns, except that the senders may be
+    read. */
+void ghost_communicator_start(GhostCommunicator *gc);
+
+/** check whether the current phase of \ref ghost_comm_pending has
+    arrived, and if so, store it and start the next phase. Call
+    this regularly while waiting for a communication.
+    @return 1 if the communication is complete. */
+int ghost_communicator_progress();
+
+/** complete the communication gc. If it was started by \ref
+    ghost_communicator_start, wait for it to finish, otherwise do a
+    blocking communication. */
+void ghost_communicator_wait(GhostCommunicator *gc);
+
+/** the communicator started by \ref ghost_communicator_start which
+    is not yet complete, or NULL. */
+extern GhostCommunicator *ghost_comm_pending;
+
 /** Go through \ref ghost_cells and remove the ghost entries from \ref
     local_particles. Part of \ref dd_exchange_and_sort_particles.*/
 void invalidate_ghosts();
@@ -43,8 +43,10 @@
 #include "layered.h"
 #include "pressure.h"
 #include "rattle.h"
+#include "random.h"
 #include "lattice.h"
 #include "adresso.h"
+#include "threads.h"
 
 /**********************************************
  * description of variables
@@ -102,6 +104,12 @@ const Datafield fields[] = {
   {&dpd_twf,            TYPE_INT, 1, "dpd_twf",    tclcallback_ro,     6 },         /* 40 from thermostat.c */
   {&dpd_wf,             TYPE_INT, 1, "dpd_wf",    tclcallback_ro,     5 },         /* 41 from thermostat.c */
   {adress_vars,      TYPE_DOUBLE, 7, "adress_vars",tclcallback_ro,  1 },         /* 42  from adresso.c */
+  {&n_threads,          TYPE_INT, 1, "n_threads",     tclcallback_n_threads, 3 },   /* 43  from threads.c */
+  {&random_backend,     TYPE_INT, 1, "rng_backend",   tclcallback_thermo_ro, 3 }, /* 44  from random.c */
+  {&philox_seed,        TYPE_INT, 1, "philox_seed",   tclcallback_thermo_ro, 8 }, /* 45  from random.c */
+  {&philox_counter,     TYPE_INT, 1, "philox_counter", tclcallback_philox_counter, 8 }, /* 46  from random.c */
+  {&obs_fused,          TYPE_INT, 1, "obs_fused",     tclcallback_obs_fused, 3 }, /* 47  from forces.c */
+  {&kspace_overlap,     TYPE_INT, 1, "kspace_overlap", tclcallback_kspace_overlap, 3 }, /* 48  from forces.c */
   { NULL, 0, 0, NULL, NULL, 0 }
 };
 
@@ -171,6 +171,18 @@ extern const Datafield fields[];
 #define FIELD_DPD_WF           41
 /** index of address variable in \ref #fields */
 #define FIELD_ADRESS           42
+/** index of \ref n_threads in \ref #fields */
+#define FIELD_NTHREADS         43
+/** index of \ref random_backend in \ref #fields */
+#define FIELD_RANDOM_BACKEND   44
+/** index of \ref philox_seed in \ref #fields */
+#define FIELD_PHILOX_SEED      45
+/** index of \ref philox_counter in \ref #fields */
+#define FIELD_PHILOX_COUNTER   46
+/** index of \ref obs_fused in \ref #fields */
+#define FIELD_OBS_FUSED        47
+/** index of \ref kspace_overlap in \ref #fields */
+#define FIELD_KSPACE_OVERLAP   48
 /*@}*/
 
 /**********************************************
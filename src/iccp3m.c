@@ -60,8 +60,6 @@ int iccp3m_initialized = 0;
  * excluding forces other than the electrostatic ones */
 void init_forces_iccp3m();
 void calc_long_range_forces_iccp3m();
-MDINLINE void add_pair_iccp3m(PairList *pl, Particle *p1, Particle *p2);
-void resize_verlet_list_iccp3m(PairList *pl);
 MDINLINE void init_local_particle_force_iccp3m(Particle *part);
 MDINLINE void init_ghost_force_iccp3m(Particle *part);
 extern void on_particle_change();
@@ -75,9 +73,6 @@ int imod(int x,int y);
 void iccp3m_revive_forces();
 void iccp3m_store_forces();
 
-/** Granularity of the verlet list */
-#define LIST_INCREMENT 20
-
 void iccp3m_init(void){
    iccp3m_cfg.set_flag=0;
    iccp3m_cfg.areas = NULL;
@@ -445,9 +440,9 @@ void layered_calculate_ia_iccp3m()
 
 void build_verlet_lists_and_calc_verlet_ia_iccp3m()
 {
-  int c, np1, n, np2, i ,j, j_start=0;
+  int c, np1, n, np2, i ,j, j_start, n_start;
   Cell *cell;
-  IA_Neighbor *neighbor;
+  IA_Neighbor_List *nl;
   Particle *p1, *p2;
   PairList *pl;
   double dist2, vec21[3];
@@ -468,23 +463,23 @@ void build_verlet_lists_and_calc_verlet_ia_iccp3m()
     cell = local_cells.cell[c];
     p1   = cell->part;
     np1  = cell->n;
-    /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      neighbor = &dd.cell_inter[c].nList[n];
-      p2  = neighbor->pList->part;
-      np2 = neighbor->pList->n;
-      VERLET_TRACE(fprintf(stderr,"%d: neighbor %d contains %d parts\n",this_node,n,np2));
-      /* init pair list */
-      pl  = &neighbor->vList;
-      pl->n = 0;
-      /* Loop cell particles */
-      for(i=0; i < np1; i++) {
-	j_start = 0;
-	/* Tasks within cell: (no bonded forces) store old position, avoid double counting */
-	if(n == 0) {
-	  memcpy(p1[i].l.p_old, p1[i].r.p, 3*sizeof(double));
-	  j_start = i+1;
-	}
+    nl   = &dd.cell_inter[c];
+    /* init pair list */
+    pl   = &nl->vList;
+    start_verlet_list(pl, np1);
+
+    /* Loop cell particles */
+    for(i=0; i < np1; i++) {
+      /* Tasks within cell: (no bonded forces) store old position */
+      memcpy(p1[i].l.p_old, p1[i].r.p, 3*sizeof(double));
+      n_start = pl->n;
+
+      /* Loop cell neighbors */
+      for (n = 0; n < nl->n_neighbors; n++) {
+	p2  = nl->nList[n].pList->part;
+	np2 = nl->nList[n].pList->n;
+	/* avoid double counting within the cell */
+	j_start = (n == 0) ? i+1 : 0;
 	/* Loop neighbor cell particles */
 	for(j = j_start; j < np2; j++) {
 #ifdef EXCLUSIONS
@@ -498,23 +493,19 @@ void build_verlet_lists_and_calc_verlet_ia_iccp3m()
 	    ONEPART_TRACE(if(p1[i].p.identity==check_id) fprintf(stderr,"%d: OPT: Verlet Pair %d %d (Cells %d,%d %d,%d dist %f)\n",this_node,p1[i].p.identity,p2[j].p.identity,c,i,n,j,sqrt(dist2)));
 	    ONEPART_TRACE(if(p2[j].p.identity==check_id) fprintf(stderr,"%d: OPT: Verlet Pair %d %d (Cells %d %d dist %f)\n",this_node,p1[i].p.identity,p2[j].p.identity,c,n,sqrt(dist2)));
 
-	    add_pair_iccp3m(pl, &p1[i], &p2[j]);
-	    /* calc non bonded interactions */ 
-           if(!(p1[i].p.identity > iccp3m_cfg.last_ind_id && p2[j].p.identity >iccp3m_cfg.last_ind_id)) {
-	       add_non_bonded_pair_force_iccp3m(&(p1[i]), &(p2[j]), vec21, sqrt(dist2), dist2);
-                } 
-/*           else {
-             printf("Ever here \n");
-             }*/
-             /* avoid source-source computation */ 
+	    add_pair(pl, n, j);
+	    /* calc non bonded interactions, avoid source-source computation */
+	    if(!(p1[i].p.identity > iccp3m_cfg.last_ind_id && p2[j].p.identity >iccp3m_cfg.last_ind_id))
+	      add_non_bonded_pair_force_iccp3m(&(p1[i]), &(p2[j]), vec21, sqrt(dist2), dist2);
 	  }
 	 }
 	}
       }
-      resize_verlet_list_iccp3m(pl);
-      VERLET_TRACE(fprintf(stderr,"%d: neighbor %d has %d pairs\n",this_node,n,pl->n));
-      VERLET_TRACE(sum += pl->n);
+      pl->n_partners[i] = pl->n - n_start;
     }
+    finish_verlet_list(pl);
+    VERLET_TRACE(fprintf(stderr,"%d: cell %d has %d pairs\n",this_node,c,pl->n));
+    VERLET_TRACE(sum += pl->n);
   }
 
   VERLET_TRACE(fprintf(stderr,"%d: total number of interaction pairs: %d (should be around %d)\n",this_node,sum,estimate));
@@ -524,27 +515,25 @@ void build_verlet_lists_and_calc_verlet_ia_iccp3m()
 
 void calculate_verlet_ia_iccp3m()
 {
-  int c, np, n, i;
-  Cell *cell;
-  Particle *p1, *p2, **pairs;
+  int c, i, j, k;
+  IA_Neighbor_List *nl;
+  Particle *p1, *p2;
+  PairList *pl;
   double dist2, vec21[3];
 
   /* Loop local cells */
   for (c = 0; c < local_cells.n; c++) {
-    cell = local_cells.cell[c];
-    p1   = cell->part;
-    np  = cell->n;
-    /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      pairs = dd.cell_inter[c].nList[n].vList.pair;
-      np    = dd.cell_inter[c].nList[n].vList.n;
-      /* verlet list loop */
-      for(i=0; i<2*np; i+=2) {
-	      p1 = pairs[i];                    /* pointer to particle 1 */
-	      p2 = pairs[i+1];                  /* pointer to particle 2 */
-	      dist2 = distance2vec(p1->r.p, p2->r.p, vec21); 
-          if(!(p1->p.identity > iccp3m_cfg.last_ind_id && p2->p.identity >iccp3m_cfg.last_ind_id))  /* avoid source-source computation */
-	          add_non_bonded_pair_force_iccp3m(p1, p2, vec21, sqrt(dist2), dist2);
+    p1 = local_cells.cell[c]->part;
+    nl = &dd.cell_inter[c];
+    pl = &nl->vList;
+    /* verlet list loop, over the particles the list was built for */
+    for(i = 0, k = 0; i < pl->n_part; i++) {
+      for(j = 0; j < pl->n_partners[i]; j++, k++) {
+	p2 = dd_verlet_partner(nl, pl->pair[k]);
+	dist2 = distance2vec(p1[i].r.p, p2->r.p, vec21);
+	/* avoid source-source computation */
+	if(!(p1[i].p.identity > iccp3m_cfg.last_ind_id && p2->p.identity >iccp3m_cfg.last_ind_id))
+	  add_non_bonded_pair_force_iccp3m(&p1[i], p2, vec21, sqrt(dist2), dist2);
       }
     }
   }
@@ -724,37 +713,6 @@ void calc_long_range_forces_iccp3m()
 /************************************************************/
 /*@{*/
 
-/** Add a particle pair to a verlet pair list.
-    Checks verlet pair list size and reallocates memory if necessary.
- *  \param p1 Pointer to paricle one.
- *  \param p2 Pointer to paricle two.
- *  \param pl Pointer to the verlet pair list.
- */
-MDINLINE void add_pair_iccp3m(PairList *pl, Particle *p1, Particle *p2)
-{
-  /* check size of verlet List */
-  if(pl->n+1 >= pl->max) {
-    pl->max += LIST_INCREMENT;
-    pl->pair = (Particle **)realloc(pl->pair, 2*pl->max*sizeof(Particle *));
-  }
-  /* add pair */
-  pl->pair[(2*pl->n)  ] = p1;
-  pl->pair[(2*pl->n)+1] = p2;
-  /* increase number of pairs */
-  pl->n++;
-}
-
-void resize_verlet_list_iccp3m(PairList *pl)
-{
-  int diff;
-  diff = pl->max - pl->n;
-  if( diff > 2*LIST_INCREMENT ) {
-    diff = (diff/LIST_INCREMENT)-1;
-    pl->max -= diff*LIST_INCREMENT;
-    pl->pair = (Particle **)realloc(pl->pair, 2*pl->max*sizeof(Particle *));
-  }
-}
-
 /** initialize the forces for a real particle */
 MDINLINE void init_local_particle_force_iccp3m(Particle *part)
 {
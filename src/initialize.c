@@ -31,6 +31,9 @@
 #include "particle_data.h"
 #include "interaction_data.h"
 #include "binary_file.h"
+#include "trajectory.h"
+#include "timers.h"
+#include "correlation.h"
 #include "integrate.h"
 #include "statistics.h"
 #include "energy.h"
@@ -41,6 +44,8 @@
 #include "communication.h"
 #include "blockfile_tcl.h"
 #include "cells.h"
+#include "soa.h"
+#include "threads.h"
 #include "grid.h"
 #include "thermostat.h"
 #include "rotation.h"
@@ -97,6 +102,7 @@ int on_program_start(Tcl_Interp *interp)
   */
   init_random();
   init_bit_random();
+  threads_init();
 
   setup_node_grid();
   /* calculate initial minimimal number of cells (see tclcallback_min_num_cells) */
@@ -333,6 +339,8 @@ void on_particle_change()
   reinit_electrostatics = 1;
   reinit_magnetostatics = 1;
   rebuild_verletlist = 1;
+  /* the particle arrays might have been reallocated */
+  cells_release_ghost_requests();
 
 #ifdef LB_GPU
   lb_reinit_particles_gpu = 1;
@@ -413,6 +421,7 @@ void on_short_range_ia_change()
 {
   EVENT_TRACE(fprintf(stderr, "%d: on_short_range_ia_changes\n", this_node));
   invalidate_obs();
+  soa_invalidate_pair_table();
 
   integrate_vv_recalc_maxrange();
   on_parameter_change(FIELD_MAXRANGE);
@@ -546,6 +555,9 @@ void on_parameter_change(int field)
 
   EVENT_TRACE(fprintf(stderr, "%d: on_parameter_change %s\n", this_node, fields[field].name));
 
+  /* e.g. the box or the prefactors of the last force calculation */
+  obs_fused_invalidate();
+
   if (field == FIELD_SKIN) {
     integrate_vv_recalc_maxrange();
     on_parameter_change(FIELD_MAXRANGE);
@@ -653,6 +665,9 @@ void on_parameter_change(int field)
   if (field == FIELD_MAXRANGE)
     rebuild_verletlist = 1;
 
+  if (field == FIELD_NTHREADS)
+    threads_set_num_threads();
+
   switch (cell_structure.type) {
   case CELL_STRUCTURE_LAYERED:
     if (field == FIELD_NODEGRID) {
@@ -790,8 +805,14 @@ static void init_tcl(Tcl_Interp *interp)
   /* in file binaryfile.c */
   REGISTER_COMMAND("writemd", tclcommand_writemd);
   REGISTER_COMMAND("readmd", tclcommand_readmd);
+  /* in file trajectory.c */
+  REGISTER_COMMAND("trajectory", tclcommand_trajectory);
   /* in file statistics.c */
   REGISTER_COMMAND("analyze", tclcommand_analyze);
+  /* in file correlation.c */
+  REGISTER_COMMAND("correlation", tclcommand_correlation);
+  /* in file timers.c */
+  REGISTER_COMMAND("timers", tclcommand_timers);
   /* in file polymer.c */
   REGISTER_COMMAND("polymer", tclcommand_polymer);
   REGISTER_COMMAND("counterions", tclcommand_counterions);
@@ -57,6 +57,9 @@
 #include "virtual_sites.h"
 #include "adresso.h"
 #include "lbgpu.h"
+#include "threads.h"
+#include "correlation.h"
+#include "timers.h"
 
 /************************************************
  * DEFINES
@@ -332,6 +335,7 @@ void integrate_vv_recalc_maxrange()
   if (max_cut <= 0.0) {
     max_range  = -1.0;
     max_range2 = -1.0;
+    calc_nb_kernels();
     return;
   }
   max_range            = max_cut;
@@ -343,6 +347,9 @@ void integrate_vv_recalc_maxrange()
   }
   max_range2            = SQR(max_range);
   max_range_non_bonded2 = SQR(max_range_non_bonded);
+
+  /* the Verlet ranges of the type pairs */
+  calc_nb_kernels();
 }
 
 /************************************************************/
@@ -410,6 +417,8 @@ void integrate_vv(int n_steps)
 #endif
 
    
+   /* an integrate 0 is just for the observables */
+   obs_fused_step = obs_fused && n_steps == 0;
    force_calc();
 
    
@@ -421,7 +430,7 @@ void integrate_vv(int n_steps)
    if (check_runtime_errors()) return;
 #endif
 
-ghost_communicator(&cell_structure.collect_ghost_force_comm);
+ghost_communicator_wait(&cell_structure.collect_ghost_force_comm);
 
 #ifdef ROTATION
     convert_initial_torques();
@@ -448,6 +457,7 @@ ghost_communicator(&cell_structure.collect_ghost_force_comm);
   n_verlet_updates = 0;
 
   /* Integration loop */
+  timer_start(TIMER_INTEGRATE);
   for(i=0;i<n_steps;i++) {
     INTEG_TRACE(fprintf(stderr,"%d: STEP %d\n",this_node,i));
 
@@ -490,7 +500,7 @@ ghost_communicator(&cell_structure.collect_ghost_force_comm);
       break;
 #endif
 
-    cells_update_ghosts();
+    cells_start_update_ghosts();
 
 //VIRTUAL_SITES update pos and vel (for DPD)
 #ifdef VIRTUAL_SITES
@@ -512,6 +522,9 @@ ghost_communicator(&cell_structure.collect_ghost_force_comm);
     transfer_momentum_gpu = 1;
 #endif
 
+    /* the observables are accumulated along with the forces after
+       which they are due */
+    obs_fused_step = obs_fused && (i == n_steps - 1 || correlation_stress_due());
     force_calc();
 
 //VIRTUAL_SITES distribute forces
@@ -523,7 +536,7 @@ ghost_communicator(&cell_structure.collect_ghost_force_comm);
 #endif
 
     /* Communication step: ghost forces */
-    ghost_communicator(&cell_structure.collect_ghost_force_comm);
+    ghost_communicator_wait(&cell_structure.collect_ghost_force_comm);
 
     /*apply trap forces to trapped molecules*/
 #ifdef MOLFORCES         
@@ -576,7 +589,12 @@ ghost_communicator(&cell_structure.collect_ghost_force_comm);
 
     /* Propagate time: t = t+dt */
     if(this_node==0) sim_time += time_step;
+
+    /* samples of the time correlations */
+    if (n_correlations > 0)
+      correlation_integration_step();
   }
+  timer_stop(TIMER_INTEGRATE);
 
   /* after simulating the forces are necessarily set. Necessary since
      resort_particles sets recalc_forces to 1 */
@@ -714,6 +732,10 @@ void rescale_forces_propagate_vel()
   scale = 0.5 * time_step * time_step;
   INTEG_TRACE(fprintf(stderr,"%d: rescale_forces_propagate_vel:\n",this_node));
 
+  /* not threaded with NpT, see threads_active */
+#ifdef _OPENMP
+#pragma omp parallel for private(cell, p, np, i, j) schedule(dynamic) if(threads_active())
+#endif
   for (c = 0; c < local_cells.n; c++) {
     cell = local_cells.cell[c];
     p  = cell->part;
@@ -975,17 +997,18 @@ void propagate_vel_pos()
 {
   Cell *cell;
   Particle *p;
-  int c, i, j, np;
+  int c, i, j, np, rebuild = 0;
 
   INTEG_TRACE(fprintf(stderr,"%d: propagate_vel_pos:\n",this_node));
 
-  rebuild_verletlist = 0;
-
 #ifdef ADDITIONAL_CHECKS
   db_max_force = db_max_vel = 0;
   db_maxf_id = db_maxv_id = -1;
 #endif
 
+#ifdef _OPENMP
+#pragma omp parallel for private(cell, p, np, i, j) reduction(|:rebuild) schedule(dynamic) if(threads_active())
+#endif
   for (c = 0; c < local_cells.n; c++) {
     cell = local_cells.cell[c];
     p  = cell->part;
@@ -1015,9 +1038,10 @@ void propagate_vel_pos()
 #endif
 
       /* Verlet criterion check */
-      if(distance2(p[i].r.p,p[i].l.p_old) > skin2 ) rebuild_verletlist = 1;
+      if(distance2(p[i].r.p,p[i].l.p_old) > skin2 ) rebuild = 1;
     }
   }
+  rebuild_verletlist = rebuild;
 
   if(dd.use_vList) announce_rebuild_vlist();
 
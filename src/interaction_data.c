@@ -29,6 +29,7 @@
 #include "errorhandling.h"
 #include "communication.h"
 #include "grid.h"
+#include "integrate.h"
 #include "pressure.h"
 #include "p3m.h"
 #include "ewald.h"
@@ -94,6 +95,7 @@ Bonded_ia_parameters *bonded_ia_params = NULL;
 
 double max_cut;
 double max_cut_non_bonded;
+int nb_potentials_used = 0;
 
 double lj_force_cap = 0.0;
 double ljangle_force_cap = 0.0;
@@ -355,6 +357,10 @@ void initialize_ia_params(IA_parameters *params) {
   params->TUNABLE_SLIP_vy  = 0.0;
   params->TUNABLE_SLIP_vz  = 0.0;
 #endif
+
+  params->nb_potentials = 0;
+  params->nb_kernel = NB_KERNEL_NONE;
+  params->nb_range2 = -1.0;
 }
 
 #ifdef ADRESS
@@ -567,6 +573,9 @@ void copy_ia_params(IA_parameters *dst, IA_parameters *src) {
   dst->TUNABLE_SLIP_vz  = src->TUNABLE_SLIP_vz;
 #endif
 
+  dst->nb_potentials = src->nb_potentials;
+  dst->nb_kernel = src->nb_kernel;
+  dst->nb_range2 = src->nb_range2;
 }
 
 #ifdef ADRESS
@@ -768,6 +777,8 @@ void realloc_ia_params(int nsize)
 
   n_particle_types = nsize;
   ia_params = new_params;
+
+  calc_nb_kernels();
 }
 
 #ifdef ADRESS
@@ -845,6 +856,143 @@ void make_bond_type_exist(int type)
   n_bonded_ia = ns;
 }
 
+/** maximal cutoff of the non bonded interactions of a type pair,
+    -1 if there are none. */
+static double calc_pair_cutoff(IA_parameters *data)
+{
+  double cut = -1.0;
+
+#ifdef LENNARD_JONES
+  if (data->LJ_cut != 0) {
+    if(cut < (data->LJ_cut+data->LJ_offset) )
+      cut = (data->LJ_cut+data->LJ_offset);
+  }
+#endif
+
+#ifdef DPD
+  if (dpd_r_cut !=0) {
+    if(cut < dpd_r_cut)
+      cut = dpd_r_cut;
+  }
+#endif
+
+#ifdef TRANS_DPD
+  if (dpd_tr_cut !=0) {
+    if(cut < dpd_tr_cut)
+      cut = dpd_tr_cut;
+  }
+#endif
+
+#ifdef LENNARD_JONES_GENERIC
+  if (data->LJGEN_cut != 0) {
+    if(cut < (data->LJGEN_cut+data->LJGEN_offset) )
+      cut = (data->LJGEN_cut+data->LJGEN_offset);
+  }
+#endif
+
+#ifdef LJ_ANGLE
+  if (data->LJANGLE_cut != 0) {
+    if(cut < (data->LJANGLE_cut) )
+      cut = (data->LJANGLE_cut);
+  }
+#endif
+
+#ifdef INTER_DPD
+  if ((data->dpd_r_cut != 0) || (data->dpd_tr_cut != 0)){
+    if(cut < ( (data->dpd_r_cut > data->dpd_tr_cut)?data->dpd_r_cut:data->dpd_tr_cut ) )
+      cut = ( (data->dpd_r_cut > data->dpd_tr_cut)?data->dpd_r_cut:data->dpd_tr_cut );
+  }
+#endif
+
+#ifdef SMOOTH_STEP
+  if (data->SmSt_cut != 0) {
+    if(cut < data->SmSt_cut)
+      cut = data->SmSt_cut;
+  }
+#endif
+
+#ifdef HERTZIAN
+  if (data->Hertzian_sig != 0) {
+    if(cut < data->Hertzian_sig)
+      cut = data->Hertzian_sig;
+  }
+#endif
+
+#ifdef BMHTF_NACL
+  if (data->BMHTF_cut != 0) {
+    if(cut < data->BMHTF_cut)
+      cut = data->BMHTF_cut;
+  }
+#endif
+
+#ifdef MORSE
+  if (data->MORSE_cut != 0) {
+    if(cut < (data->MORSE_cut) )
+      cut = (data->MORSE_cut);
+  }
+#endif
+
+#ifdef BUCKINGHAM
+  if (data->BUCK_cut != 0) {
+    if(cut < data->BUCK_cut )
+      cut = data->BUCK_cut;
+  }
+#endif
+
+#ifdef SOFT_SPHERE
+  if (data->soft_cut != 0) {
+    if(cut < data->soft_cut )
+      cut = data->soft_cut;
+  }
+#endif
+
+#ifdef LJCOS
+  if (data->LJCOS_cut != 0) {
+    if(cut < (data->LJCOS_cut+data->LJCOS_offset) )
+      cut = (data->LJCOS_cut+data->LJCOS_offset);
+  }
+#endif
+
+#ifdef LJCOS2
+  if (data->LJCOS2_cut != 0) {
+    if(cut < (data->LJCOS2_cut+data->LJCOS2_offset) )
+      cut = (data->LJCOS2_cut+data->LJCOS2_offset);
+  }
+#endif
+
+#ifdef GAY_BERNE
+  if (data->GB_cut != 0) {
+    if(cut < (data->GB_cut) )
+      cut = (data->GB_cut);
+  }
+#endif
+
+#ifdef TABULATED
+  if (data->TAB_maxval != 0){
+    if(cut < (data->TAB_maxval ))
+      cut = data->TAB_maxval;
+  }
+#endif
+  
+#ifdef ADRESS
+#ifdef INTERFACE_CORRECTION
+  if (data->ADRESS_TAB_maxval !=0){
+    if(cut < (data->ADRESS_TAB_maxval ))
+      cut = data->ADRESS_TAB_maxval;
+  }
+#endif
+#endif
+
+#ifdef TUNABLE_SLIP
+  if (data->TUNABLE_SLIP_r_cut != 0){
+    if(cut < (data->TUNABLE_SLIP_r_cut ))
+      cut = data->TUNABLE_SLIP_r_cut;
+  }
+#endif
+
+  return cut;
+}
+
 void calc_maximal_cutoff()
 {
   int i, j;
@@ -930,134 +1078,9 @@ void calc_maximal_cutoff()
   for (i = 0; i < n_particle_types; i++)
      for (j = i; j < n_particle_types; j++) {
        if (checkIfParticlesInteract(i, j)) {
-	 IA_parameters *data = get_ia_param(i, j);
-#ifdef LENNARD_JONES
-	 if (data->LJ_cut != 0) {
-	   if(max_cut_non_bonded < (data->LJ_cut+data->LJ_offset) )
-	     max_cut_non_bonded = (data->LJ_cut+data->LJ_offset);
-	 }
-#endif
-
-#ifdef DPD
-	 if (dpd_r_cut !=0) {
-	   if(max_cut_non_bonded < dpd_r_cut)
-	     max_cut_non_bonded = dpd_r_cut;
-	 }
-#endif
-
-#ifdef TRANS_DPD
-	 if (dpd_tr_cut !=0) {
-	   if(max_cut_non_bonded < dpd_tr_cut)
-	     max_cut_non_bonded = dpd_tr_cut;
-	 }
-#endif
-
-#ifdef LENNARD_JONES_GENERIC
-	 if (data->LJGEN_cut != 0) {
-	   if(max_cut_non_bonded < (data->LJGEN_cut+data->LJGEN_offset) )
-	     max_cut_non_bonded = (data->LJGEN_cut+data->LJGEN_offset);
-	 }
-#endif
-
-#ifdef LJ_ANGLE
-	 if (data->LJANGLE_cut != 0) {
-	   if(max_cut_non_bonded < (data->LJANGLE_cut) )
-	     max_cut_non_bonded = (data->LJANGLE_cut);
-	 }
-#endif
-
-#ifdef INTER_DPD
-	 if ((data->dpd_r_cut != 0) || (data->dpd_tr_cut != 0)){
-	   if(max_cut_non_bonded < ( (data->dpd_r_cut > data->dpd_tr_cut)?data->dpd_r_cut:data->dpd_tr_cut ) )
-	     max_cut_non_bonded = ( (data->dpd_r_cut > data->dpd_tr_cut)?data->dpd_r_cut:data->dpd_tr_cut );
-	 }
-#endif
-
-#ifdef SMOOTH_STEP
-         if (data->SmSt_cut != 0) {
-           if(max_cut_non_bonded < data->SmSt_cut)
-             max_cut_non_bonded = data->SmSt_cut;
-         }
-#endif
-
-#ifdef HERTZIAN
-         if (data->Hertzian_sig != 0) {
-           if(max_cut_non_bonded < data->Hertzian_sig)
-             max_cut_non_bonded = data->Hertzian_sig;
-         }
-#endif
-
-#ifdef BMHTF_NACL
-         if (data->BMHTF_cut != 0) {
-           if(max_cut_non_bonded < data->BMHTF_cut)
-             max_cut_non_bonded = data->BMHTF_cut;
-         }
-#endif
-
-#ifdef MORSE
-         if (data->MORSE_cut != 0) {
-           if(max_cut_non_bonded < (data->MORSE_cut) )
-             max_cut_non_bonded = (data->MORSE_cut);
-         }
-#endif
-
-#ifdef BUCKINGHAM
-	 if (data->BUCK_cut != 0) {
-	   if(max_cut_non_bonded < data->BUCK_cut )
-	     max_cut_non_bonded = data->BUCK_cut;
-	 }
-#endif
-
-#ifdef SOFT_SPHERE
-	 if (data->soft_cut != 0) {
-	   if(max_cut_non_bonded < data->soft_cut )
-	     max_cut_non_bonded = data->soft_cut;
-	 }
-#endif
-
-#ifdef LJCOS
-	 if (data->LJCOS_cut != 0) {
-	   if(max_cut_non_bonded < (data->LJCOS_cut+data->LJCOS_offset) )
-	     max_cut_non_bonded = (data->LJCOS_cut+data->LJCOS_offset);
-	 }
-#endif
-
-#ifdef LJCOS2
-	 if (data->LJCOS2_cut != 0) {
-	   if(max_cut_non_bonded < (data->LJCOS2_cut+data->LJCOS2_offset) )
-	     max_cut_non_bonded = (data->LJCOS2_cut+data->LJCOS2_offset);
-	 }
-#endif
-
-#ifdef GAY_BERNE
-	 if (data->GB_cut != 0) {
-	   if(max_cut_non_bonded < (data->GB_cut) )
-	     max_cut_non_bonded = (data->GB_cut);
-	 }
-#endif
-
-#ifdef TABULATED
-	 if (data->TAB_maxval != 0){
-	   if(max_cut_non_bonded < (data->TAB_maxval ))
-	     max_cut_non_bonded = data->TAB_maxval;
-	 }
-#endif
-	 
-#ifdef ADRESS
-#ifdef INTERFACE_CORRECTION
-	 if (data->ADRESS_TAB_maxval !=0){
-	   if(max_cut_non_bonded < (data->ADRESS_TAB_maxval ))
-	     max_cut_non_bonded = data->ADRESS_TAB_maxval;
-	 }
-#endif
-#endif
-
-#ifdef TUNABLE_SLIP
-	 if (data->TUNABLE_SLIP_r_cut != 0){
-	   if(max_cut_non_bonded < (data->TUNABLE_SLIP_r_cut ))
-	     max_cut_non_bonded = data->TUNABLE_SLIP_r_cut;
-	 }
-#endif
+	 max_cut_tmp = calc_pair_cutoff(get_ia_param(i, j));
+	 if (max_cut_non_bonded < max_cut_tmp)
+	   max_cut_non_bonded = max_cut_tmp;
        }
      }
 
@@ -1123,6 +1146,108 @@ if(max_cut_bonded > 0)
   if ( max_cut_non_bonded > max_cut) max_cut = max_cut_non_bonded;
 }
 
+/** the non bonded potentials switched on for a type pair, see \ref
+    IA_parameters::nb_potentials. */
+static int calc_nb_potentials(IA_parameters *data)
+{
+  int pot = 0;
+
+#ifdef LENNARD_JONES
+  if (data->LJ_cut != 0) pot |= NB_POT_LJ;
+#endif
+#ifdef LENNARD_JONES_GENERIC
+  if (data->LJGEN_cut != 0) pot |= NB_POT_LJGEN;
+#endif
+#ifdef LJ_ANGLE
+  if (data->LJANGLE_cut != 0) pot |= NB_POT_LJANGLE;
+#endif
+#ifdef SMOOTH_STEP
+  if (data->SmSt_cut != 0) pot |= NB_POT_SMOOTH_STEP;
+#endif
+#ifdef HERTZIAN
+  if (data->Hertzian_sig != 0) pot |= NB_POT_HERTZIAN;
+#endif
+#ifdef BMHTF_NACL
+  if (data->BMHTF_cut != 0) pot |= NB_POT_BMHTF;
+#endif
+#ifdef BUCKINGHAM
+  if (data->BUCK_cut != 0) pot |= NB_POT_BUCKINGHAM;
+#endif
+#ifdef MORSE
+  if (data->MORSE_cut != 0) pot |= NB_POT_MORSE;
+#endif
+#ifdef SOFT_SPHERE
+  if (data->soft_cut != 0) pot |= NB_POT_SOFT_SPHERE;
+#endif
+#ifdef LJCOS
+  if (data->LJCOS_cut != 0) pot |= NB_POT_LJCOS;
+#endif
+#ifdef LJCOS2
+  if (data->LJCOS2_cut != 0) pot |= NB_POT_LJCOS2;
+#endif
+#ifdef TABULATED
+  if (data->TAB_maxval != 0) pot |= NB_POT_TABULATED;
+#endif
+#ifdef GAY_BERNE
+  if (data->GB_cut != 0) pot |= NB_POT_GAY_BERNE;
+#endif
+#ifdef INTER_RF
+  if (data->rf_on == 1) pot |= NB_POT_INTER_RF;
+#endif
+#ifdef ADRESS
+#ifdef INTERFACE_CORRECTION
+  if (data->ADRESS_TAB_maxval != 0) pot |= NB_POT_ADRESS_TAB;
+#endif
+#endif
+
+  return pot;
+}
+
+void calc_nb_kernels()
+{
+  int i, j, all_pairs = 0;
+  double cut;
+  IA_parameters *data;
+
+  /* methods that act on all particle pairs, independent of the types */
+#ifdef ELECTROSTATICS
+  if (coulomb.method != COULOMB_NONE) all_pairs = 1;
+#endif
+#ifdef MAGNETOSTATICS
+  if (coulomb.Dmethod != DIPOLAR_NONE) all_pairs = 1;
+#endif
+#ifdef MOL_CUT
+  /* the range depends on the molecules */
+  all_pairs = 1;
+#endif
+
+  nb_potentials_used = 0;
+  for (i = 0; i < n_particle_types; i++)
+    for (j = 0; j < n_particle_types; j++) {
+      data = get_ia_param(i, j);
+
+      data->nb_potentials = calc_nb_potentials(data);
+      nb_potentials_used |= data->nb_potentials;
+      if (data->nb_potentials == 0)
+	data->nb_kernel = NB_KERNEL_NONE;
+      else if (data->nb_potentials == NB_POT_LJ)
+	data->nb_kernel = NB_KERNEL_LJ;
+      else
+	data->nb_kernel = NB_KERNEL_GENERIC;
+
+      if (all_pairs)
+	data->nb_range2 = max_range_non_bonded2;
+      else if (checkIfInteraction(data)) {
+	cut = calc_pair_cutoff(data);
+	if (skin > 0.0)
+	  cut += skin;
+	data->nb_range2 = dmin(SQR(cut), max_range_non_bonded2);
+      }
+      else
+	data->nb_range2 = -1.0;
+    }
+}
+
 int check_obs_calc_initialized()
 {
   /* set to zero if initialization was not successful. */
@@ -172,6 +172,42 @@
 #define CONSTRAINT_PLANE 9
 /*@}*/
 
+/** \name Non bonded potentials
+    Bits of \ref IA_parameters::nb_potentials, one for each potential
+    evaluated in \ref calc_non_bonded_pair_force_parts.
+*/
+/************************************************************/
+/*@{*/
+#define NB_POT_LJ          (1<<0)
+#define NB_POT_LJGEN       (1<<1)
+#define NB_POT_LJANGLE     (1<<2)
+#define NB_POT_SMOOTH_STEP (1<<3)
+#define NB_POT_HERTZIAN    (1<<4)
+#define NB_POT_BMHTF       (1<<5)
+#define NB_POT_BUCKINGHAM  (1<<6)
+#define NB_POT_MORSE       (1<<7)
+#define NB_POT_SOFT_SPHERE (1<<8)
+#define NB_POT_LJCOS       (1<<9)
+#define NB_POT_LJCOS2      (1<<10)
+#define NB_POT_TABULATED   (1<<11)
+#define NB_POT_GAY_BERNE   (1<<12)
+#define NB_POT_INTER_RF    (1<<13)
+#define NB_POT_ADRESS_TAB  (1<<14)
+/*@}*/
+
+/** \name Non bonded force kernels
+    Values of \ref IA_parameters::nb_kernel.
+*/
+/************************************************************/
+/*@{*/
+/** no potential between the two types */
+#define NB_KERNEL_NONE    0
+/** plain Lennard-Jones only */
+#define NB_KERNEL_LJ      1
+/** all potentials in \ref IA_parameters::nb_potentials */
+#define NB_KERNEL_GENERIC 2
+/*@}*/
+
 /* Data Types */
 /************************************************************/
 
@@ -428,6 +464,17 @@ typedef struct {
   double TUNABLE_SLIP_vz;
 #endif
 
+  /** \name Force kernel of the type pair, set by \ref calc_nb_kernels */
+  /*@{*/
+  /** the potentials that are switched on, combination of NB_POT_* */
+  int nb_potentials;
+  /** the force kernel, one of NB_KERNEL_* */
+  int nb_kernel;
+  /** squared Verlet range for this type pair, negative if particles of
+      these types never interact */
+  double nb_range2;
+  /*@}*/
+
 } IA_parameters;
 
 /** thermodynamic force parameters */
@@ -776,6 +823,9 @@ extern DoubleList thermodynamic_f_energies;
 extern double max_cut;
 /** Maximal interaction cutoff (real space/short range non-bonded interactions). */
 extern double max_cut_non_bonded;
+/** All non bonded potentials used by any pair of types, combination
+    of NB_POT_*. Set by \ref calc_nb_kernels. */
+extern int nb_potentials_used;
 
 /** For the warmup you can cap the singularity of the Lennard-Jones
     potential at r=0. look into the warmup documentation for more
@@ -894,6 +944,14 @@ void realloc_tf_params(int nsize);
     verlet.h). */
 void calc_maximal_cutoff();
 
+/** determine for each pair of types which non bonded potentials are
+    switched on and the matching force kernel, and the squared Verlet
+    range of the pair. Pairs of types without potentials are dropped
+    from the Verlet lists unless a method like electrostatics acts on
+    all particle pairs. Called from \ref integrate_vv_recalc_maxrange,
+    i.e. whenever the interactions or the skin change. */
+void calc_nb_kernels();
+
 /** check whether all force calculation routines are properly initialized. */
 int check_obs_calc_initialized();
 
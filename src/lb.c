@@ -36,12 +36,14 @@
 #include "grid.h"
 #include "domain_decomposition.h"
 #include "interaction_data.h"
+#include "random.h"
 #include "thermostat.h"
 #include "lattice.h"
 #include "halo.h"
 #include "lb-d3q19.h"
 #include "lb-boundaries.h"
 #include "lb.h"
+#include "timers.h"
 
 #ifdef LB
 
@@ -1690,60 +1692,98 @@ MDINLINE void lb_relax_modes(index_t index, double *mode) {
 
 }
 
+/** draw the random numbers for the thermalization of the modes of
+    lattice site index. The counter based generator is keyed on the
+    global position of the site, so that the noise does not depend on
+    the node grid.
+    @param index    local index of the lattice site
+    @param gaussian draw Gaussian instead of uniform random numbers
+    @param rnd      the random numbers, in the order of the modes
+*/
+MDINLINE void lb_draw_fluct_noise(index_t index, int gaussian, double rnd[15]) {
+  int site = 0, block, n, x, y, z;
+
+  if (random_backend == RANDOM_BACKEND_PHILOX) {
+    x = index % lblattice.halo_grid[0];
+    y = (index / lblattice.halo_grid[0]) % lblattice.halo_grid[1];
+    z = index / (lblattice.halo_grid[0]*lblattice.halo_grid[1]);
+    x += node_pos[0]*lblattice.grid[0] - 1;
+    y += node_pos[1]*lblattice.grid[1] - 1;
+    z += node_pos[2]*lblattice.grid[2] - 1;
+    site = x + node_grid[0]*lblattice.grid[0]*(y + node_grid[1]*lblattice.grid[1]*z);
+  }
+
+#ifndef OLD_FLUCT
+  n = 15;
+#else
+  n = 6;
+#endif
+  for (block = 0; 4*block < n; block++) {
+    if (gaussian)
+      noise_gaussian(PHILOX_STREAM_LB_FLUID, site, block, imin(4, n - 4*block), rnd + 4*block);
+    else
+      noise_uniform(PHILOX_STREAM_LB_FLUID, site, block, imin(4, n - 4*block), rnd + 4*block);
+  }
+}
+
 MDINLINE void lb_thermalize_modes(index_t index, double *mode) {
-    double fluct[6];
+    double fluct[6], rnd[15];
 #ifdef GAUSSRANDOM
     double rootrho_gauss = sqrt(fabs(mode[0]+lbpar.rho*agrid*agrid*agrid));
 
+    lb_draw_fluct_noise(index, 1, rnd);
+
     /* stress modes */
-    mode[4] += (fluct[0] = rootrho_gauss*lb_phi[4]*gaussian_random());
-    mode[5] += (fluct[1] = rootrho_gauss*lb_phi[5]*gaussian_random());
-    mode[6] += (fluct[2] = rootrho_gauss*lb_phi[6]*gaussian_random());
-    mode[7] += (fluct[3] = rootrho_gauss*lb_phi[7]*gaussian_random());
-    mode[8] += (fluct[4] = rootrho_gauss*lb_phi[8]*gaussian_random());
-    mode[9] += (fluct[5] = rootrho_gauss*lb_phi[9]*gaussian_random());
+    mode[4] += (fluct[0] = rootrho_gauss*lb_phi[4]*rnd[0]);
+    mode[5] += (fluct[1] = rootrho_gauss*lb_phi[5]*rnd[1]);
+    mode[6] += (fluct[2] = rootrho_gauss*lb_phi[6]*rnd[2]);
+    mode[7] += (fluct[3] = rootrho_gauss*lb_phi[7]*rnd[3]);
+    mode[8] += (fluct[4] = rootrho_gauss*lb_phi[8]*rnd[4]);
+    mode[9] += (fluct[5] = rootrho_gauss*lb_phi[9]*rnd[5]);
     //if (index == lblattice.halo_offset) {
     //  fprintf(stderr,"%f %f %f %f %f %f\n",fluct[0],fluct[1],fluct[2],fluct[3],fluct[4],fluct[5]);
     //}
     
 #ifndef OLD_FLUCT
     /* ghost modes */
-    mode[10] += rootrho_gauss*lb_phi[10]*gaussian_random();
-    mode[11] += rootrho_gauss*lb_phi[11]*gaussian_random();
-    mode[12] += rootrho_gauss*lb_phi[12]*gaussian_random();
-    mode[13] += rootrho_gauss*lb_phi[13]*gaussian_random();
-    mode[14] += rootrho_gauss*lb_phi[14]*gaussian_random();
-    mode[15] += rootrho_gauss*lb_phi[15]*gaussian_random();
-    mode[16] += rootrho_gauss*lb_phi[16]*gaussian_random();
-    mode[17] += rootrho_gauss*lb_phi[17]*gaussian_random();
-    mode[18] += rootrho_gauss*lb_phi[18]*gaussian_random();
+    mode[10] += rootrho_gauss*lb_phi[10]*rnd[6];
+    mode[11] += rootrho_gauss*lb_phi[11]*rnd[7];
+    mode[12] += rootrho_gauss*lb_phi[12]*rnd[8];
+    mode[13] += rootrho_gauss*lb_phi[13]*rnd[9];
+    mode[14] += rootrho_gauss*lb_phi[14]*rnd[10];
+    mode[15] += rootrho_gauss*lb_phi[15]*rnd[11];
+    mode[16] += rootrho_gauss*lb_phi[16]*rnd[12];
+    mode[17] += rootrho_gauss*lb_phi[17]*rnd[13];
+    mode[18] += rootrho_gauss*lb_phi[18]*rnd[14];
 #endif
 
 #else
     double rootrho = sqrt(fabs(12.0*(mode[0]+lbpar.rho*agrid*agrid*agrid)));
 
+    lb_draw_fluct_noise(index, 0, rnd);
+
     /* stress modes */
-    mode[4] += (fluct[0] = rootrho*lb_phi[4]*(d_random()-0.5));
-    mode[5] += (fluct[1] = rootrho*lb_phi[5]*(d_random()-0.5));
-    mode[6] += (fluct[2] = rootrho*lb_phi[6]*(d_random()-0.5));
-    mode[7] += (fluct[3] = rootrho*lb_phi[7]*(d_random()-0.5));
-    mode[8] += (fluct[4] = rootrho*lb_phi[8]*(d_random()-0.5));
-    mode[9] += (fluct[5] = rootrho*lb_phi[9]*(d_random()-0.5));
+    mode[4] += (fluct[0] = rootrho*lb_phi[4]*rnd[0]);
+    mode[5] += (fluct[1] = rootrho*lb_phi[5]*rnd[1]);
+    mode[6] += (fluct[2] = rootrho*lb_phi[6]*rnd[2]);
+    mode[7] += (fluct[3] = rootrho*lb_phi[7]*rnd[3]);
+    mode[8] += (fluct[4] = rootrho*lb_phi[8]*rnd[4]);
+    mode[9] += (fluct[5] = rootrho*lb_phi[9]*rnd[5]);
     //if (index == lblattice.halo_offset) {
     //  fprintf(stderr,"%f %f %f %f %f %f\n",fluct[0],fluct[1],fluct[2],fluct[3],fluct[4],fluct[5]);
     //}
     
 #ifndef OLD_FLUCT
     /* ghost modes */
-    mode[10] += rootrho*lb_phi[10]*(d_random()-0.5);
-    mode[11] += rootrho*lb_phi[11]*(d_random()-0.5);
-    mode[12] += rootrho*lb_phi[12]*(d_random()-0.5);
-    mode[13] += rootrho*lb_phi[13]*(d_random()-0.5);
-    mode[14] += rootrho*lb_phi[14]*(d_random()-0.5);
-    mode[15] += rootrho*lb_phi[15]*(d_random()-0.5);
-    mode[16] += rootrho*lb_phi[16]*(d_random()-0.5);
-    mode[17] += rootrho*lb_phi[17]*(d_random()-0.5);
-    mode[18] += rootrho*lb_phi[18]*(d_random()-0.5);
+    mode[10] += rootrho*lb_phi[10]*rnd[6];
+    mode[11] += rootrho*lb_phi[11]*rnd[7];
+    mode[12] += rootrho*lb_phi[12]*rnd[8];
+    mode[13] += rootrho*lb_phi[13]*rnd[9];
+    mode[14] += rootrho*lb_phi[14]*rnd[10];
+    mode[15] += rootrho*lb_phi[15]*rnd[11];
+    mode[16] += rootrho*lb_phi[16]*rnd[12];
+    mode[17] += rootrho*lb_phi[17]*rnd[13];
+    mode[18] += rootrho*lb_phi[18]*rnd[14];
 #endif
 #endif//GAUSSRANDOM
 
@@ -2122,11 +2162,13 @@ void lattice_boltzmann_update() {
   if (fluidstep>=factor) {
     fluidstep=0;
 
+    timer_start(TIMER_LB);
 #ifdef PULL
     lb_stream_collide();
 #else 
     lb_collide_stream();
 #endif
+    timer_stop(TIMER_LB);
   }
   
 }
@@ -2317,7 +2359,7 @@ void calc_particle_lattice_ia() {
   int i, c, np;
   Cell *cell ;
   Particle *p ;
-  double force[3];
+  double force[3], rnd[3];
 
 
   if (transfer_momentum) {
@@ -2347,13 +2389,15 @@ void calc_particle_lattice_ia() {
       np = cell->n ;
       for (i=0;i<np;i++) {
 #ifdef GAUSSRANDOM
-	p[i].lc.f_random[0] = lb_coupl_pref2*gaussian_random();
-	p[i].lc.f_random[1] = lb_coupl_pref2*gaussian_random();
-	p[i].lc.f_random[2] = lb_coupl_pref2*gaussian_random();
+	noise_gaussian(PHILOX_STREAM_LB_COUPLING, p[i].p.identity, 0, 3, rnd);
+	p[i].lc.f_random[0] = lb_coupl_pref2*rnd[0];
+	p[i].lc.f_random[1] = lb_coupl_pref2*rnd[1];
+	p[i].lc.f_random[2] = lb_coupl_pref2*rnd[2];
 #else
-	p[i].lc.f_random[0] = lb_coupl_pref*(d_random()-0.5);
-	p[i].lc.f_random[1] = lb_coupl_pref*(d_random()-0.5);
-	p[i].lc.f_random[2] = lb_coupl_pref*(d_random()-0.5);
+	noise_uniform(PHILOX_STREAM_LB_COUPLING, p[i].p.identity, 0, 3, rnd);
+	p[i].lc.f_random[0] = lb_coupl_pref*rnd[0];
+	p[i].lc.f_random[1] = lb_coupl_pref*rnd[1];
+	p[i].lc.f_random[2] = lb_coupl_pref*rnd[2];
 #endif
 
 #ifdef ADDITIONAL_CHECKS
@@ -81,9 +81,11 @@ int mpifake_sendrecv(void *s, int scount, MPI_Datatype sdtype,
 #define MPI_LOR mpifake_copy
 #define MPI_SUM mpifake_copy
 #define MPI_MAX mpifake_copy
+#define MPI_MIN mpifake_copy
 #define MPI_COPY mpifake_copy
 
 #define MPI_STATUS_IGNORE NULL
+#define MPI_STATUSES_IGNORE NULL
 #define MPI_SUCCESS 1
 
 #define MPI_COMM_WORLD NULL
@@ -91,6 +93,10 @@ int mpifake_sendrecv(void *s, int scount, MPI_Datatype sdtype,
 #define MPI_REQUEST_NULL NULL
 
 #define MPI_IN_PLACE (void*)0x1
+#define MPI_BOTTOM (void*)0x0
+
+#define MPI_THREAD_SINGLE   0
+#define MPI_THREAD_FUNNELED 1
 
 extern struct mpifake_dtype mpifake_dtype_int;
 extern struct mpifake_dtype mpifake_dtype_double;
@@ -113,12 +119,14 @@ int MPI_Type_struct(int count, int *lengths, MPI_Aint *disps, MPI_Datatype *oldt
 int MPI_Type_contiguous(int count, MPI_Datatype oldtype, MPI_Datatype *newtype);
 int MPI_Type_vector(int count, int length, int stride, MPI_Datatype oldtype, MPI_Datatype *newtype);
 int MPI_Type_hvector(int count, int length, int stride, MPI_Datatype oldtype, MPI_Datatype *newtype);
+int MPI_Type_create_hindexed(int count, int *lengths, MPI_Aint *disps, MPI_Datatype oldtype, MPI_Datatype *newtype);
 
 MDINLINE int MPI_Init(int *a, char ***b) { return MPI_SUCCESS; }
+MDINLINE int MPI_Init_thread(int *a, char ***b, int required, int *provided) { *provided = required; return MPI_SUCCESS; }
 MDINLINE int MPI_Finalize(void) { return MPI_SUCCESS; }
 MDINLINE int MPI_Comm_size(MPI_Comm comm, int *psize) { *psize = 1; return MPI_SUCCESS; }
 MDINLINE int MPI_Comm_rank(MPI_Comm comm, int *rank) { *rank = 0; return MPI_SUCCESS; }
-MDINLINE int MPI_Comm_split(MPI_Comm comm, int colour, int key, MPI_Comm *newcomm) { return MPI_SUCCESS; }
+MDINLINE int MPI_Comm_split(MPI_Comm comm, int colour, int key, MPI_Comm *newcomm) { *newcomm = comm; return MPI_SUCCESS; }
 MDINLINE int MPI_Comm_free(MPI_Comm *comm) { return MPI_SUCCESS; }
 MDINLINE int MPI_Type_commit(MPI_Datatype *dtype) { return MPI_SUCCESS; }
 MDINLINE int MPI_Type_free(MPI_Datatype *dtype) { free(*dtype); *dtype = NULL; return MPI_SUCCESS; }
@@ -126,6 +134,10 @@ MDINLINE int MPI_Type_extent(MPI_Datatype dtype, MPI_Aint *pextent) { *pextent =
 MDINLINE int MPI_Barrier(MPI_Comm comm) { return MPI_SUCCESS; }
 MDINLINE int MPI_Waitall(int count, MPI_Request *reqs, MPI_Status *stats) { return MPI_SUCCESS; }
 MDINLINE int MPI_Wait(MPI_Request *reqs, MPI_Status *stats) { return MPI_SUCCESS; }
+MDINLINE int MPI_Testall(int count, MPI_Request *reqs, int *flag, MPI_Status *stats) { *flag = 1; return MPI_SUCCESS; }
+MDINLINE int MPI_Start(MPI_Request *req) { return MPI_SUCCESS; }
+MDINLINE int MPI_Request_free(MPI_Request *req) { *req = MPI_REQUEST_NULL; return MPI_SUCCESS; }
+MDINLINE int MPI_Get_address(void *location, MPI_Aint *address) { *address = (MPI_Aint)location; return MPI_SUCCESS; }
 MDINLINE int MPI_Errhandler_create(MPI_Handler_function *errfunc, MPI_Errhandler *errhdl) { return MPI_SUCCESS; }
 MDINLINE int MPI_Errhandler_set(MPI_Comm comm, MPI_Errhandler errhdl) { return MPI_SUCCESS; }
 MDINLINE int MPI_Bcast(void *buff, int count, MPI_Datatype datatype, int root, MPI_Comm comm) { return MPI_SUCCESS; }
@@ -143,6 +155,10 @@ MDINLINE int MPI_Sendrecv(void *sbuf, int scount, MPI_Datatype stype, int dst, i
 }
 MDINLINE int MPI_Isend(void *buf, int count, MPI_Datatype dtype, int dst, int tag, MPI_Comm comm, MPI_Request *req) {
   fprintf(stderr, "MPI_Recv on a single node\n"); errexit(); return MPI_SUCCESS; }
+MDINLINE int MPI_Send_init(void *buf, int count, MPI_Datatype dtype, int dst, int tag, MPI_Comm comm, MPI_Request *req) {
+  fprintf(stderr, "MPI_Send_init on a single node\n"); errexit(); return MPI_SUCCESS; }
+MDINLINE int MPI_Recv_init(void *buf, int count, MPI_Datatype dtype, int src, int tag, MPI_Comm comm, MPI_Request *req) {
+  fprintf(stderr, "MPI_Recv_init on a single node\n"); errexit(); return MPI_SUCCESS; }
 
 #else
 
@@ -155,6 +171,8 @@ MDINLINE int __MPI_ERR(char *func, char *file, int line) {
 #define MPI_Irecv(buf, count, dtype, src, tag, comm, req) __MPI_ERR("MPI_IRecv", __FILE__, __LINE__)
 #define MPI_Send(buf, count, dtype, dst, tag, comm) __MPI_ERR("MPI_Send", __FILE__, __LINE__)
 #define MPI_Isend(buf, count, dtype, dst, tag, comm, req) __MPI_ERR("MPI_Isend", __FILE__, __LINE__)
+#define MPI_Send_init(buf, count, dtype, dst, tag, comm, req) __MPI_ERR("MPI_Send_init", __FILE__, __LINE__)
+#define MPI_Recv_init(buf, count, dtype, src, tag, comm, req) __MPI_ERR("MPI_Recv_init", __FILE__, __LINE__)
 #define MPI_Sendrecv(sbuf, scount, stype, dst, stag, rbuf, rcount, rtype, src, rtag, comm, stat) \
   __MPI_ERR("MPI_Sendrecv", __FILE__, __LINE__)
 
@@ -164,17 +182,41 @@ MDINLINE int MPI_Gather(void *sbuf, int scount, MPI_Datatype sdtype,
 			void *rbuf, int rcount, MPI_Datatype rdtype,
 			int root, MPI_Comm comm)
 { return mpifake_sendrecv(sbuf, scount, sdtype, rbuf, rcount, rdtype); }
+MDINLINE int MPI_Gatherv(void *sbuf, int scount, MPI_Datatype sdtype,
+			 void *rbuf, int *rcounts, int *displs, MPI_Datatype rdtype,
+			 int root, MPI_Comm comm)
+{ return mpifake_sendrecv(sbuf, scount, sdtype, (char *)rbuf + displs[0]*(rdtype->upper - rdtype->lower),
+			  rcounts[0], rdtype); }
 MDINLINE int MPI_Allgather(void *sbuf, int scount, MPI_Datatype sdtype,
 			   void *rbuf, int rcount, MPI_Datatype rdtype,
 			   MPI_Comm comm)
 { return mpifake_sendrecv(sbuf, scount, sdtype, rbuf, rcount, rdtype); }
+MDINLINE int MPI_Allgatherv(void *sbuf, int scount, MPI_Datatype sdtype,
+			    void *rbuf, int *rcounts, int *displs, MPI_Datatype rdtype,
+			    MPI_Comm comm)
+{ return mpifake_sendrecv(sbuf, scount, sdtype, (char *)rbuf + displs[0]*(rdtype->upper - rdtype->lower),
+			  rcounts[0], rdtype); }
 MDINLINE int MPI_Scatter(void *sbuf, int scount, MPI_Datatype sdtype,
 			 void *rbuf, int rcount, MPI_Datatype rdtype,
 			 int root, MPI_Comm comm)
 { return mpifake_sendrecv(sbuf, scount, sdtype, rbuf, rcount, rdtype); }
+MDINLINE int MPI_Scatterv(void *sbuf, int *scounts, int *displs, MPI_Datatype sdtype,
+			  void *rbuf, int rcount, MPI_Datatype rdtype,
+			  int root, MPI_Comm comm)
+{ if (rbuf == MPI_IN_PLACE)
+    return MPI_SUCCESS;
+  return mpifake_sendrecv((char *)sbuf + displs[0]*(sdtype->upper - sdtype->lower), scounts[0], sdtype,
+			  rbuf, rcount, rdtype); }
+MDINLINE int MPI_Alltoallv(void *sbuf, int *scounts, int *sdispls, MPI_Datatype sdtype,
+			    void *rbuf, int *rcounts, int *rdispls, MPI_Datatype rdtype,
+			    MPI_Comm comm)
+{ return mpifake_sendrecv((char *)sbuf + sdispls[0]*(sdtype->upper - sdtype->lower), scounts[0], sdtype,
+			  (char *)rbuf + rdispls[0]*(rdtype->upper - rdtype->lower), rcounts[0], rdtype); }
 MDINLINE int MPI_Op_create(MPI_User_function func, int commute, MPI_Op *pop) { *pop = func; return MPI_SUCCESS; }
 MDINLINE int MPI_Reduce(void *sbuf, void* rbuf, int count, MPI_Datatype dtype, MPI_Op op, int root, MPI_Comm comm)
-{ op(sbuf, rbuf, &count, &dtype); return MPI_SUCCESS; }
+{ if(sbuf == MPI_IN_PLACE)
+    return MPI_SUCCESS;
+  op(sbuf, rbuf, &count, &dtype); return MPI_SUCCESS; }
 MDINLINE int MPI_Allreduce(void *sbuf, void *rbuf, int count, MPI_Datatype dtype, MPI_Op op, MPI_Comm comm)
 { if(sbuf == MPI_IN_PLACE)
     return MPI_SUCCESS; 
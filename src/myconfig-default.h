@@ -31,6 +31,7 @@
 #define COMFORCE
 #define COMFIXED
 #define NPT
+#define TIMERS
 
 /* potentials */
 #define TABULATED
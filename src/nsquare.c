@@ -32,6 +32,7 @@
 #include "pressure.h"
 #include "energy.h"
 #include "constraint.h"
+#include "soa.h"
 
 Cell *local;
 CellPList me_do_ghosts;
@@ -282,6 +283,55 @@ void nsq_calculate_ia()
   }
 }
 
+void nsq_calculate_ia_soa()
+{
+  Particle *partl, *partg;
+  CellSoA *sl, *sg;
+  int p, p2, npl, npg, c;
+  double d[3], pos1[3], pos2[3], dist2;
+
+  npl   = local->n;
+  partl = local->part;
+  sl    = cell_soa(local);
+
+  /* calculate bonded interactions and non bonded node-node */
+  for (p = 0; p < npl; p++) {
+    add_bonded_force(&partl[p]);
+#ifdef CONSTRAINTS
+    add_constraints_forces(&partl[p]);
+#endif
+    pos1[0] = sl->x[p]; pos1[1] = sl->y[p]; pos1[2] = sl->z[p];
+
+    /* other particles, same node */
+    for (p2 = p + 1; p2 < npl; p2++) {
+      pos2[0] = sl->x[p2]; pos2[1] = sl->y[p2]; pos2[2] = sl->z[p2];
+      get_mi_vector(d, pos1, pos2);
+      dist2 = sqrlen(d);
+#ifdef EXCLUSIONS
+      if (sl->n_excl[p] == 0 || do_nonbonded(&partl[p], &partl[p2]))
+#endif
+	add_non_bonded_pair_force_soa(&partl[p], sl, p, &partl[p2], sl, p2, d, dist2);
+    }
+
+    /* calculate with my ghosts */
+    for (c = 0; c < me_do_ghosts.n; c++) {
+      npg   = me_do_ghosts.cell[c]->n;
+      partg = me_do_ghosts.cell[c]->part;
+      sg    = cell_soa(me_do_ghosts.cell[c]);
+
+      for (p2 = 0; p2 < npg; p2++) {
+	pos2[0] = sg->x[p2]; pos2[1] = sg->y[p2]; pos2[2] = sg->z[p2];
+	get_mi_vector(d, pos1, pos2);
+	dist2 = sqrlen(d);
+#ifdef EXCLUSIONS
+	if (sl->n_excl[p] == 0 || do_nonbonded(&partl[p], &partg[p2]))
+#endif
+	  add_non_bonded_pair_force_soa(&partl[p], sl, p, &partg[p2], sg, p2, d, dist2);
+      }
+    }
+  }
+}
+
 void nsq_calculate_energies()
 {
   Particle *partl, *partg;
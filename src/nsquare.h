@@ -73,6 +73,9 @@ void nsq_balance_particles();
 /** n^2 force calculation */
 void nsq_calculate_ia();
 
+/** n^2 force calculation on the cell mirrors, see \ref soa.h */
+void nsq_calculate_ia_soa();
+
 /** n^2 energy calculation */
 void nsq_calculate_energies();
 
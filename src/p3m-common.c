@@ -20,10 +20,20 @@
 */
 /** \file p3m-common.c P3M main file.
 */
+#include <mpi.h>
 #include "p3m-common.h"
+#include "communication.h"
+#include "grid.h"
+#include "fft.h"
 
 #if defined(P3M) || defined(DP3M)
 
+/* MPI tags for the mesh communications: */
+/** Tag for communication in p3m_calc_send_mesh() */
+#define REQ_P3M_INIT   200
+/** Tag for communication in p3m_gather_mesh_start() */
+#define REQ_P3M_GATHER 201
+
 /** Debug function printing p3m structures */
 void p3m_print_local_mesh(local_mesh l) 
 {
@@ -77,6 +87,220 @@ void add_block(double *in, double *out, int start[3], int size[3], int dim[3])
   }
 }
 
+void p3m_calc_local_mesh(local_mesh *lm, double ai[3], double mesh_off[3],
+			 double full_skin[3], int cao)
+{
+  int i;
+  int ind[3];
+
+  /* inner left down grid point (global index) */
+  for(i=0;i<3;i++) lm->in_ld[i] = (int)ceil(my_left[i]*ai[i]-mesh_off[i]);
+  /* inner up right grid point (global index) */
+  for(i=0;i<3;i++) lm->in_ur[i] = (int)floor(my_right[i]*ai[i]-mesh_off[i]);
+  
+  /* correct roundof errors at boundary */
+  for(i=0;i<3;i++) {
+    if((my_right[i]*ai[i]-mesh_off[i])-lm->in_ur[i]<ROUND_ERROR_PREC) lm->in_ur[i]--;
+    if(1.0+(my_left[i]*ai[i]-mesh_off[i])-lm->in_ld[i]<ROUND_ERROR_PREC) lm->in_ld[i]--;
+  }
+  /* inner grid dimensions */
+  for(i=0;i<3;i++) lm->inner[i] = lm->in_ur[i] - lm->in_ld[i] + 1;
+  /* index of left down grid point in global mesh */
+  for(i=0;i<3;i++) 
+    lm->ld_ind[i]=(int)ceil((my_left[i]-full_skin[i])*ai[i]-mesh_off[i]);
+  /* spacial position of left down mesh point */
+  p3m_calc_lm_ld_pos(lm, ai, mesh_off);
+  /* left down margin */
+  for(i=0;i<3;i++) lm->margin[i*2] = lm->in_ld[i]-lm->ld_ind[i];
+  /* up right grid point */
+  for(i=0;i<3;i++) ind[i]=(int)floor((my_right[i]+full_skin[i])*ai[i]-mesh_off[i]);
+  /* correct roundof errors at up right boundary */
+  for(i=0;i<3;i++)
+    if(((my_right[i]+full_skin[i])*ai[i]-mesh_off[i])-ind[i]==0) ind[i]--;
+  /* up right margin */
+  for(i=0;i<3;i++) lm->margin[(i*2)+1] = ind[i] - lm->in_ur[i];
+
+  /* grid dimension */
+  lm->size=1; 
+  for(i=0;i<3;i++) {lm->dim[i] = ind[i] - lm->ld_ind[i] + 1; lm->size*=lm->dim[i];}
+  /* reduce inner grid indices from global to local */
+  for(i=0;i<3;i++) lm->in_ld[i] = lm->margin[i*2];
+  for(i=0;i<3;i++) lm->in_ur[i] = lm->margin[i*2]+lm->inner[i];
+
+  lm->q_2_off  = lm->dim[2] - cao;
+  lm->q_21_off = lm->dim[2] * (lm->dim[1] - cao);
+}
+
+void p3m_calc_lm_ld_pos(local_mesh *lm, double ai[3], double mesh_off[3])
+{
+  int i; 
+  for(i=0;i<3;i++)
+    lm->ld_pos[i] = (lm->ld_ind[i]+ mesh_off[i])*(1.0/ai[i]);
+}
+
+void p3m_calc_send_mesh(send_mesh *sm, local_mesh *lm)
+{
+  int i,j,evenodd;
+  int done[3]={0,0,0};
+  MPI_Status status;
+  /* send grids */
+  for(i=0;i<3;i++) {
+    for(j=0;j<3;j++) {
+      /* left */
+      sm->s_ld[i*2][j] = 0 + done[j]*lm->margin[j*2];
+      if(j==i) sm->s_ur[i*2][j] = lm->margin[j*2]; 
+      else     sm->s_ur[i*2][j] = lm->dim[j]-done[j]*lm->margin[(j*2)+1];
+      /* right */
+      if(j==i) sm->s_ld[(i*2)+1][j] = lm->in_ur[j];
+      else     sm->s_ld[(i*2)+1][j] = 0 + done[j]*lm->margin[j*2];
+      sm->s_ur[(i*2)+1][j] = lm->dim[j] - done[j]*lm->margin[(j*2)+1];
+    }   
+    done[i]=1;
+  }
+  sm->max=0;
+  for(i=0;i<6;i++) {
+    sm->s_size[i] = 1;
+    for(j=0;j<3;j++) {
+      sm->s_dim[i][j] = sm->s_ur[i][j]-sm->s_ld[i][j];
+      sm->s_size[i] *= sm->s_dim[i][j];
+    }
+    if(sm->s_size[i]>sm->max) sm->max=sm->s_size[i];
+  }
+  /* communication */
+  for(i=0;i<6;i++) {
+    if(i%2==0) j = i+1;
+    else       j = i-1;
+    if(node_neighbors[i] != this_node) {
+      /* two step communication: first all even positions than all odd */
+      for(evenodd=0; evenodd<2;evenodd++) {
+	if((node_pos[i/2]+evenodd)%2==0)
+	  MPI_Send(&(lm->margin[i]), 1, MPI_INT, 
+		   node_neighbors[i],REQ_P3M_INIT,MPI_COMM_WORLD);
+	else
+	  MPI_Recv(&(lm->r_margin[j]), 1, MPI_INT,
+		   node_neighbors[j],REQ_P3M_INIT,MPI_COMM_WORLD,&status);    
+      }
+    }
+    else {
+      lm->r_margin[j] = lm->margin[i];
+    }
+  }
+  /* recv grids */
+  for(i=0;i<3;i++) 
+    for(j=0;j<3;j++) {
+      if(j==i) {
+	sm->r_ld[ i*2   ][j] = sm->s_ld[ i*2   ][j] + lm->margin[2*j];
+	sm->r_ur[ i*2   ][j] = sm->s_ur[ i*2   ][j] + lm->r_margin[2*j];
+	sm->r_ld[(i*2)+1][j] = sm->s_ld[(i*2)+1][j] - lm->r_margin[(2*j)+1];
+	sm->r_ur[(i*2)+1][j] = sm->s_ur[(i*2)+1][j] - lm->margin[(2*j)+1];
+      }
+      else {
+	sm->r_ld[ i*2   ][j] = sm->s_ld[ i*2   ][j];
+	sm->r_ur[ i*2   ][j] = sm->s_ur[ i*2   ][j];
+	sm->r_ld[(i*2)+1][j] = sm->s_ld[(i*2)+1][j];
+	sm->r_ur[(i*2)+1][j] = sm->s_ur[(i*2)+1][j];
+      }
+    }
+  for(i=0;i<6;i++) {
+    sm->r_size[i] = 1;
+    for(j=0;j<3;j++) {
+      sm->r_dim[i][j] = sm->r_ur[i][j]-sm->r_ld[i][j];
+      sm->r_size[i] *= sm->r_dim[i][j];
+    }
+    if(sm->r_size[i]>sm->max) sm->max=sm->r_size[i];
+  }
+}
+
+void p3m_gather_mesh(double *themesh, local_mesh *lm, send_mesh *sm,
+		     double *send_grid, double *recv_grid)
+{
+  mesh_gather mg;
+
+  p3m_gather_mesh_start(&mg, themesh, lm, sm, send_grid, recv_grid);
+  p3m_gather_mesh_wait(&mg);
+}
+
+/** add the received block of the direction in flight of mg. */
+static void finish_gather_dir(mesh_gather *mg)
+{
+  int r_dir = (mg->s_dir%2==0) ? mg->s_dir+1 : mg->s_dir-1;
+
+  if(mg->sm->r_size[r_dir]>0)
+    add_block(mg->recv_grid, mg->themesh, mg->sm->r_ld[r_dir], mg->sm->r_dim[r_dir], mg->lm->dim);
+}
+
+/** post the next directions of mg, until one actually has to wait
+    for a neighbor. Directions without a neighbor are done
+    immediately. */
+static void post_gather_dir(mesh_gather *mg)
+{
+  int s_dir,r_dir;
+  send_mesh *sm = mg->sm;
+  double *tmp_ptr;
+
+  for(; mg->s_dir<6; mg->s_dir++) {
+    s_dir = mg->s_dir;
+    if(s_dir%2==0) r_dir = s_dir+1;
+    else           r_dir = s_dir-1;
+    /* pack send block */ 
+    if(sm->s_size[s_dir]>0) 
+      pack_block(mg->themesh, mg->send_grid, sm->s_ld[s_dir], sm->s_dim[s_dir], mg->lm->dim, 1);
+
+    /* communication */
+    if(node_neighbors[s_dir] != this_node) {
+      mg->request[0] = mg->request[1] = MPI_REQUEST_NULL;
+      if(sm->r_size[r_dir]>0) 
+	MPI_Irecv(mg->recv_grid, sm->r_size[r_dir], MPI_DOUBLE, 
+		  node_neighbors[r_dir], REQ_P3M_GATHER, MPI_COMM_WORLD, &mg->request[0]);
+      if(sm->s_size[s_dir]>0) 
+	MPI_Isend(mg->send_grid, sm->s_size[s_dir], MPI_DOUBLE, 
+		  node_neighbors[s_dir], REQ_P3M_GATHER, MPI_COMM_WORLD, &mg->request[1]);
+      return;
+    }
+    tmp_ptr = mg->recv_grid;
+    mg->recv_grid = mg->send_grid;
+    mg->send_grid = tmp_ptr;
+    finish_gather_dir(mg);
+  }
+}
+
+void p3m_gather_mesh_start(mesh_gather *mg, double *themesh, local_mesh *lm, send_mesh *sm,
+			   double *send_grid, double *recv_grid)
+{
+  mg->themesh   = themesh;
+  mg->lm        = lm;
+  mg->sm        = sm;
+  mg->send_grid = send_grid;
+  mg->recv_grid = recv_grid;
+  mg->s_dir     = 0;
+  post_gather_dir(mg);
+}
+
+int p3m_gather_mesh_progress(mesh_gather *mg)
+{
+  int flag;
+
+  if(mg->s_dir == 6)
+    return 1;
+  MPI_Testall(2, mg->request, &flag, MPI_STATUSES_IGNORE);
+  if(!flag)
+    return 0;
+  finish_gather_dir(mg);
+  mg->s_dir++;
+  post_gather_dir(mg);
+  return mg->s_dir == 6;
+}
+
+void p3m_gather_mesh_wait(mesh_gather *mg)
+{
+  while(mg->s_dir < 6) {
+    MPI_Waitall(2, mg->request, MPI_STATUSES_IGNORE);
+    finish_gather_dir(mg);
+    mg->s_dir++;
+    post_gather_dir(mg);
+  }
+}
+
 double analytic_cotangent_sum(int n, double mesh_i, int cao)
 {
   double c, res=0.0;
@@ -113,6 +337,32 @@ double analytic_cotangent_sum(int n, double mesh_i, int cao)
   return res;
 }
 
+/** The aliasing sum of U^2 n^2 used by the analytical
+    differentiation. Since sinc^2 times n^2 is (mesh/PI)^2 times sin^2,
+    which does not depend on the Brillouin zone, it reduces to the
+    cotangent sum of one order less. */
+double analytic_gradient_sum(int n, int mesh, int cao)
+{
+  return SQR(mesh*sin(PI*n/(double)mesh)/PI)*analytic_cotangent_sum(n, 1.0/mesh, cao-1);
+}
+
+/** The alternating aliasing sum of the interlaced mesh. Splitting
+    the sum into even and odd Brillouin zones gives two cotangent sums
+    on a mesh twice as coarse. */
+double analytic_alternating_sum(int n, int mesh, int cao)
+{
+  double x = PI*n/(2.0*mesh);
+  return pow(cos(x), 2*cao)*analytic_cotangent_sum(n, 0.5/mesh, cao)
+    - pow(sin(x), 2*cao)*analytic_cotangent_sum(n + mesh, 0.5/mesh, cao);
+}
+
+/** The alternating aliasing sum of U^2 n^2, which reduces to the
+    alternating sum of one order less as \ref analytic_gradient_sum. */
+double analytic_alternating_gradient_sum(int n, int mesh, int cao)
+{
+  return SQR(mesh*sin(PI*n/(double)mesh)/PI)*analytic_alternating_sum(n, mesh, cao-1);
+}
+
 /** Computes the  assignment function of for the \a i'th degree
     at value \a x. */
 double P3M_caf(int i, double x,int cao_value) {
@@ -192,6 +442,14 @@ double P3M_caf(int i, double x,int cao_value) {
   }}}
 }
 
+/** Computes the derivative of the assignment function for the \a
+    i'th degree at value \a x. The derivative of a cardinal B-spline
+    is the difference of two neighbouring ones of one order less. */
+double P3M_caf_d(int i, double x, int cao_value) {
+  return (i > 0 ? P3M_caf(i-1, x, cao_value-1) : 0.0)
+    - (i < cao_value-1 ? P3M_caf(i, x, cao_value-1) : 0.0);
+}
+
 /* double caf10(double x) */
 /* { double y; */
 /*    y = 1.0; */
@@ -49,6 +49,7 @@
  *  </ul>
  *
  */
+#include <mpi.h>
 #include "config.h"
 #include "utils.h"
 
@@ -118,6 +119,25 @@ typedef struct {
   int max;
 } send_mesh;
 
+/** State of a gather of the margins of a local mesh, see \ref
+    p3m_gather_mesh_start. */
+typedef struct {
+  /** the local mesh data. */
+  double *themesh;
+  /** the local mesh. */
+  local_mesh *lm;
+  /** its send/recv sub-meshes. */
+  send_mesh *sm;
+  /** send buffer of at least \ref send_mesh::max doubles. */
+  double *send_grid;
+  /** recv buffer of at least \ref send_mesh::max doubles. */
+  double *recv_grid;
+  /** the send direction in flight, 6 if the gather is complete. */
+  int s_dir;
+  /** recv and send request of the direction in flight. */
+  MPI_Request request[2];
+} mesh_gather;
+
 /** print local mesh content. 
     \param l local mesh structure.
 */
@@ -139,6 +159,58 @@ void p3m_print_send_mesh(send_mesh sm);
 */
 void add_block(double *in, double *out, int start[3], int size[3], int dim[3]);
 
+/** Calculate the local mesh of this node, i.e. the mesh points
+    inside the node domain plus the margins to which particles up to
+    full_skin outside the domain assign.
+    \param lm        the local mesh (output).
+    \param ai        the inverse mesh constants.
+    \param mesh_off  the mesh offset in mesh units.
+    \param full_skin the distance up to which particles outside the domain assign.
+    \param cao       the charge assignment order.
+*/
+void p3m_calc_local_mesh(local_mesh *lm, double ai[3], double mesh_off[3],
+			 double full_skin[3], int cao);
+
+/** Calculate the spacial position \ref local_mesh::ld_pos of the left
+    down mesh point of a local mesh, e.g. after the \ref box_l changed. */
+void p3m_calc_lm_ld_pos(local_mesh *lm, double ai[3], double mesh_off[3]);
+
+/** Calculate the properties of the send/recv sub-meshes of a local
+    mesh. In order to calculate the recv sub-meshes there is a
+    communication of the margins between neighbouring nodes. */
+void p3m_calc_send_mesh(send_mesh *sm, local_mesh *lm);
+
+/** Add the margins of a local mesh to the mesh points of the
+    neighbouring nodes, so that each node has the complete values of
+    the mesh points in its spatial domain.
+    \param themesh   the local mesh data.
+    \param lm        the local mesh.
+    \param sm        its send/recv sub-meshes.
+    \param send_grid buffer of at least \ref send_mesh::max doubles.
+    \param recv_grid buffer of at least \ref send_mesh::max doubles.
+*/
+void p3m_gather_mesh(double *themesh, local_mesh *lm, send_mesh *sm,
+		     double *send_grid, double *recv_grid);
+
+/** Start \ref p3m_gather_mesh without waiting for it. The six
+    directions are sent one after the other with nonblocking MPI
+    calls, since the corners are forwarded. The next direction is
+    started by \ref p3m_gather_mesh_progress or \ref
+    p3m_gather_mesh_wait, which has to be called in any case. The
+    mesh and the buffers must not be touched until the gather is
+    complete. The parameters are those of \ref p3m_gather_mesh. */
+void p3m_gather_mesh_start(mesh_gather *mg, double *themesh, local_mesh *lm, send_mesh *sm,
+			   double *send_grid, double *recv_grid);
+
+/** check whether the direction in flight of a gather has arrived,
+    and if so, add it and start the next direction. Call this
+    regularly while waiting for the gather.
+    @return 1 if the gather is complete. */
+int p3m_gather_mesh_progress(mesh_gather *mg);
+
+/** complete a gather started by \ref p3m_gather_mesh_start. */
+void p3m_gather_mesh_wait(mesh_gather *mg);
+
 /** One of the aliasing sums used by \ref P3M_k_space_error. 
     (fortunately the one which is most important (because it converges
     most slowly, since it is not damped exponentially)) can be
@@ -148,10 +220,32 @@ void add_block(double *in, double *out, int start[3], int size[3], int dim[3]);
     is Eqn. 7.66 in the book of Hockney and Eastwood). */
 double analytic_cotangent_sum(int n, double mesh_i, int cao);
 
+/** The aliasing sum over the squared charge assignment function in
+    Fourier space times \f$n^2\f$ in one dimension, as needed for the
+    optimal influence function of the analytical differentiation,
+    which reduces to \ref analytic_cotangent_sum of order \a cao-1. */
+double analytic_gradient_sum(int n, int mesh, int cao);
+
+/** The aliasing sum over the squared charge assignment function in
+    one dimension with alternating signs \f$(-1)^m\f$ over the
+    Brillouin zones \f$m\f$, as needed for the influence function of
+    the interlaced P3M, where the second mesh is shifted by half a
+    mesh constant. */
+double analytic_alternating_sum(int n, int mesh, int cao);
+
+/** The alternating counterpart of \ref analytic_gradient_sum for the
+    interlaced P3M with analytical differentiation. */
+double analytic_alternating_gradient_sum(int n, int mesh, int cao);
+
 /** Computes the  assignment function of for the \a i'th degree
     at value \a x. */
 double P3M_caf(int i, double x,int cao_value);
 
+/** Computes the derivative of the assignment function for the \a
+    i'th degree at value \a x, as needed for the analytical
+    differentiation. */
+double P3M_caf_d(int i, double x, int cao_value);
+
 /* These functions are used for calculation of a charge assignment function */
 /* double caf10(double x); */
 
@@ -345,7 +345,7 @@ double JJ_sumi2(double alpha_L){
 
 /* ====== Subroutines to compute analyticaly <Uk_p3m> and parse the output .============*/
 double P3M_Average_dipolar_SelfEnergy(double box_l, int mesh) {
-	int	i,ind,n[3];
+	int	i,ind,n[3],h = fft_ks_half_dir(Dfft_plan);
 	double node_phi = 0.0, phi = 0.0;
 	double U2;
 	
@@ -371,7 +371,8 @@ double P3M_Average_dipolar_SelfEnergy(double box_l, int mesh) {
 	  node_phi += 0.0;
 	else {
 		  U2 = perform_aliasing_sums_dipolar_self_energy(n);
-		  node_phi += Dg_energy[ind] * U2*(SQR(Dd_op[n[0]])+SQR(Dd_op[n[1]])+SQR(Dd_op[n[2]]));
+		  node_phi += fft_ks_weight(Dfft_plan, n[h]) *
+		    Dg_energy[ind] * U2*(SQR(Dd_op[n[0]])+SQR(Dd_op[n[1]])+SQR(Dd_op[n[2]]));
 	}
       }}}
   
@@ -1136,7 +1137,7 @@ static void DP3M_assign_forces_dip(double prefac, int d_rs)
 
 double P3M_calc_kspace_forces_for_dipoles(int force_flag, int energy_flag) 
 {
-  int i,d,d_rs,ind,j[3];
+  int i,d,d_rs,ind,j[3],h;
   /**************************************************************/
    /* k space energy */
   double dipole_prefac;
@@ -1172,12 +1173,14 @@ double P3M_calc_kspace_forces_for_dipoles(int force_flag, int energy_flag)
     P3M_TRACE(fprintf(stderr,"%d: dipolar p3m start Energy calculation: k-Space\n",this_node));
     
     /* i*k differentiation for dipolar gradients: |(\Fourier{\vect{mu}}(k)\cdot \vect{k})|^2 */
+    /* the k-space mesh is halved along h, see fft_ks_weight */
+    h = fft_ks_half_dir(Dfft_plan);
     ind=0;
     i=0;
     for(j[0]=0; j[0]<Dfft_plan[3].new_mesh[0]; j[0]++) {
       for(j[1]=0; j[1]<Dfft_plan[3].new_mesh[1]; j[1]++) {
 	for(j[2]=0; j[2]<Dfft_plan[3].new_mesh[2]; j[2]++) {
-	  node_k_space_energy_dip += Dg_energy[i] * (
+	  node_k_space_energy_dip += fft_ks_weight(Dfft_plan, j[h]+Dfft_plan[3].start[h]) * Dg_energy[i] * (
 	  SQR(Drs_mesh_dip[0][ind]*Dd_op[j[2]+Dfft_plan[3].start[2]]+
 	      Drs_mesh_dip[1][ind]*Dd_op[j[0]+Dfft_plan[3].start[0]]+
 	      Drs_mesh_dip[2][ind]*Dd_op[j[1]+Dfft_plan[3].start[1]]
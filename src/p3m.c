@@ -36,6 +36,7 @@
 #include "cells.h"
 #include "tuning.h"
 #include "elc.h"
+#include "timers.h"
 
 #ifdef P3M
 
@@ -46,16 +47,13 @@
 p3m_struct p3m = { 
   0.0, 0.0, 
   {0,0,0}, {P3M_MESHOFF, P3M_MESHOFF, P3M_MESHOFF}, 
-  0, P3M_N_INTERPOL, 0.0, P3M_EPSILON, 
+  0, P3M_N_INTERPOL, P3M_DIFF_IK, 0, 0.0, P3M_EPSILON, 
   {0.0,0.0,0.0}, {0.0,0.0,0.0}, {0.0,0.0,0.0}, 0.0, 0.0, 0, 0, {0, 0, 0},
 };
 
 
 /* MPI tags for the charge-charge p3m communications: */
-/** Tag for communication in P3M_init() -> send_calc_mesh(). */
-#define REQ_P3M_INIT   200
-/** Tag for communication in gather_fft_grid(). */
-#define REQ_P3M_GATHER 201
+/* (the tags 200 and 201 are used in p3m-common.c) */
 /** Tag for communication in spread_force_grid(). */
 #define REQ_P3M_SPREAD 202
 
@@ -74,6 +72,9 @@ p3m_struct p3m = {
 
 /** interpolation of the charge assignment function. */
 double *int_caf[7] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+/** interpolation of the derivative of the charge assignment function,
+    only for the analytical differentiation. */
+double *int_caf_d[7] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL};
 /** position shift for calc. of first assignment mesh point. */
 double pos_shift;
 /** help variable for calculation of aliasing sums */
@@ -91,11 +92,19 @@ double *g_energy = NULL;
 int ca_num=0;
 /** Charge fractions for mesh assignment. */
 double *ca_frac = NULL;
+/** Gradients of the charge fractions, three per fraction, only for
+    the analytical differentiation. */
+double *ca_fgrad = NULL;
 /** index of first mesh point for charge assignment. */
 int *ca_fmp = NULL;
 /** number of permutations in k_space */
 int ks_pnum;
 
+/** differentiation scheme fixed for the tuning, or -1 to try both. */
+static int p3m_tune_diff = -1;
+/** interlacing fixed for the tuning, or -1 to try both. */
+static int p3m_tune_interlace = -1;
+
 
 /** number of charged particles (only on master node). */
 int p3m_sum_qpart=0;
@@ -118,6 +127,13 @@ double *rs_mesh = NULL;
 /** k space mesh (local) for k space calculation and FFT.*/
 double *ks_mesh = NULL;
 
+/** real space mesh shifted by half a mesh constant and the charge
+    fractions on it, only for interlacing. */
+double *rs_mesh_il = NULL;
+double *ca_frac_il = NULL;
+double *ca_fgrad_il = NULL;
+int *ca_fmp_il = NULL;
+
 
 /** Field to store grid points to send. */
 double *send_grid = NULL; 
@@ -127,6 +143,15 @@ double *recv_grid = NULL;
 /** Allocation size of send_grid and recv_grid. */
 int send_recv_grid_size=0;
 
+/** the gather of the charge meshes started by \ref P3M_charge_assign_start. */
+static mesh_gather charge_gather;
+/** number of charge meshes gathered by \ref P3M_charge_assign_start,
+    0 if the k-space calculation gathers them itself. */
+static int charge_gather_n = 0;
+/** number of charge meshes that are gathered completely. */
+static int charge_gather_done = 0;
+int p3m_gather_pending = 0;
+
 
 /** \name Private Functions */
 /************************************************************/
@@ -172,6 +197,13 @@ void static calc_lm_ld_pos(void);
 /** Calculates the dipole term */
 double static calc_dipole_term(int force_flag, int energy_flag);
 
+/** Add the k-space contribution to the stress tensor on the master.
+ *  Works on the charge mesh after the forward FFT, i.e. has to be
+ *  called from \ref P3M_calc_kspace_forces_and_stress, which passes
+ *  its force prefactor.
+ */
+void static add_kspace_stress(double *stress, double force_prefac);
+
 /** Gather FFT grid.
  *  After the charge assignment Each node needs to gather the
  *  information for the FFT grid in his spatial domain.
@@ -188,6 +220,10 @@ void static spread_force_grid(double* mesh);
 /** realloc charge assignment fields. */
 void realloc_ca_fields(int newsize);
 
+/** Exchanges the charge assignment mesh and fractions with those of
+    the interlaced mesh. */
+void static swap_interlaced_mesh(void);
+
 /** checks for correctness for charges in P3M of the cao_cut, necessary when the box length changes */
 int P3M_sanity_checks_boxl(void);
 
@@ -218,7 +254,8 @@ void static calc_differential_operator(void);
  * (optimised for force calculations)
  *
  *  Each node calculates only the values for its domain in k-space
- *  (see fft_plan[3].mesh and fft_plan[3].start).
+ *  (see fft_plan[3].mesh and fft_plan[3].start), which is halved by the
+ *  real to complex FFT, see \ref fft_ks_half_dir.
  *
  *  See also: Hockney/Eastwood 8-22 (p275). Note the somewhat
  *  different convention for the prefactors, which is described in
@@ -241,7 +278,17 @@ void static calc_influence_function_energy(void);
  * \return denominator aliasing sum in the denominator
  */
 MDINLINE double perform_aliasing_sums_force(int n[3], double nominator[3]);
+/** Calculates the aliasing sums for the optimal influence function of
+    the analytical differentiation, see Ballenegger/Cerda/Holm, JCTC 8,
+    936 (2012). Returns the influence function up to the prefactor
+    2/PI. */
+MDINLINE double perform_aliasing_sums_force_ad(int n[3]);
 MDINLINE double perform_aliasing_sums_energy(int n[3]);
+/** Calculates the squared aliasing sum in the denominator of the
+    influence functions for interlacing, i.e. the mean of the squared
+    sum and the squared alternating sum of the shifted mesh, see
+    Neelov/Holm, JCP 132, 234103 (2010). */
+MDINLINE double perform_aliasing_sums_interlaced(int n[3]);
 
 int tclcommand_inter_coulomb_print_p3m_adaptive_tune_parameters(Tcl_Interp *interp);
 
@@ -273,9 +320,11 @@ double static P3M_real_space_error(double prefac, double r_cut_iL, int n_c_part,
     \param n_c_part number of charged particles in the system.
     \param sum_q2   sum of square of charges in the system
     \param alpha_L  rescaled ewald splitting parameter.
+    \param diff     differentiation scheme, see \ref P3M_DIFF.
+    \param interlace whether to use interlacing.
     \return reciprocal (k) space error
 */
-double static P3M_k_space_error(double prefac, int mesh[3], int cao, int n_c_part, double sum_q2, double alpha_L);
+double static P3M_k_space_error(double prefac, int mesh[3], int cao, int n_c_part, double sum_q2, double alpha_L, int diff, int interlace);
 
 
 
@@ -284,6 +333,11 @@ void static P3M_tune_aliasing_sums(int nx, int ny, int nz,
 			    int mesh[3], double mesh_i[3], int cao, double alpha_L_i, 
 			    double *alias1, double *alias2);
 
+/** aliasing sums used by \ref P3M_k_space_error for the analytical differentiation. */
+void static P3M_tune_aliasing_sums_ad(int nx, int ny, int nz, 
+			    int mesh[3], double mesh_i[3], int cao, double alpha_L_i, 
+			    double *alias1, double *alias2);
+
 void static p3m_set_tune_params(double r_cut, int mesh, int cao,
 			 double alpha, double accuracy, int n_interpol)
 {
@@ -380,6 +434,34 @@ int static p3m_set_eps(double eps)
 
 
 
+int static p3m_set_diff(int diff)
+{
+  if (diff != P3M_DIFF_IK && diff != P3M_DIFF_AD)
+    return TCL_ERROR;
+
+  p3m.diff = diff;
+
+  mpi_bcast_coulomb_params();
+
+  return TCL_OK;
+}
+
+
+
+int static p3m_set_interlace(int interlace)
+{
+  if (interlace != 0 && interlace != 1)
+    return TCL_ERROR;
+
+  p3m.interlace = interlace;
+
+  mpi_bcast_coulomb_params();
+
+  return TCL_OK;
+}
+
+
+
 int static p3m_set_ninterpol(int n)
 {
   if (n < 0)
@@ -397,7 +479,7 @@ int static p3m_set_ninterpol(int n)
 
 int tclcommand_inter_coulomb_parse_p3m_tune(Tcl_Interp * interp, int argc, char ** argv, int adaptive)
 {
-  int mesh = -1, cao = -1, n_interpol = -1;
+  int mesh = -1, cao = -1, n_interpol = -1, diff = -1, interlace = -1;
   double r_cut = -1, accuracy = -1;
 
   while(argc > 0) {
@@ -434,6 +516,22 @@ int tclcommand_inter_coulomb_parse_p3m_tune(Tcl_Interp * interp, int argc, char
 	Tcl_AppendResult(interp, "n_interpol expects an nonnegative integer", (char *) NULL);
 	return TCL_ERROR;
       }
+
+    } else if (ARG0_IS_S("diff")) {
+      if (argc > 1 && ARG1_IS_S("ik"))
+	diff = P3M_DIFF_IK;
+      else if (argc > 1 && ARG1_IS_S("ad"))
+	diff = P3M_DIFF_AD;
+      else {
+	Tcl_AppendResult(interp, "diff expects ik or ad", (char *) NULL);
+	return TCL_ERROR;
+      }
+
+    } else if (ARG0_IS_S("interlace")) {
+      if (! (argc > 1 && ARG1_IS_I(interlace) && interlace >= -1 && interlace <= 1)) {
+	Tcl_AppendResult(interp, "interlace expects 0 or 1", (char *) NULL);
+	return TCL_ERROR;
+      }
     }
     /* unknown parameter. Probably one of the optionals */
     else break;
@@ -442,6 +540,8 @@ int tclcommand_inter_coulomb_parse_p3m_tune(Tcl_Interp * interp, int argc, char
     argv += 2;
   }
   p3m_set_tune_params(r_cut, mesh, cao, -1.0, accuracy, n_interpol);
+  p3m_tune_diff = diff;
+  p3m_tune_interlace = interlace;
 
   /* check for optional parameters */
   if (argc > 0) {
@@ -584,6 +684,56 @@ int tclcommand_inter_coulomb_parse_p3m_opt_params(Tcl_Interp * interp, int argc,
       argv += 2;
     }
     
+    /* p3m parameter: diff */
+    else if (ARG0_IS_S("diff")) {
+
+      if(argc < 2) {
+	Tcl_AppendResult(interp, argv[0], " needs 1 parameter",
+			 (char *) NULL);
+	return TCL_ERROR;
+      }
+
+      if (ARG1_IS_S("ik"))
+	i = P3M_DIFF_IK;
+      else if (ARG1_IS_S("ad"))
+	i = P3M_DIFF_AD;
+      else {
+	Tcl_AppendResult(interp, argv[0], " needs ik or ad",
+			 (char *) NULL);
+	return TCL_ERROR;
+      }
+
+      p3m_set_diff(i);
+
+      argc -= 2;
+      argv += 2;
+    }
+
+    /* p3m parameter: interlace */
+    else if (ARG0_IS_S("interlace")) {
+
+      if(argc < 2) {
+	Tcl_AppendResult(interp, argv[0], " needs 1 parameter",
+			 (char *) NULL);
+	return TCL_ERROR;
+      }
+
+      if (! ARG1_IS_I(i)) {
+	Tcl_AppendResult(interp, argv[0], " needs 1 INTEGER parameter",
+			 (char *) NULL);
+	return TCL_ERROR;
+      }
+
+      if (p3m_set_interlace(i) == TCL_ERROR) {
+	Tcl_AppendResult(interp, argv[0], " argument must be 0 or 1",
+			 (char *) NULL);
+	return TCL_ERROR;
+      }
+
+      argc -= 2;
+      argv += 2;
+    }
+
     /* p3m parameter: mesh_off */
     else if (ARG0_IS_S("mesh_off")) {
       
@@ -673,6 +823,12 @@ void interpolate_charge_assignment_function()
     /* loop over all interpolation points */
     for (j=-p3m.inter; j<=p3m.inter; j++)
       int_caf[i][j+p3m.inter] = P3M_caf(i, j*dInterpol,p3m.cao);
+
+    if (p3m.diff == P3M_DIFF_AD) {
+      int_caf_d[i] = (double *) realloc(int_caf_d[i], sizeof(double)*(2*p3m.inter+1));
+      for (j=-p3m.inter; j<=p3m.inter; j++)
+	int_caf_d[i][j+p3m.inter] = P3M_caf_d(i, j*dInterpol, p3m.cao);
+    }
   }
   
 }
@@ -686,7 +842,7 @@ void P3M_charge_assign()
   /* charged particle counter, charge fraction counter */
   int cp_cnt=0;
   /* prepare local FFT mesh */
-  for(i=0; i<lm.size; i++) rs_mesh[i] = 0.0;
+  P3M_clear_charge_grid();
 
   for (c = 0; c < local_cells.n; c++) {
     cell = local_cells.cell[c];
@@ -704,9 +860,55 @@ void P3M_charge_assign()
   
 }
 
-void P3M_assign_charge(double q,
-		       double real_pos[3],
-		       int cp_cnt)
+void P3M_charge_assign_start()
+{
+  timer_start(TIMER_P3M_KSPACE);
+  P3M_charge_assign();
+  charge_gather_n = charge_gather_done = 0;
+  if (p3m_sum_q2 > 0) {
+    /* the interlaced mesh follows, since they share the buffers */
+    charge_gather_n = p3m.interlace ? 2 : 1;
+    p3m_gather_mesh_start(&charge_gather, rs_mesh, &lm, &sm, send_grid, recv_grid);
+    p3m_gather_pending = 1;
+    P3M_gather_progress();
+  }
+  timer_stop(TIMER_P3M_KSPACE);
+}
+
+int P3M_gather_progress()
+{
+  while (p3m_gather_pending) {
+    if (!p3m_gather_mesh_progress(&charge_gather))
+      return 0;
+    if (++charge_gather_done < charge_gather_n)
+      p3m_gather_mesh_start(&charge_gather, rs_mesh_il, &lm, &sm, send_grid, recv_grid);
+    else
+      p3m_gather_pending = 0;
+  }
+  return 1;
+}
+
+/** complete the gather started by \ref P3M_charge_assign_start, if any. */
+static void P3M_gather_wait()
+{
+  while (p3m_gather_pending) {
+    p3m_gather_mesh_wait(&charge_gather);
+    P3M_gather_progress();
+  }
+}
+
+void P3M_clear_charge_grid()
+{
+  int i;
+  for(i=0; i<lm.size; i++) rs_mesh[i] = 0.0;
+  if (p3m.interlace)
+    for(i=0; i<lm.size; i++) rs_mesh_il[i] = 0.0;
+}
+
+/* assign a single charge into the current mesh only */
+static void P3M_assign_charge_to_mesh(double q,
+				      double real_pos[3],
+				      int cp_cnt)
 {
   extern double P3M_caf(int i, double xc,int cao_value);
   extern void realloc_ca_fields(int size);
@@ -717,104 +919,106 @@ void P3M_assign_charge(double q,
   extern double pos_shift;
   extern double *rs_mesh;
 
-  int d, i0, i1, i2;
+  int d, i, i0, i1, i2;
   double tmp0, tmp1;
   /* position of a particle in local mesh units */
   double pos;
   /* 1d-index of nearest mesh point */
   int nmp;
   /* distance to nearest mesh point */
-  double dist[3];
+  double dist;
   /* index for caf interpolation grid */
-  int arg[3];
+  int arg;
+  /* charge assignment weights and their derivatives per direction */
+  double caf[3][7], caf_d[3][7];
   /* index, index jumps for rs_mesh array */
   int q_ind = 0;
-  double cur_ca_frac_val, *cur_ca_frac;
+  double cur_ca_frac_val, *cur_ca_frac, *cur_ca_fgrad = NULL;
+  /* whether to store the gradients of the charge fractions */
+  int ad = (p3m.diff == P3M_DIFF_AD && cp_cnt >= 0);
 
   // make sure we have enough space
   if (cp_cnt >= ca_num) realloc_ca_fields(cp_cnt + 1);
   // do it here, since realloc_ca_fields may change the address of ca_frac
   cur_ca_frac = ca_frac + p3m.cao3*cp_cnt;
+  if (ad) cur_ca_fgrad = ca_fgrad + 3*p3m.cao3*cp_cnt;
 
-  if (p3m.inter == 0) {
-    for(d=0;d<3;d++) {
-      /* particle position in mesh coordinates */
-      pos    = ((real_pos[d]-lm.ld_pos[d])*p3m.ai[d]) - pos_shift;
-      /* nearest mesh point */
-      nmp  = (int)pos;
+  for(d=0;d<3;d++) {
+    /* particle position in mesh coordinates */
+    pos    = ((real_pos[d]-lm.ld_pos[d])*p3m.ai[d]) - pos_shift;
+    /* nearest mesh point */
+    nmp  = (int)pos;
+    /* 3d-array index of nearest mesh point. For the first dimension,
+       q_ind is always zero, so this shifts correctly */
+    q_ind = nmp + lm.dim[d]*q_ind;
+
+    if (p3m.inter == 0) {
       /* distance to nearest mesh point */
-      dist[d] = (pos-nmp)-0.5;
-      /* 3d-array index of nearest mesh point */
-      q_ind = (d == 0) ? nmp : nmp + lm.dim[d]*q_ind;
-
-#ifdef ADDITIONAL_CHECKS
-      if( pos < -skin*p3m.ai[d] ) {
-	fprintf(stderr,"%d: rs_mesh underflow! (pos %f)\n", this_node, real_pos[d]);
-	fprintf(stderr,"%d: allowed coordinates: %f - %f\n",
-		this_node,my_left[d] - skin, my_right[d] + skin);	    
-      }
-      if( (nmp + p3m.cao) > lm.dim[d] ) {
-	fprintf(stderr,"%d: rs_mesh overflow! (pos %f, nmp=%d)\n", this_node, real_pos[d],nmp);
-	fprintf(stderr,"%d: allowed coordinates: %f - %f\n",
-		this_node, my_left[d] - skin, my_right[d] + skin);
+      dist = (pos-nmp)-0.5;
+      for(i=0; i<p3m.cao; i++) {
+	caf[d][i] = P3M_caf(i, dist, p3m.cao);
+	if (ad) caf_d[d][i] = p3m.ai[d]*P3M_caf_d(i, dist, p3m.cao);
       }
-#endif
     }
-    if (cp_cnt >= 0) ca_fmp[cp_cnt] = q_ind;
-    
-    for(i0=0; i0<p3m.cao; i0++) {
-      tmp0 = P3M_caf(i0, dist[0],p3m.cao);
-      for(i1=0; i1<p3m.cao; i1++) {
-	tmp1 = tmp0 * P3M_caf(i1, dist[1],p3m.cao);
-	for(i2=0; i2<p3m.cao; i2++) {
-	  cur_ca_frac_val = q * tmp1 * P3M_caf(i2, dist[2], p3m.cao);
-	  if (cp_cnt >= 0) *(cur_ca_frac++) = cur_ca_frac_val;
-	  rs_mesh[q_ind] += cur_ca_frac_val;
-	  q_ind++;
-	}
-	q_ind += lm.q_2_off;
+    else {
+      arg = (int) ((pos - nmp)*p3m.inter2);
+      for(i=0; i<p3m.cao; i++) {
+	caf[d][i] = int_caf[i][arg];
+	if (ad) caf_d[d][i] = p3m.ai[d]*int_caf_d[i][arg];
       }
-      q_ind += lm.q_21_off;
     }
-  }
-  else {
-    /* particle position in mesh coordinates */
-    for(d=0;d<3;d++) {
-      pos    = ((real_pos[d]-lm.ld_pos[d])*p3m.ai[d]) - pos_shift;
-      nmp    = (int) pos;
-      arg[d] = (int) ((pos - nmp)*p3m.inter2);
-      /* for the first dimension, q_ind is always zero, so this shifts correctly */
-      q_ind = nmp + lm.dim[d]*q_ind;
 
 #ifdef ADDITIONAL_CHECKS
-      if( pos < -skin*p3m.ai[d] ) {
-	fprintf(stderr,"%d: rs_mesh underflow! (pos %f)\n", this_node, real_pos[d]);
-	fprintf(stderr,"%d: allowed coordinates: %f - %f\n",
-		this_node,my_left[d] - skin, my_right[d] + skin);	    
-      }
-      if( (nmp + p3m.cao) > lm.dim[d] ) {
-	fprintf(stderr,"%d: rs_mesh overflow! (pos %f, nmp=%d)\n", this_node, real_pos[d],nmp);
-	fprintf(stderr,"%d: allowed coordinates: %f - %f\n",
-		this_node, my_left[d] - skin, my_right[d] + skin);
-      }
-#endif
+    if( pos < -skin*p3m.ai[d] ) {
+      fprintf(stderr,"%d: rs_mesh underflow! (pos %f)\n", this_node, real_pos[d]);
+      fprintf(stderr,"%d: allowed coordinates: %f - %f\n",
+	      this_node,my_left[d] - skin, my_right[d] + skin);	    
     }
-    if (cp_cnt >= 0) ca_fmp[cp_cnt] = q_ind;
-
-    for(i0=0; i0<p3m.cao; i0++) {
-      tmp0 = int_caf[i0][arg[0]];
-      for(i1=0; i1<p3m.cao; i1++) {
-	tmp1 = tmp0 * int_caf[i1][arg[1]];
-	for(i2=0; i2<p3m.cao; i2++) {
-	  cur_ca_frac_val = q * tmp1 * int_caf[i2][arg[2]];
-	  if (cp_cnt >= 0) *(cur_ca_frac++) = cur_ca_frac_val;
-	  rs_mesh[q_ind] += cur_ca_frac_val;
-	  q_ind++;
+    if( (nmp + p3m.cao) > lm.dim[d] ) {
+      fprintf(stderr,"%d: rs_mesh overflow! (pos %f, nmp=%d)\n", this_node, real_pos[d],nmp);
+      fprintf(stderr,"%d: allowed coordinates: %f - %f\n",
+	      this_node, my_left[d] - skin, my_right[d] + skin);
+    }
+#endif
+  }
+  if (cp_cnt >= 0) ca_fmp[cp_cnt] = q_ind;
+
+  for(i0=0; i0<p3m.cao; i0++) {
+    tmp0 = caf[0][i0];
+    for(i1=0; i1<p3m.cao; i1++) {
+      tmp1 = tmp0 * caf[1][i1];
+      for(i2=0; i2<p3m.cao; i2++) {
+	cur_ca_frac_val = q * tmp1 * caf[2][i2];
+	if (cp_cnt >= 0) *(cur_ca_frac++) = cur_ca_frac_val;
+	if (ad) {
+	  *(cur_ca_fgrad++) = q * caf_d[0][i0] * caf[1][i1]   * caf[2][i2];
+	  *(cur_ca_fgrad++) = q * tmp0         * caf_d[1][i1] * caf[2][i2];
+	  *(cur_ca_fgrad++) = q * tmp1                        * caf_d[2][i2];
 	}
-	q_ind += lm.q_2_off;
+	rs_mesh[q_ind] += cur_ca_frac_val;
+	q_ind++;
       }
-      q_ind += lm.q_21_off;
+      q_ind += lm.q_2_off;
     }
+    q_ind += lm.q_21_off;
+  }
+}
+
+void P3M_assign_charge(double q,
+		       double real_pos[3],
+		       int cp_cnt)
+{
+  int d;
+  double shifted_pos[3];
+
+  P3M_assign_charge_to_mesh(q, real_pos, cp_cnt);
+  if (p3m.interlace) {
+    /* moving the charge by half a mesh constant down is the same as
+       moving the mesh up */
+    for(d=0;d<3;d++) shifted_pos[d] = real_pos[d] - 0.5*p3m.a[d];
+    swap_interlaced_mesh();
+    P3M_assign_charge_to_mesh(q, shifted_pos, cp_cnt);
+    swap_interlaced_mesh();
   }
 }
 
@@ -868,28 +1072,70 @@ static void P3M_assign_forces(double force_prefac, int d_rs)
   }
 }
 
+/* assign the forces obtained from the k-space potential by
+   analytical differentiation of the charge assignment function */
+static void P3M_assign_forces_ad(double force_prefac)
+{
+  Cell *cell;
+  Particle *p;
+  int i,c,np,i0,i1,i2;
+  double phi;
+  /* charged particle counter, charge fraction gradient counter */
+  int cp_cnt=0, cg_cnt=0;
+  /* index, index jumps for rs_mesh array */
+  int q_ind;
+  int q_m_off = (lm.dim[2] - p3m.cao);
+  int q_s_off = lm.dim[2] * (lm.dim[1] - p3m.cao);
+
+  for (c = 0; c < local_cells.n; c++) {
+    cell = local_cells.cell[c];
+    p  = cell->part;
+    np = cell->n;
+    for(i=0; i<np; i++) { 
+      if( p[i].p.q != 0.0 ) {
+	q_ind = ca_fmp[cp_cnt];
+	for(i0=0; i0<p3m.cao; i0++) {
+	  for(i1=0; i1<p3m.cao; i1++) {
+	    for(i2=0; i2<p3m.cao; i2++) {
+	      phi = force_prefac*rs_mesh[q_ind++];
+	      p[i].f.f[0] -= phi*ca_fgrad[cg_cnt++];
+	      p[i].f.f[1] -= phi*ca_fgrad[cg_cnt++];
+	      p[i].f.f[2] -= phi*ca_fgrad[cg_cnt++];
+	    }
+	    q_ind += q_m_off;
+	  }
+	  q_ind += q_s_off;
+	}
+	cp_cnt++;
+
+	ONEPART_TRACE(if(p[i].p.identity==check_id) fprintf(stderr,"%d: OPT: P3M  f = (%.3e,%.3e,%.3e)\n",this_node,p[i].f.f[0],p[i].f.f[1],p[i].f.f[2]));
+      }
+    }
+  }
+}
+
 
 
 double P3M_calc_kspace_forces_for_charges(int force_flag, int energy_flag)
 {
-    int i,d,d_rs,ind,j[3];
-    /**************************************************************/
-    /* Prefactor for force */
-    double force_prefac;
+  return P3M_calc_kspace_forces_and_stress(force_flag, energy_flag, NULL);
+}
+
+/* the k-space forces, energy and stress from the current mesh only.
+   Returns the energy of this node. */
+static double P3M_calc_kspace_mesh(int force_flag, int energy_flag, double *stress, double force_prefac)
+{
+    int i,d,d_rs,ind,j[3],h;
     /* k space energy */
-    double k_space_energy=0.0, node_k_space_energy=0.0;
+    double node_k_space_energy=0.0;
     /* directions */
     double *d_operator = NULL;
 
-    P3M_TRACE(fprintf(stderr,"%d: p3m_perform: \n",this_node));
-//     fprintf(stderr, "calculating kspace forces\n");
-
-    force_prefac = coulomb.prefactor / ( 2 * box_l[0] * box_l[1] * box_l[2] );
-
     /* Gather information for FFT grid inside the nodes domain (inner local mesh) */
     /* and Perform forward 3D FFT (Charge Assignment Mesh). */
     if (p3m_sum_q2 > 0) {
-        gather_fft_grid(rs_mesh);
+        if (!charge_gather_n)
+            gather_fft_grid(rs_mesh);
         fft_perform_forw(rs_mesh);
     }
     //Note: after these calls, the grids are in the order yzx and not xyz anymore!!!
@@ -905,69 +1151,132 @@ double P3M_calc_kspace_forces_for_charges(int force_flag, int energy_flag)
         **********************/
 
 
-      for(i=0;i<fft_plan[3].new_size;i++) {
-        // Use the energy optimized influence function for energy!
-        node_k_space_energy += g_energy[i] * ( SQR(rs_mesh[2*i]) + SQR(rs_mesh[2*i+1]) );
+      /* the k-space mesh is halved along h, see fft_ks_weight */
+      h = fft_ks_half_dir(fft_plan);
+      i = 0;
+      for(j[0]=0; j[0]<fft_plan[3].new_mesh[0]; j[0]++) {
+        for(j[1]=0; j[1]<fft_plan[3].new_mesh[1]; j[1]++) {
+          for(j[2]=0; j[2]<fft_plan[3].new_mesh[2]; j[2]++) {
+            // Use the energy optimized influence function for energy!
+            node_k_space_energy += fft_ks_weight(fft_plan, j[h]+fft_plan[3].start[h])
+              * g_energy[i] * ( SQR(rs_mesh[2*i]) + SQR(rs_mesh[2*i+1]) );
+            i++;
+          }
+        }
       }
         node_k_space_energy *= force_prefac;
-
-        MPI_Reduce(&node_k_space_energy, &k_space_energy, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-        if(this_node==0) {
-            /* self energy correction */
-            k_space_energy -= coulomb.prefactor*(p3m_sum_q2 * p3m.alpha * wupii);
-            /* net charge correction */
-            k_space_energy -= coulomb.prefactor* p3m_square_sum_q * PI / (2.0*box_l[0]*box_l[1]*box_l[2]*SQR(p3m.alpha));
-        }
-
     } /* if (energy_flag) */
 
+    /* the stress from the same transformed mesh, before the force
+       components overwrite it */
+    if (stress && p3m_sum_q2 > 0)
+      add_kspace_stress(stress, force_prefac);
+
     /* === K Space Force Calculation  === */
     if(force_flag && p3m_sum_q2 > 0) {
        /***************************
         COULOMB FORCES (k-space)
         ****************************/
-        /* Force preparation */
-        ind = 0;
-        /* apply the influence function */
-        for(i=0; i<fft_plan[3].new_size; i++) {
-            ks_mesh[ind] = g_force[i] * rs_mesh[ind]; ind++;
-            ks_mesh[ind] = g_force[i] * rs_mesh[ind]; ind++;
-        } 
-
-        /* === 3 Fold backward 3D FFT (Force Component Meshs) === */
-
-        /* Force component loop */
-        for(d=0;d<3;d++) {
-            if (d == KX)
-                d_operator = d_op[RX];
-            else if (d == KY)
-                d_operator = d_op[RY];
-            else if (d == KZ)
-                d_operator = d_op[RZ];
-
-            /* direction in k space: */
-            d_rs = (d+ks_pnum)%3;
-            /* srqt(-1)*k differentiation */
-            ind=0;
-            for(j[0]=0; j[0]<fft_plan[3].new_mesh[0]; j[0]++) {
-                for(j[1]=0; j[1]<fft_plan[3].new_mesh[1]; j[1]++) {
-                    for(j[2]=0; j[2]<fft_plan[3].new_mesh[2]; j[2]++) {
-                        /* i*k*(Re+i*Im) = - Im*k + i*Re*k     (i=sqrt(-1)) */
-                        rs_mesh[ind] = -2.0*PI*(ks_mesh[ind+1] * d_operator[ j[d]+fft_plan[3].start[d] ])/box_l[d_rs]; ind++;
-                        rs_mesh[ind] =   2.0*PI*ks_mesh[ind-1] * d_operator[ j[d]+fft_plan[3].start[d] ]/box_l[d_rs];  ind++;
+        if (p3m.diff == P3M_DIFF_AD) {
+            /* apply the influence function, which gives the potential */
+            ind = 0;
+            for(i=0; i<fft_plan[3].new_size; i++) {
+                rs_mesh[ind] *= g_force[i]; ind++;
+                rs_mesh[ind] *= g_force[i]; ind++;
+            }
+
+            /* === Single backward 3D FFT (Potential Mesh) === */
+            fft_perform_back(rs_mesh);
+            spread_force_grid(rs_mesh);
+            /* Assign the gradient of the potential to the particles */
+            P3M_assign_forces_ad(force_prefac);
+        }
+        else {
+            /* Force preparation */
+            ind = 0;
+            /* apply the influence function */
+            for(i=0; i<fft_plan[3].new_size; i++) {
+                ks_mesh[ind] = g_force[i] * rs_mesh[ind]; ind++;
+                ks_mesh[ind] = g_force[i] * rs_mesh[ind]; ind++;
+            } 
+
+            /* === 3 Fold backward 3D FFT (Force Component Meshs) === */
+
+            /* Force component loop */
+            for(d=0;d<3;d++) {
+                if (d == KX)
+                    d_operator = d_op[RX];
+                else if (d == KY)
+                    d_operator = d_op[RY];
+                else if (d == KZ)
+                    d_operator = d_op[RZ];
+
+                /* direction in k space: */
+                d_rs = (d+ks_pnum)%3;
+                /* srqt(-1)*k differentiation */
+                ind=0;
+                for(j[0]=0; j[0]<fft_plan[3].new_mesh[0]; j[0]++) {
+                    for(j[1]=0; j[1]<fft_plan[3].new_mesh[1]; j[1]++) {
+                        for(j[2]=0; j[2]<fft_plan[3].new_mesh[2]; j[2]++) {
+                            /* i*k*(Re+i*Im) = - Im*k + i*Re*k     (i=sqrt(-1)) */
+                            rs_mesh[ind] = -2.0*PI*(ks_mesh[ind+1] * d_operator[ j[d]+fft_plan[3].start[d] ])/box_l[d_rs]; ind++;
+                            rs_mesh[ind] =   2.0*PI*ks_mesh[ind-1] * d_operator[ j[d]+fft_plan[3].start[d] ]/box_l[d_rs];  ind++;
+                        }
                     }
                 }
+                fft_perform_back(rs_mesh);              /* Back FFT force component mesh */
+                spread_force_grid(rs_mesh);             /* redistribute force component mesh */
+                P3M_assign_forces(force_prefac, d_rs);  /* Assign force component from mesh to particle */
             }
-            fft_perform_back(rs_mesh);              /* Back FFT force component mesh */
-            spread_force_grid(rs_mesh);             /* redistribute force component mesh */
-            P3M_assign_forces(force_prefac, d_rs);  /* Assign force component from mesh to particle */
         }
     } /* if(force_flag) */
 
+    return node_k_space_energy;
+}
+
+double P3M_calc_kspace_forces_and_stress(int force_flag, int energy_flag, double *stress)
+{
+    /* Prefactor for force */
+    double force_prefac;
+    /* k space energy */
+    double k_space_energy=0.0, node_k_space_energy;
+
+    P3M_TRACE(fprintf(stderr,"%d: p3m_perform: \n",this_node));
+
+    timer_start(TIMER_P3M_KSPACE);
+
+    force_prefac = coulomb.prefactor / ( 2 * box_l[0] * box_l[1] * box_l[2] );
+
+    P3M_gather_wait();
+
+    if (p3m.interlace) {
+        /* both meshes contribute half of the forces, energy and stress */
+        force_prefac *= 0.5;
+        node_k_space_energy = P3M_calc_kspace_mesh(force_flag, energy_flag, stress, force_prefac);
+        swap_interlaced_mesh();
+        node_k_space_energy += P3M_calc_kspace_mesh(force_flag, energy_flag, stress, force_prefac);
+        swap_interlaced_mesh();
+    }
+    else
+        node_k_space_energy = P3M_calc_kspace_mesh(force_flag, energy_flag, stress, force_prefac);
+    /* the next charge assignment is gathered here again */
+    charge_gather_n = 0;
+
+    if (energy_flag) {
+        MPI_Reduce(&node_k_space_energy, &k_space_energy, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        if(this_node==0) {
+            /* self energy correction */
+            k_space_energy -= coulomb.prefactor*(p3m_sum_q2 * p3m.alpha * wupii);
+            /* net charge correction */
+            k_space_energy -= coulomb.prefactor* p3m_square_sum_q * PI / (2.0*box_l[0]*box_l[1]*box_l[2]*SQR(p3m.alpha));
+        }
+    }
+
     if (p3m.epsilon != P3M_EPSILON_METALLIC) {
       k_space_energy += calc_dipole_term(force_flag, energy_flag);
     }
 
+    timer_stop(TIMER_P3M_KSPACE);
     return k_space_energy;
 }
 
@@ -1019,45 +1328,8 @@ double calc_dipole_term(int force_flag, int energy_flag)
 
 void gather_fft_grid(double* themesh)
 {
-  int s_dir,r_dir,evenodd;
-  MPI_Status status;
-  double *tmp_ptr;
-
   P3M_TRACE(fprintf(stderr,"%d: gather_fft_grid:\n",this_node));
-
-  /* direction loop */
-  for(s_dir=0; s_dir<6; s_dir++) {
-    if(s_dir%2==0) r_dir = s_dir+1;
-    else           r_dir = s_dir-1;
-    /* pack send block */ 
-    if(sm.s_size[s_dir]>0) 
-      pack_block(themesh, send_grid, sm.s_ld[s_dir], sm.s_dim[s_dir], lm.dim, 1);
-      
-    /* communication */
-    if(node_neighbors[s_dir] != this_node) {
-      for(evenodd=0; evenodd<2;evenodd++) {
-	if((node_pos[s_dir/2]+evenodd)%2==0) {
-	  if(sm.s_size[s_dir]>0) 
-	    MPI_Send(send_grid, sm.s_size[s_dir], MPI_DOUBLE, 
-		     node_neighbors[s_dir], REQ_P3M_GATHER, MPI_COMM_WORLD);
-	}
-	else {
-	  if(sm.r_size[r_dir]>0) 
-	    MPI_Recv(recv_grid, sm.r_size[r_dir], MPI_DOUBLE, 
-		     node_neighbors[r_dir], REQ_P3M_GATHER, MPI_COMM_WORLD, &status); 	    
-	}
-      }
-    }
-    else {
-      tmp_ptr = recv_grid;
-      recv_grid = send_grid;
-      send_grid = tmp_ptr;
-    }
-    /* add recv block */
-    if(sm.r_size[r_dir]>0) {
-      add_block(recv_grid, themesh, sm.r_ld[r_dir], sm.r_dim[r_dir], lm.dim); 
-    }
-  }
+  p3m_gather_mesh(themesh, &lm, &sm, send_grid, recv_grid);
 }
 
 
@@ -1113,9 +1385,28 @@ void realloc_ca_fields(int newsize)
   ca_num = newsize;
   ca_frac = (double *)realloc(ca_frac, p3m.cao3*ca_num*sizeof(double));
   ca_fmp  = (int *)realloc(ca_fmp, ca_num*sizeof(int));
+  if (p3m.diff == P3M_DIFF_AD)
+    ca_fgrad = (double *)realloc(ca_fgrad, 3*p3m.cao3*ca_num*sizeof(double));
+  if (p3m.interlace) {
+    ca_frac_il = (double *)realloc(ca_frac_il, p3m.cao3*ca_num*sizeof(double));
+    ca_fmp_il  = (int *)realloc(ca_fmp_il, ca_num*sizeof(int));
+    if (p3m.diff == P3M_DIFF_AD)
+      ca_fgrad_il = (double *)realloc(ca_fgrad_il, 3*p3m.cao3*ca_num*sizeof(double));
+  }
     
 } 
 
+void swap_interlaced_mesh(void)
+{
+  double *tmp;
+  int *tmp_fmp;
+
+  tmp = rs_mesh;  rs_mesh  = rs_mesh_il;  rs_mesh_il  = tmp;
+  tmp = ca_frac;  ca_frac  = ca_frac_il;  ca_frac_il  = tmp;
+  tmp = ca_fgrad; ca_fgrad = ca_fgrad_il; ca_fgrad_il = tmp;
+  tmp_fmp = ca_fmp; ca_fmp = ca_fmp_il; ca_fmp_il = tmp_fmp;
+}
+
 
 
 void calc_meshift(void)
@@ -1188,13 +1479,19 @@ void calc_influence_function_force()
                 if( (n[KX]%(p3m.mesh[RX]/2)==0) && (n[KY]%(p3m.mesh[RY]/2)==0) && (n[KZ]%(p3m.mesh[RZ]/2)==0) ) {
                     g_force[ind] = 0.0;
                 }
+                else if (p3m.diff == P3M_DIFF_AD) {
+                    g_force[ind] = 2*perform_aliasing_sums_force_ad(n)/PI;
+                }
                 else {
                     denominator = perform_aliasing_sums_force(n,nominator);
 
                     fak1 =  d_op[RX][n[KX]]*nominator[RX]/box_l[RX] + d_op[RY][n[KY]]*nominator[RY]/box_l[RY] + d_op[RZ][n[KZ]]*nominator[RZ]/box_l[RZ];
                     fak2 = SQR(d_op[RX][n[KX]]/box_l[RX])+SQR(d_op[RY][n[KY]]/box_l[RY])+SQR(d_op[RZ][n[KZ]]/box_l[RZ]);
 
-                    fak3 = fak1/(fak2 * SQR(denominator));
+                    if (p3m.interlace)
+                        fak3 = fak1/(fak2 * perform_aliasing_sums_interlaced(n));
+                    else
+                        fak3 = fak1/(fak2 * SQR(denominator));
                     g_force[ind] = 2*fak3/(PI);
                 }
             }
@@ -1241,6 +1538,57 @@ MDINLINE double perform_aliasing_sums_force(int n[3], double numerator[3])
     return denominator;
 }
 
+MDINLINE double perform_aliasing_sums_force_ad(int n[3])
+{
+    int d, nd[3];
+    double numerator = 0.0, denominator, gradient;
+    double cs[3], cs_d[3];
+    /* lots of temporary variables... */
+    double sx, sy, sz, f1, mx, my, mz, nmx, nmy, nmz, nm2, expo;
+    double limit = 30;
+
+    /* the sums over U^2 and U^2 k^2 converge slowly and are done analytically */
+    nd[RX] = n[KX]; nd[RY] = n[KY]; nd[RZ] = n[KZ];
+    for(d = 0; d < 3; d++) {
+        cs[d]   = analytic_cotangent_sum(nd[d], 1.0/p3m.mesh[d], p3m.cao);
+        cs_d[d] = analytic_gradient_sum(nd[d], p3m.mesh[d], p3m.cao)/SQR(box_l[d]);
+    }
+    denominator = cs[0]*cs[1]*cs[2];
+    gradient    = cs_d[0]*cs[1]*cs[2] + cs[0]*cs_d[1]*cs[2] + cs[0]*cs[1]*cs_d[2];
+    denominator *= gradient;
+    if (p3m.interlace) {
+        /* the mean with the alternating sums of the shifted mesh */
+        for(d = 0; d < 3; d++) {
+            cs[d]   = analytic_alternating_sum(nd[d], p3m.mesh[d], p3m.cao);
+            cs_d[d] = analytic_alternating_gradient_sum(nd[d], p3m.mesh[d], p3m.cao)/SQR(box_l[d]);
+        }
+        gradient = cs_d[0]*cs[1]*cs[2] + cs[0]*cs_d[1]*cs[2] + cs[0]*cs[1]*cs_d[2];
+        denominator = 0.5*(denominator + cs[0]*cs[1]*cs[2]*gradient);
+    }
+
+    f1 = SQR(PI/(p3m.alpha));
+
+    for(mx = -P3M_BRILLOUIN; mx <= P3M_BRILLOUIN; mx++) {
+        nmx = meshift_x[n[KX]] + p3m.mesh[RX]*mx;
+        sx  = pow(sinc(nmx/(double)p3m.mesh[RX]),2.0*p3m.cao);
+        for(my = -P3M_BRILLOUIN; my <= P3M_BRILLOUIN; my++) {
+            nmy = meshift_y[n[KY]] + p3m.mesh[RY]*my;
+            sy  = sx*pow(sinc(nmy/(double)p3m.mesh[RY]),2.0*p3m.cao);
+            for(mz = -P3M_BRILLOUIN; mz <= P3M_BRILLOUIN; mz++) {
+                nmz = meshift_z[n[KZ]] + p3m.mesh[RZ]*mz;
+                sz  = sy*pow(sinc(nmz/(double)p3m.mesh[RZ]),2.0*p3m.cao);
+
+                nm2          =  SQR(nmx/box_l[RX]) + SQR(nmy/box_l[RY]) + SQR(nmz/box_l[RZ]);
+                expo         =  f1*nm2;
+
+                if (expo < limit)
+                    numerator += sz*exp(-expo);
+            }
+        }
+    }
+    return numerator/denominator;
+}
+
 void calc_influence_function_energy()
 {
     int i,n[3],ind;
@@ -1306,9 +1654,24 @@ MDINLINE double perform_aliasing_sums_energy(int n[3])
         }
     }
 
+    if (p3m.interlace)
+        return numerator/perform_aliasing_sums_interlaced(n);
     return numerator/SQR(denominator);
 }
 
+MDINLINE double perform_aliasing_sums_interlaced(int n[3])
+{
+    int d, nd[3];
+    double cs = 1.0, as = 1.0;
+
+    nd[RX] = n[KX]; nd[RY] = n[KY]; nd[RZ] = n[KZ];
+    for(d = 0; d < 3; d++) {
+        cs *= analytic_cotangent_sum(nd[d], 1.0/p3m.mesh[d], p3m.cao);
+        as *= analytic_alternating_sum(nd[d], p3m.mesh[d], p3m.cao);
+    }
+    return 0.5*(SQR(cs) + SQR(as));
+}
+
 
 
 /************************************************
@@ -1343,7 +1706,7 @@ static double get_accuracy(int mesh[3], int cao, double r_cut_iL, double *_alpha
   *_alpha_L = alpha_L;
   /* calculate real space and k space error for this alpha_L */
   rs_err = P3M_real_space_error(coulomb.prefactor,r_cut_iL,p3m_sum_qpart,p3m_sum_q2,alpha_L);
-  ks_err = P3M_k_space_error(coulomb.prefactor,mesh,cao,p3m_sum_qpart,p3m_sum_q2,alpha_L);
+  ks_err = P3M_k_space_error(coulomb.prefactor,mesh,cao,p3m_sum_qpart,p3m_sum_q2,alpha_L,p3m.diff,p3m.interlace);
 
   *_rs_err = rs_err;
   *_ks_err = ks_err;
@@ -1606,11 +1969,13 @@ static double p3m_m_time(Tcl_Interp *interp, int mesh[3],
 int p3m_adaptive_tune(Tcl_Interp *interp) {
   int  mesh[3] = {0, 0, 0}, tmp_mesh_points; 
   int tmp_mesh[3];
-  double r_cut_iL_min, r_cut_iL_max, r_cut_iL = -1, tmp_r_cut_iL=0.0;
-  int    cao_min, cao_max,           cao      = -1, tmp_cao;
+  double r_cut_iL_min, r_cut_iL_max, r_cut_iL = -1, tmp_r_cut_iL=0.0, diff_r_cut_iL_max;
+  int    cao_min, cao_max,           cao      = -1, tmp_cao, diff_cao_min;
   double                             alpha_L  = -1, tmp_alpha_L=0.0;
   double                             accuracy = -1, tmp_accuracy=0.0;
-  double                            time_best=1e20, tmp_time;
+  double                            time_best=1e20, tmp_time, diff_time_best;
+  int    diff_min, diff_max,         diff     = P3M_DIFF_IK, tmp_diff;
+  int    il_min, il_max,             interlace = 0, tmp_interlace;
   double mesh_density = 0.0, mesh_density_min, mesh_density_max;
   char
     b1[3*TCL_INTEGER_SPACE + TCL_DOUBLE_SPACE + 12],
@@ -1686,56 +2051,94 @@ int p3m_adaptive_tune(Tcl_Interp *interp) {
     cao_min = cao_max = cao = p3m.cao;
   }
 
-  Tcl_AppendResult(interp, "mesh cao r_cut_iL     alpha_L      err          rs_err     ks_err     time [ms]\n", (char *) NULL);
-
-  /* mesh loop */
-  /* we're tuning the density of mesh points, which is the same in every direction. */
-  for (mesh_density=mesh_density_min;mesh_density<=mesh_density_max;mesh_density+=0.1) {
-    tmp_cao = cao;
-
-    P3M_TRACE(fprintf(stderr, "%d: trying meshdensity %lf.\n", this_node, mesh_density));
-
-    tmp_mesh[0] = (int)(box_l[0]*mesh_density);
-    tmp_mesh[1] = (int)(box_l[1]*mesh_density);
-    tmp_mesh[2] = (int)(box_l[2]*mesh_density);
-
-    if(tmp_mesh[0] % 2)
-      tmp_mesh[0]++;
-    if(tmp_mesh[1] % 2) 
-      tmp_mesh[1]++;
-    if(tmp_mesh[2] % 2)
-      tmp_mesh[2]++;
-
-    tmp_time = p3m_m_time(interp, tmp_mesh,
-			  cao_min, cao_max, &tmp_cao,
-			  r_cut_iL_min, r_cut_iL_max, &tmp_r_cut_iL,
-			  &tmp_alpha_L, &tmp_accuracy); 
-    /* some error occured during the tuning force evaluation */
-    P3M_TRACE(fprintf(stderr,"delta_acceracy: %lf tune time: %lf\n", p3m.accuracy - tmp_accuracy,tmp_time));
-    //    if (tmp_time == -1) con;
-    /* this mesh does not work at all */
-    if (tmp_time < 0.0) continue;
-
-    /* the optimum r_cut for this mesh is the upper limit for higher meshes,
-       everything else is slower */
-    r_cut_iL_max = tmp_r_cut_iL;
-
-    /* new optimum */
-    if (tmp_time < time_best) {
-      P3M_TRACE(fprintf(stderr, "Found new optimum: time %lf, mesh (%d %d %d)\n", tmp_time, tmp_mesh[0], tmp_mesh[1], tmp_mesh[2]));
-      time_best = tmp_time;
-      mesh[0]   = tmp_mesh[0];
-      mesh[1]   = tmp_mesh[1];
-      mesh[2]   = tmp_mesh[2];
-      cao       = tmp_cao;
-      r_cut_iL  = tmp_r_cut_iL;
-      alpha_L   = tmp_alpha_L;
-      accuracy  = tmp_accuracy;
-    }
-    /* no hope of further optimisation */
-    else if (tmp_time > time_best + P3M_TIME_GRAN) {
-      P3M_TRACE(fprintf(stderr, "%d: %lf is mush slower then best time, aborting.\n", this_node, tmp_time));
-      break;
+  if (p3m_tune_diff == -1) {
+    diff_min = P3M_DIFF_IK;
+    diff_max = P3M_DIFF_AD;
+  }
+  else {
+    diff_min = diff_max = p3m_tune_diff;
+    Tcl_AppendResult(interp, "fixed diff ", (p3m_tune_diff == P3M_DIFF_AD) ? "ad" : "ik", "\n", (char *)NULL);
+  }
+
+  if (p3m_tune_interlace == -1) {
+    il_min = 0;
+    il_max = 1;
+  }
+  else {
+    il_min = il_max = p3m_tune_interlace;
+    Tcl_AppendResult(interp, "fixed interlace ", p3m_tune_interlace ? "1" : "0", "\n", (char *)NULL);
+  }
+
+  /* differentiation scheme and interlacing loop: the schemes differ
+     in accuracy and speed, so each gets its own parameter search */
+  for (tmp_diff = diff_min; tmp_diff <= diff_max; tmp_diff++) {
+    /* the analytical differentiation needs a differentiable charge assignment */
+    diff_cao_min = (tmp_diff == P3M_DIFF_AD) ? imax(cao_min, 2) : cao_min;
+    if (diff_cao_min > cao_max) continue;
+    for (tmp_interlace = il_min; tmp_interlace <= il_max; tmp_interlace++) {
+      diff_r_cut_iL_max = r_cut_iL_max;
+      diff_time_best = 1e20;
+      p3m.diff = tmp_diff;
+      p3m.interlace = tmp_interlace;
+
+      Tcl_AppendResult(interp, "diff ", (tmp_diff == P3M_DIFF_AD) ? "ad" : "ik",
+		       " interlace ", tmp_interlace ? "1" : "0", "\n", (char *)NULL);
+      Tcl_AppendResult(interp, "mesh cao r_cut_iL     alpha_L      err          rs_err     ks_err     time [ms]\n", (char *) NULL);
+      /* mesh loop */
+      /* we're tuning the density of mesh points, which is the same in every direction. */
+      for (mesh_density=mesh_density_min;mesh_density<=mesh_density_max;mesh_density+=0.1) {
+        tmp_cao = imax(cao, diff_cao_min);
+
+        P3M_TRACE(fprintf(stderr, "%d: trying meshdensity %lf.\n", this_node, mesh_density));
+
+        tmp_mesh[0] = (int)(box_l[0]*mesh_density);
+        tmp_mesh[1] = (int)(box_l[1]*mesh_density);
+        tmp_mesh[2] = (int)(box_l[2]*mesh_density);
+
+        if(tmp_mesh[0] % 2)
+          tmp_mesh[0]++;
+        if(tmp_mesh[1] % 2) 
+          tmp_mesh[1]++;
+        if(tmp_mesh[2] % 2)
+          tmp_mesh[2]++;
+
+        tmp_time = p3m_m_time(interp, tmp_mesh,
+			      diff_cao_min, cao_max, &tmp_cao,
+			      r_cut_iL_min, diff_r_cut_iL_max, &tmp_r_cut_iL,
+			      &tmp_alpha_L, &tmp_accuracy); 
+        /* some error occured during the tuning force evaluation */
+        P3M_TRACE(fprintf(stderr,"delta_acceracy: %lf tune time: %lf\n", p3m.accuracy - tmp_accuracy,tmp_time));
+        //    if (tmp_time == -1) con;
+        /* this mesh does not work at all */
+        if (tmp_time < 0.0) continue;
+
+        /* the optimum r_cut for this mesh is the upper limit for higher meshes,
+           everything else is slower */
+        diff_r_cut_iL_max = tmp_r_cut_iL;
+
+        /* new optimum */
+        if (tmp_time < time_best) {
+          P3M_TRACE(fprintf(stderr, "Found new optimum: time %lf, mesh (%d %d %d), diff %d\n", tmp_time, tmp_mesh[0], tmp_mesh[1], tmp_mesh[2], tmp_diff));
+          time_best = tmp_time;
+          mesh[0]   = tmp_mesh[0];
+          mesh[1]   = tmp_mesh[1];
+          mesh[2]   = tmp_mesh[2];
+          cao       = tmp_cao;
+          r_cut_iL  = tmp_r_cut_iL;
+          alpha_L   = tmp_alpha_L;
+          accuracy  = tmp_accuracy;
+          diff      = tmp_diff;
+          interlace = tmp_interlace;
+        }
+
+        /* no hope of further optimisation with this scheme */
+        if (tmp_time < diff_time_best)
+          diff_time_best = tmp_time;
+        else if (tmp_time > diff_time_best + P3M_TIME_GRAN) {
+          P3M_TRACE(fprintf(stderr, "%d: %lf is mush slower then best time, aborting.\n", this_node, tmp_time));
+          break;
+        }
+      }
     }
   }
   
@@ -1753,6 +2156,8 @@ int p3m_adaptive_tune(Tcl_Interp *interp) {
   p3m.cao      = cao;
   p3m.alpha_L  = alpha_L;
   p3m.accuracy = accuracy;
+  p3m.diff     = diff;
+  p3m.interlace = interlace;
   P3M_scaleby_box_l_charges();
   /* broadcast tuned p3m parameters */
   P3M_TRACE(fprintf(stderr,"%d: Broadcasting P3M parameters: mesh: (%d %d %d), cao: %d, alpha_L: %lf, acccuracy: %lf\n", this_node, p3m.mesh[0], p3m.mesh[1],  p3m.mesh[2], p3m.cao, p3m.alpha_L, p3m.accuracy));
@@ -1767,7 +2172,8 @@ int p3m_adaptive_tune(Tcl_Interp *interp) {
   sprintf(b1,"%.5e",r_cut_iL); sprintf(b2,"%.5e",alpha_L); sprintf(b3,"%.5e",accuracy);
   Tcl_AppendResult(interp, b1,"  ", b2,"  ", b3,"  ", (char *) NULL);
   sprintf(b3,"                 %-8d",(int)time_best);
-  Tcl_AppendResult(interp, b3, (char *) NULL);
+  Tcl_AppendResult(interp, b3, (diff == P3M_DIFF_AD) ? "  diff ad" : "  diff ik",
+		   interlace ? " interlace 1" : " interlace 0", (char *) NULL);
   return (TCL_OK);
 }
   
@@ -1859,23 +2265,56 @@ double P3M_real_space_error(double prefac, double r_cut_iL,
   return (2.0*prefac*sum_q2*exp(-SQR(r_cut_iL*alpha_L))) / (sqrt((double)n_c_part*r_cut_iL)*box_l[1]*box_l[2]);
 }
 
-double P3M_k_space_error(double prefac, int mesh[3], int cao, int n_c_part, double sum_q2, double alpha_L)
+double P3M_k_space_error(double prefac, int mesh[3], int cao, int n_c_part, double sum_q2, double alpha_L, int diff, int interlace)
 {
   int  nx, ny, nz;
   double he_q = 0.0, mesh_i[3] = {1.0/mesh[0], 1.0/mesh[1], 1.0/mesh[2]}, alpha_L_i = 1./alpha_L;
-  double alias1, alias2, n2, cs;
-  double ctan_x, ctan_y;
+  double alias1, alias2, alias3, n2, cs, denominator;
+  double ctan_x, ctan_y, ctan_z, grad_x = 0.0, grad_y = 0.0, grad_z;
+  /* the alternating sums of the interlaced mesh */
+  double as = 0.0, alt_x = 0.0, alt_y = 0.0, alt_z, agrad_x = 0.0, agrad_y = 0.0, agrad_z;
 
   for (nx=-mesh[0]/2; nx<mesh[0]/2; nx++) {
     ctan_x = analytic_cotangent_sum(nx,mesh_i[0],cao);
+    if (diff == P3M_DIFF_AD) grad_x = analytic_gradient_sum(nx,mesh[0],cao);
+    if (interlace) {
+      alt_x = analytic_alternating_sum(nx,mesh[0],cao);
+      if (diff == P3M_DIFF_AD) agrad_x = analytic_alternating_gradient_sum(nx,mesh[0],cao);
+    }
     for (ny=-mesh[1]/2; ny<mesh[1]/2; ny++) {
-      ctan_y = ctan_x * analytic_cotangent_sum(ny,mesh_i[1],cao);
+      ctan_y = analytic_cotangent_sum(ny,mesh_i[1],cao);
+      if (diff == P3M_DIFF_AD) grad_y = analytic_gradient_sum(ny,mesh[1],cao);
+      if (interlace) {
+	alt_y = analytic_alternating_sum(ny,mesh[1],cao);
+	if (diff == P3M_DIFF_AD) agrad_y = analytic_alternating_gradient_sum(ny,mesh[1],cao);
+      }
       for (nz=-mesh[2]/2; nz<mesh[2]/2; nz++) {
 	if((nx!=0) || (ny!=0) || (nz!=0)) {
 	  n2 = SQR(nx) + SQR(ny) + SQR(nz);
-	  cs = analytic_cotangent_sum(nz,mesh_i[2],cao)*ctan_y;
-	  P3M_tune_aliasing_sums(nx,ny,nz,mesh,mesh_i,cao,alpha_L_i,&alias1,&alias2);
-	  he_q += (alias1  -  SQR(alias2/cs) / n2);
+	  ctan_z = analytic_cotangent_sum(nz,mesh_i[2],cao);
+	  cs = ctan_x*ctan_y*ctan_z;
+	  if (interlace) {
+	    alt_z = analytic_alternating_sum(nz,mesh[2],cao);
+	    as = alt_x*alt_y*alt_z;
+	  }
+	  if (diff == P3M_DIFF_AD) {
+	    grad_z = analytic_gradient_sum(nz,mesh[2],cao);
+	    alias3 = grad_x*ctan_y*ctan_z + ctan_x*grad_y*ctan_z + ctan_x*ctan_y*grad_z;
+	    denominator = cs*alias3;
+	    if (interlace) {
+	      agrad_z = analytic_alternating_gradient_sum(nz,mesh[2],cao);
+	      alias3 = agrad_x*alt_y*alt_z + alt_x*agrad_y*alt_z + alt_x*alt_y*agrad_z;
+	      denominator = 0.5*(denominator + as*alias3);
+	    }
+	    P3M_tune_aliasing_sums_ad(nx,ny,nz,mesh,mesh_i,cao,alpha_L_i,&alias1,&alias2);
+	    /* the terms are positive, but may cancel down to round off errors */
+	    he_q += dmax(alias1  -  SQR(alias2) / denominator, 0.0);
+	  }
+	  else {
+	    denominator = interlace ? 0.5*(SQR(cs) + SQR(as)) : SQR(cs);
+	    P3M_tune_aliasing_sums(nx,ny,nz,mesh,mesh_i,cao,alpha_L_i,&alias1,&alias2);
+	    he_q += dmax(alias1  -  SQR(alias2) / (denominator*n2), 0.0);
+	  }
 	}
       }
     }
@@ -1920,63 +2359,60 @@ void P3M_tune_aliasing_sums(int nx, int ny, int nz,
 
 
 
+void P3M_tune_aliasing_sums_ad(int nx, int ny, int nz, 
+			       int mesh[3], double mesh_i[3], int cao, double alpha_L_i, 
+			       double *alias1, double *alias2)
+{
+
+  int    mx,my,mz;
+  double nmx,nmy,nmz;
+  double fnmx,fnmy,fnmz;
+
+  double ex,ex2,nm2,U2,factor1;
+
+  factor1 = SQR(PI*alpha_L_i);
+
+  *alias1 = *alias2 = 0.0;
+  for (mx=-P3M_BRILLOUIN; mx<=P3M_BRILLOUIN; mx++) {
+    fnmx = mesh_i[0] * (nmx = nx + mx*mesh[0]);
+    for (my=-P3M_BRILLOUIN; my<=P3M_BRILLOUIN; my++) {
+      fnmy = mesh_i[1] * (nmy = ny + my*mesh[1]);
+      for (mz=-P3M_BRILLOUIN; mz<=P3M_BRILLOUIN; mz++) {
+	fnmz = mesh_i[2] * (nmz = nz + mz*mesh[2]);
+
+	nm2 = SQR(nmx) + SQR(nmy) + SQR(nmz);
+	ex2 = SQR( ex = exp(-factor1*nm2) );
+	
+	U2 = pow(sinc(fnmx)*sinc(fnmy)*sinc(fnmz), 2.0*cao);
+	
+	*alias1 += ex2 / nm2;
+	*alias2 += U2 * ex;
+      }
+    }
+  }
+}
+
+
 /************************************************************/
 
 void calc_local_ca_mesh() {
   int i;
-  int ind[3];
   /* total skin size */
   double full_skin[3];
   
-  for(i=0;i<3;i++)
+  for(i=0;i<3;i++) {
     full_skin[i]= p3m.cao_cut[i]+skin+p3m.additional_mesh[i];
+    /* the charges are shifted by half a mesh constant for the interlaced mesh */
+    if (p3m.interlace) full_skin[i] += 0.5*p3m.a[i];
+  }
 
-  /* inner left down grid point (global index) */
-  for(i=0;i<3;i++) lm.in_ld[i] = (int)ceil(my_left[i]*p3m.ai[i]-p3m.mesh_off[i]);
-  /* inner up right grid point (global index) */
-  for(i=0;i<3;i++) lm.in_ur[i] = (int)floor(my_right[i]*p3m.ai[i]-p3m.mesh_off[i]);
-  
-  /* correct roundof errors at boundary */
-  for(i=0;i<3;i++) {
-    if((my_right[i]*p3m.ai[i]-p3m.mesh_off[i])-lm.in_ur[i]<ROUND_ERROR_PREC) lm.in_ur[i]--;
-    if(1.0+(my_left[i]*p3m.ai[i]-p3m.mesh_off[i])-lm.in_ld[i]<ROUND_ERROR_PREC) lm.in_ld[i]--;
-  }
-  /* inner grid dimensions */
-  for(i=0;i<3;i++) lm.inner[i] = lm.in_ur[i] - lm.in_ld[i] + 1;
-  /* index of left down grid point in global mesh */
-  for(i=0;i<3;i++) 
-    lm.ld_ind[i]=(int)ceil((my_left[i]-full_skin[i])*p3m.ai[i]-p3m.mesh_off[i]);
-  /* spacial position of left down mesh point */
-  calc_lm_ld_pos();
-  /* left down margin */
-  for(i=0;i<3;i++) lm.margin[i*2] = lm.in_ld[i]-lm.ld_ind[i];
-  /* up right grid point */
-  for(i=0;i<3;i++) ind[i]=(int)floor((my_right[i]+full_skin[i])*p3m.ai[i]-p3m.mesh_off[i]);
-  /* correct roundof errors at up right boundary */
-  for(i=0;i<3;i++)
-    if(((my_right[i]+full_skin[i])*p3m.ai[i]-p3m.mesh_off[i])-ind[i]==0) ind[i]--;
-  /* up right margin */
-  for(i=0;i<3;i++) lm.margin[(i*2)+1] = ind[i] - lm.in_ur[i];
-
-  /* grid dimension */
-  lm.size=1; 
-  for(i=0;i<3;i++) {lm.dim[i] = ind[i] - lm.ld_ind[i] + 1; lm.size*=lm.dim[i];}
-  /* reduce inner grid indices from global to local */
-  for(i=0;i<3;i++) lm.in_ld[i] = lm.margin[i*2];
-  for(i=0;i<3;i++) lm.in_ur[i] = lm.margin[i*2]+lm.inner[i];
-
-  lm.q_2_off  = lm.dim[2] - p3m.cao;
-  lm.q_21_off = lm.dim[2] * (lm.dim[1] - p3m.cao);
- 
+  p3m_calc_local_mesh(&lm, p3m.ai, p3m.mesh_off, full_skin, p3m.cao);
 }
 
 
 void calc_lm_ld_pos() {
-  int i; 
   /* spacial position of left down mesh point */
-  for(i=0;i<3;i++) {
-    lm.ld_pos[i] = (lm.ld_ind[i]+ p3m.mesh_off[i])*p3m.a[i];
-  }
+  p3m_calc_lm_ld_pos(&lm, p3m.ai, p3m.mesh_off);
 }
 
 
@@ -2058,6 +2494,11 @@ int P3M_sanity_checks()
     ERROR_SPRINTF(errtxt,"{046 P3M_init: cao is not yet set} ");
     ret = 1;
   }
+  if( p3m.diff == P3M_DIFF_AD && p3m.cao == 1) {
+    errtxt = runtime_error(128);
+    ERROR_SPRINTF(errtxt,"{050 P3M_init: analytical differentiation requires cao >= 2} ");
+    ret = 1;
+  }
   if (skin == -1) {
     errtxt = runtime_error(128 + 2*TCL_DOUBLE_SPACE);
     ERROR_SPRINTF(errtxt,"{047 P3M_init: skin is not yet set} ");
@@ -2077,77 +2518,7 @@ int P3M_sanity_checks()
 
 void calc_send_mesh()
 {
-  int i,j,evenodd;
-  int done[3]={0,0,0};
-  MPI_Status status;
-  /* send grids */
-  for(i=0;i<3;i++) {
-    for(j=0;j<3;j++) {
-      /* left */
-      sm.s_ld[i*2][j] = 0 + done[j]*lm.margin[j*2];
-      if(j==i) sm.s_ur[i*2][j] = lm.margin[j*2]; 
-      else     sm.s_ur[i*2][j] = lm.dim[j]-done[j]*lm.margin[(j*2)+1];
-      /* right */
-      if(j==i) sm.s_ld[(i*2)+1][j] = lm.in_ur[j];
-      else     sm.s_ld[(i*2)+1][j] = 0 + done[j]*lm.margin[j*2];
-      sm.s_ur[(i*2)+1][j] = lm.dim[j] - done[j]*lm.margin[(j*2)+1];
-    }   
-    done[i]=1;
-  }
-  sm.max=0;
-  for(i=0;i<6;i++) {
-    sm.s_size[i] = 1;
-    for(j=0;j<3;j++) {
-      sm.s_dim[i][j] = sm.s_ur[i][j]-sm.s_ld[i][j];
-      sm.s_size[i] *= sm.s_dim[i][j];
-    }
-    if(sm.s_size[i]>sm.max) sm.max=sm.s_size[i];
-  }
-  /* communication */
-  for(i=0;i<6;i++) {
-    if(i%2==0) j = i+1;
-    else       j = i-1;
-    if(node_neighbors[i] != this_node) {
-      /* two step communication: first all even positions than all odd */
-      for(evenodd=0; evenodd<2;evenodd++) {
-	if((node_pos[i/2]+evenodd)%2==0)
-	  MPI_Send(&(lm.margin[i]), 1, MPI_INT, 
-		   node_neighbors[i],REQ_P3M_INIT,MPI_COMM_WORLD);
-	else
-	  MPI_Recv(&(lm.r_margin[j]), 1, MPI_INT,
-		   node_neighbors[j],REQ_P3M_INIT,MPI_COMM_WORLD,&status);    
-      }
-    }
-    else {
-      lm.r_margin[j] = lm.margin[i];
-    }
-  }
-  /* recv grids */
-  for(i=0;i<3;i++) 
-    for(j=0;j<3;j++) {
-      if(j==i) {
-	sm.r_ld[ i*2   ][j] = sm.s_ld[ i*2   ][j] + lm.margin[2*j];
-	sm.r_ur[ i*2   ][j] = sm.s_ur[ i*2   ][j] + lm.r_margin[2*j];
-	sm.r_ld[(i*2)+1][j] = sm.s_ld[(i*2)+1][j] - lm.r_margin[(2*j)+1];
-	sm.r_ur[(i*2)+1][j] = sm.s_ur[(i*2)+1][j] - lm.margin[(2*j)+1];
-      }
-      else {
-	sm.r_ld[ i*2   ][j] = sm.s_ld[ i*2   ][j];
-	sm.r_ur[ i*2   ][j] = sm.s_ur[ i*2   ][j];
-	sm.r_ld[(i*2)+1][j] = sm.s_ld[(i*2)+1][j];
-	sm.r_ur[(i*2)+1][j] = sm.s_ur[(i*2)+1][j];
-      }
-    }
-  for(i=0;i<6;i++) {
-    sm.r_size[i] = 1;
-    for(j=0;j<3;j++) {
-      sm.r_dim[i][j] = sm.r_ur[i][j]-sm.r_ld[i][j];
-      sm.r_size[i] *= sm.r_dim[i][j];
-    }
-    if(sm.r_size[i]>sm.max) sm.max=sm.r_size[i];
-  }
-  
-  
+  p3m_calc_send_mesh(&sm, &lm);
 }
 
 
@@ -2165,66 +2536,54 @@ void P3M_scaleby_box_l_charges() {
 
 /************************************************/
 
-void P3M_calc_kspace_stress (double* stress) {
-    if (p3m_sum_q2 > 0) {
-        double* node_k_space_stress;
-        double* k_space_stress;
-        double force_prefac, node_k_space_energy, sqk, vterm, kx, ky, kz;
-        int jx, jy, jz, i, ind = 0;
-        // ordering after fourier transform
-        const int x = 2, y = 0, z = 1;
-        node_k_space_stress = malloc(9*sizeof(double));
-        k_space_stress = malloc(9*sizeof(double));
-
-        for (i = 0; i < 9; i++) {
-            node_k_space_stress[i] = 0.0;
-            k_space_stress[i] = 0.0;
-        }
-
-        gather_fft_grid(rs_mesh);
-        fft_perform_forw(rs_mesh);
-        force_prefac = coulomb.prefactor / (2.0 * box_l[0] * box_l[1] * box_l[2]);
-
-        for(jx=0; jx < fft_plan[3].new_mesh[0]; jx++) {
-            for(jy=0; jy < fft_plan[3].new_mesh[1]; jy++) {
-                for(jz=0; jz < fft_plan[3].new_mesh[2]; jz++) {
-                       kx = d_op[2][ jx + fft_plan[3].start[0] ];
-                       ky = d_op[0][ jy + fft_plan[3].start[1] ];
-                       kz = d_op[1][ jz + fft_plan[3].start[2] ];
-                    sqk = SQR(kx/box_l[x]) + SQR(ky/box_l[y]) + SQR(kz/box_l[z]);
-                    if (sqk == 0) {
-                        node_k_space_energy = 0.0;
-                        vterm = 0.0;
-                    }
-                    else {
-                        vterm = -2.0 * (1/sqk + SQR(PI/p3m.alpha));
-                        node_k_space_energy = g_energy[ind] * ( SQR(rs_mesh[2*ind]) + SQR(rs_mesh[2*ind + 1]) );
-                    }
-                    ind++;
+void static add_kspace_stress(double *stress, double force_prefac)
+{
+  double node_k_space_stress[9], k_space_stress[9];
+  double node_k_space_energy, sqk, vterm, kx, ky, kz;
+  int j[3], i, ind = 0, h = fft_ks_half_dir(fft_plan);
+  // ordering after fourier transform
+  const int x = 2, y = 0, z = 1;
+
+  for (i = 0; i < 9; i++) {
+    node_k_space_stress[i] = 0.0;
+    k_space_stress[i] = 0.0;
+  }
+
+  for(j[0]=0; j[0] < fft_plan[3].new_mesh[0]; j[0]++) {
+    for(j[1]=0; j[1] < fft_plan[3].new_mesh[1]; j[1]++) {
+      for(j[2]=0; j[2] < fft_plan[3].new_mesh[2]; j[2]++) {
+	kx = d_op[2][ j[0] + fft_plan[3].start[0] ];
+	ky = d_op[0][ j[1] + fft_plan[3].start[1] ];
+	kz = d_op[1][ j[2] + fft_plan[3].start[2] ];
+	sqk = SQR(kx/box_l[x]) + SQR(ky/box_l[y]) + SQR(kz/box_l[z]);
+	if (sqk == 0) {
+	  node_k_space_energy = 0.0;
+	  vterm = 0.0;
+	}
+	else {
+	  vterm = -2.0 * (1/sqk + SQR(PI/p3m.alpha));
+	  node_k_space_energy = fft_ks_weight(fft_plan, j[h] + fft_plan[3].start[h])
+	    * g_energy[ind] * ( SQR(rs_mesh[2*ind]) + SQR(rs_mesh[2*ind + 1]) );
+	}
+	ind++;
 
-                    node_k_space_stress[0] += node_k_space_energy * (1.0 + vterm*SQR(kx/box_l[x]));     /* sigma_xx */
-                    node_k_space_stress[1] += node_k_space_energy * (vterm*kx*ky/(box_l[x]*box_l[y]));  /* sigma_xy */
-                    node_k_space_stress[2] += node_k_space_energy * (vterm*kx*kz/(box_l[x]*box_l[z]));  /* sigma_xz */
+	node_k_space_stress[0] += node_k_space_energy * (1.0 + vterm*SQR(kx/box_l[x]));     /* sigma_xx */
+	node_k_space_stress[1] += node_k_space_energy * (vterm*kx*ky/(box_l[x]*box_l[y]));  /* sigma_xy */
+	node_k_space_stress[2] += node_k_space_energy * (vterm*kx*kz/(box_l[x]*box_l[z]));  /* sigma_xz */
 
-                    node_k_space_stress[3] += node_k_space_energy * (vterm*kx*ky/(box_l[x]*box_l[y]));  /* sigma_yx */
-                    node_k_space_stress[4] += node_k_space_energy * (1.0 + vterm*SQR(ky/box_l[y]));     /* sigma_yy */
-                    node_k_space_stress[5] += node_k_space_energy * (vterm*ky*kz/(box_l[y]*box_l[z]));  /* sigma_yz */
+	node_k_space_stress[3] += node_k_space_energy * (vterm*kx*ky/(box_l[x]*box_l[y]));  /* sigma_yx */
+	node_k_space_stress[4] += node_k_space_energy * (1.0 + vterm*SQR(ky/box_l[y]));     /* sigma_yy */
+	node_k_space_stress[5] += node_k_space_energy * (vterm*ky*kz/(box_l[y]*box_l[z]));  /* sigma_yz */
 
-                    node_k_space_stress[6] += node_k_space_energy * (vterm*kx*kz/(box_l[x]*box_l[z]));  /* sigma_zx */
-                    node_k_space_stress[7] += node_k_space_energy * (vterm*ky*kz/(box_l[y]*box_l[z]));  /* sigma_zy */
-                    node_k_space_stress[8] += node_k_space_energy * (1.0 + vterm*SQR(kz/box_l[z]));     /* sigma_zz */
-                }
-            }
-        }
-        MPI_Reduce(node_k_space_stress, k_space_stress, 9, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
-        for (i = 0; i < 9; i++) {
-            stress[i] += k_space_stress[i] * force_prefac;
-        }
-//         fprintf(stderr, "sxx = %.5e, syy = %.5e, szz = %.5e\n", stress[0], stress[4], stress[8]);
-//         fprintf(stderr, "sxy = %.5e, sxz = %.5e, syz = %.5e\n", stress[1], stress[2], stress[5]);
-        free (node_k_space_stress);
-        free (k_space_stress);
+	node_k_space_stress[6] += node_k_space_energy * (vterm*kx*kz/(box_l[x]*box_l[z]));  /* sigma_zx */
+	node_k_space_stress[7] += node_k_space_energy * (vterm*ky*kz/(box_l[y]*box_l[z]));  /* sigma_zy */
+	node_k_space_stress[8] += node_k_space_energy * (1.0 + vterm*SQR(kz/box_l[z]));     /* sigma_zz */
+      }
     }
+  }
+  MPI_Reduce(node_k_space_stress, k_space_stress, 9, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  for (i = 0; i < 9; i++)
+    stress[i] += k_space_stress[i] * force_prefac;
 }
 
 
@@ -2286,6 +2645,8 @@ void   P3M_init_charges() {
  
     ca_mesh_size = fft_init(&rs_mesh,lm.dim,lm.margin,&ks_pnum);
     ks_mesh = (double *) realloc(ks_mesh, ca_mesh_size*sizeof(double));
+    if (p3m.interlace)
+      rs_mesh_il = (double *) realloc(rs_mesh_il, ca_mesh_size*sizeof(double));
     
 
     P3M_TRACE(fprintf(stderr,"%d: rs_mesh ADR=%p\n",this_node,rs_mesh));
@@ -2333,6 +2694,8 @@ int tclprint_to_result_ChargeP3M(Tcl_Interp *interp)
   Tcl_AppendResult(interp, buffer, " ", (char *) NULL);
   Tcl_PrintDouble(interp, p3m.mesh_off[2], buffer);
   Tcl_AppendResult(interp, buffer, (char *) NULL);
+  Tcl_AppendResult(interp, " diff ", (p3m.diff == P3M_DIFF_AD) ? "ad" : "ik", (char *) NULL);
+  Tcl_AppendResult(interp, " interlace ", p3m.interlace ? "1" : "0", (char *) NULL);
 
   return TCL_OK;
 }
@@ -2342,12 +2705,20 @@ void P3M_free()
   int i;
   /* free memory */
   free(ca_frac);
+  free(ca_fgrad);
   free(ca_fmp);
   free(send_grid);
   free(recv_grid);
   free(rs_mesh);
   free(ks_mesh); 
-  for(i=0; i<p3m.cao; i++) free(int_caf[i]);
+  free(rs_mesh_il);
+  free(ca_frac_il);
+  free(ca_fgrad_il);
+  free(ca_fmp_il);
+  for(i=0; i<p3m.cao; i++) {
+    free(int_caf[i]);
+    free(int_caf_d[i]);
+  }
 }
 
 
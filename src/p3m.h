@@ -57,6 +57,12 @@
  * data types
  ************************************************/
 
+/** Differentiation schemes for the k-space forces: P3M_DIFF_IK
+    transforms each force component back separately, P3M_DIFF_AD
+    transforms only the potential back and differentiates the charge
+    assignment function. */
+enum P3M_DIFF { P3M_DIFF_IK = 0, P3M_DIFF_AD = 1 };
+
 /** Structure to hold P3M parameters and some dependend variables. */
 typedef struct {
   /** Ewald splitting parameter (0<alpha<1), rescaled to alpha_L = alpha * box_l. */
@@ -72,6 +78,11 @@ typedef struct {
   int    cao;
   /** number of interpolation points for charge assignment function */
   int    inter;
+  /** differentiation scheme for the forces, see \ref P3M_DIFF. */
+  int    diff;
+  /** whether to average over a second mesh shifted by half a mesh
+      constant in every direction (interlacing, 0 or 1). */
+  int    interlace;
   /** Accuracy of the actual parameter set. */
   double accuracy;
 
@@ -103,6 +114,9 @@ extern double* rs_mesh;
 extern int p3m_sum_qpart;
 extern double p3m_sum_q2;
 extern double p3m_square_sum_q;
+/** set while the gather of the charge meshes started by \ref
+    P3M_charge_assign_start is not complete. */
+extern int p3m_gather_pending;
 
 /** \name Exported Functions */
 /************************************************************/
@@ -125,8 +139,12 @@ int tclcommand_inter_coulomb_parse_p3m(Tcl_Interp * interp, int argc, char ** ar
 /** compute the k-space part of forces and energies for the charge-charge interaction  **/
 double P3M_calc_kspace_forces_for_charges(int force_flag, int energy_flag);
 
-/** computer the k-space part of the stress tensor **/
-void P3M_calc_kspace_stress (double* stress);
+/** compute the k-space part of forces and energies as \ref
+    P3M_calc_kspace_forces_for_charges, and add the k-space part of the
+    stress tensor to stress on the master. The stress is evaluated on
+    the same transformed charge mesh as the energy, so that it can be
+    obtained during the force calculation, see \ref obs_fused. **/
+double P3M_calc_kspace_forces_and_stress(int force_flag, int energy_flag, double *stress);
 
 /// sanity checks
 int P3M_sanity_checks();
@@ -150,7 +168,7 @@ enum P3M_TUNE_ERROR { P3M_TUNE_FAIL = 1, P3M_TUNE_NOCUTOFF = 2, P3M_TUNE_CAOTOLA
 /** Tune P3M parameters to desired accuracy.
 
     Usage:
-    \verbatim inter coulomb <bjerrum> p3m tune accuracy <value> [r_cut <value> mesh <value> cao <value>] \endverbatim
+    \verbatim inter coulomb <bjerrum> p3m tune accuracy <value> [r_cut <value> mesh <value> cao <value> diff ik|ad interlace 0|1] \endverbatim
 
     The parameters are tuned to obtain the desired accuracy in best
     time, by running mpi_integrate(0) for several parameter sets.
@@ -168,6 +186,8 @@ enum P3M_TUNE_ERROR { P3M_TUNE_FAIL = 1, P3M_TUNE_NOCUTOFF = 2, P3M_TUNE_CAOTOLA
     p3m_struct::mesh the function uses the two values which matches best the
     equation: number of mesh point = number of charged particles. For
     \ref p3m_struct::cao the function considers all possible values.
+    Unless fixed, both differentiation schemes \ref P3M_DIFF are tried,
+    each with and without interlacing.
 
     For each setting \ref p3m_struct::alpha_L is calculated assuming that the
     error contributions of real and reciprocal space should be equal.
@@ -187,9 +207,25 @@ int tclcommand_inter_coulomb_print_p3m_tune_parameters(Tcl_Interp *interp);
     cur_ca_frac. */
 void P3M_charge_assign();
 
+/** assign the charges as \ref P3M_charge_assign, and start gathering
+    the charge grid without waiting, so that the communication proceeds
+    while the short ranged forces are calculated. Meanwhile, \ref
+    P3M_gather_progress should be called regularly. The gather is
+    completed by the next \ref P3M_calc_kspace_forces_and_stress. */
+void P3M_charge_assign_start();
+
+/** check whether the charge grid gather started by \ref
+    P3M_charge_assign_start has advanced, and if so, start its next
+    step. @return 1 if the gather is complete. */
+int P3M_gather_progress();
+
+/** zero the charge grid, and for interlacing also the shifted one. */
+void P3M_clear_charge_grid();
+
 /** assign a single charge into the current charge grid. cp_cnt gives the a running index,
     which may be smaller than 0, in which case the charge is assumed to be virtual and is not
-    stored in the ca_frac arrays. */
+    stored in the ca_frac arrays. For interlacing, the charge is also assigned to the shifted
+    grid. */
 void P3M_assign_charge(double q,
 		       double real_pos[3],
 		       int cp_cnt);
@@ -198,7 +234,8 @@ void P3M_assign_charge(double q,
 void P3M_shrink_wrap_charge_grid(int n_charges);
 
 /** Calculate real space contribution of coulomb pair forces.
-    If NPT is compiled in, it returns the energy, which is needed for NPT. */
+    Returns the energy, which is needed for NPT and the fused
+    observables. */
 MDINLINE double add_p3m_coulomb_pair_force(double chgfac, double *d,double dist2,double dist,double force[3])
 {
   int j;
@@ -219,9 +256,7 @@ MDINLINE double add_p3m_coulomb_pair_force(double chgfac, double *d,double dist2
 	force[j] += fac2 * d[j];
       ESR_TRACE(fprintf(stderr,"%d: RSE: Pair dist=%.3f: force (%.3e,%.3e,%.3e)\n",this_node,
 			dist,fac2*d[0],fac2*d[1],fac2*d[2]));
-#ifdef NPT
       return fac1 * erfc_part_ri;
-#endif
     }
   }
   return 0.0;
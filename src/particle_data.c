@@ -2076,6 +2076,154 @@ int tclcommand_part_parse_cmd(Tcl_Interp *interp, int argc, char **argv,
   return mpi_gather_runtime_errors(interp, err);
 }
 
+/** Parse the part bulk command. The last argument holds the data, one
+    record per particle, consisting of the identity followed by the values
+    of the given properties in the given order. The data is either a
+    Tcl list or, with "binary", native doubles as produced by
+    "binary format d*". */
+static int tclcommand_part_parse_bulk(Tcl_Interp *interp, int argc, char **argv)
+{
+  int props = 0, binary = 0, n_order = 0, rec_size = 1, n_part, i, j, k;
+  int order[5];
+  double *values, dt2 = 0.5*time_step*time_step;
+  DoubleList list;
+  ParticleBulkData *data;
+
+  argc--; argv++;
+
+  if (argc > 1 && ARG0_IS_S("binary")) {
+    binary = 1;
+    argc--; argv++;
+  }
+
+  for (; argc > 1; argc--, argv++) {
+    int prop, size;
+    if (ARG0_IS_S("pos")) {
+      prop = PART_BULK_POS; size = 3;
+    }
+    else if (ARG0_IS_S("v")) {
+      prop = PART_BULK_V; size = 3;
+    }
+    else if (ARG0_IS_S("f")) {
+      prop = PART_BULK_F; size = 3;
+    }
+#ifdef ELECTROSTATICS
+    else if (ARG0_IS_S("q")) {
+      prop = PART_BULK_Q; size = 1;
+    }
+#endif
+    else if (ARG0_IS_S("type")) {
+      prop = PART_BULK_TYPE; size = 1;
+    }
+    else {
+      Tcl_AppendResult(interp, "unknown particle property for part bulk \"",
+		       argv[0], "\"", (char *)NULL);
+      return TCL_ERROR;
+    }
+    if (props & prop) {
+      Tcl_AppendResult(interp, "particle property \"", argv[0],
+		       "\" given twice", (char *)NULL);
+      return TCL_ERROR;
+    }
+    props |= prop;
+    order[n_order++] = prop;
+    rec_size += size;
+  }
+
+  if (argc != 1 || n_order == 0) {
+    Tcl_AppendResult(interp, "usage: part bulk [binary] <property>... <data>",
+		     (char *)NULL);
+    return TCL_ERROR;
+  }
+
+  init_doublelist(&list);
+  if (binary) {
+    /* the string form of a byte array maps each byte to one character,
+       which Tcl_GetByteArrayFromObj reverts */
+    Tcl_Obj *obj = Tcl_NewStringObj(argv[0], -1);
+    unsigned char *bytes;
+    int n_bytes;
+
+    Tcl_IncrRefCount(obj);
+    bytes = Tcl_GetByteArrayFromObj(obj, &n_bytes);
+    if (n_bytes % sizeof(double)) {
+      Tcl_DecrRefCount(obj);
+      Tcl_AppendResult(interp, "binary particle data is not a sequence of doubles",
+		       (char *)NULL);
+      return TCL_ERROR;
+    }
+    alloc_doublelist(&list, list.n = n_bytes/sizeof(double));
+    memcpy(list.e, bytes, n_bytes);
+    Tcl_DecrRefCount(obj);
+  }
+  else if (!ARG0_IS_DOUBLELIST(list)) {
+    realloc_doublelist(&list, 0);
+    Tcl_ResetResult(interp);
+    Tcl_AppendResult(interp, "particle data has to be a list of numbers",
+		     (char *)NULL);
+    return TCL_ERROR;
+  }
+
+  if (list.n % rec_size) {
+    char buffer[2*TCL_INTEGER_SPACE];
+    realloc_doublelist(&list, 0);
+    sprintf(buffer, "%d", rec_size);
+    Tcl_AppendResult(interp, "particle data does not consist of records of ",
+		     buffer, " values", (char *)NULL);
+    return TCL_ERROR;
+  }
+  n_part = list.n/rec_size;
+
+  data = (ParticleBulkData *)malloc(n_part*sizeof(ParticleBulkData));
+  for (i = 0; i < n_part; i++) {
+    values = list.e + i*rec_size;
+    data[i].id = (int)values[0];
+    if (data[i].id != values[0] || data[i].id < 0) {
+      free(data);
+      realloc_doublelist(&list, 0);
+      Tcl_AppendResult(interp, "particle identities must be non-negative integers",
+		       (char *)NULL);
+      return TCL_ERROR;
+    }
+    values++;
+    for (j = 0; j < n_order; j++) {
+      switch (order[j]) {
+      case PART_BULK_POS:
+	for (k = 0; k < 3; k++) data[i].pos[k] = *values++;
+	break;
+      case PART_BULK_V:
+	for (k = 0; k < 3; k++) data[i].v[k] = time_step*(*values++);
+	break;
+      case PART_BULK_F:
+	for (k = 0; k < 3; k++) data[i].f[k] = dt2*(*values++);
+	break;
+      case PART_BULK_Q:
+	data[i].q = *values++;
+	break;
+      case PART_BULK_TYPE:
+	data[i].type = (int)*values;
+	if (data[i].type != *values++ || data[i].type < 0) {
+	  free(data);
+	  realloc_doublelist(&list, 0);
+	  Tcl_AppendResult(interp, "invalid particle type", (char *)NULL);
+	  return TCL_ERROR;
+	}
+	break;
+      }
+    }
+  }
+  realloc_doublelist(&list, 0);
+
+  if (place_particles_bulk(n_part, props, data) == TCL_ERROR) {
+    free(data);
+    Tcl_AppendResult(interp, "set particle position first", (char *)NULL);
+    return TCL_ERROR;
+  }
+  free(data);
+
+  return TCL_OK;
+}
+
 int tclcommand_part(ClientData data, Tcl_Interp *interp,
 	 int argc, char **argv)
 {
@@ -2094,6 +2242,8 @@ int tclcommand_part(ClientData data, Tcl_Interp *interp,
     remove_all_particles();
     return TCL_OK;
   }
+  else if (ARG1_IS_S("bulk"))
+    return tclcommand_part_parse_bulk(interp, argc - 1, argv + 1);
 #ifdef EXCLUSIONS
   else if (ARG1_IS_S("delete_exclusions")) {
     if (argc != 2) {
@@ -2194,6 +2344,59 @@ int place_particle(int part, double p[3])
   return retcode;
 }
 
+int place_particles_bulk(int n, int props, ParticleBulkData *data)
+{
+  int i, part, max_part = max_seen_particle, max_type = -1, n_new = 0;
+  int *pnode;
+
+  if (!particle_node)
+    build_particle_node();
+
+  /* check everything first, so that nothing is changed on error */
+  for (i = 0; i < n; i++) {
+    part = data[i].id;
+    if (part < 0)
+      return TCL_ERROR;
+    if (!(props & PART_BULK_POS) &&
+	(part > max_seen_particle || particle_node[part] == -1))
+      return TCL_ERROR;
+    if (part > max_part)
+      max_part = part;
+    if ((props & PART_BULK_TYPE) && data[i].type > max_type)
+      max_type = data[i].type;
+  }
+
+  if (max_type >= 0)
+    make_particle_type_exist(max_type);
+
+  /* master node specific stuff */
+  if (max_part > max_seen_particle) {
+    realloc_particle_node(max_part);
+    /* fill up possible gap */
+    for (i = max_seen_particle + 1; i <= max_part; i++)
+      particle_node[i] = -1;
+  }
+
+  /* new particles by spatial position, the others stay where they
+     are. An id which occurs more than once is only created by the
+     first occurrence, and all of them go to the same node. */
+  pnode = (int *)malloc(n*sizeof(int));
+  for (i = 0; i < n; i++) {
+    part = data[i].id;
+    data[i].new = (particle_node[part] == -1);
+    if (data[i].new) {
+      particle_node[part] = cell_structure.position_to_node(data[i].pos);
+      n_new++;
+    }
+    pnode[i] = particle_node[part];
+  }
+
+  mpi_place_particles_bulk(n, props, data, pnode, n_new, max_part);
+
+  free(pnode);
+  return TCL_OK;
+}
+
 int set_particle_v(int part, double v[3])
 {
   int pnode;
@@ -2690,6 +2893,43 @@ void added_particle(int part)
   }
 }
 
+void added_particles(int n, int max_part)
+{
+  int i;
+
+  n_total_particles += n;
+
+  if (max_part > max_seen_particle) {
+    realloc_local_particles(max_part);
+    for (i = max_seen_particle + 1; i <= max_part; i++)
+      local_particles[i] = NULL;
+    max_seen_particle = max_part;
+  }
+}
+
+void local_place_particles_bulk(int n, int props, ParticleBulkData *data)
+{
+  int i;
+  Particle *p;
+
+  for (i = 0; i < n; i++) {
+    if (props & PART_BULK_POS)
+      local_place_particle(data[i].id, data[i].pos, data[i].new);
+    p = local_particles[data[i].id];
+
+    if (props & PART_BULK_V)
+      memcpy(p->m.v, data[i].v, 3*sizeof(double));
+    if (props & PART_BULK_F)
+      memcpy(p->f.f, data[i].f, 3*sizeof(double));
+#ifdef ELECTROSTATICS
+    if (props & PART_BULK_Q)
+      p->p.q = data[i].q;
+#endif
+    if (props & PART_BULK_TYPE)
+      p->p.type = data[i].type;
+  }
+}
+
 int local_change_bond(int part, int *bond, int delete)
 {
   IntList *bl;
@@ -40,6 +40,19 @@
 /**  bonds_flag "bonds_flag" value for updating particle config with bonding information */
 #define WITH_BONDS 1
 
+/** \name Properties set by \ref place_particles_bulk */
+/*@{*/
+/** set the position, creates new particles */
+#define PART_BULK_POS  1
+/** set the velocity */
+#define PART_BULK_V    2
+/** set the force */
+#define PART_BULK_F    4
+/** set the charge, only with ELECTROSTATICS */
+#define PART_BULK_Q    8
+/** set the type */
+#define PART_BULK_TYPE 16
+/*@}*/
 
 #ifdef EXTERNAL_FORCES
 /** \ref ParticleLocal::ext_flag "ext_flag" value for particle subject to an external force. */
@@ -243,6 +256,25 @@ typedef struct {
   int max;
 } ParticleList;
 
+/** One particle of a \ref place_particles_bulk call. Only the
+    fields selected by the property mask are used. */
+typedef struct {
+  /** identity of the particle */
+  int id;
+  /** set by \ref place_particles_bulk: particle has to be created */
+  int new;
+  /** type */
+  int type;
+  /** position */
+  double pos[3];
+  /** velocity */
+  double v[3];
+  /** force */
+  double f[3];
+  /** charge */
+  double q;
+} ParticleBulkData;
+
 /************************************************
  * exported variables
  ************************************************/
@@ -407,6 +439,21 @@ int get_particle_data(int part, Particle *data);
 */
 int place_particle(int part, double p[3]);
 
+/** Call only on the master node.
+    Create or modify many particles at once. All particles are sent
+    to their nodes in a single collective, and inserted into the
+    cells before \ref on_particle_change is called once. Without
+    \ref PART_BULK_POS, all particles have to exist already.
+    @param n     number of particles
+    @param props which properties to set, an or of the PART_BULK_* flags
+    @param data  the particles. Their \ref ParticleBulkData::new "new" field
+                 is overwritten.
+    @return TCL_OK if all particles could be set, TCL_ERROR if an id
+    is illegal or a particle without position does not exist. In this
+    case, nothing is changed.
+*/
+int place_particles_bulk(int n, int props, ParticleBulkData *data);
+
 /** Call only on the master node: set particle velocity.
     @param part the particle.
     @param v its new velocity.
@@ -609,6 +656,22 @@ void local_place_particle(int part, double p[3], int new);
 */
 void added_particle(int part);
 
+/** Used by \ref mpi_place_particles_bulk, should not be used elsewhere.
+    Called if somewhere n particles were added.
+    @param n        the number of particles added
+    @param max_part the largest identity of the added particles
+*/
+void added_particles(int n, int max_part);
+
+/** Used by \ref mpi_place_particles_bulk, should not be used elsewhere.
+    Set the properties of particles stored on this node, and create
+    the new ones. The positions must be on the local node!
+    @param n     number of particles
+    @param props which properties to set, an or of the PART_BULK_* flags
+    @param data  the particles
+*/
+void local_place_particles_bulk(int n, int props, ParticleBulkData *data);
+
 /** Used by \ref mpi_send_bond, should not be used elsewhere.
     Modify a bond.
     @param part the identity of the particle to change
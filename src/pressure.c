@@ -42,6 +42,13 @@ Observable_stat_non_bonded total_pressure_non_bonded = {0, {NULL,0,0}, 0,0,0};
 Observable_stat_non_bonded p_tensor_non_bonded = {0, {NULL,0,0},0,0,0};
 Observable_stat_non_bonded total_p_tensor_non_bonded = {0, {NULL,0,0},0,0,0};
 
+/** the virials and stress tensors of this node from the last fused
+    force calculation, without the ideal gas part */
+static DoubleList fused_virials = {NULL, 0, 0};
+static DoubleList fused_p_tensor = {NULL, 0, 0};
+static DoubleList fused_virials_non_bonded = {NULL, 0, 0};
+static DoubleList fused_p_tensor_non_bonded = {NULL, 0, 0};
+
 nptiso_struct   nptiso   = {0.0,0.0,0.0,0.0,0.0,0.0,0.0,{0.0,0.0,0.0},{0.0,0.0,0.0},1, 0 ,{NPTGEOM_XDIR, NPTGEOM_YDIR, NPTGEOM_ZDIR},0,0,0};
 
 /************************************************************/
@@ -103,7 +110,8 @@ void init_p_tensor_non_bonded(Observable_stat_non_bonded *stat_nb);
 
 void pressure_calc(double *result, double *result_t, double *result_nb, double *result_t_nb, int v_comp)
 {
-  int n, i;
+  int n, i, c, np, fused;
+  Particle *p;
   double volume = box_l[0]*box_l[1]*box_l[2];
 
   if (!check_obs_calc_initialized())
@@ -119,7 +127,26 @@ void pressure_calc(double *result, double *result_t, double *result_nb, double *
 
   on_observable_calc();
 
-  switch (cell_structure.type) {
+  fused = obs_fused_cached(fused_virials.n == virials.data.n &&
+			   fused_p_tensor.n == p_tensor.data.n &&
+			   fused_virials_non_bonded.n == virials_non_bonded.data_nb.n &&
+			   fused_p_tensor_non_bonded.n == p_tensor_non_bonded.data_nb.n);
+  if (fused) {
+    /* only the ideal gas part is missing */
+    memcpy(virials.data.e, fused_virials.e, virials.data.n*sizeof(double));
+    memcpy(p_tensor.data.e, fused_p_tensor.e, p_tensor.data.n*sizeof(double));
+    memcpy(virials_non_bonded.data_nb.e, fused_virials_non_bonded.e,
+	   virials_non_bonded.data_nb.n*sizeof(double));
+    memcpy(p_tensor_non_bonded.data_nb.e, fused_p_tensor_non_bonded.e,
+	   p_tensor_non_bonded.data_nb.n*sizeof(double));
+    for (c = 0; c < local_cells.n; c++) {
+      p  = local_cells.cell[c]->part;
+      np = local_cells.cell[c]->n;
+      for (i = 0; i < np; i++)
+	add_kinetic_virials(&p[i], v_comp);
+    }
+  }
+  else switch (cell_structure.type) {
   case CELL_STRUCTURE_LAYERED:
     layered_calculate_virials();
     break;
@@ -133,7 +160,8 @@ void pressure_calc(double *result, double *result_t, double *result_nb, double *
   /* rescale kinetic energy (=ideal contribution) */
   virials.data.e[0] /= (3.0*volume*time_step*time_step);
 
-  calc_long_range_virials();
+  if (!fused || !obs_fused_kspace())
+    calc_long_range_virials();
 
   for (n = 1; n < virials.data.n; n++)
     virials.data.e[n] /= 3.0*volume;
@@ -177,11 +205,10 @@ void calc_long_range_virials()
   case COULOMB_P3M: {
     int k;
     P3M_charge_assign();
-    virials.coulomb[1] = P3M_calc_kspace_forces_for_charges(0,1);
+    virials.coulomb[1] = P3M_calc_kspace_forces_and_stress(0, 1, p_tensor.coulomb);
     
     for(k=0;k<3;k++)
       p_tensor.coulomb[9+ k*3 + k] = virials.coulomb[1]/3.;
-    P3M_calc_kspace_stress(p_tensor.coulomb);
     break;
   }
 #endif
@@ -316,6 +343,30 @@ void init_p_tensor_non_bonded(Observable_stat_non_bonded *stat_nb)
   stat_nb->init_status_nb = 0;
 }
 
+/************************************************************/
+void pressure_fused_init()
+{
+  init_virials(&virials);
+  init_p_tensor(&p_tensor);
+  init_virials_non_bonded(&virials_non_bonded);
+  init_p_tensor_non_bonded(&p_tensor_non_bonded);
+}
+
+/** copy the data of an observable */
+static void copy_to_doublelist(DoubleList *dst, DoubleList *src)
+{
+  realloc_doublelist(dst, dst->n = src->n);
+  memcpy(dst->e, src->e, src->n*sizeof(double));
+}
+
+void pressure_fused_store()
+{
+  copy_to_doublelist(&fused_virials, &virials.data);
+  copy_to_doublelist(&fused_p_tensor, &p_tensor.data);
+  copy_to_doublelist(&fused_virials_non_bonded, &virials_non_bonded.data_nb);
+  copy_to_doublelist(&fused_p_tensor_non_bonded, &p_tensor_non_bonded.data_nb);
+}
+
 /************************************************************/
 void master_pressure_calc(int v_comp) {
   if(v_comp)
@@ -329,6 +380,37 @@ void master_pressure_calc(int v_comp) {
   total_p_tensor_non_bonded.init_status_nb = 1+v_comp;
 }
 
+/************************************************************/
+void stress_tensor_calc(double *stress)
+{
+  /* the totals on the master, separate from the ones of analyze
+     pressure, which are only recalculated if invalid */
+  static Observable_stat sample_pressure = {0, {NULL,0,0}, 0,0,0,0};
+  static Observable_stat sample_p_tensor = {0, {NULL,0,0},0,0,0,0};
+  static Observable_stat_non_bonded sample_pressure_non_bonded = {0, {NULL,0,0}, 0,0,0};
+  static Observable_stat_non_bonded sample_p_tensor_non_bonded = {0, {NULL,0,0},0,0,0};
+  int i, j;
+
+  if (this_node != 0) {
+    pressure_calc(NULL, NULL, NULL, NULL, 0);
+    return;
+  }
+
+  init_virials(&sample_pressure);
+  init_p_tensor(&sample_p_tensor);
+  init_virials_non_bonded(&sample_pressure_non_bonded);
+  init_p_tensor_non_bonded(&sample_p_tensor_non_bonded);
+
+  pressure_calc(sample_pressure.data.e, sample_p_tensor.data.e,
+		sample_pressure_non_bonded.data_nb.e, sample_p_tensor_non_bonded.data_nb.e, 0);
+
+  for (j = 0; j < 9; j++) {
+    stress[j] = sample_p_tensor.data.e[j];
+    for (i = 1; i < sample_p_tensor.data.n/9; i++)
+      stress[j] += sample_p_tensor.data.e[9*i + j];
+  }
+}
+
 
 /*****************************************************/
 /* Routines for Local Stress Tensor                  */
@@ -895,8 +977,9 @@ int local_stress_tensor_calc(DoubleList *TensorInBin, int bins[3], int periodic[
   int c, np, n, bin;
   double centre[3];
   Cell *cell;
-  Particle *p1, *p2, **pairs;
+  Particle *p1, *p2;
   Particle *particles;
+  PairList *pl;
   double force[3];
   int k,l;
   int type_num;
@@ -978,15 +1061,12 @@ int local_stress_tensor_calc(DoubleList *TensorInBin, int bins[3], int periodic[
       }
     }
 
-    // Loop cell neighbors
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      pairs = dd.cell_inter[c].nList[n].vList.pair;
-      np    = dd.cell_inter[c].nList[n].vList.n;
-
-      // verlet list loop //
-      for(i=0; i<2*np; i+=2) {
-	p1 = pairs[i];                    // pointer to particle 1
-	p2 = pairs[i+1];                  // pointer to particle 2
+    // verlet list loop //
+    pl = &dd.cell_inter[c].vList;
+    for(i = 0, k = 0; i < pl->n_part; i++) {
+      p1 = &particles[i];                // pointer to particle 1
+      for(n = pl->n_partners[i]; n > 0; n--, k++) {
+	p2 = dd_verlet_partner(&dd.cell_inter[c], pl->pair[k]); // pointer to particle 2
 	if ((incubewithskin(p1->r.p,centre,range)) && (incubewithskin(p2->r.p,centre,range))) {
 	  get_nonbonded_interaction(p1,p2, force);
 	  PTENSOR_TRACE(fprintf(stderr,"%d:Looking at pair %d %d force is %f %f %f\n",this_node,p1->p.identity, p2->p.identity,force[0],force[1], force[2]));
@@ -70,6 +70,22 @@ int tclcallback_npt_p_diff(Tcl_Interp *interp, void *_data);
 */
 void pressure_calc(double *result, double *result_t, double *result_nb, double *result_t_nb, int v_comp);
 
+/** clear the virials and stress tensors of this node before a fused
+    force calculation, which accumulates them, see \ref obs_fused. */
+void pressure_fused_init();
+
+/** keep the virials and stress tensors of this node accumulated by a
+    fused force calculation for \ref pressure_calc. */
+void pressure_fused_store();
+
+/** Calculates the total stress tensor, i.e. the sum of all
+    contributions as in \ref pressure_calc. In contrast to \ref
+    master_pressure_calc, this is called on all nodes, e.g. for
+    sampling during the integration.
+    @param stress on the master, here the 9 components are stored;
+                  ignored on the other nodes */
+void stress_tensor_calc(double *stress);
+
 /** Calculate non bonded energies between a pair of particles.
     @param p1        pointer to particle 1.
     @param p2        pointer to particle 2.
@@ -42,6 +42,11 @@ int rand_w_array[MERS_BIT_RANDOM];
 int random_pointer_1 = -1;
 int random_pointer_2 = -1;
 
+/* Counter based generator */
+int random_backend = RANDOM_BACKEND_RAN1;
+int philox_seed = 0;
+int philox_counter = 0;
+
 /*----------------------------------------------------------------------*/
 
 void init_random(void)
@@ -119,6 +124,15 @@ RandomStatus print_random_stat(void) {
 
 /*----------------------------------------------------------------------*/
 
+int tclcallback_philox_counter(Tcl_Interp *interp, void *_data)
+{
+  philox_counter = *(int *)_data;
+  mpi_bcast_parameter(FIELD_PHILOX_COUNTER);
+  return (TCL_OK);
+}
+
+/*----------------------------------------------------------------------*/
+
 /**  Implementation of the tcl-command
      t_random [{ int \<n\> | seed [\<seed(0)\> ... \<seed(n_nodes-1)\>] | stat [status-list] }]
      <ul>
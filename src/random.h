@@ -25,6 +25,8 @@
     A random generator
 */
 
+#include <stdint.h>
+
 /*----------------------------------------------------------*/
 
 /* Stuff for Franks ran1-generator */
@@ -163,6 +165,131 @@ MDINLINE double gaussian_random(void) {
 
 }
 
+/*----------------------------------------------------------*/
+
+/** \name Counter based generator
+
+    Philox4x32-10 of Salmon et al., "Parallel random numbers: as easy
+    as 1, 2, 3", SC11. The random numbers are a bijective function of
+    a 128 bit counter and a 64 bit key, so that there is no state to
+    share. The thermostats use the counter (id1, id2, \ref
+    philox_counter, stream), where id1 and id2 are the identities of
+    the particle(s) or lattice site the noise is drawn for, and the
+    key (\ref philox_seed, 0). The noise therefore neither depends on
+    the order in which the particles are processed nor on the number
+    of nodes or threads.
+*/
+/*@{*/
+
+/** \ref random_backend value: thermostat noise from \ref d_random */
+#define RANDOM_BACKEND_RAN1   0
+/** \ref random_backend value: thermostat noise from \ref philox_4x32 */
+#define RANDOM_BACKEND_PHILOX 1
+
+/** streams of the counter based generator, one per noise source */
+#define PHILOX_STREAM_LANGEVIN        0
+#define PHILOX_STREAM_LANGEVIN_ROT    1
+#define PHILOX_STREAM_DPD             2
+#define PHILOX_STREAM_TRANS_DPD       3
+#define PHILOX_STREAM_INTER_DPD       4
+#define PHILOX_STREAM_INTER_TRANS_DPD 5
+#define PHILOX_STREAM_LB_COUPLING     6
+#define PHILOX_STREAM_LB_FLUID        7
+
+/** generator used for the thermostat noise, see \ref RANDOM_BACKEND_RAN1 */
+extern int random_backend;
+/** key of the counter based generator. Same on all nodes. */
+extern int philox_seed;
+/** step part of the counter of the counter based generator. Advanced
+    once per force calculation on all nodes, see \ref force_calc. */
+extern int philox_counter;
+
+/** ten rounds of the Philox4x32 bijection, applied in place to the
+    counter ctr. */
+MDINLINE void philox_4x32(uint32_t ctr[4], uint32_t key0, uint32_t key1)
+{
+  int round;
+  uint64_t p0, p1;
+  uint32_t k0 = key0, k1 = key1;
+
+  for (round = 0; round < 10; round++) {
+    p0 = (uint64_t)0xD2511F53 * ctr[0];
+    p1 = (uint64_t)0xCD9E8D57 * ctr[2];
+    ctr[0] = (uint32_t)(p1 >> 32) ^ ctr[1] ^ k0;
+    ctr[1] = (uint32_t)p1;
+    ctr[2] = (uint32_t)(p0 >> 32) ^ ctr[3] ^ k1;
+    ctr[3] = (uint32_t)p0;
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+}
+
+/** four uniform random numbers in (-0.5,0.5) from the counter based
+    generator for the given stream and identities and the current
+    \ref philox_counter. */
+MDINLINE void philox_uniform4(int stream, int id1, int id2, double u[4])
+{
+  int j;
+  uint32_t ctr[4];
+
+  ctr[0] = (uint32_t)id1;
+  ctr[1] = (uint32_t)id2;
+  ctr[2] = (uint32_t)philox_counter;
+  ctr[3] = (uint32_t)stream;
+  philox_4x32(ctr, (uint32_t)philox_seed, 0);
+  for (j = 0; j < 4; j++)
+    u[j] = (ctr[j] + 0.5)*(1.0/4294967296.0) - 0.5;
+}
+
+/** n <= 4 uniform random numbers in (-0.5,0.5) for thermostat noise,
+    either from \ref philox_uniform4 or \ref d_random, depending on
+    \ref random_backend. With \ref RANDOM_BACKEND_RAN1, this is the
+    same sequence as n calls of d_random()-0.5. */
+MDINLINE void noise_uniform(int stream, int id1, int id2, int n, double *u)
+{
+  int j;
+  double r[4];
+
+  if (random_backend == RANDOM_BACKEND_PHILOX) {
+    philox_uniform4(stream, id1, id2, r);
+    for (j = 0; j < n; j++)
+      u[j] = r[j];
+  }
+  else {
+    for (j = 0; j < n; j++)
+      u[j] = d_random() - 0.5;
+  }
+}
+
+/** n <= 4 Gaussian random numbers with unit variance for thermostat
+    noise, either from \ref philox_uniform4 via the Box-Muller
+    transformation or from \ref gaussian_random, depending on \ref
+    random_backend. */
+MDINLINE void noise_gaussian(int stream, int id1, int id2, int n, double *g)
+{
+  int j;
+  double r[4], fac;
+
+  if (random_backend == RANDOM_BACKEND_PHILOX) {
+    philox_uniform4(stream, id1, id2, r);
+    for (j = 0; j < n; j += 2) {
+      fac = sqrt(-2.0*log(r[j] + 0.5));
+      g[j] = fac*cos(2.0*PI*(r[j+1] + 0.5));
+      if (j + 1 < n)
+	g[j+1] = fac*sin(2.0*PI*(r[j+1] + 0.5));
+    }
+  }
+  else {
+    for (j = 0; j < n; j++)
+      g[j] = gaussian_random();
+  }
+}
+
+/** Callback for \ref philox_counter. */
+int tclcallback_philox_counter(Tcl_Interp *interp, void *_data);
+
+/*@}*/
+
 /**  Implementation of the tcl command \ref tclcommand_t_random. Access to the
      parallel random number generator.
 */
@@ -0,0 +1,298 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file soa.c
+    Structure-of-arrays mirror of the cell particle data.
+    For more information see \ref soa.h "soa.h".
+*/
+#include <stdlib.h>
+#include "utils.h"
+#include "soa.h"
+#include "cells.h"
+#include "integrate.h"
+#include "interaction_data.h"
+#include "thermostat.h"
+#include "threads.h"
+
+/** Granularity of the mirror arrays */
+#define SOA_INCREMENT 32
+
+int soa_enabled = 0;
+
+CellSoA *cells_soa = NULL;
+
+char *soa_pair_simple = NULL;
+
+int soa_simple_global = 0;
+
+/** number of mirrors allocated in \ref cells_soa */
+static int n_cells_soa = 0;
+
+/** number of particle types the pair table was built for, -1 if outdated */
+static int soa_pair_table_types = -1;
+
+/************************************************************/
+
+static void realloc_cell_soa(CellSoA *s, int size)
+{
+  if (size <= s->max && (size >= s->max/4 || s->max <= SOA_INCREMENT))
+    return;
+
+  /* grow geometrically, shrink if less than a quarter is used */
+  s->max = SOA_INCREMENT*((size + size/2 + SOA_INCREMENT - 1)/SOA_INCREMENT);
+  s->x    = (double *)realloc(s->x,  s->max*sizeof(double));
+  s->y    = (double *)realloc(s->y,  s->max*sizeof(double));
+  s->z    = (double *)realloc(s->z,  s->max*sizeof(double));
+  s->fx   = (double *)realloc(s->fx, s->max*sizeof(double));
+  s->fy   = (double *)realloc(s->fy, s->max*sizeof(double));
+  s->fz   = (double *)realloc(s->fz, s->max*sizeof(double));
+  s->type = (int *)realloc(s->type,  s->max*sizeof(int));
+#ifdef ELECTROSTATICS
+  s->q    = (double *)realloc(s->q,  s->max*sizeof(double));
+#endif
+#ifdef EXCLUSIONS
+  s->n_excl = (int *)realloc(s->n_excl, s->max*sizeof(int));
+#endif
+}
+
+static void init_cell_soa(CellSoA *s)
+{
+  s->x = s->y = s->z = NULL;
+  s->fx = s->fy = s->fz = NULL;
+  s->type = NULL;
+#ifdef ELECTROSTATICS
+  s->q = NULL;
+#endif
+#ifdef EXCLUSIONS
+  s->n_excl = NULL;
+#endif
+  s->n = s->max = 0;
+}
+
+static void free_cell_soa(CellSoA *s)
+{
+  free(s->x);  free(s->y);  free(s->z);
+  free(s->fx); free(s->fy); free(s->fz);
+  free(s->type);
+#ifdef ELECTROSTATICS
+  free(s->q);
+#endif
+#ifdef EXCLUSIONS
+  free(s->n_excl);
+#endif
+  init_cell_soa(s);
+}
+
+/** copy type, charge and exclusion information of a cell into its mirror. */
+static void fill_cell_soa(Cell *cell, CellSoA *s)
+{
+  Particle *part = cell->part;
+  int i, np = cell->n;
+
+  realloc_cell_soa(s, np);
+  s->n = np;
+  for (i = 0; i < np; i++) {
+    s->type[i] = part[i].p.type;
+#ifdef ELECTROSTATICS
+    s->q[i] = part[i].p.q;
+#endif
+#ifdef EXCLUSIONS
+    s->n_excl[i] = part[i].el.n;
+#endif
+  }
+}
+
+/** check whether a type pair only interacts via plain Lennard-Jones,
+    i. e. all other short range potentials are switched off. */
+static int soa_check_pair_simple(IA_parameters *data)
+{
+#ifdef LENNARD_JONES_GENERIC
+  if (data->LJGEN_cut != 0) return 0;
+#endif
+#ifdef LJ_ANGLE
+  if (data->LJANGLE_cut != 0) return 0;
+#endif
+#ifdef SMOOTH_STEP
+  if (data->SmSt_cut != 0) return 0;
+#endif
+#ifdef HERTZIAN
+  if (data->Hertzian_sig != 0) return 0;
+#endif
+#ifdef BMHTF_NACL
+  if (data->BMHTF_cut != 0) return 0;
+#endif
+#ifdef BUCKINGHAM
+  if (data->BUCK_cut != 0) return 0;
+#endif
+#ifdef MORSE
+  if (data->MORSE_cut != 0) return 0;
+#endif
+#ifdef SOFT_SPHERE
+  if (data->soft_cut != 0) return 0;
+#endif
+#ifdef LJCOS
+  if (data->LJCOS_cut != 0) return 0;
+#endif
+#ifdef LJCOS2
+  if (data->LJCOS2_cut != 0) return 0;
+#endif
+#ifdef TABULATED
+  if (data->TAB_maxval != 0) return 0;
+#endif
+#ifdef GAY_BERNE
+  if (data->GB_cut != 0) return 0;
+#endif
+#ifdef INTER_RF
+  if (data->rf_on != 0) return 0;
+#endif
+  return 1;
+}
+
+static void soa_update_pair_table()
+{
+  int i, j;
+
+  soa_pair_simple = (char *)realloc(soa_pair_simple, n_particle_types*n_particle_types*sizeof(char));
+  for (i = 0; i < n_particle_types; i++)
+    for (j = 0; j < n_particle_types; j++)
+      soa_pair_simple[i*n_particle_types + j] = soa_check_pair_simple(get_ia_param(i, j));
+
+  soa_pair_table_types = n_particle_types;
+}
+
+/** check the methods which need the full particle data in \ref
+    add_non_bonded_pair_force. */
+static int soa_check_global_simple()
+{
+  /* these modify every pair based on the molecule or the position */
+#if defined(ADRESS) || defined(MOL_CUT) || defined(NO_INTRA_NB)
+  return 0;
+#endif
+#ifdef DPD
+  if (thermo_switch & THERMO_DPD) return 0;
+#endif
+#ifdef INTER_DPD
+  if (thermo_switch & THERMO_INTER_DPD) return 0;
+#endif
+#ifdef NPT
+  if (integ_switch == INTEG_METHOD_NPT_ISO) return 0;
+#endif
+#ifdef ELECTROSTATICS
+  if (coulomb.method != COULOMB_NONE
+#ifdef P3M
+      && coulomb.method != COULOMB_P3M
+#endif
+      ) return 0;
+#endif
+#ifdef MAGNETOSTATICS
+  if (coulomb.Dmethod != DIPOLAR_NONE) return 0;
+#endif
+  return 1;
+}
+
+/************************************************************/
+
+void soa_update_layout()
+{
+  int c;
+
+  if (!soa_enabled) {
+    soa_release();
+    return;
+  }
+
+  if (n_cells != n_cells_soa) {
+    for (c = n_cells; c < n_cells_soa; c++)
+      free_cell_soa(&cells_soa[c]);
+    cells_soa = (CellSoA *)realloc(cells_soa, n_cells*sizeof(CellSoA));
+    for (c = n_cells_soa; c < n_cells; c++)
+      init_cell_soa(&cells_soa[c]);
+    n_cells_soa = n_cells;
+  }
+
+  for (c = 0; c < n_cells; c++)
+    fill_cell_soa(&cells[c], &cells_soa[c]);
+}
+
+void soa_update_positions()
+{
+  int c, i, np;
+  Particle *part;
+  CellSoA *s;
+
+  if (n_cells != n_cells_soa)
+    soa_update_layout();
+
+  if (soa_pair_table_types != n_particle_types)
+    soa_update_pair_table();
+  soa_simple_global = soa_check_global_simple();
+
+#ifdef _OPENMP
+#pragma omp parallel for private(part, np, s, i) schedule(dynamic) if(threads_active())
+#endif
+  for (c = 0; c < n_cells; c++) {
+    part = cells[c].part;
+    np   = cells[c].n;
+    s    = &cells_soa[c];
+    /* particles were added or removed without a resort */
+    if (s->n != np)
+      fill_cell_soa(&cells[c], s);
+    for (i = 0; i < np; i++) {
+      s->x[i] = part[i].r.p[0];
+      s->y[i] = part[i].r.p[1];
+      s->z[i] = part[i].r.p[2];
+      s->fx[i] = s->fy[i] = s->fz[i] = 0.0;
+    }
+  }
+}
+
+void soa_flush_forces()
+{
+  int c, i, np;
+  Particle *part;
+  CellSoA *s;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(part, np, s, i) schedule(dynamic) if(threads_active())
+#endif
+  for (c = 0; c < n_cells; c++) {
+    part = cells[c].part;
+    np   = cells[c].n;
+    s    = &cells_soa[c];
+    for (i = 0; i < np; i++) {
+      part[i].f.f[0] += s->fx[i];
+      part[i].f.f[1] += s->fy[i];
+      part[i].f.f[2] += s->fz[i];
+    }
+  }
+}
+
+void soa_invalidate_pair_table()
+{
+  soa_pair_table_types = -1;
+}
+
+void soa_release()
+{
+  int c;
+  for (c = 0; c < n_cells_soa; c++)
+    free_cell_soa(&cells_soa[c]);
+  free(cells_soa);
+  cells_soa = NULL;
+  n_cells_soa = 0;
+}
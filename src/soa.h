@@ -0,0 +1,128 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SOA_H
+#define SOA_H
+/** \file soa.h
+    Structure-of-arrays mirror of the particle data stored in the cells.
+
+    The pair loops only need the position, type, charge and force of a
+    particle, but a \ref Particle carries much more (momentum, local
+    data, bond lists...), so most of each cache line loaded in the
+    pair loop is wasted. If \ref soa_enabled is set (tcl command
+    cellsystem with flag -soa), every cell gets a mirror with
+    contiguous arrays of exactly these quantities, and the short range
+    force loops of the domain decomposition and nsquare cell systems
+    run over the mirror instead of the particle structs.
+
+    The layout of the mirror (number of particles, type, charge) is
+    rebuilt in \ref cells_resort_particles, the positions are copied
+    from the particles after the ghost update, i. e. right before the
+    short range force calculation. Forces of pairs that can be
+    evaluated on the mirror alone (see \ref soa_pair_simple) are
+    accumulated in the mirror and added to the particle forces by
+    \ref soa_flush_forces, all other pairs fall back to \ref
+    add_non_bonded_pair_force. Energies and virials always use the
+    particle structs.
+*/
+
+#include "cells.h"
+#include "interaction_data.h"
+
+/************************************************
+ * data types
+ ************************************************/
+
+/** Structure-of-arrays mirror of one cell. Entry i corresponds to
+    particle i of the cell. */
+typedef struct {
+  /** positions */
+  double *x, *y, *z;
+  /** forces accumulated on the mirror */
+  double *fx, *fy, *fz;
+  /** particle types */
+  int *type;
+#ifdef ELECTROSTATICS
+  /** charges */
+  double *q;
+#endif
+#ifdef EXCLUSIONS
+  /** length of the exclusion list of the particle */
+  int *n_excl;
+#endif
+  /** number of particles in the mirror */
+  int n;
+  /** number of particles that fit in until a resize is needed */
+  int max;
+} CellSoA;
+
+/************************************************
+ * exported variables
+ ************************************************/
+
+/** If non-zero, the short range force loops use the cell mirrors. */
+extern int soa_enabled;
+
+/** the mirrors, one per cell in \ref cells::cells */
+extern CellSoA *cells_soa;
+
+/** Pair type table, n_particle_types^2 entries. Non-zero if the
+    interaction between the two types is plain Lennard-Jones (or
+    nothing), so that it can be evaluated on the mirror alone. */
+extern char *soa_pair_simple;
+
+/** Non-zero if no global method (DPD, NpT, Coulomb methods other than
+    P3M...) needs the full particle data in the pair loop. */
+extern int soa_simple_global;
+
+/************************************************
+ * functions
+ ************************************************/
+
+/** get the mirror of a cell. */
+MDINLINE CellSoA *cell_soa(Cell *cell)
+{
+  return &cells_soa[cell - cells];
+}
+
+/** check whether the pair interaction between types t1 and t2 can be
+    evaluated on the mirror alone. */
+MDINLINE int soa_simple_types(int t1, int t2)
+{
+  return soa_simple_global && soa_pair_simple[t1*n_particle_types + t2];
+}
+
+/** Rebuild the mirrors of all local and ghost cells from the particle
+    data. Called from \ref cells_resort_particles. */
+void soa_update_layout();
+
+/** Copy the particle positions into the mirrors and clear the mirror
+    forces. Called right before the short range force calculation. */
+void soa_update_positions();
+
+/** Add the forces accumulated in the mirrors to the particles. */
+void soa_flush_forces();
+
+/** Mark the pair type table as outdated. Called whenever the short
+    range interactions change. */
+void soa_invalidate_pair_table();
+
+/** Free all mirrors. */
+void soa_release();
+
+#endif
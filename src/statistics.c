@@ -26,6 +26,10 @@
 #include <string.h>
 #include "utils.h"
 #include "statistics.h"
+#include "statistics_local.h"
+#include "statistics_rdf.h"
+#include "statistics_sf.h"
+#include "statistics_uf.h"
 #include "statistics_chain.h"
 #include "statistics_molecule.h"
 #include "statistics_cluster.h"
@@ -146,113 +150,6 @@ double mindist(IntList *set1, IntList *set2)
   return mindist;
 }
 
-void merge_aggregate_lists(int *head_list, int *agg_id_list, int p1molid, int p2molid, int *link_list)
-{
-    int target1, target2, head_p1;
-    /* merge list containing p2molid into list containing p1molid*/
-    target1=head_list[agg_id_list[p2molid]];
-    head_list[agg_id_list[p2molid]]=-2;
-    head_p1=head_list[agg_id_list[p1molid]];
-    head_list[agg_id_list[p1molid]]=target1;
-    agg_id_list[target1]=agg_id_list[p1molid];
-    target2=link_list[target1];
-    while(target2 != -1) {
-	target1=target2;
-	target2=link_list[target1];
-	agg_id_list[target1]=agg_id_list[p1molid];
-    }
-    agg_id_list[target1]=agg_id_list[p1molid];
-    link_list[target1]=head_p1;
-}
-
-int aggregation(double dist_criteria2, int min_contact, int s_mol_id, int f_mol_id, int *head_list, int *link_list, int *agg_id_list, int *agg_num, int *agg_size, int *agg_max, int *agg_min, int *agg_avg, int *agg_std, int charge)
-{
-  int c, np, n, i;
-  Particle *p1, *p2, **pairs;
-  double dist2;
-  int target1;
-  int p1molid, p2molid;
-  int *contact_num, ind;
-
-  if (min_contact > 1) {
-    contact_num = (int *) malloc(n_molecules*n_molecules *sizeof(int));
-    for (i = 0; i < n_molecules *n_molecules; i++) contact_num[i]=0;
-  } else {
-    contact_num = (int *) 0; /* Just to keep the compiler happy */
-  }
-
-  on_observable_calc();
-  build_verlet_lists();
-
-  for (i = s_mol_id; i <= f_mol_id; i++) {
-    head_list[i]=i;
-    link_list[i]=-1;
-    agg_id_list[i]=i;
-    agg_size[i]=0;
-  }
-  
-  /* Loop local cells */
-  for (c = 0; c < local_cells.n; c++) {
-    /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      pairs = dd.cell_inter[c].nList[n].vList.pair;
-      np    = dd.cell_inter[c].nList[n].vList.n;
-      /* verlet list loop */
-      for(i=0; i<2*np; i+=2) {
-	p1 = pairs[i];                    /* pointer to particle 1 */
-	p2 = pairs[i+1];                  /* pointer to particle 2 */
-	p1molid = p1->p.mol_id;
-	p2molid = p2->p.mol_id;
-	if (((p1molid <= f_mol_id) && (p1molid >= s_mol_id)) && ((p2molid <= f_mol_id) && (p2molid >= s_mol_id))) {
-	  if (agg_id_list[p1molid] != agg_id_list[p2molid]) {
-	    dist2 = min_distance2(p1->r.p, p2->r.p);
-
-#ifdef ELECTROSTATICS
-	    if (charge && (p1->p.q * p2->p.q >= 0)) {continue;}
-#endif
-	    if (dist2 < dist_criteria2) {
-	      if ( p1molid > p2molid ) { ind=p1molid*n_molecules + p2molid;} 
-	      else { ind=p2molid*n_molecules +p1molid;}
-	      if (min_contact > 1) {
-		contact_num[ind] ++;
-		if (contact_num[ind] >= min_contact) {
-		    merge_aggregate_lists( head_list, agg_id_list, p1molid, p2molid, link_list);				    
-		}
-	      } else {
-		  merge_aggregate_lists( head_list, agg_id_list, p1molid, p2molid, link_list);				    
-	      }
-	    }
-	  }
-	}
-      }
-    }
-  }
-  
-  /* count number of aggregates 
-     find aggregate size
-     find max and find min size, and std */
-  for (i = s_mol_id ; i <= f_mol_id ; i++) {
-    if (head_list[i] != -2) {
-      (*agg_num)++;
-      agg_size[*agg_num -1]++;
-      target1= head_list[i];
-      while( link_list[target1] != -1) {
-	target1= link_list[target1];
-	agg_size[*agg_num -1]++;
-      }
-    }
-  }
-  
-  for (i = 0 ; i < *agg_num; i++) {
-    *agg_avg += agg_size[i];
-    *agg_std += agg_size[i] * agg_size[i];
-    if (*agg_min > agg_size[i]) { *agg_min = agg_size[i]; }
-    if (*agg_max < agg_size[i]) { *agg_max = agg_size[i]; }
-  }
-  
-  return 0;
-}
-
 /** Calculate momentum of all particles in the local domain
  * @param result Result for this processor (Output)
  */
@@ -304,69 +201,50 @@ void momentum_calc(double *momentum)
 
 void centermass(int type, double *com)
 {
-  int i, j;
-  double M = 0.0;
-  com[0]=com[1]=com[2]=0.;
-   	
-  updatePartCfg(WITHOUT_BONDS);
-  for (j=0; j<n_total_particles; j++) {
-    if ((partCfg[j].p.type == type) || (type == -1)) {
-      for (i=0; i<3; i++) {
-      	com[i] += partCfg[j].r.p[i]*PMASS(partCfg[j]);
-      }
-      M += PMASS(partCfg[j]);
-    }
-  }
-  
+  int i;
+  double *res;
+  LocalObservableParams par;
+
+  init_local_observable_params(&par);
+  local_observable_select_type(&par, 0, type);
+  mpi_local_observable(LOCAL_OBS_COM, &par, &res);
   for (i=0; i<3; i++) {
-    com[i] /= M;
+    com[i] = res[i]/res[3];
   }
-  return;
+  free(res);
 }
 
-void centermass_vel(int type, double *com)
+int centermass_vel(int type, double *com)
 {
   /*center of mass velocity scaled with time_step*/
-  int i, j;
-  int count = 0;
-  com[0]=com[1]=com[2]=0.;
-
-  updatePartCfg(WITHOUT_BONDS);
-  for (j=0; j<n_total_particles; j++) {
-    if (type == partCfg[j].p.type) {
-      for (i=0; i<3; i++) {
-      	com[i] += partCfg[j].m.v[i];
-      }
-      count++;
-    }
-  }
-
+  int i, count;
+  double *res;
+  LocalObservableParams par;
+
+  init_local_observable_params(&par);
+  local_observable_select_type(&par, 0, type);
+  mpi_local_observable(LOCAL_OBS_COM_VEL, &par, &res);
+  count = (int)res[3];
   for (i=0; i<3; i++) {
-    com[i] /= count;
+    com[i] = res[i]/count;
   }
-  return;
+  free(res);
+  return count;
 }
 
 void angularmomentum(int type, double *com)
 {
-  int i, j;
-  double tmp[3];
-  double pre_factor;
-  com[0]=com[1]=com[2]=0.;
+  int i;
+  double *res;
+  LocalObservableParams par;
 
-  updatePartCfg(WITHOUT_BONDS);
-  for (j=0; j<n_total_particles; j++) 
-  {
-    if (type == partCfg[j].p.type) 
-    {
-      vector_product(partCfg[j].r.p,partCfg[j].m.v,tmp);
-      pre_factor=PMASS(partCfg[j]);
-      for (i=0; i<3; i++) {
-        com[i] += tmp[i]*pre_factor;
-      }
-    }
+  init_local_observable_params(&par);
+  local_observable_select_type(&par, 0, type);
+  mpi_local_observable(LOCAL_OBS_ANGMOM, &par, &res);
+  for (i=0; i<3; i++) {
+    com[i] = res[i];
   }
-  return;
+  free(res);
 }
 
 void  momentofinertiamatrix(int type, double *MofImatrix)
@@ -618,309 +496,151 @@ void calc_part_distribution(int *p1_types, int n_p1, int *p2_types, int n_p2,
 			    double r_min, double r_max, int r_bins, int log_flag, 
 			    double *low, double *dist)
 {
-  int i,j,t1,t2,ind,cnt=0;
-  double inv_bin_width=0.0;
-  double min_dist,min_dist2=0.0,start_dist2,act_dist2;
-
-  start_dist2 = SQR(box_l[0] + box_l[1] + box_l[2]);
-  /* bin preparation */
-  *low = 0.0;
-  for(i=0;i<r_bins;i++) dist[i] = 0.0;
-  if(log_flag == 1) inv_bin_width = (double)r_bins/(log(r_max)-log(r_min));
-  else              inv_bin_width = (double)r_bins / (r_max-r_min);
+  int i;
+  double *res, cnt;
+  LocalObservableParams par;
+
+  init_local_observable_params(&par);
+  local_observable_select_types(&par, 0, p1_types, n_p1);
+  local_observable_select_types(&par, 1, p2_types, n_p2);
+  par.min = r_min;
+  par.max = r_max;
+  par.bins = r_bins;
+  par.log_flag = log_flag;
+  mpi_local_observable(LOCAL_OBS_MIN_DIST, &par, &res);
 
-  /* particle loop: p1_types*/
-  for(i=0; i<n_total_particles; i++) {
-    for(t1=0; t1<n_p1; t1++) {
-      if(partCfg[i].p.type == p1_types[t1]) {
-	min_dist2 = start_dist2;
-	/* particle loop: p2_types*/
-	for(j=0; j<n_total_particles; j++) {
-	  if(j != i) {
-	    for(t2=0; t2<n_p2; t2++) {
-	      if(partCfg[j].p.type == p2_types[t2]) {
-		act_dist2 =  min_distance2(partCfg[i].r.p, partCfg[j].r.p);
-		if(act_dist2 < min_dist2) { min_dist2 = act_dist2; }
-	      }
-	    }
-	  }
-	}
-	min_dist = sqrt(min_dist2);
-	if(min_dist <= r_max) {
-	  if(min_dist >= r_min) {
-	    /* calculate bin index */
-	    if(log_flag == 1) ind = (int) ((log(min_dist) - log(r_min))*inv_bin_width);
-	    else              ind = (int) ((min_dist - r_min)*inv_bin_width);
-	    if(ind >= 0 && ind < r_bins) {
-	      dist[ind] += 1.0;
-	    }
-	  }
-	  else {
-	    *low += 1.0;
-	  }
-	}
-	cnt++;    
-      }
-    }
-  }
-  
   /* normalization */
-  *low /= (double)cnt;
-  for(i=0;i<r_bins;i++) dist[i] /= (double)cnt;
+  cnt = res[r_bins + 1];
+  *low = res[r_bins]/cnt;
+  for(i=0;i<r_bins;i++) dist[i] = res[i]/cnt;
+  free(res);
 }
 
-void tclcommand_analyze_print_vel_distr(Tcl_Interp *interp, int type,int bins,double given_max)
+void calc_density_profile(int *types, int n_types, int dir, int bins, double *rho)
 {
-   int i,j,p_count,dist_count,ind;
-   double min,max,bin_width,inv_bin_width,com[3],vel;
-   long distribution[bins];
-   char buffer[2*TCL_DOUBLE_SPACE+TCL_INTEGER_SPACE+256];
+  int i;
+  double *res, bin_volume;
+  LocalObservableParams par;
 
-   max=given_max*time_step;
-   min=-given_max*time_step;
-   p_count=0;
-   for(i=0; i<bins; i++) {distribution[i]=0;}
+  init_local_observable_params(&par);
+  local_observable_select_types(&par, 0, types, n_types);
+  par.dir = dir;
+  par.bins = bins;
+  mpi_local_observable(LOCAL_OBS_DENSITY, &par, &res);
 
-   centermass_vel(type,com);
+  bin_volume = box_l[0]*box_l[1]*box_l[2]/bins;
+  for(i=0;i<bins;i++) rho[i] = res[i]/bin_volume;
+  free(res);
+}
 
-   for (i=0;i<n_total_particles;i++)
-   {
-      if (partCfg[i].p.type==type)
-      {
-        p_count++;
-        for (j=0;j<3;j++)
-        {
-           vel=partCfg[i].m.v[j] - com[j];
-           if (min > vel ){min = vel;}
-           if (max < vel ){max = vel;}
-        }
-      }
-   }
+void tclcommand_analyze_print_vel_distr(Tcl_Interp *interp, int type,int bins,double given_max)
+{
+   int i;
+   double min,max,bin_width,vel,dist_count;
+   double *res;
+   char buffer[2*TCL_DOUBLE_SPACE+TCL_INTEGER_SPACE+256];
+   LocalObservableParams par;
 
-   if (p_count==0) {return;}
+   init_local_observable_params(&par);
+   local_observable_select_type(&par, 0, type);
+   if (centermass_vel(type, par.shift) == 0) {return;}
 
-   if ( (-min) > max ) {
-      max = -min;
-   }
-   else{
-      min = -max;
-   }
+   /* symmetric range that includes all velocities */
+   mpi_local_observable(LOCAL_OBS_VEL_MAX, &par, &res);
+   max = dmax(given_max*time_step, res[0]);
+   min = -max;
+   free(res);
 
-   bin_width     = (max-min) / (double)bins;
-   inv_bin_width = 1.0 / bin_width;
-   dist_count=0;
-   for (i=0;i<n_total_particles;i++)
-   {
-     if (partCfg[i].p.type==type)
-     {
-        for (j=0;j<3;j++)
-        {
-          vel= partCfg[i].m.v[j] - com[j];
-          ind = (int) ( (vel - min)*inv_bin_width );
-          distribution[ind]++;
-          dist_count++;
-        }
-     }
-   }
-   
+   par.min  = min;
+   par.max  = max;
+   par.bins = bins;
+   mpi_local_observable(LOCAL_OBS_VEL_DISTR, &par, &res);
+   dist_count = res[bins];
+
+   bin_width = (max-min) / (double)bins;
    vel=min + bin_width/2.0;
    Tcl_AppendResult(interp, " {\n", (char *)NULL);
    for(i=0; i<bins; i++) {
-      sprintf(buffer,"%f %f",vel/time_step,distribution[i]/(double)dist_count);
+      sprintf(buffer,"%f %f",vel/time_step,res[i]/dist_count);
       Tcl_AppendResult(interp, "{ ",buffer," }\n", (char *)NULL);
       vel += bin_width;
    }
    Tcl_AppendResult(interp, "}\n", (char *)NULL);
+   free(res);
 }
 
 void calc_rdf(int *p1_types, int n_p1, int *p2_types, int n_p2, 
 	      double r_min, double r_max, int r_bins, double *rdf)
 {
-  long int cnt=0;
-  int i,j,t1,t2,ind;
-  int mixed_flag=0,start;
-  double inv_bin_width=0.0,bin_width=0.0, dist;
-  double volume, bin_volume, r_in, r_out;
-
-  if(n_p1 == n_p2) {
-    for(i=0;i<n_p1;i++) 
-      if( p1_types[i] != p2_types[i] ) mixed_flag=1;
-  }
-  else mixed_flag=1;
-
-  bin_width     = (r_max-r_min) / (double)r_bins;
-  inv_bin_width = 1.0 / bin_width;
-  for(i=0;i<r_bins;i++) rdf[i] = 0.0;
-  /* particle loop: p1_types*/
+  int i;
+  double *res, cnt;
+  LocalObservableParams par;
+
+  init_local_observable_params(&par);
+  local_observable_select_types(&par, 0, p1_types, n_p1);
+  local_observable_select_types(&par, 1, p2_types, n_p2);
+  par.min = r_min;
+  par.max = r_max;
+  par.bins = r_bins;
+  mpi_local_observable(LOCAL_OBS_RDF, &par, &res);
+
+  /* number of pairs, including the ones beyond r_max */
+  if (rdf_same_types(p1_types, n_p1, p2_types, n_p2))
+    cnt = 0.5*res[r_bins]*(res[r_bins] - 1);
+  else
+    cnt = res[r_bins]*res[r_bins + 1];
+
+  for(i=0; i<r_bins; i++) rdf[i] = res[i];
+  rdf_normalize(r_min, r_max, r_bins, cnt, rdf);
+  free(res);
+}
+
+/** RDF averaged over the last n_conf stored configurations. The
+    configurations are distributed over the nodes. */
+static void calc_rdf_configs(int *p1_types, int n_p1, int *p2_types, int n_p2,
+			     double r_min, double r_max, int r_bins, double *rdf, int n_conf,
+			     int intermol)
+{
+  int i, *types, *mol;
+  RdfParams par;
+
+  par.n_types[0] = n_p1;
+  memcpy(par.types[0], p1_types, n_p1*sizeof(int));
+  par.n_types[1] = n_p2;
+  memcpy(par.types[1], p2_types, n_p2*sizeof(int));
+  par.r_min = r_min;
+  par.r_max = r_max;
+  par.bins = r_bins;
+  par.intermol = intermol;
+  par.n_part = n_total_particles;
+  par.n_conf = n_conf;
+
+  types = malloc(n_total_particles*sizeof(int));
+  mol   = malloc(n_total_particles*sizeof(int));
   for(i=0; i<n_total_particles; i++) {
-    for(t1=0; t1<n_p1; t1++) {
-      if(partCfg[i].p.type == p1_types[t1]) {
-	/* distinguish mixed and identical rdf's */
-	if(mixed_flag == 1) start = 0;
-	else                start = (i+1);
-	/* particle loop: p2_types*/
-	for(j=start; j<n_total_particles; j++) {
-	  for(t2=0; t2<n_p2; t2++) {
-	    if(partCfg[j].p.type == p2_types[t2]) {
-	      dist = min_distance(partCfg[i].r.p, partCfg[j].r.p);
-	      if(dist > r_min && dist < r_max) {
-		ind = (int) ( (dist - r_min)*inv_bin_width );
-		rdf[ind]++;
-	      }
-	      cnt++;
-	    }
-	  }
-	}
-      }
-    }
+    types[i] = partCfg[i].p.type;
+    mol[i]   = partCfg[i].p.mol_id;
   }
 
-  /* normalization */
-  volume = box_l[0]*box_l[1]*box_l[2];
+  mpi_rdf_configs(&par, types, mol, rdf);
+
   for(i=0; i<r_bins; i++) {
-    r_in       = i*bin_width + r_min; 
-    r_out      = r_in + bin_width;
-    bin_volume = (4.0/3.0) * PI * ((r_out*r_out*r_out) - (r_in*r_in*r_in));
-    rdf[i] *= volume / (bin_volume * cnt);
+    rdf[i] /= n_conf;
   }
+  free(mol);
+  free(types);
 }
 
 void calc_rdf_av(int *p1_types, int n_p1, int *p2_types, int n_p2,
 		 double r_min, double r_max, int r_bins, double *rdf, int n_conf)
 {
-  long int cnt=0;
-  int i,j,k,l,t1,t2,ind,cnt_conf=1;
-  int mixed_flag=0,start;
-  double inv_bin_width=0.0,bin_width=0.0, dist;
-  double volume, bin_volume, r_in, r_out;
-  double *rdf_tmp, p1[3],p2[3];
-
-  rdf_tmp = malloc(r_bins*sizeof(double));
-
-  if(n_p1 == n_p2) {
-    for(i=0;i<n_p1;i++)
-      if( p1_types[i] != p2_types[i] ) mixed_flag=1;
-  }
-  else mixed_flag=1;
-  bin_width     = (r_max-r_min) / (double)r_bins;
-  inv_bin_width = 1.0 / bin_width;
-  volume = box_l[0]*box_l[1]*box_l[2];
-  for(l=0;l<r_bins;l++) rdf_tmp[l]=rdf[l] = 0.0;
-
-  while(cnt_conf<=n_conf) {
-    for(l=0;l<r_bins;l++) rdf_tmp[l]=0.0;
-    cnt=0;
-    k=n_configs-cnt_conf;
-    for(i=0; i<n_total_particles; i++) {
-      for(t1=0; t1<n_p1; t1++) {
-	if(partCfg[i].p.type == p1_types[t1]) {
-	  // distinguish mixed and identical rdf's
-	  if(mixed_flag == 1) start = 0;
-	  else                start = (i+1);
-	  //particle loop: p2_types
-	  for(j=start; j<n_total_particles; j++) {
-	    for(t2=0; t2<n_p2; t2++) {
-	      if(partCfg[j].p.type == p2_types[t2]) {
-		p1[0]=configs[k][3*i  ];p1[1]=configs[k][3*i+1];p1[2]=configs[k][3*i+2];
-		p2[0]=configs[k][3*j  ];p2[1]=configs[k][3*j+1];p2[2]=configs[k][3*j+2];
-		dist =min_distance(p1, p2);
-		if(dist > r_min && dist < r_max) {
-		  ind = (int) ( (dist - r_min)*inv_bin_width );
-		  rdf_tmp[ind]++;
-		}
-		cnt++;
-	      }
-	    }
-	  }
-	}
-      }
-    }
-    // normalization
-  
-    for(i=0; i<r_bins; i++) {
-      r_in       = i*bin_width + r_min;
-      r_out      = r_in + bin_width;
-      bin_volume = (4.0/3.0) * PI * ((r_out*r_out*r_out) - (r_in*r_in*r_in));
-      rdf[i] += rdf_tmp[i]*volume / (bin_volume * cnt);
-    }
-
-    cnt_conf++;
-  } //cnt_conf loop
-  for(i=0; i<r_bins; i++) {
-    rdf[i] /= (cnt_conf-1);
-  }
-  free(rdf_tmp);
-
+  calc_rdf_configs(p1_types, n_p1, p2_types, n_p2, r_min, r_max, r_bins, rdf, n_conf, 0);
 }
 
 void calc_rdf_intermol_av(int *p1_types, int n_p1, int *p2_types, int n_p2,
 			  double r_min, double r_max, int r_bins, double *rdf, int n_conf)
 {
-  int i,j,k,l,t1,t2,ind,cnt=0,cnt_conf=1;
-  int mixed_flag=0,start;
-  double inv_bin_width=0.0,bin_width=0.0, dist;
-  double volume, bin_volume, r_in, r_out;
-  double *rdf_tmp, p1[3],p2[3];
-
-  rdf_tmp = malloc(r_bins*sizeof(double));
-
-  if(n_p1 == n_p2) {
-    for(i=0;i<n_p1;i++)
-      if( p1_types[i] != p2_types[i] ) mixed_flag=1;
-  }
-  else mixed_flag=1;
-  bin_width     = (r_max-r_min) / (double)r_bins;
-  inv_bin_width = 1.0 / bin_width;
-  volume = box_l[0]*box_l[1]*box_l[2];
-  for(l=0;l<r_bins;l++) rdf_tmp[l]=rdf[l] = 0.0;
-
-  while(cnt_conf<=n_conf) {
-    for(l=0;l<r_bins;l++) rdf_tmp[l]=0.0;
-    cnt=0;
-    k=n_configs-cnt_conf;
-    for(i=0; i<n_total_particles; i++) {
-      for(t1=0; t1<n_p1; t1++) {
-	if(partCfg[i].p.type == p1_types[t1]) {
-	  // distinguish mixed and identical rdf's
-	  if(mixed_flag == 1) start = 0;
-	  else                start = (i+1);
-	  //particle loop: p2_types
-	  for(j=start; j<n_total_particles; j++) {
-	    for(t2=0; t2<n_p2; t2++) {
-	      if(partCfg[j].p.type == p2_types[t2]) {
-		/*see if particles i and j belong to different molecules*/
-		if(partCfg[i].p.mol_id!=partCfg[j].p.mol_id) {
-		  p1[0]=configs[k][3*i  ];p1[1]=configs[k][3*i+1];p1[2]=configs[k][3*i+2];
-		  p2[0]=configs[k][3*j  ];p2[1]=configs[k][3*j+1];p2[2]=configs[k][3*j+2];
-		  dist =min_distance(p1, p2);
-		  if(dist > r_min && dist < r_max) {
-		    ind = (int) ( (dist - r_min)*inv_bin_width );
-		    rdf_tmp[ind]++;
-		  }
-		  cnt++;
-		}
-	      }
-	    }
-	  }
-	}
-      }
-    }
-    // normalization
-
-    for(i=0; i<r_bins; i++) {
-      r_in       = i*bin_width + r_min;
-      r_out      = r_in + bin_width;
-      bin_volume = (4.0/3.0) * PI * ((r_out*r_out*r_out) - (r_in*r_in*r_in));
-      rdf[i] += rdf_tmp[i]*volume / (bin_volume * cnt);
-    }
-
-    cnt_conf++;
-  } //cnt_conf loop
-  for(i=0; i<r_bins; i++) {
-    rdf[i] /= (cnt_conf-1);
-  }
-  free(rdf_tmp);
-
+  calc_rdf_configs(p1_types, n_p1, p2_types, n_p2, r_min, r_max, r_bins, rdf, n_conf, 1);
 }
 
 /*addes this line*/
@@ -1483,6 +1203,7 @@ void invalidate_obs()
 {
   total_energy.init_status = 0;
   total_pressure.init_status = 0;
+  obs_fused_invalidate();
 }
 
 
@@ -2070,49 +1791,22 @@ static int tclcommand_analyze_parse_lipid_orient_order(Tcl_Interp *interp, int a
 
 static int tclcommand_analyze_parse_aggregation(Tcl_Interp *interp, int argc, char **argv)
 {
-  /* 'analyze centermass [<type>]' */
+  /* 'analyze aggregation <dist_criteria> <start mol_id> <finish mol_id> [<min_contact>] [<charge_criteria>]' */
   char buffer[256 + 3*TCL_INTEGER_SPACE + 2*TCL_DOUBLE_SPACE];
-  int i, target1;
-  int *agg_id_list;
-  double dist_criteria, dist_criteria2;
-  int charge_criteria, min_contact, *head_list, *link_list;
-  int agg_num =0, *agg_size, agg_min= n_molecules, agg_max = 0,  agg_std = 0, agg_avg = 0; 
+  int i, j, m;
+  double dist_criteria;
+  int charge_criteria, min_contact;
+  int agg_num, *agg_size, *agg_members, agg_min, agg_max = 0, agg_std = 0, agg_avg = 0;
   float fagg_avg;
   int s_mol_id, f_mol_id;
-
-  agg_id_list = (int *) malloc(n_molecules *sizeof(int));
-  head_list =  (int *) malloc(n_molecules *sizeof(int));
-  link_list = (int *) malloc(n_molecules *sizeof(int));
-  agg_size = (int *) malloc(n_molecules *sizeof(int));
+  ClusterParams par;
 
   /* parse arguments */
-  if (argc < 3) {
-    Tcl_AppendResult(interp, "usage: analyze aggregation <dist_criteria> <start mol_id> <finish mol_id> [<min_contact>] [<charge_criteria>]", (char *)NULL);
-    return (TCL_ERROR);
-  }
-
-  if (!ARG_IS_D(0,dist_criteria)) {
-    Tcl_ResetResult(interp);
-    Tcl_AppendResult(interp, "usage: analyze aggregation <dist_criteria> <start mol_id> <finish mol_id> [<min_contact>] [<charge_criteria>]", (char *)NULL);
-    return (TCL_ERROR);
-  }
-  dist_criteria2 = dist_criteria * dist_criteria;
-
-  if (!ARG_IS_I(1,s_mol_id)) {
-    Tcl_ResetResult(interp);
-    Tcl_AppendResult(interp, "usage: analyze aggregation <dist_criteria> <start mol_id> <finish mol_id> [<min_contact>] [<charge_criteria>]", (char *)NULL);
-    return (TCL_ERROR);
-  }
-  if (!ARG_IS_I(2,f_mol_id)) {
+  if (argc < 3 || !ARG_IS_D(0,dist_criteria) || !ARG_IS_I(1,s_mol_id) || !ARG_IS_I(2,f_mol_id)) {
     Tcl_ResetResult(interp);
     Tcl_AppendResult(interp, "usage: analyze aggregation <dist_criteria> <start mol_id> <finish mol_id> [<min_contact>] [<charge_criteria>]", (char *)NULL);
     return (TCL_ERROR);
   }
-  
-  if (n_nodes > 1) {
-    Tcl_AppendResult(interp, "aggregation can only be calculated on a single processor", (char *)NULL);
-    return TCL_ERROR;
-  }
 
   if (cell_structure.type != CELL_STRUCTURE_DOMDEC) {
     Tcl_AppendResult(interp, "aggregation can only be calculated with the domain decomposition cell system", (char *)NULL);
@@ -2124,13 +1818,12 @@ static int tclcommand_analyze_parse_aggregation(Tcl_Interp *interp, int argc, ch
     return TCL_ERROR;
   }
 
-  if ( max_range_non_bonded2 < dist_criteria2) {
-    Tcl_AppendResult(interp, "dist_criteria is larger than max_range_non_bonded.", (char *)NULL);
+  if (dist_criteria > cluster_max_dist()) {
+    Tcl_AppendResult(interp, "dist_criteria is larger than the cell size.", (char *)NULL);
     return TCL_ERROR;    
-    
   }
 
-  if (argc == 4) {
+  if (argc >= 4) {
       if (!ARG_IS_I(3,min_contact)) {
 	  Tcl_ResetResult(interp);
 	  Tcl_AppendResult(interp, "usage: analyze aggregation <dist_criteria> <start mol_id> <finish mol_id> [<min_contact>] [<charge_criteria>]", (char *)NULL);
@@ -2140,7 +1833,7 @@ static int tclcommand_analyze_parse_aggregation(Tcl_Interp *interp, int argc, ch
       min_contact = 1;
   }
 
-  if (argc == 5) {
+  if (argc >= 5) {
       if (!ARG_IS_I(4, charge_criteria)) {
 	  Tcl_ResetResult(interp);
 	  Tcl_AppendResult(interp, "usage: analyze aggregation <dist_criteria> <start mol_id> <finish mol_id> [<min_contact>] [<charge_criteria>]", (char *)NULL);
@@ -2150,34 +1843,40 @@ static int tclcommand_analyze_parse_aggregation(Tcl_Interp *interp, int argc, ch
       charge_criteria = 0;
   }
 
+  par.mode        = CLUSTER_MOLECULES;
+  par.type        = -1;
+  par.mol_start   = s_mol_id;
+  par.mol_end     = f_mol_id;
+  par.dist        = dist_criteria;
+  par.min_contact = min_contact;
+  par.charge      = charge_criteria;
+  par.n_keys      = f_mol_id + 1;
+  agg_num = mpi_cluster_analysis(&par, &agg_size, &agg_members);
 
-  aggregation(dist_criteria2, min_contact, s_mol_id, f_mol_id, head_list, link_list, agg_id_list, 
-	      &agg_num, agg_size, &agg_max, &agg_min, &agg_avg, &agg_std, charge_criteria);
+  agg_min = n_molecules;
+  for (i = 0 ; i < agg_num; i++) {
+    agg_avg += agg_size[i];
+    agg_std += agg_size[i] * agg_size[i];
+    if (agg_min > agg_size[i]) { agg_min = agg_size[i]; }
+    if (agg_max < agg_size[i]) { agg_max = agg_size[i]; }
+  }
 
   fagg_avg = (float) (agg_avg)/agg_num;
   sprintf (buffer, " MAX %d MIN %d AVG %f STD %f AGG_NUM %d AGGREGATES", 
 	   agg_max, agg_min, fagg_avg, sqrt( (float) (agg_std/(float)(agg_num)-fagg_avg*fagg_avg)), agg_num);
   Tcl_AppendResult(interp, buffer, (char *)NULL);
   
-  for (i = s_mol_id ; i <= f_mol_id ; i++) {
-    if (head_list[i] != -2) {
-      target1= head_list[i];
-      sprintf(buffer, " { %d ", target1); 
-      Tcl_AppendResult(interp, buffer, (char *)NULL);
-      while( link_list[target1] != -1) {
-	target1= link_list[target1];
-	sprintf(buffer, "%d ", target1); 
-	Tcl_AppendResult(interp, buffer, (char *)NULL); 
-      }
-      sprintf(buffer, "} ");
-      Tcl_AppendResult(interp, buffer, (char *)NULL);
+  for (i = 0, m = 0; i < agg_num; i++) {
+    Tcl_AppendResult(interp, " { ", (char *)NULL);
+    for (j = 0; j < agg_size[i]; j++, m++) {
+      sprintf(buffer, "%d ", agg_members[m]); 
+      Tcl_AppendResult(interp, buffer, (char *)NULL); 
     }
+    Tcl_AppendResult(interp, "} ", (char *)NULL);
   }
 
-  free(agg_id_list);
-  free(head_list);
-  free(link_list);
   free(agg_size);
+  free(agg_members);
 
   return TCL_OK;
 }
@@ -2276,28 +1975,32 @@ static int tclcommand_analyze_parse_angularmomentum(Tcl_Interp *interp, int argc
   return TCL_OK;
 }
 
-  //subfunction: mark all neighbors of a particle and their neighbors (recursiv!)
-void mark_neighbours(int type,int pa_nr,double dist,int *list){
-  int k;
-  for (k=0;k<n_total_particles;k++){
-     //only unmarked and particles with right distance
-     if ( (partCfg[k].p.type == type) && (list[k] == 0) && (min_distance(partCfg[pa_nr].r.p,partCfg[k].r.p) < dist) ){
-        //mark particle with same number as calling particle
-        list[k]=list[pa_nr];
-        mark_neighbours(type,k,dist,list);
-     }
-  }
+/** find the clusters of the particles of a type, see \ref
+    statistics_uf.h. If the cells of the domain decomposition are
+    large enough, the nodes find them, otherwise the master. */
+static int analyze_particle_clusters(int type, double dist, int **sizes, int **members)
+{
+  ClusterParams par;
+
+  par.mode        = CLUSTER_PARTICLES;
+  par.type        = type;
+  par.mol_start   = par.mol_end = -1;
+  par.dist        = dist;
+  par.min_contact = 1;
+  par.charge      = 0;
+  par.n_keys      = max_seen_particle + 1;
+  if (dist <= cluster_max_dist())
+    return mpi_cluster_analysis(&par, sizes, members);
+  return cluster_calc_partcfg(&par, sizes, members);
 }
 
 static int tclcommand_analyze_parse_cluster_size_dist(Tcl_Interp *interp, int argc, char **argv)
 {
-  /* 'analyze cluster_size_dist [<type>]' */
+  /* 'analyze cluster_size_dist <type> <dist>' */
   char buffer[3*TCL_DOUBLE_SPACE+3];
   int p1;
   double dist;
-  int i,j,max_cluster_number,size;
-  int cluster_number[n_total_particles];//cluster number of particle number
-  int cluster_size[n_total_particles+1]; //number of clusters with some size
+  int i, n_clusters, *sizes, *members, *cluster_size;
 
   /* parse arguments */
   if (argc != 2) {
@@ -2317,40 +2020,12 @@ static int tclcommand_analyze_parse_cluster_size_dist(Tcl_Interp *interp, int ar
     return (TCL_ERROR);
   }
 
-  updatePartCfg(WITHOUT_BONDS);
-  for (i=0;i<n_total_particles;i++){
-     cluster_number[i]=0;
-     cluster_size[i]=0;
-  }
-  cluster_size[n_total_particles]=0;
-
-  max_cluster_number=1;
-  for (i=0;i<n_total_particles-1;i++){
-     //if particle was not marked till now
-     if ( (partCfg[i].p.type == p1) && (cluster_number[i]==0) ){
-       //mark current particle with max_cluster_number
-       cluster_number[i]=max_cluster_number;
-       mark_neighbours(p1,i,dist,cluster_number);
-       max_cluster_number++;
-     }
-  }
+  n_clusters = analyze_particle_clusters(p1, dist, &sizes, &members);
 
-  for (i=0;i<n_total_particles;i++){
-    if ( (partCfg[i].p.type == p1) && (cluster_number[i]==0) ) {
-       Tcl_ResetResult(interp);
-       Tcl_AppendResult(interp, "ERROR: at least one particle is not marked !", (char *)NULL);
-       return (TCL_ERROR);
-    }
-  }
-
-  for (i=1;i<max_cluster_number;i++){
-     size=0;
-     for (j=0;j<n_total_particles;j++){
-        //Finding particles belonging to cluster i
-        if ( (partCfg[j].p.type == p1) && (cluster_number[j]==i)) {size++;}
-     }
-     cluster_size[size]++;
-  }
+  /* number of clusters with some size */
+  cluster_size = calloc(n_total_particles + 1, sizeof(int));
+  for (i = 0; i < n_clusters; i++)
+    cluster_size[sizes[i]]++;
 
   sprintf(buffer,"%i %f",p1,dist);
   Tcl_AppendResult(interp, "{ analyze cluster_size_dist ",buffer,"} {\n",(char *)NULL);
@@ -2362,6 +2037,42 @@ static int tclcommand_analyze_parse_cluster_size_dist(Tcl_Interp *interp, int ar
   }
   Tcl_AppendResult(interp, "}",(char *)NULL);
 
+  free(cluster_size);
+  free(sizes);
+  free(members);
+  return TCL_OK;
+}
+
+static int tclcommand_analyze_parse_clusters(Tcl_Interp *interp, int argc, char **argv)
+{
+  /* 'analyze clusters <type> <dist>' */
+  char buffer[TCL_INTEGER_SPACE + 2];
+  int type, i, j, m, n_clusters, *sizes, *members;
+  double dist;
+
+  if (argc != 2 || !ARG0_IS_I(type) || !ARG1_IS_D(dist)) {
+    Tcl_ResetResult(interp);
+    Tcl_AppendResult(interp, "usage: analyze clusters <type> <dist>", (char *)NULL);
+    return (TCL_ERROR);
+  }
+  if (dist <= 0) {
+    Tcl_AppendResult(interp, "the distance must be positive", (char *)NULL);
+    return (TCL_ERROR);
+  }
+
+  n_clusters = analyze_particle_clusters(type, dist, &sizes, &members);
+
+  for (i = 0, m = 0; i < n_clusters; i++) {
+    Tcl_AppendResult(interp, "{", (char *)NULL);
+    for (j = 0; j < sizes[i]; j++, m++) {
+      sprintf(buffer, j ? " %d" : "%d", members[m]);
+      Tcl_AppendResult(interp, buffer, (char *)NULL);
+    }
+    Tcl_AppendResult(interp, (i < n_clusters - 1) ? "} " : "}", (char *)NULL);
+  }
+
+  free(sizes);
+  free(members);
   return TCL_OK;
 }
 
@@ -2704,6 +2415,12 @@ static int tclcommand_analyze_parse_distribution(Tcl_Interp *interp, int argc, c
   if( argc>0 ) { if (!ARG0_IS_I(log_flag)) return (TCL_ERROR); argc--; argv++; }
   if( argc>0 ) { if (!ARG0_IS_I(int_flag)) return (TCL_ERROR); argc--; argv++; }
 
+  if (p1.max > LOCAL_MAX_TYPES || p2.max > LOCAL_MAX_TYPES) {
+    sprintf(buffer, "%d", LOCAL_MAX_TYPES);
+    Tcl_AppendResult(interp, "analyze distribution supports at most ", buffer, " types per list", (char *)NULL);
+    return (TCL_ERROR);
+  }
+
   /* if not given set defaults */
   if(r_max == -1.) r_max = min_box_l/2.0;
   if(r_bins < 0 )  r_bins = n_total_particles / 20;
@@ -2727,7 +2444,6 @@ static int tclcommand_analyze_parse_distribution(Tcl_Interp *interp, int argc, c
   if(r_bins < 1) return TCL_ERROR;
   /* calculate distribution */
   distribution = malloc(r_bins*sizeof(double));
-  updatePartCfg(WITHOUT_BONDS);
   calc_part_distribution(p1.e, p1.max, p2.e, p2.max, r_min, r_max, r_bins, log_flag,&low,distribution);
   if(int_flag==1) {
     distribution[0] += low;
@@ -2794,7 +2510,6 @@ static int tclcommand_analyze_parse_vel_distr(Tcl_Interp *interp, int argc, char
 
   sprintf(buffer,"%i %i %f",p1,bins,max);
   Tcl_AppendResult(interp, "{ analyze vel_distr ",buffer,"} ",(char *)NULL);
-  updatePartCfg(WITHOUT_BONDS);
   tclcommand_analyze_print_vel_distr(interp,p1,bins,max);
 
   return TCL_OK;
@@ -2825,6 +2540,12 @@ static int tclcommand_analyze_parse_rdf(Tcl_Interp *interp, int average, int arg
   }
   argc-=2; argv+=2;
 
+  if (p1.max > LOCAL_MAX_TYPES || p2.max > LOCAL_MAX_TYPES) {
+    sprintf(buffer, "%d", LOCAL_MAX_TYPES);
+    Tcl_AppendResult(interp, "analyze rdf supports at most ", buffer, " types per list", (char *)NULL);
+    return (TCL_ERROR);
+  }
+
   if( average==3 ) {
     if( argc>0 ) { if (!ARG0_IS_D(x_min)) return (TCL_ERROR); argc--; argv++; }
     if( argc>0 ) { if (!ARG0_IS_D(x_max)) return (TCL_ERROR); argc--; argv++; }
@@ -2890,7 +2611,7 @@ static int tclcommand_analyze_parse_rdf(Tcl_Interp *interp, int average, int arg
     Tcl_AppendResult(interp, " }", (char *)NULL);
   rdf = malloc(r_bins*sizeof(double));
 
-  if (!sortPartCfg()) { Tcl_AppendResult(interp, "for analyze, store particles consecutively starting with 0.",(char *) NULL); return (TCL_ERROR); }
+  if (average && !sortPartCfg()) { Tcl_AppendResult(interp, "for analyze, store particles consecutively starting with 0.",(char *) NULL); return (TCL_ERROR); }
 
   switch (average) {
   case 0:
@@ -2928,13 +2649,17 @@ static int tclcommand_analyze_parse_rdf(Tcl_Interp *interp, int average, int arg
 
 int tclcommand_analyze_parse_structurefactor(Tcl_Interp *interp, int argc, char **argv)
 {
-  /* 'analyze { stucturefactor } <type> <order>' */
+  /* 'analyze { stucturefactor } <type> <order> [mesh <mesh>] [cao <cao>] [exact]' */
   /***********************************************************************************************************/
   char buffer[2*TCL_DOUBLE_SPACE+4];
-  int i, type, order;
+  int i, type, order, mesh = 0, cao = 7, exact = 0;
   double qfak, *sf;
+#ifdef P3M
+  int min_mesh;
+  SfParams par;
+#endif
   if (argc < 2) {
-    Tcl_AppendResult(interp, "Wrong # of args! Usage: analyze structurefactor <type> <order> [<chain_start> <n_chains> <chain_length>]",
+    Tcl_AppendResult(interp, "Wrong # of args! Usage: analyze structurefactor <type> <order> [mesh <mesh>] [cao <cao>] [exact]",
 		     (char *)NULL);
     return (TCL_ERROR);
   } else {
@@ -2944,8 +2669,81 @@ int tclcommand_analyze_parse_structurefactor(Tcl_Interp *interp, int argc, char
       return (TCL_ERROR);
     argc-=2; argv+=2;
   }
-  updatePartCfg(WITHOUT_BONDS);
-  calc_structurefactor(type, order, &sf); 
+  while (argc > 0) {
+    if (ARG0_IS_S("mesh")) {
+      if (argc < 2 || !ARG1_IS_I(mesh)) {
+	Tcl_AppendResult(interp, "usage: analyze structurefactor <type> <order> mesh <mesh>", (char *)NULL);
+	return (TCL_ERROR);
+      }
+      argc-=2; argv+=2;
+    }
+    else if (ARG0_IS_S("cao")) {
+      if (argc < 2 || !ARG1_IS_I(cao)) {
+	Tcl_AppendResult(interp, "usage: analyze structurefactor <type> <order> cao <cao>", (char *)NULL);
+	return (TCL_ERROR);
+      }
+      argc-=2; argv+=2;
+    }
+    else if (ARG0_IS_S("exact")) {
+      exact = 1;
+      argc--; argv++;
+    }
+    else {
+      Tcl_AppendResult(interp, "unknown parameter \"", argv[0], "\" for analyze structurefactor", (char *)NULL);
+      return (TCL_ERROR);
+    }
+  }
+  if (type < 0 || type > n_particle_types) {
+    Tcl_AppendResult(interp, "particle type does not exist", (char *)NULL);
+    return (TCL_ERROR);
+  }
+  if (order < 1) {
+    Tcl_AppendResult(interp, "order has to be a positive integer", (char *)NULL);
+    return (TCL_ERROR);
+  }
+  if (cao < 1 || cao > 7) {
+    Tcl_AppendResult(interp, "cao has to be between 1 and 7", (char *)NULL);
+    return (TCL_ERROR);
+  }
+
+#ifndef P3M
+  if (mesh > 0 && !exact) {
+    Tcl_AppendResult(interp, "a mesh needs the features ELECTROSTATICS and FFTW", (char *)NULL);
+    return (TCL_ERROR);
+  }
+#else
+  /* via the mesh, unless the domains are too small for the default mesh */
+  min_mesh = sf_min_mesh(cao);
+  if (!exact && cell_structure.type == CELL_STRUCTURE_DOMDEC && (mesh > 0 || min_mesh > 0)) {
+    if (mesh == 0)
+      mesh = imax(6*order, min_mesh);
+    if (mesh <= 2*order) {
+      Tcl_AppendResult(interp, "mesh has to be larger than 2*order", (char *)NULL);
+      return (TCL_ERROR);
+    }
+    if (min_mesh < 0) {
+      Tcl_AppendResult(interp, "the node domains are too small for a mesh", (char *)NULL);
+      return (TCL_ERROR);
+    }
+    if (mesh < min_mesh) {
+      sprintf(buffer, "%d", min_mesh);
+      Tcl_AppendResult(interp, "mesh is too coarse for the node domains, it has to be at least ",
+		       buffer, (char *)NULL);
+      return (TCL_ERROR);
+    }
+    par.type  = type;
+    par.order = order;
+    par.mesh  = mesh;
+    par.cao   = cao;
+    sf = malloc(2*order*order*sizeof(double));
+    mpi_structure_factor(&par, sf);
+  }
+  else
+#endif
+  {
+    updatePartCfg(WITHOUT_BONDS);
+    calc_structurefactor(type, order, &sf); 
+  }
   
   qfak = 2.0*PI/box_l[0];
   for(i=0; i<order*order; i++) { 
@@ -3026,6 +2824,48 @@ static int tclcommand_analyze_parse_density_profile_av(Tcl_Interp *interp, int a
 }
 
 
+static int tclcommand_analyze_parse_density_profile(Tcl_Interp *interp, int argc, char **argv)
+{
+  /* 'analyze density_profile <n_bin> <dir> [<type_list>]' */
+  int n_bin, dir, i;
+  IntList types;
+  double *rho, r_bin, r;
+  char buffer[2*TCL_DOUBLE_SPACE+256];
+
+  init_intlist(&types);
+
+  if (argc < 2 || !ARG0_IS_I(n_bin) || !ARG1_IS_I(dir) ||
+      (argc > 2 && !ARG_IS_INTLIST(2, types))) {
+    Tcl_ResetResult(interp);
+    Tcl_AppendResult(interp, "usage: analyze density_profile <n_bin> <dir> [<type_list>]", (char *)NULL);
+    realloc_intlist(&types, 0);
+    return (TCL_ERROR);
+  }
+  if (n_bin < 1 || dir < 0 || dir > 2 || types.n > LOCAL_MAX_TYPES) {
+    Tcl_AppendResult(interp, "analyze density_profile: illegal number of bins, direction or too many types", (char *)NULL);
+    realloc_intlist(&types, 0);
+    return (TCL_ERROR);
+  }
+
+  rho = malloc(n_bin*sizeof(double));
+  calc_density_profile(types.e, types.n, dir, n_bin, rho);
+
+  /* append result */
+  r_bin = box_l[dir]/(double)(n_bin);
+  r = r_bin/2.0;
+  Tcl_AppendResult(interp, " {\n", (char *)NULL);
+  for(i=0; i<n_bin; i++) {
+    sprintf(buffer,"%f %f",r,rho[i]);
+    Tcl_AppendResult(interp, "{ ",buffer," }\n", (char *)NULL);
+    r += r_bin;
+  }
+  Tcl_AppendResult(interp, "}\n", (char *)NULL);
+
+  free(rho);
+  realloc_intlist(&types, 0);
+  return TCL_OK;
+}
+
 static int tclcommand_analyze_parse_diffusion_profile(Tcl_Interp *interp, int argc, char **argv )
 {
   int i;
@@ -3681,9 +3521,10 @@ static int tclcommand_analyze_parse_MSD(Tcl_Interp *interp, int argc, char **arg
 
 static int tclcommand_analyze_parse_and_print_energy_kinetic(Tcl_Interp *interp,int argc, char **argv)
 {
-   int i,type;
+   int type;
    char buffer[TCL_DOUBLE_SPACE];
-   double E_kin=0;
+   double E_kin, *res;
+   LocalObservableParams par;
 
   /* parse arguments */
   if (argc < 1) {
@@ -3694,15 +3535,11 @@ static int tclcommand_analyze_parse_and_print_energy_kinetic(Tcl_Interp *interp,
      Tcl_AppendResult(interp, "usage: analyze energy_kinetic <type> where type is int", (char *)NULL);
      return (TCL_ERROR);
   }
-  updatePartCfg(WITHOUT_BONDS);
-  for (i=0;i<n_total_particles;i++)
-  {
-      if (partCfg[i].p.type == type )
-      {
-         E_kin+=PMASS(partCfg[i])*sqrlen(partCfg[i].m.v);
-      }
-  }
-  E_kin*=0.5/time_step/time_step;
+  init_local_observable_params(&par);
+  local_observable_select_type(&par, 0, type);
+  mpi_local_observable(LOCAL_OBS_EKIN, &par, &res);
+  E_kin=0.5*res[0]/time_step/time_step;
+  free(res);
   Tcl_PrintDouble(interp, E_kin, buffer);;
   Tcl_AppendResult(interp, buffer,(char *)NULL);
   return TCL_OK;
@@ -3752,6 +3589,7 @@ int tclcommand_analyze(ClientData data, Tcl_Interp *interp, int argc, char **arg
 #endif
   REGISTER_ANALYSIS("mol", tclcommand_analyze_parse_mol);
   REGISTER_ANALYSIS("cluster_size_dist", tclcommand_analyze_parse_cluster_size_dist);
+  REGISTER_ANALYSIS("clusters", tclcommand_analyze_parse_clusters);
   REGISTER_ANALYSIS("mindist", tclcommand_analyze_parse_mindist);
   REGISTER_ANALYSIS("aggregation", tclcommand_analyze_parse_aggregation);
   REGISTER_ANALYSIS("centermass", tclcommand_analyze_parse_centermass);
@@ -3815,6 +3653,7 @@ int tclcommand_analyze(ClientData data, Tcl_Interp *interp, int argc, char **arg
   REGISTER_ANALYSIS("cwvac", tclcommand_analyze_parse_cwvac);
 #endif
   REGISTER_ANALYSIS("structurefactor", tclcommand_analyze_parse_structurefactor);
+  REGISTER_ANALYSIS("density_profile", tclcommand_analyze_parse_density_profile);
   REGISTER_ANALYSIS("<density_profile>", tclcommand_analyze_parse_density_profile_av);
   REGISTER_ANALYSIS("<diffusion_profile>", tclcommand_analyze_parse_diffusion_profile);
   REGISTER_ANALYSIS("vanhove", tclcommand_analyze_parse_vanhove);
@@ -116,25 +116,6 @@ int acf_cmd(ClientData data, Tcl_Interp *interp, int argc, char **argv);
     @return the minimal distance of two particles */
 double mindist(IntList *set1, IntList *set2);
 
-/** calculate the aggregate distribution for molecules.
-    @param dist_criteria2 distance criteria squared
-    @param min_contact minimum number of contacts 
-    @param s_mol_id start molecule id
-    @param f_mol_id finish molecule id
-    @param head_list 
-    @param link_list
-    @param agg_id_list
-    @param agg_num
-    @param agg_size
-    @param agg_max
-    @param agg_min
-    @param agg_avg
-    @param agg_std
-    @param charge_criteria
-*/
-int aggregation(double dist_criteria2, int min_contact, int s_mol_id, int f_mol_id, int *head_list, int *link_list,
-		int *agg_id_list, int *agg_num, int *agg_size, int *agg_max, int *agg_min, int *agg_avg, int *agg_std, int charge_criteria);
-
 /** returns all particles within a given radius r_catch around a position.
     @param pos position of sphere of point
     @param r_catch the radius around the position
@@ -202,10 +183,24 @@ void analyze_remove(int ind);
     @param log_flag Wether the bins are (logarithmically) aequidistant.
     @param low      particles closer than r_min
     @param dist     Array to store the result (size: r_bins).
+
+    The particles of the p2_types are collected on all nodes, but
+    not the other ones. Both lists may contain at most \ref
+    LOCAL_MAX_TYPES types.
  */
 void calc_part_distribution(int *p1_types, int n_p1, int *p2_types, int n_p2, 
 			    double r_min, double r_max, int r_bins, int log_flag,
 			    double *low, double *dist);
+
+/** Calculates the number density profile of the current configuration.
+    @param types   list with types of particles, all particles if n_types is 0.
+    @param n_types length of types, at most \ref LOCAL_MAX_TYPES.
+    @param dir     the direction of the profile.
+    @param bins    number of bins over the box.
+    @param rho     Array to store the result (size: bins).
+ */
+void calc_density_profile(int *types, int n_types, int dir, int bins, double *rho);
+
 /** Calculates the radial distribution function.
 
     Calculates the radial distribution function of particles with
@@ -296,7 +291,8 @@ double calc_vanhove(int ptype, double rmin, double rmax, int rbins, int tmax, do
     Calculates the spherically averaged structure factor of particles of a
     given type. The possible wave vectors are given by q = 2PI/L sqrt(nx^2 + ny^2 + nz^2).
     The S(q) is calculated up to a given length measured in 2PI/L (the recommended order of
-    the wave vector is less than 20).
+    the wave vector is less than 20). This is the explicit sum over the wave vectors and
+    \ref partCfg, see \ref sf_calc for the parallel calculation via a mesh.
     The data is stored starting with q=1, and contains alternatingly S(q-1) and the number
     of wave vectors l with l^2=q. Only if the second number is nonzero, the first is meaningful.
     This means the q=1 entries are sf[0]=S(1) and sf[1]=1. For q=7, there are no possible wave vectors,
@@ -337,6 +333,13 @@ MDINLINE double min_distance(double pos1[3], double pos2[3]) {
  */
 void centermass(int type, double *com);
 
+/** calculate the center of mass velocity of a special type of the current configuration
+ *  \param type  type of the particle, -1 for all
+ *  \param com   center of mass velocity, scaled with the time step
+ *  \return the number of particles of the type
+ */
+int centermass_vel(int type, double *com);
+
 /** calculate the angular momentum of a special type of the current configuration
  *  \param type  type of the particle
  *  \param com   angular momentum vector
@@ -27,6 +27,7 @@
 
 
 #include "statistics_cluster.h"
+#include "statistics_uf.h"
 
 /** \name Data structures */
 /************************************************************/
@@ -130,82 +131,51 @@ void clusters_join(Cluster *cluster1, Cluster *cluster2)
   if(cluster2 == first_cluster) first_cluster = cluster2->next;
 }
 
-/* test wether two clusters are connected (criterion of step 2 of the necklace cluster algorithm) */
-int clusters_connected(Particle *part, Cluster cluster1, Cluster cluster2)
-{
-  int id1,id2;
-  ClusterElement *element1,*element2;
-
-  element1 = cluster1.first;
-  while ( element1 != NULL ) {
-    id1      = element1->id;
-    element2 = cluster2.first;
-    while ( element2 != NULL ) {
-      id2 = element2->id;
-      if ( abs( id1 - id2 ) > backbone_distance && 
-	   distance2(part[id1].r.p,part[id2].r.p) < space_distance2 ) return 1;
-      element2 = element2->next;
-    }
-    element1 = element1->next;
-  }
-  return 0;
-}
-
-/* test wether two clusters interpenetrate (criterion 4 of the necklace cluster algorithm) */
-int clusters_interpenetrate(Cluster cluster1, Cluster cluster2)
-{
-  int min1,min2,max1,max2;
-  ClusterElement *element;
-
-  element = cluster1.first;
-  min1 = max1 = element->id;
-  while(element->next != NULL) {
-    element = element->next;
-    if(element->id < min1) min1 = element->id;
-    if(element->id > max1) max1 = element->id;
-  }
-
-  element = cluster2.first;
-  min2 = max2 = element->id;
-  while(element->next != NULL) {
-    element = element->next;
-    if(element->id < min2) min2 = element->id;
-    if(element->id > max2) max2 = element->id;
-  }
-
-  /* test if one cluster is completelly on left side of the other ... */
-  if( ((min1 < min2) && (max1 < min2)) ||
-      ((min2 < min1) && (max2 < min1)) ) return 0;
-  /* ... otherwise they interpenetrate. */
-  return 1;
-}
-
-/* perform step 2 to 4 of the necklace cluster algorithm */
-int cluster_joincicle(Particle *part) {
-  int joins=1, cicles=0;
-  Cluster *cluster1,*cluster2;
-
-  while(joins > 0) {
-    joins  =0;
-    cicles ++;
-    cluster1 = first_cluster;
-    /* loop cluster 1 until last cluster but one */
-    while(cluster1->next != first_cluster) {
-      cluster2 = cluster1->next;
-      /* loop cluster 2 until lust cluster */
-      while(cluster2->prev != last_cluster) {
-	if( clusters_connected(part,*cluster1,*cluster2) || 
-	    clusters_interpenetrate(*cluster1,*cluster2) ) {
-	  clusters_join(cluster1,cluster2);
-	  joins++;
-	}
-	cluster2 = cluster2->next;
-      }
-      cluster1 = cluster1->next;
+/* perform step 2 to 4 of the necklace cluster algorithm, i.e. join
+   clusters that are connected (criterion 2) or interpenetrate
+   (criterion 4) until nothing changes. The connected pairs are joined
+   once in a disjoint-set forest. Since interpenetrating clusters are
+   joined, the final clusters are segments of the chain, so that one
+   sweep along the chain joins the clusters whose ranges overlap. 
+   \return number of clusters */
+int cluster_joincicle(Particle *part, int size) {
+  int i, j, start, end, n_clusters = 0, *uf, *last;
+  Cluster *prev = NULL;
+
+  uf = (int *)malloc(size*sizeof(int));
+  uf_init(uf, size);
+  for(i=0;i<size;i++)
+    for(j=i+backbone_distance+1;j<size;j++)
+      if(distance2(part[i].r.p,part[j].r.p) < space_distance2) uf_union(uf,i,j);
+
+  /* last monomer of each cluster of the forest */
+  last = (int *)malloc(size*sizeof(int));
+  for(i=0;i<size;i++) last[uf_find(uf,i)] = i;
+
+  for(start=0;start<size;start=end+1) {
+    /* extend the segment until no cluster reaches beyond it */
+    end = last[uf_find(uf,start)];
+    for(i=start+1;i<=end;i++)
+      if(last[uf_find(uf,i)] > end) end = last[uf_find(uf,i)];
+
+    cluster[start].size  = end - start + 1;
+    for(i=start;i<end;i++) element[i].next = &element[i+1];
+    element[end].next = NULL;
+    if(prev) {
+      prev->next = &cluster[start];
+      cluster[start].prev = prev;
     }
+    else first_cluster = &cluster[start];
+    prev = &cluster[start];
+    n_clusters++;
   }
+  last_cluster = prev;
+  last_cluster->next  = first_cluster;
+  first_cluster->prev = last_cluster;
 
-  return cicles;
+  free(last);
+  free(uf);
+  return n_clusters;
 }
 
 /* perform step 5 to 7 of the necklace cluster algorithm 
@@ -275,7 +245,7 @@ int analyze_necklace(Particle *part, int np) {
   /* initialize: step 1 in necklace cluster analyzation.*/
   cluster_init(part,np);
   /* perform step 2-4 in necklace cluster analyzation.*/
-  cluster_joincicle(part);
+  cluster_joincicle(part,np);
   /* perform step 5-7 in necklace cluster analyzation.*/
   n_pearls = cluster_join_to_substructures();
 
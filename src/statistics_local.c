@@ -0,0 +1,424 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file statistics_local.c
+    Implementation of \ref statistics_local.h "statistics_local.h".
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include "utils.h"
+#include "statistics_local.h"
+#include "statistics_rdf.h"
+#include "statistics.h"
+#include "communication.h"
+#include "cells.h"
+#include "grid.h"
+
+/** A kernel, which is applied to each local particle.
+    @param p   the particle
+    @param par the parameters of the observable
+    @param res for \ref LOCAL_REDUCE_SUM and \ref LOCAL_REDUCE_MAX the
+               local result, which the kernel adds the particle to.
+	       For \ref LOCAL_REDUCE_CONCAT where to store the values of
+	       the particle.
+    @return for \ref LOCAL_REDUCE_CONCAT whether the particle is
+    selected, i.e. whether it stored its values. */
+typedef int (LocalKernel)(Particle *p, LocalObservableParams *par, double *res);
+
+/** An observable. */
+typedef struct {
+  /** the reduction, \ref LOCAL_REDUCE_SUM... */
+  int reduction;
+  /** number of values of the result, for \ref LOCAL_REDUCE_CONCAT per particle */
+  int (*size)(LocalObservableParams *par);
+  /** called on all nodes before the kernel, may be NULL */
+  void (*prepare)(LocalObservableParams *par);
+  /** called on all nodes after the reduction, may be NULL */
+  void (*finish)();
+  /** the kernel */
+  LocalKernel *kernel;
+} LocalObservable;
+
+/** \name Reference particles of \ref LOCAL_OBS_MIN_DIST and \ref LOCAL_OBS_RDF */
+/*@{*/
+/** the particles of the second type list, on all nodes */
+static RdfGrid local_ref;
+/** whether both type lists are the same */
+static int local_same_types;
+/*@}*/
+
+/************************************************
+ * helpers
+ ************************************************/
+
+/** whether a particle type is in one of the type lists. */
+MDINLINE int local_type_selected(LocalObservableParams *par, int list, int type)
+{
+  int t;
+  if (par->n_types[list] == 0)
+    return 1;
+  for (t = 0; t < par->n_types[list]; t++)
+    if (par->types[list][t] == type)
+      return 1;
+  return 0;
+}
+
+/** the unfolded position of a particle. */
+MDINLINE void local_unfolded_position(Particle *p, double pos[3])
+{
+  int img[3];
+  memcpy(pos, p->r.p, 3*sizeof(double));
+  memcpy(img, p->l.i, 3*sizeof(int));
+  unfold_position(pos, img);
+}
+
+/** bin of a linear histogram over [min, max), clamped to the valid bins. */
+MDINLINE int local_bin(double x, double min, double max, int bins)
+{
+  int ind = (int)((x - min)*(1.0/((max - min)/bins)));
+  if (ind < 0) return 0;
+  if (ind >= bins) return bins - 1;
+  return ind;
+}
+
+static int size_one(LocalObservableParams *par)   { return 1; }
+static int size_three(LocalObservableParams *par) { return 3; }
+static int size_four(LocalObservableParams *par)  { return 4; }
+static int size_bins(LocalObservableParams *par)  { return par->bins; }
+static int size_bins_plus_one(LocalObservableParams *par) { return par->bins + 1; }
+static int size_bins_plus_two(LocalObservableParams *par) { return par->bins + 2; }
+
+/************************************************
+ * kernels
+ ************************************************/
+
+static int kernel_com(Particle *p, LocalObservableParams *par, double *res)
+{
+  int i;
+  double pos[3];
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  local_unfolded_position(p, pos);
+  for (i = 0; i < 3; i++)
+    res[i] += pos[i]*PMASS(*p);
+  res[3] += PMASS(*p);
+  return 1;
+}
+
+static int kernel_com_vel(Particle *p, LocalObservableParams *par, double *res)
+{
+  int i;
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  for (i = 0; i < 3; i++)
+    res[i] += p->m.v[i];
+  res[3] += 1;
+  return 1;
+}
+
+static int kernel_angmom(Particle *p, LocalObservableParams *par, double *res)
+{
+  int i;
+  double pos[3], tmp[3];
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  local_unfolded_position(p, pos);
+  vector_product(pos, p->m.v, tmp);
+  for (i = 0; i < 3; i++)
+    res[i] += tmp[i]*PMASS(*p);
+  return 1;
+}
+
+static int kernel_ekin(Particle *p, LocalObservableParams *par, double *res)
+{
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  res[0] += PMASS(*p)*sqrlen(p->m.v);
+  return 1;
+}
+
+static int kernel_vel_max(Particle *p, LocalObservableParams *par, double *res)
+{
+  int i;
+  double dv;
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  for (i = 0; i < 3; i++) {
+    dv = fabs(p->m.v[i] - par->shift[i]);
+    if (dv > res[0]) res[0] = dv;
+  }
+  return 1;
+}
+
+static int kernel_vel_distr(Particle *p, LocalObservableParams *par, double *res)
+{
+  int i;
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  for (i = 0; i < 3; i++)
+    res[local_bin(p->m.v[i] - par->shift[i], par->min, par->max, par->bins)] += 1;
+  res[par->bins] += 3;
+  return 1;
+}
+
+static int kernel_density(Particle *p, LocalObservableParams *par, double *res)
+{
+  double pos[3];
+  int img[3] = {0, 0, 0};
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  memcpy(pos, p->r.p, 3*sizeof(double));
+  fold_coordinate(pos, img, par->dir);
+  res[local_bin(pos[par->dir], 0, box_l[par->dir], par->bins)] += 1;
+  return 1;
+}
+
+static int kernel_min_dist(Particle *p, LocalObservableParams *par, double *res)
+{
+  int ind;
+  double d, min_d2;
+
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+
+  /* only partners within max matter */
+  min_d2 = rdf_grid_min_dist2(&local_ref, p->r.p, p->p.identity, par->max);
+  if (min_d2 >= 0) {
+    d = sqrt(min_d2);
+    if (d >= par->min) {
+      if (par->log_flag)
+	ind = (int)((log(d) - log(par->min))*(par->bins/(log(par->max) - log(par->min))));
+      else
+	ind = (int)((d - par->min)*(par->bins/(par->max - par->min)));
+      if (ind >= 0 && ind < par->bins)
+	res[ind] += 1;
+    }
+    else
+      res[par->bins] += 1;
+  }
+  res[par->bins + 1] += 1;
+  return 1;
+}
+
+static int kernel_rdf(Particle *p, LocalObservableParams *par, double *res)
+{
+  if (local_type_selected(par, 1, p->p.type))
+    res[par->bins + 1] += 1;
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  rdf_grid_histogram(&local_ref, p->r.p, p->p.identity, -1, local_same_types ? RDF_HALF : 0,
+		     par->min, par->max, par->bins, res);
+  res[par->bins] += 1;
+  return 1;
+}
+
+static int kernel_positions(Particle *p, LocalObservableParams *par, double *res)
+{
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  res[0] = p->p.identity;
+  local_unfolded_position(p, res + 1);
+  return 1;
+}
+
+static int kernel_velocities(Particle *p, LocalObservableParams *par, double *res)
+{
+  if (!local_type_selected(par, 0, p->p.type))
+    return 0;
+  res[0] = p->p.identity;
+  memcpy(res + 1, p->m.v, 3*sizeof(double));
+  return 1;
+}
+
+static LocalObservable local_observables[LOCAL_OBS_N_CODES];
+
+static int local_concat(LocalObservable *obs, LocalObservableParams *par, double **result, int all);
+
+/** collect the particles of the second type list on all nodes, and
+    sort them into cells of size max. */
+static void prepare_pairs(LocalObservableParams *par)
+{
+  LocalObservableParams ref = *par;
+  double *data;
+  int i, n, *ids;
+
+  ref.n_types[0] = par->n_types[1];
+  memcpy(ref.types[0], par->types[1], sizeof(ref.types[0]));
+  n = local_concat(&local_observables[LOCAL_OBS_POSITIONS], &ref, &data, 1)/4;
+
+  ids = malloc((n + 1)*sizeof(int));
+  for (i = 0; i < n; i++)
+    ids[i] = (int)data[4*i];
+  rdf_grid_init(&local_ref, n, data + 1, 4, ids, NULL, par->max);
+  free(ids);
+  free(data);
+
+  local_same_types = rdf_same_types(par->types[0], par->n_types[0],
+				    par->types[1], par->n_types[1]);
+}
+
+static void finish_pairs()
+{
+  rdf_grid_free(&local_ref);
+}
+
+/************************************************
+ * the observables
+ ************************************************/
+
+/** the observables, indexed by their codes. */
+static LocalObservable local_observables[LOCAL_OBS_N_CODES] = {
+  { LOCAL_REDUCE_SUM,    size_four,          NULL, NULL, kernel_com },
+  { LOCAL_REDUCE_SUM,    size_four,          NULL, NULL, kernel_com_vel },
+  { LOCAL_REDUCE_SUM,    size_three,         NULL, NULL, kernel_angmom },
+  { LOCAL_REDUCE_SUM,    size_one,           NULL, NULL, kernel_ekin },
+  { LOCAL_REDUCE_MAX,    size_one,           NULL, NULL, kernel_vel_max },
+  { LOCAL_REDUCE_SUM,    size_bins_plus_one, NULL, NULL, kernel_vel_distr },
+  { LOCAL_REDUCE_SUM,    size_bins,          NULL, NULL, kernel_density },
+  { LOCAL_REDUCE_SUM,    size_bins_plus_two, prepare_pairs, finish_pairs, kernel_min_dist },
+  { LOCAL_REDUCE_CONCAT, size_four,          NULL, NULL, kernel_positions },
+  { LOCAL_REDUCE_SUM,    size_bins_plus_two, prepare_pairs, finish_pairs, kernel_rdf },
+  { LOCAL_REDUCE_CONCAT, size_four,          NULL, NULL, kernel_velocities }
+};
+
+/************************************************
+ * parameters
+ ************************************************/
+
+void init_local_observable_params(LocalObservableParams *par)
+{
+  memset(par, 0, sizeof(LocalObservableParams));
+}
+
+void local_observable_select_type(LocalObservableParams *par, int list, int type)
+{
+  if (type < 0)
+    par->n_types[list] = 0;
+  else {
+    par->n_types[list] = 1;
+    par->types[list][0] = type;
+  }
+}
+
+int local_observable_select_types(LocalObservableParams *par, int list, int *types, int n_types)
+{
+  if (n_types > LOCAL_MAX_TYPES)
+    return 1;
+  par->n_types[list] = n_types;
+  memcpy(par->types[list], types, n_types*sizeof(int));
+  return 0;
+}
+
+/************************************************
+ * reductions
+ ************************************************/
+
+/** apply a kernel to all local particles, accumulating in res. */
+static void local_accumulate(LocalObservable *obs, LocalObservableParams *par, double *res)
+{
+  int c, i, np;
+  Particle *part;
+
+  for (c = 0; c < local_cells.n; c++) {
+    part = local_cells.cell[c]->part;
+    np   = local_cells.cell[c]->n;
+    for (i = 0; i < np; i++)
+      obs->kernel(&part[i], par, res);
+  }
+}
+
+/** concatenate the values of the selected particles of all nodes.
+    @param all whether the result is needed on all nodes instead of
+               only on the master
+    @return the number of values, on the nodes that get the result */
+static int local_concat(LocalObservable *obs, LocalObservableParams *par, double **result, int all)
+{
+  int c, i, np, n_local = 0, n = 0, tot = 0;
+  int width = obs->size(par);
+  int *sizes, *displs;
+  double *local;
+  Particle *part;
+
+  for (c = 0; c < local_cells.n; c++)
+    n_local += local_cells.cell[c]->n;
+  local = malloc((n_local*width + 1)*sizeof(double));
+
+  for (c = 0; c < local_cells.n; c++) {
+    part = local_cells.cell[c]->part;
+    np   = local_cells.cell[c]->n;
+    for (i = 0; i < np; i++)
+      if (obs->kernel(&part[i], par, local + n))
+	n += width;
+  }
+
+  sizes  = malloc(n_nodes*sizeof(int));
+  displs = malloc(n_nodes*sizeof(int));
+  if (all)
+    MPI_Allgather(&n, 1, MPI_INT, sizes, 1, MPI_INT, MPI_COMM_WORLD);
+  else
+    MPI_Gather(&n, 1, MPI_INT, sizes, 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  if (all || this_node == 0) {
+    for (i = 0; i < n_nodes; i++) {
+      displs[i] = tot;
+      tot += sizes[i];
+    }
+    *result = malloc((tot + 1)*sizeof(double));
+  }
+
+  if (all)
+    MPI_Allgatherv(local, n, MPI_DOUBLE, *result, sizes, displs, MPI_DOUBLE, MPI_COMM_WORLD);
+  else
+    MPI_Gatherv(local, n, MPI_DOUBLE, this_node == 0 ? *result : NULL,
+		sizes, displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+  free(displs);
+  free(sizes);
+  free(local);
+
+  return tot;
+}
+
+int local_observable_calc(int code, LocalObservableParams *par, double **result)
+{
+  LocalObservable *obs = &local_observables[code];
+  int n;
+  double *local;
+
+  if (obs->prepare)
+    obs->prepare(par);
+
+  if (obs->reduction == LOCAL_REDUCE_CONCAT)
+    n = local_concat(obs, par, result, 0);
+  else {
+    n = obs->size(par);
+    local = calloc(n, sizeof(double));
+    local_accumulate(obs, par, local);
+    if (this_node == 0)
+      *result = malloc(n*sizeof(double));
+    MPI_Reduce(local, this_node == 0 ? *result : NULL, n, MPI_DOUBLE,
+	       obs->reduction == LOCAL_REDUCE_MAX ? MPI_MAX : MPI_SUM, 0, MPI_COMM_WORLD);
+    free(local);
+  }
+
+  if (obs->finish)
+    obs->finish();
+
+  return n;
+}
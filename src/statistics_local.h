@@ -0,0 +1,153 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef STATISTICS_LOCAL_H
+#define STATISTICS_LOCAL_H
+/** \file statistics_local.h
+    Observables of the current configuration that are calculated
+    without \ref partCfg.
+
+    Each observable consists of a kernel, which every node applies to
+    the particles in its \ref local_cells, and a reduction, which
+    combines the contributions of the nodes on the master:
+    <ul>
+    <li> \ref LOCAL_REDUCE_SUM sums up a fixed number of values, e.g. a
+    mass weighted position or the bins of a histogram.
+    <li> \ref LOCAL_REDUCE_MAX takes the maximum of a fixed number of
+    values, e.g. to find the range of a histogram.
+    <li> \ref LOCAL_REDUCE_CONCAT concatenates a fixed number of values
+    per selected particle, in node order.
+    </ul>
+    Only the reduced data is communicated, so that the memory on the
+    master does not grow with the number of particles, except for the
+    concatenation. An observable is evaluated on the master with \ref
+    mpi_local_observable.
+
+    To add an observable, add a code \ref LOCAL_OBS_COM..., write its
+    kernel and add it to the table \ref local_observables in
+    statistics_local.c.
+*/
+
+#include "particle_data.h"
+
+/************************************************
+ * defines
+ ************************************************/
+
+/** \name Reductions */
+/*@{*/
+/** sum up the values of all nodes */
+#define LOCAL_REDUCE_SUM    0
+/** maximum of the values of all nodes */
+#define LOCAL_REDUCE_MAX    1
+/** concatenate the values of all nodes */
+#define LOCAL_REDUCE_CONCAT 2
+/*@}*/
+
+/** \name Observable codes */
+/*@{*/
+/** mass weighted unfolded position and mass, 4 values */
+#define LOCAL_OBS_COM        0
+/** velocity and number of particles, 4 values */
+#define LOCAL_OBS_COM_VEL    1
+/** angular momentum with respect to the origin, 3 values */
+#define LOCAL_OBS_ANGMOM     2
+/** twice the kinetic energy, scaled by the time step squared, 1 value */
+#define LOCAL_OBS_EKIN       3
+/** maximal deviation of a velocity component from \ref
+    LocalObservableParams::shift, 1 value */
+#define LOCAL_OBS_VEL_MAX    4
+/** histogram of the velocity components minus \ref
+    LocalObservableParams::shift, bins values plus the number of
+    entries */
+#define LOCAL_OBS_VEL_DISTR  5
+/** histogram of the folded positions along \ref
+    LocalObservableParams::dir, bins values */
+#define LOCAL_OBS_DENSITY    6
+/** histogram of the minimal distances of the particles of the first
+    to the particles of the second type list, bins values plus the
+    entries below the range and the number of particles */
+#define LOCAL_OBS_MIN_DIST   7
+/** identity and unfolded position, 4 values per particle, which are
+    concatenated */
+#define LOCAL_OBS_POSITIONS  8
+/** histogram of the pair distances between the particles of the
+    first and the second type list, bins values plus the numbers of
+    particles of both lists. Pairs are counted once if the lists are
+    equal, otherwise twice if both particles are in both lists. */
+#define LOCAL_OBS_RDF        9
+/** identity and velocity, 4 values per particle, which are
+    concatenated */
+#define LOCAL_OBS_VELOCITIES 10
+/** number of observable codes */
+#define LOCAL_OBS_N_CODES   11
+/*@}*/
+
+/** maximal number of types in each type list of \ref LocalObservableParams */
+#define LOCAL_MAX_TYPES 32
+
+/************************************************
+ * data types
+ ************************************************/
+
+/** The parameters of an observable, which are broadcasted as a
+    whole. Which of them are used depends on the observable. */
+typedef struct {
+  /** number of types in the type lists, 0 selects all particles */
+  int n_types[2];
+  /** the type lists. Most observables only use the first. */
+  int types[2][LOCAL_MAX_TYPES];
+  /** direction for profiles */
+  int dir;
+  /** number of bins of histograms */
+  int bins;
+  /** whether the bins are logarithmically equidistant */
+  int log_flag;
+  /** the range of histograms */
+  double min, max;
+  /** a vector that is subtracted, e.g. the center of mass velocity */
+  double shift[3];
+} LocalObservableParams;
+
+/************************************************
+ * functions
+ ************************************************/
+
+/** initialize the parameters to select all particles, no bins. */
+void init_local_observable_params(LocalObservableParams *par);
+
+/** select particles of a single type for a type list.
+    @param par  the parameters
+    @param list the type list, 0 or 1
+    @param type the type, -1 for all particles */
+void local_observable_select_type(LocalObservableParams *par, int list, int type);
+
+/** select particles of several types for a type list.
+    @return 0 if ok, 1 if there are more than \ref LOCAL_MAX_TYPES types */
+int local_observable_select_types(LocalObservableParams *par, int list, int *types, int n_types);
+
+/** run the kernel of an observable on the local particles and reduce
+    the results. Called on all nodes by \ref mpi_local_observable.
+    @param code   the observable code, \ref LOCAL_OBS_COM...
+    @param par    the parameters
+    @param result on the master, where to store the malloced result,
+                  NULL on the other nodes
+    @return on the master the number of values in result */
+int local_observable_calc(int code, LocalObservableParams *par, double **result);
+
+#endif
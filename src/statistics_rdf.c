@@ -0,0 +1,318 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file statistics_rdf.c
+    Implementation of \ref statistics_rdf.h "statistics_rdf.h".
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+#include "statistics_rdf.h"
+#include "grid.h"
+
+/************************************************
+ * the grid
+ ************************************************/
+
+/** cell of a position in one direction */
+MDINLINE int rdf_cell_index(RdfGrid *grid, double x, int dir)
+{
+  int c;
+  x -= floor(x/box_l[dir])*box_l[dir];
+  c = (int)(x*grid->inv_cell_size[dir]);
+  if (c < 0) return 0;
+  if (c >= grid->n_cells[dir]) return grid->n_cells[dir] - 1;
+  return c;
+}
+
+/** the cells to search in one direction around cell c. If there are
+    less than three cells, all of them are searched, but each only once.
+    @return the number of cells */
+MDINLINE int rdf_neighbor_cells(RdfGrid *grid, int c, int dir, int nb[3])
+{
+  int n = grid->n_cells[dir], i;
+  if (n < 3) {
+    for (i = 0; i < n; i++)
+      nb[i] = i;
+    return n;
+  }
+  nb[0] = (c + n - 1) % n;
+  nb[1] = c;
+  nb[2] = (c + 1) % n;
+  return 3;
+}
+
+void rdf_grid_init(RdfGrid *grid, int n, double *pos, int stride, int *id, int *mol, double r_max)
+{
+  int i, d, c, n_total, *cell;
+
+  grid->n = n;
+  n_total = 1;
+  for (d = 0; d < 3; d++) {
+    /* cells of at least r_max; along open directions, all in one cell */
+    grid->n_cells[d] = (r_max > 0) ? (int)(box_l[d]/r_max) : 1;
+    if (grid->n_cells[d] < 1 || !PERIODIC(d))
+      grid->n_cells[d] = 1;
+  }
+  /* not much more cells than particles */
+  while (grid->n_cells[0]*grid->n_cells[1]*grid->n_cells[2] > 2*n + 27) {
+    d = 0;
+    if (grid->n_cells[1] > grid->n_cells[d]) d = 1;
+    if (grid->n_cells[2] > grid->n_cells[d]) d = 2;
+    grid->n_cells[d] /= 2;
+  }
+  for (d = 0; d < 3; d++) {
+    grid->inv_cell_size[d] = grid->n_cells[d]/box_l[d];
+    n_total *= grid->n_cells[d];
+  }
+
+  /* counting sort of the particles by cell */
+  cell = malloc((n + 1)*sizeof(int));
+  grid->cell_start = calloc(n_total + 1, sizeof(int));
+  for (i = 0; i < n; i++) {
+    double *p = pos + i*stride;
+    cell[i] = (rdf_cell_index(grid, p[2], 2)*grid->n_cells[1] +
+	       rdf_cell_index(grid, p[1], 1))*grid->n_cells[0] +
+      rdf_cell_index(grid, p[0], 0);
+    grid->cell_start[cell[i] + 1]++;
+  }
+  for (c = 0; c < n_total; c++)
+    grid->cell_start[c + 1] += grid->cell_start[c];
+
+  grid->pos = malloc((3*n + 1)*sizeof(double));
+  grid->id  = malloc((n + 1)*sizeof(int));
+  grid->mol = malloc((n + 1)*sizeof(int));
+  for (i = 0; i < n; i++) {
+    int j = grid->cell_start[cell[i]]++;
+    double *p = pos + i*stride;
+    for (d = 0; d < 3; d++)
+      grid->pos[3*j + d] = PERIODIC(d) ? p[d] - floor(p[d]/box_l[d])*box_l[d] : p[d];
+    grid->id[j]  = id  ? id[i]  : i;
+    grid->mol[j] = mol ? mol[i] : -1;
+  }
+  /* the cell starts have moved to the ends, shift back */
+  for (c = n_total; c > 0; c--)
+    grid->cell_start[c] = grid->cell_start[c - 1];
+  grid->cell_start[0] = 0;
+
+  free(cell);
+}
+
+void rdf_grid_free(RdfGrid *grid)
+{
+  free(grid->cell_start);
+  free(grid->pos);
+  free(grid->id);
+  free(grid->mol);
+  grid->cell_start = NULL;
+  grid->pos = NULL;
+  grid->id = grid->mol = NULL;
+  grid->n = 0;
+}
+
+void rdf_grid_histogram(RdfGrid *grid, double pos[3], int id, int mol, int flags,
+			double r_min, double r_max, int bins, double *hist)
+{
+  int nb[3][3], n_nb[3], d, x, y, z, c, j;
+  double inv_bin_width = 1.0/((r_max - r_min)/(double)bins);
+  double dist, dist2, r_max2 = SQR(r_max), vec[3];
+
+  for (d = 0; d < 3; d++)
+    n_nb[d] = rdf_neighbor_cells(grid, rdf_cell_index(grid, pos[d], d), d, nb[d]);
+
+  for (z = 0; z < n_nb[2]; z++)
+    for (y = 0; y < n_nb[1]; y++)
+      for (x = 0; x < n_nb[0]; x++) {
+	c = (nb[2][z]*grid->n_cells[1] + nb[1][y])*grid->n_cells[0] + nb[0][x];
+	for (j = grid->cell_start[c]; j < grid->cell_start[c + 1]; j++) {
+	  if (grid->id[j] == id ||
+	      ((flags & RDF_HALF) && grid->id[j] < id) ||
+	      ((flags & RDF_INTERMOL) && grid->mol[j] == mol))
+	    continue;
+	  get_mi_vector(vec, pos, grid->pos + 3*j);
+	  dist2 = sqrlen(vec);
+	  if (dist2 >= r_max2)
+	    continue;
+	  dist = sqrt(dist2);
+	  if (dist > r_min && dist < r_max)
+	    hist[(int)((dist - r_min)*inv_bin_width)] += 1;
+	}
+      }
+}
+
+double rdf_grid_min_dist2(RdfGrid *grid, double pos[3], int id, double r_max)
+{
+  int nb[3][3], n_nb[3], d, x, y, z, c, j;
+  double d2, min_d2 = -1, vec[3];
+
+  for (d = 0; d < 3; d++)
+    n_nb[d] = rdf_neighbor_cells(grid, rdf_cell_index(grid, pos[d], d), d, nb[d]);
+
+  for (z = 0; z < n_nb[2]; z++)
+    for (y = 0; y < n_nb[1]; y++)
+      for (x = 0; x < n_nb[0]; x++) {
+	c = (nb[2][z]*grid->n_cells[1] + nb[1][y])*grid->n_cells[0] + nb[0][x];
+	for (j = grid->cell_start[c]; j < grid->cell_start[c + 1]; j++) {
+	  if (grid->id[j] == id)
+	    continue;
+	  get_mi_vector(vec, pos, grid->pos + 3*j);
+	  d2 = sqrlen(vec);
+	  if (d2 <= SQR(r_max) && (min_d2 < 0 || d2 < min_d2))
+	    min_d2 = d2;
+	}
+      }
+  return min_d2;
+}
+
+int rdf_grid_partners(RdfGrid *grid, double pos[3], int id, double r_max, int *partners)
+{
+  int nb[3][3], n_nb[3], d, x, y, z, c, j, n = 0;
+  double vec[3];
+
+  for (d = 0; d < 3; d++)
+    n_nb[d] = rdf_neighbor_cells(grid, rdf_cell_index(grid, pos[d], d), d, nb[d]);
+
+  for (z = 0; z < n_nb[2]; z++)
+    for (y = 0; y < n_nb[1]; y++)
+      for (x = 0; x < n_nb[0]; x++) {
+	c = (nb[2][z]*grid->n_cells[1] + nb[1][y])*grid->n_cells[0] + nb[0][x];
+	for (j = grid->cell_start[c]; j < grid->cell_start[c + 1]; j++) {
+	  if (grid->id[j] == id)
+	    continue;
+	  get_mi_vector(vec, pos, grid->pos + 3*j);
+	  if (sqrlen(vec) < SQR(r_max))
+	    partners[n++] = grid->id[j];
+	}
+      }
+  return n;
+}
+
+/************************************************
+ * RDFs
+ ************************************************/
+
+int rdf_same_types(int *p1_types, int n_p1, int *p2_types, int n_p2)
+{
+  int i;
+  if (n_p1 != n_p2)
+    return 0;
+  for (i = 0; i < n_p1; i++)
+    if (p1_types[i] != p2_types[i])
+      return 0;
+  return 1;
+}
+
+void rdf_normalize(double r_min, double r_max, int bins, double cnt, double *hist)
+{
+  int i;
+  double bin_width = (r_max - r_min)/(double)bins;
+  double volume = box_l[0]*box_l[1]*box_l[2];
+  double r_in, r_out, bin_volume;
+
+  for (i = 0; i < bins; i++) {
+    r_in       = i*bin_width + r_min;
+    r_out      = r_in + bin_width;
+    bin_volume = (4.0/3.0) * PI * ((r_out*r_out*r_out) - (r_in*r_in*r_in));
+    hist[i] *= volume / (bin_volume * cnt);
+  }
+}
+
+/** whether a type is in a type list */
+MDINLINE int rdf_type_in(RdfParams *par, int list, int type)
+{
+  int t;
+  for (t = 0; t < par->n_types[list]; t++)
+    if (par->types[list][t] == type)
+      return 1;
+  return 0;
+}
+
+/** number of pairs of a configuration, including the ones beyond r_max. */
+static double rdf_pair_count(RdfParams *par, int *types, int *mol, int same)
+{
+  int i, min_mol = 0, max_mol = -1;
+  double n1 = 0, n2 = 0, cnt, *n1_mol, *n2_mol;
+
+  for (i = 0; i < par->n_part; i++) {
+    if (rdf_type_in(par, 0, types[i])) n1++;
+    if (rdf_type_in(par, 1, types[i])) n2++;
+    if (max_mol < min_mol) min_mol = max_mol = mol[i];
+    if (mol[i] < min_mol) min_mol = mol[i];
+    if (mol[i] > max_mol) max_mol = mol[i];
+  }
+  cnt = same ? 0.5*n1*(n1 - 1) : n1*n2;
+  if (!par->intermol)
+    return cnt;
+
+  /* subtract the pairs within the molecules */
+  n1_mol = calloc(max_mol - min_mol + 1, sizeof(double));
+  n2_mol = calloc(max_mol - min_mol + 1, sizeof(double));
+  for (i = 0; i < par->n_part; i++) {
+    if (rdf_type_in(par, 0, types[i])) n1_mol[mol[i] - min_mol]++;
+    if (rdf_type_in(par, 1, types[i])) n2_mol[mol[i] - min_mol]++;
+  }
+  for (i = 0; i <= max_mol - min_mol; i++)
+    cnt -= same ? 0.5*n1_mol[i]*(n1_mol[i] - 1) : n1_mol[i]*n2_mol[i];
+  free(n1_mol);
+  free(n2_mol);
+  return cnt;
+}
+
+void rdf_add_configs(RdfParams *par, int *types, int *mol, double *pos, int n, double *rdf)
+{
+  int same = rdf_same_types(par->types[0], par->n_types[0], par->types[1], par->n_types[1]);
+  int flags = (same ? RDF_HALF : 0) | (par->intermol ? RDF_INTERMOL : 0);
+  int i, k, n2;
+  int *ids2   = malloc((par->n_part + 1)*sizeof(int));
+  int *mol2   = malloc((par->n_part + 1)*sizeof(int));
+  double *pos2 = malloc((3*par->n_part + 1)*sizeof(double));
+  double *hist = malloc(par->bins*sizeof(double));
+  double cnt = rdf_pair_count(par, types, mol, same);
+  RdfGrid grid;
+
+  for (k = 0; k < n; k++) {
+    double *conf = pos + 3*k*par->n_part;
+
+    /* the partners */
+    n2 = 0;
+    for (i = 0; i < par->n_part; i++)
+      if (rdf_type_in(par, 1, types[i])) {
+	memcpy(pos2 + 3*n2, conf + 3*i, 3*sizeof(double));
+	ids2[n2] = i;
+	mol2[n2] = mol[i];
+	n2++;
+      }
+    rdf_grid_init(&grid, n2, pos2, 3, ids2, mol2, par->r_max);
+
+    for (i = 0; i < par->bins; i++) hist[i] = 0.0;
+    for (i = 0; i < par->n_part; i++)
+      if (rdf_type_in(par, 0, types[i]))
+	rdf_grid_histogram(&grid, conf + 3*i, i, mol[i], flags,
+			   par->r_min, par->r_max, par->bins, hist);
+    rdf_grid_free(&grid);
+
+    rdf_normalize(par->r_min, par->r_max, par->bins, cnt, hist);
+    for (i = 0; i < par->bins; i++)
+      rdf[i] += hist[i];
+  }
+
+  free(hist);
+  free(pos2);
+  free(mol2);
+  free(ids2);
+}
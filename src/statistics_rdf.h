@@ -0,0 +1,153 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef STATISTICS_RDF_H
+#define STATISTICS_RDF_H
+/** \file statistics_rdf.h
+    Pair distance histograms via a linked cell grid.
+
+    For radial distribution functions and minimal distances, only
+    pairs closer than some r_max contribute, which is usually much
+    smaller than the box. Therefore the reference particles are
+    sorted into a \ref RdfGrid with cells of at least r_max, and only
+    the neighboring cells are searched, which makes the calculation
+    O(N) instead of O(N^2).
+
+    The RDF of the current configuration is a \ref
+    statistics_local.h "local observable", i.e. every node bins the
+    pairs of its own particles. For the RDFs averaged over the stored
+    configurations, the configurations are distributed over the nodes
+    by \ref mpi_rdf_configs, and the histograms are summed up.
+*/
+
+#include "statistics_local.h"
+
+/************************************************
+ * defines
+ ************************************************/
+
+/** \name Flags for \ref rdf_grid_histogram */
+/*@{*/
+/** count only partners with a larger identity, i.e. every pair once */
+#define RDF_HALF     1
+/** count only partners in other molecules */
+#define RDF_INTERMOL 2
+/*@}*/
+
+/************************************************
+ * data types
+ ************************************************/
+
+/** A set of reference particles, sorted into cells. */
+typedef struct {
+  /** number of particles */
+  int n;
+  /** number of cells in each direction */
+  int n_cells[3];
+  /** inverse cell size */
+  double inv_cell_size[3];
+  /** index of the first particle of each cell, n_cells+1 entries */
+  int *cell_start;
+  /** the folded positions, sorted by cell */
+  double *pos;
+  /** the identities, sorted by cell */
+  int *id;
+  /** the molecule ids, sorted by cell */
+  int *mol;
+} RdfGrid;
+
+/** The parameters of an RDF averaged over the stored configurations. */
+typedef struct {
+  /** number of types in the type lists */
+  int n_types[2];
+  /** the type lists */
+  int types[2][LOCAL_MAX_TYPES];
+  /** the range of the histogram */
+  double r_min, r_max;
+  /** the number of bins */
+  int bins;
+  /** whether only pairs in different molecules count */
+  int intermol;
+  /** number of particles per configuration */
+  int n_part;
+  /** number of configurations */
+  int n_conf;
+} RdfParams;
+
+/************************************************
+ * functions
+ ************************************************/
+
+/** sort reference particles into cells.
+    @param grid   the grid to initialize
+    @param n      the number of particles
+    @param pos    their positions, which need not be folded
+    @param stride distance of the positions in pos in doubles
+    @param id     their identities, or NULL for the index
+    @param mol    their molecule ids, or NULL
+    @param r_max  the minimal cell size */
+void rdf_grid_init(RdfGrid *grid, int n, double *pos, int stride, int *id, int *mol, double r_max);
+
+/** free a grid. */
+void rdf_grid_free(RdfGrid *grid);
+
+/** add the distances of a particle to the reference particles to a
+    histogram. The particle itself, i.e. a reference particle with the
+    same identity, is skipped.
+    @param grid   the reference particles
+    @param pos    position of the particle
+    @param id     its identity
+    @param mol    its molecule id
+    @param flags  or of \ref RDF_HALF and \ref RDF_INTERMOL
+    @param r_min  histogram range, exclusive
+    @param r_max  histogram range, exclusive, at most the cell size
+    @param bins   number of bins
+    @param hist   the histogram */
+void rdf_grid_histogram(RdfGrid *grid, double pos[3], int id, int mol, int flags,
+			double r_min, double r_max, int bins, double *hist);
+
+/** minimal squared distance of a particle to the other reference particles.
+    @return the squared distance, or -1 if there is none within r_max,
+    which is at most the cell size */
+double rdf_grid_min_dist2(RdfGrid *grid, double pos[3], int id, double r_max);
+
+/** the reference particles closer than r_max to a particle. The
+    particle itself is skipped.
+    @param partners where to store the identities of the partners, at
+                    least grid->n entries
+    @return the number of partners */
+int rdf_grid_partners(RdfGrid *grid, double pos[3], int id, double r_max, int *partners);
+
+/** whether the two type lists are equal, i.e. every pair counts once. */
+int rdf_same_types(int *p1_types, int n_p1, int *p2_types, int n_p2);
+
+/** turn a pair histogram into the RDF, i.e. divide by the ideal gas.
+    @param cnt number of pairs of which the histogram was taken */
+void rdf_normalize(double r_min, double r_max, int bins, double cnt, double *hist);
+
+/** add the normalized RDFs of some configurations. Called on all nodes
+    by \ref mpi_rdf_configs.
+    @param par   the parameters
+    @param types the types of the particles
+    @param mol   the molecule ids of the particles
+    @param pos   the configurations, 3*n_part doubles each
+    @param n     number of configurations in pos
+    @param rdf   the sum of the RDFs */
+void rdf_add_configs(RdfParams *par, int *types, int *mol, double *pos, int n, double *rdf);
+
+#endif
@@ -0,0 +1,209 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file statistics_sf.c
+    Implementation of \ref statistics_sf.h "statistics_sf.h".
+*/
+#include <stdlib.h>
+#include <mpi.h>
+#include "utils.h"
+#include "statistics_sf.h"
+#include "communication.h"
+#include "cells.h"
+#include "grid.h"
+#include "integrate.h"
+#include "initialize.h"
+#include "fft.h"
+#include "p3m-common.h"
+
+#ifdef P3M
+
+/** the FFT plans of the structure factor mesh */
+static fft_mesh_plans sf_plans;
+/** the structure factor mesh, see \ref fft_mesh_init */
+static double *sf_mesh = NULL;
+/** buffers for \ref p3m_gather_mesh */
+static double *sf_send_grid = NULL, *sf_recv_grid = NULL;
+
+/************************************************
+ * helpers
+ ************************************************/
+
+/** add a particle to the local mesh.
+    @param lm        the local mesh
+    @param ai        the inverse mesh constants
+    @param pos_shift offset of the first assigned mesh point
+    @param cao       the charge assignment order
+    @param pos       the position of the particle */
+static void sf_assign(local_mesh *lm, double ai[3], double pos_shift, int cao, double pos[3])
+{
+  int d, i0, i1, i2, nmp, ind = 0;
+  double p, dist[3], w[3][7];
+
+  for (d = 0; d < 3; d++) {
+    /* position in local mesh coordinates, and the nearest mesh point */
+    p = (pos[d] - lm->ld_pos[d])*ai[d] - pos_shift;
+    nmp = (int)p;
+    dist[d] = (p - nmp) - 0.5;
+    ind = (d == 0) ? nmp : nmp + lm->dim[d]*ind;
+  }
+  for (d = 0; d < 3; d++)
+    for (i0 = 0; i0 < cao; i0++)
+      w[d][i0] = P3M_caf(i0, dist[d], cao);
+
+  for (i0 = 0; i0 < cao; i0++) {
+    for (i1 = 0; i1 < cao; i1++) {
+      for (i2 = 0; i2 < cao; i2++)
+	sf_mesh[ind++] += w[0][i0]*w[1][i1]*w[2][i2];
+      ind += lm->q_2_off;
+    }
+    ind += lm->q_21_off;
+  }
+}
+
+/** add |rho(k)|^2 of the wave vectors of this node to the bins, see
+    \ref sf_calc. In k-space, the mesh index d belongs to the direction
+    (d + ks_pnum)%3, as in p3m.c. Only the wave vectors of the half
+    space n_x >= 0 are counted. The mesh only holds the non-negative
+    frequencies along \ref fft_ks_half_dir, so a wave vector k on the
+    mesh also stands for -k, which has the same |rho|.
+    @param par     the parameters
+    @param ks_pnum the k-space permutation from \ref fft_mesh_init
+    @param res     the sums and counts of the bins */
+static void sf_bin(SfParams *par, int ks_pnum, double *res)
+{
+  fft_forw_plan *plan = &sf_plans.plan[3];
+  int d, i, ind, n[3], n_s[3], n2, end[3], x, h, w;
+  double *inv_w2, rho2;
+
+  /* the mesh index of the x direction, and of the halved direction */
+  x = (3 - ks_pnum%3)%3;
+  h = fft_ks_half_dir(sf_plans.plan);
+
+  /* the squared Fourier transform of the assignment function, inverted */
+  inv_w2 = malloc((par->order + 1)*sizeof(double));
+  for (i = 0; i <= par->order; i++)
+    inv_w2[i] = 1.0/pow(sinc(i/(double)par->mesh), 2.0*par->cao);
+
+  for (d = 0; d < 3; d++)
+    end[d] = plan->start[d] + plan->new_mesh[d];
+
+  ind = 0;
+  for (n[0] = plan->start[0]; n[0] < end[0]; n[0]++)
+    for (n[1] = plan->start[1]; n[1] < end[1]; n[1]++)
+      for (n[2] = plan->start[2]; n[2] < end[2]; n[2]++, ind++) {
+	n2 = 0;
+	for (d = 0; d < 3; d++) {
+	  n_s[d] = (n[d] > par->mesh/2) ? n[d] - par->mesh : n[d];
+	  n2 += n_s[d]*n_s[d];
+	}
+	if (n2 < 1 || n2 > par->order*par->order)
+	  continue;
+	/* k and, if it is not on the mesh, -k in the half space n_x >= 0 */
+	w = (n_s[x] >= 0);
+	if (fft_ks_weight(sf_plans.plan, n[h]) == 2 && (n_s[x] <= 0 || 2*n_s[x] == par->mesh))
+	  w++;
+	if (w == 0)
+	  continue;
+
+	rho2 = SQR(sf_mesh[2*ind]) + SQR(sf_mesh[2*ind + 1]);
+	res[2*n2 - 2] += w*rho2*inv_w2[abs(n_s[0])]*inv_w2[abs(n_s[1])]*inv_w2[abs(n_s[2])];
+	res[2*n2 - 1] += w;
+      }
+
+  free(inv_w2);
+}
+
+/************************************************
+ * public functions
+ ************************************************/
+
+int sf_min_mesh(int cao)
+{
+  int d, mesh, min_mesh = 1;
+
+  for (d = 0; d < 3; d++) {
+    if (local_box_l[d] <= skin)
+      return -1;
+    /* the margin 0.5*cao*box_l/mesh + skin has to be smaller than local_box_l */
+    mesh = (int)floor(0.5*cao*box_l[d]/(local_box_l[d] - skin)) + 1;
+    if (mesh > min_mesh)
+      min_mesh = mesh;
+  }
+  return min_mesh;
+}
+
+void sf_calc(SfParams *par, double *sf)
+{
+  local_mesh lm;
+  send_mesh sm;
+  Cell *cell;
+  Particle *p;
+  int mesh[3], ks_pnum, c, i, np, d, n_sf = par->order*par->order;
+  double ai[3], mesh_off[3], full_skin[3], pos_shift, *res;
+
+  on_observable_calc();
+
+  /* the local mesh, including the margins that particles in the skin assign to */
+  for (d = 0; d < 3; d++) {
+    mesh[d]      = par->mesh;
+    mesh_off[d]  = P3M_MESHOFF;
+    ai[d]        = par->mesh/box_l[d];
+    full_skin[d] = 0.5*par->cao/ai[d] + skin;
+  }
+  p3m_calc_local_mesh(&lm, ai, mesh_off, full_skin, par->cao);
+  p3m_calc_send_mesh(&sm, &lm);
+  sf_send_grid = realloc(sf_send_grid, sm.max*sizeof(double));
+  sf_recv_grid = realloc(sf_recv_grid, sm.max*sizeof(double));
+  fft_mesh_init(&sf_plans, mesh, mesh_off, &sf_mesh, lm.dim, lm.margin, &ks_pnum);
+
+  /* the sums of S and the numbers of wave vectors, and the number of particles */
+  res = calloc(2*n_sf + 1, sizeof(double));
+
+  /* density of the particles */
+  for (i = 0; i < lm.size; i++)
+    sf_mesh[i] = 0;
+  pos_shift = (double)((par->cao - 1)/2) - (par->cao%2)/2.0;
+  for (c = 0; c < local_cells.n; c++) {
+    cell = local_cells.cell[c];
+    p  = cell->part;
+    np = cell->n;
+    for (i = 0; i < np; i++)
+      if (p[i].p.type == par->type) {
+	sf_assign(&lm, ai, pos_shift, par->cao, p[i].r.p);
+	res[2*n_sf]++;
+      }
+  }
+  p3m_gather_mesh(sf_mesh, &lm, &sm, sf_send_grid, sf_recv_grid);
+
+  fft_mesh_perform_forw(&sf_plans, sf_mesh);
+  sf_bin(par, ks_pnum, res);
+
+  MPI_Reduce(this_node == 0 ? MPI_IN_PLACE : res, res, 2*n_sf + 1, MPI_DOUBLE, MPI_SUM,
+	     0, MPI_COMM_WORLD);
+
+  if (this_node == 0) {
+    for (i = 0; i < n_sf; i++) {
+      sf[2*i + 1] = res[2*i + 1];
+      sf[2*i] = (res[2*i + 1] > 0 && res[2*n_sf] > 0) ? res[2*i]/(res[2*n_sf]*res[2*i + 1]) : 0;
+    }
+  }
+  free(res);
+}
+
+#endif
@@ -0,0 +1,77 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef STATISTICS_SF_H
+#define STATISTICS_SF_H
+/** \file statistics_sf.h
+    Structure factors via a particle mesh.
+
+    The explicit sum of \ref calc_structurefactor over all wave
+    vectors up to some order and all particles costs O(N order^3) on
+    the master. Instead, every node assigns its particles of a type
+    to a mesh of M^3 points with the P3M charge assignment functions
+    of order cao, the mesh is transformed by the parallel 3D-FFT of
+    \ref fft.h, and |rho(k)|^2 is binned on the nodes that hold the
+    wave vectors. Dividing by the square of the Fourier transformed
+    assignment function removes its smoothing, the remaining aliasing
+    error decays like (2 order/M)^(2 cao). The costs are O(N cao^3 +
+    M^3 log(M)), distributed over the nodes.
+
+    As for the explicit sum, the wave vectors are 2 pi n/L with n_x
+    >= 0, and they are binned by |n|^2.
+*/
+
+#include "utils.h"
+
+/************************************************
+ * data types
+ ************************************************/
+
+/** The parameters of a structure factor, which are broadcasted. */
+typedef struct {
+  /** the particle type */
+  int type;
+  /** the maximal |n| */
+  int order;
+  /** the number of mesh points in each direction */
+  int mesh;
+  /** the charge assignment order */
+  int cao;
+} SfParams;
+
+/************************************************
+ * functions
+ ************************************************/
+
+#ifdef P3M
+/** the smallest mesh for which the assignment margins of a node do
+    not reach beyond its neighbors, or -1 if there is none.
+    @param cao the charge assignment order */
+int sf_min_mesh(int cao);
+
+/** calculate a structure factor via the mesh. Called on all nodes by
+    \ref mpi_structure_factor.
+    @param par the parameters
+    @param sf  on the master, where to store the structure factor in
+               the format of \ref calc_structurefactor, i.e. S for
+	       |n|^2 = i + 1 and the number of wave vectors for each
+	       i < order^2. NULL on the other nodes. */
+void sf_calc(SfParams *par, double *sf);
+#endif
+
+#endif
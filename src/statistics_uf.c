@@ -0,0 +1,344 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file statistics_uf.c
+    Implementation of \ref statistics_uf.h "statistics_uf.h".
+*/
+#include <stdlib.h>
+#include <mpi.h>
+#include "utils.h"
+#include "statistics_uf.h"
+#include "statistics_rdf.h"
+#include "statistics.h"
+#include "communication.h"
+#include "cells.h"
+#include "domain_decomposition.h"
+#include "initialize.h"
+
+/************************************************
+ * helpers
+ ************************************************/
+
+/** the identity of the cluster element a particle belongs to, or -1
+    if it does not take part. */
+MDINLINE int cluster_key(ClusterParams *par, Particle *p)
+{
+  if (par->mode == CLUSTER_MOLECULES)
+    return (p->p.mol_id >= par->mol_start && p->p.mol_id <= par->mol_end) ? p->p.mol_id : -1;
+  return (par->type < 0 || p->p.type == par->type) ? p->p.identity : -1;
+}
+
+/** compare two pairs of ints lexicographically, for qsort. */
+static int cluster_compare_pairs(const void *a, const void *b)
+{
+  const int *p = a, *q = b;
+  if (p[0] != q[0])
+    return (p[0] < q[0]) ? -1 : 1;
+  if (p[1] != q[1])
+    return (p[1] < q[1]) ? -1 : 1;
+  return 0;
+}
+
+/** join a close pair, or record it as a contact of two molecules if
+    more than one contact is needed. */
+MDINLINE void cluster_pair(ClusterParams *par, Particle *p1, Particle *p2,
+			   int *uf, IntList *contacts)
+{
+  int k1 = cluster_key(par, p1), k2 = cluster_key(par, p2);
+
+  if (k1 < 0 || k2 < 0 || k1 == k2)
+    return;
+#ifdef ELECTROSTATICS
+  if (par->charge && p1->p.q*p2->p.q >= 0)
+    return;
+#endif
+  if (distance2(p1->r.p, p2->r.p) >= SQR(par->dist))
+    return;
+
+  if (par->min_contact > 1) {
+    if (contacts->n + 2 > contacts->max)
+      realloc_grained_intlist(contacts, contacts->n + 2, 1024);
+    contacts->e[contacts->n++] = imin(k1, k2);
+    contacts->e[contacts->n++] = imax(k1, k2);
+  }
+  else
+    uf_union(uf, k1, k2);
+}
+
+/** join the close pairs of the local particles, including those with
+    the ghosts, in the same half shell loop as the short ranged forces. */
+static void cluster_local_pairs(ClusterParams *par, int *uf, IntList *contacts)
+{
+  int c, n, i, j, np1, np2;
+  Particle *p1, *p2;
+
+  for (c = 0; c < local_cells.n; c++) {
+    p1  = local_cells.cell[c]->part;
+    np1 = local_cells.cell[c]->n;
+    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
+      p2  = dd.cell_inter[c].nList[n].pList->part;
+      np2 = dd.cell_inter[c].nList[n].pList->n;
+      for (i = 0; i < np1; i++)
+	for (j = (n == 0) ? i + 1 : 0; j < np2; j++)
+	  cluster_pair(par, &p1[i], &p2[j], uf, contacts);
+    }
+  }
+}
+
+/** sort the contacts of molecule pairs and count them.
+    @param contacts the pairs of molecule ids
+    @param counted  where to store the malloced triples of the
+                    molecule ids and the number of contacts
+    @return the number of different pairs */
+static int cluster_count_contacts(IntList *contacts, int **counted)
+{
+  int i, n = 0, n_pairs = contacts->n/2, *e = contacts->e, *t;
+
+  qsort(e, n_pairs, 2*sizeof(int), cluster_compare_pairs);
+  t = malloc((3*n_pairs + 1)*sizeof(int));
+  for (i = 0; i < n_pairs; i++) {
+    if (n > 0 && t[3*n - 3] == e[2*i] && t[3*n - 2] == e[2*i + 1]) {
+      t[3*n - 1]++;
+      continue;
+    }
+    t[3*n] = e[2*i]; t[3*n + 1] = e[2*i + 1]; t[3*n + 2] = 1;
+    n++;
+  }
+  *counted = t;
+  return n;
+}
+
+/** concatenate the ints of all nodes on the master.
+    @return on the master, the total number */
+static int cluster_gather(int *local, int n, int **all)
+{
+  int i, tot = 0, *sizes = NULL, *displs = NULL;
+
+  if (this_node == 0) {
+    sizes  = malloc(n_nodes*sizeof(int));
+    displs = malloc(n_nodes*sizeof(int));
+  }
+  MPI_Gather(&n, 1, MPI_INT, sizes, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (this_node == 0) {
+    for (i = 0; i < n_nodes; i++) {
+      displs[i] = tot;
+      tot += sizes[i];
+    }
+    *all = malloc((tot + 1)*sizeof(int));
+  }
+  MPI_Gatherv(local, n, MPI_INT, this_node == 0 ? *all : NULL, sizes, displs,
+	      MPI_INT, 0, MPI_COMM_WORLD);
+  free(displs);
+  free(sizes);
+  return tot;
+}
+
+/** number the clusters of the members of a forest by their smallest
+    member, and list their members.
+    @param uf     the forest
+    @param n_keys the number of elements of the forest
+    @param member which elements are members of the clusters
+    @return the number of clusters */
+static int cluster_collect(int *uf, int n_keys, char *member, int **sizes, int **members)
+{
+  int k, n_cl = 0, n_m = 0, *index, *offset;
+
+  /* index of the cluster of each root */
+  index = malloc((n_keys + 1)*sizeof(int));
+  for (k = 0; k < n_keys; k++)
+    index[k] = -1;
+  for (k = 0; k < n_keys; k++)
+    if (member[k]) {
+      int r = uf_find(uf, k);
+      if (index[r] < 0)
+	index[r] = n_cl++;
+      n_m++;
+    }
+
+  *sizes = calloc(n_cl + 1, sizeof(int));
+  for (k = 0; k < n_keys; k++)
+    if (member[k])
+      (*sizes)[index[uf_find(uf, k)]]++;
+
+  /* counting sort of the members by cluster */
+  offset = malloc((n_cl + 1)*sizeof(int));
+  offset[0] = 0;
+  for (k = 0; k < n_cl; k++)
+    offset[k + 1] = offset[k] + (*sizes)[k];
+  *members = malloc((n_m + 1)*sizeof(int));
+  for (k = 0; k < n_keys; k++)
+    if (member[k])
+      (*members)[offset[index[uf_find(uf, k)]]++] = k;
+
+  free(offset);
+  free(index);
+  return n_cl;
+}
+
+/************************************************
+ * public functions
+ ************************************************/
+
+double cluster_max_dist()
+{
+  int d;
+  double max_dist;
+
+  if (cell_structure.type != CELL_STRUCTURE_DOMDEC)
+    return 0;
+  max_dist = dd.cell_size[0];
+  for (d = 1; d < 3; d++)
+    max_dist = dmin(max_dist, dd.cell_size[d]);
+  return max_dist;
+}
+
+int cluster_calc(ClusterParams *par, int **sizes, int **members)
+{
+  int *uf, *links, *ids = NULL, *counted = NULL, *all = NULL;
+  int n_links = 0, n_ids = 0, n_contacts = 0, c, i, k, n = 0;
+  char *member;
+  IntList contacts;
+  Particle *p;
+
+  on_observable_calc();
+
+  uf = malloc((par->n_keys + 1)*sizeof(int));
+  uf_init(uf, par->n_keys);
+  init_intlist(&contacts);
+  cluster_local_pairs(par, uf, &contacts);
+  if (par->min_contact > 1)
+    n_contacts = cluster_count_contacts(&contacts, &counted);
+
+  /* the links of the local forest. Links to ghosts join the clusters
+     with those of the neighbors. */
+  for (k = 0; k < par->n_keys; k++)
+    if (uf[k] >= 0)
+      n_links++;
+  links = malloc((2*n_links + 1)*sizeof(int));
+  for (k = 0, i = 0; k < par->n_keys; k++)
+    if (uf[k] >= 0) {
+      links[i++] = k;
+      links[i++] = uf_find(uf, k);
+    }
+
+  /* the members of particle clusters, the molecules are known */
+  if (par->mode == CLUSTER_PARTICLES) {
+    for (c = 0; c < local_cells.n; c++)
+      n_ids += local_cells.cell[c]->n;
+    ids = malloc((n_ids + 1)*sizeof(int));
+    n_ids = 0;
+    for (c = 0; c < local_cells.n; c++) {
+      p = local_cells.cell[c]->part;
+      for (i = 0; i < local_cells.cell[c]->n; i++)
+	if (cluster_key(par, &p[i]) >= 0)
+	  ids[n_ids++] = p[i].p.identity;
+    }
+  }
+
+  /* join everything on the master */
+  n_links = cluster_gather(links, 2*n_links, &all);
+  if (this_node == 0) {
+    uf_init(uf, par->n_keys);
+    for (i = 0; i < n_links; i += 2)
+      uf_union(uf, all[i], all[i + 1]);
+    free(all);
+  }
+
+  if (par->min_contact > 1) {
+    n_contacts = cluster_gather(counted, 3*n_contacts, &all);
+    if (this_node == 0) {
+      /* sum up the contacts of the pairs from all nodes */
+      qsort(all, n_contacts/3, 3*sizeof(int), cluster_compare_pairs);
+      for (i = 0; i < n_contacts; i += 3) {
+	int cnt = all[i + 2];
+	while (i + 3 < n_contacts && all[i + 3] == all[i] && all[i + 4] == all[i + 1]) {
+	  i += 3;
+	  cnt += all[i + 2];
+	}
+	if (cnt >= par->min_contact)
+	  uf_union(uf, all[i], all[i + 1]);
+      }
+      free(all);
+    }
+  }
+
+  member = calloc(par->n_keys + 1, 1);
+  if (par->mode == CLUSTER_PARTICLES) {
+    n_ids = cluster_gather(ids, n_ids, &all);
+    if (this_node == 0) {
+      for (i = 0; i < n_ids; i++)
+	member[all[i]] = 1;
+      free(all);
+    }
+  }
+  else
+    for (k = par->mol_start; k <= par->mol_end; k++)
+      member[k] = 1;
+
+  if (this_node == 0)
+    n = cluster_collect(uf, par->n_keys, member, sizes, members);
+
+  free(member);
+  free(ids);
+  free(links);
+  free(counted);
+  free(contacts.e);
+  free(uf);
+  return n;
+}
+
+int cluster_calc_partcfg(ClusterParams *par, int **sizes, int **members)
+{
+  int i, j, n = 0, n_p, *uf, *ids, *partners;
+  double *pos;
+  char *member;
+  RdfGrid grid;
+
+  updatePartCfg(WITHOUT_BONDS);
+
+  pos = malloc((3*n_total_particles + 1)*sizeof(double));
+  ids = malloc((n_total_particles + 1)*sizeof(int));
+  member = calloc(par->n_keys + 1, 1);
+  for (i = 0; i < n_total_particles; i++)
+    if (cluster_key(par, &partCfg[i]) >= 0) {
+      for (j = 0; j < 3; j++)
+	pos[3*n + j] = partCfg[i].r.p[j];
+      ids[n++] = partCfg[i].p.identity;
+      member[partCfg[i].p.identity] = 1;
+    }
+
+  rdf_grid_init(&grid, n, pos, 3, ids, NULL, par->dist);
+  uf = malloc((par->n_keys + 1)*sizeof(int));
+  uf_init(uf, par->n_keys);
+  partners = malloc((n + 1)*sizeof(int));
+  for (i = 0; i < n; i++) {
+    n_p = rdf_grid_partners(&grid, pos + 3*i, ids[i], par->dist, partners);
+    for (j = 0; j < n_p; j++)
+      uf_union(uf, ids[i], partners[j]);
+  }
+
+  n = cluster_collect(uf, par->n_keys, member, sizes, members);
+
+  free(partners);
+  free(uf);
+  rdf_grid_free(&grid);
+  free(member);
+  free(ids);
+  free(pos);
+  return n;
+}
@@ -0,0 +1,145 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef STATISTICS_UF_H
+#define STATISTICS_UF_H
+/** \file statistics_uf.h
+    Cluster analysis via a disjoint-set forest.
+
+    Two particles, or two molecules, belong to the same cluster if
+    they are connected by a chain of close pairs. Instead of comparing
+    all pairs on the master, every node finds the close pairs of its
+    particles in the cells of the domain decomposition, i.e. also the
+    pairs with the ghosts, and joins them in a disjoint-set forest
+    (union-find) over the identities. Since a ghost has the identity of
+    the real particle on the neighboring node, the clusters of the
+    nodes are joined on the master just by joining the links of all
+    forests, which is O(N) in total.
+
+    Without the domain decomposition, or for distances larger than
+    its cells, \ref cluster_calc_partcfg does the same on the master
+    with the cell grid of \ref statistics_rdf.h.
+*/
+
+#include "utils.h"
+
+/************************************************
+ * defines
+ ************************************************/
+
+/** \name Modes of \ref ClusterParams */
+/*@{*/
+/** the clusters consist of particles of a type */
+#define CLUSTER_PARTICLES 0
+/** the clusters consist of molecules, i.e. aggregates */
+#define CLUSTER_MOLECULES 1
+/*@}*/
+
+/************************************************
+ * data types
+ ************************************************/
+
+/** The parameters of a cluster analysis, which are broadcasted. */
+typedef struct {
+  /** \ref CLUSTER_PARTICLES or \ref CLUSTER_MOLECULES */
+  int mode;
+  /** the particle type, or -1 for all particles. Only particle mode. */
+  int type;
+  /** the range of molecule ids. Only molecule mode. */
+  int mol_start, mol_end;
+  /** the distance below which two particles are neighbors */
+  double dist;
+  /** the number of close pairs that join two molecules */
+  int min_contact;
+  /** whether only oppositely charged pairs count */
+  int charge;
+  /** the number of identities, i.e. max_seen_particle+1 or mol_end+1 */
+  int n_keys;
+} ClusterParams;
+
+/************************************************
+ * union-find
+ ************************************************/
+
+/** initialize a disjoint-set forest of n single element sets. A root
+    r is stored as -(size of its set), other elements point to their
+    parents. */
+MDINLINE void uf_init(int *uf, int n)
+{
+  int i;
+  for (i = 0; i < n; i++)
+    uf[i] = -1;
+}
+
+/** the root of the set of element i. Halves the path on the way. */
+MDINLINE int uf_find(int *uf, int i)
+{
+  while (uf[i] >= 0) {
+    if (uf[uf[i]] >= 0)
+      uf[i] = uf[uf[i]];
+    i = uf[i];
+  }
+  return i;
+}
+
+/** join the sets of elements i and j, the smaller one is attached to
+    the root of the larger one.
+    @return the new root */
+MDINLINE int uf_union(int *uf, int i, int j)
+{
+  int t;
+  i = uf_find(uf, i);
+  j = uf_find(uf, j);
+  if (i == j)
+    return i;
+  if (uf[i] > uf[j]) {
+    t = i; i = j; j = t;
+  }
+  uf[i] += uf[j];
+  uf[j] = i;
+  return i;
+}
+
+/************************************************
+ * functions
+ ************************************************/
+
+/** the largest distance for which \ref cluster_calc finds all close
+    pairs, i.e. the smallest cell size, or 0 if the cell system is not
+    the domain decomposition. */
+double cluster_max_dist();
+
+/** find the clusters. Called on all nodes by \ref
+    mpi_cluster_analysis.
+    @param par     the parameters. dist must not exceed \ref cluster_max_dist.
+    @param sizes   on the master, where to store the malloced sizes of
+                   the clusters. The clusters are ordered by their
+		   smallest identity.
+    @param members on the master, where to store the malloced
+                   identities of the members, ascending in each
+		   cluster and concatenated in the order of the clusters.
+    @return on the master, the number of clusters. */
+int cluster_calc(ClusterParams *par, int **sizes, int **members);
+
+/** find the clusters in \ref partCfg, with the same output as \ref
+    cluster_calc. Only particle mode, and without the charge
+    criterion. The pairs are found with the minimum image convention
+    and any distance. */
+int cluster_calc_partcfg(ClusterParams *par, int **sizes, int **members);
+
+#endif
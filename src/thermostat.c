@@ -121,6 +121,42 @@ int tclcommand_thermostat_parse_langevin(Tcl_Interp *interp, int argc, char **ar
   return (TCL_OK);
 }
 
+int tclcommand_thermostat_parse_rng(Tcl_Interp *interp, int argc, char **argv) 
+{
+  int seed;
+
+  if (argc >= 3 && ARG_IS_S(2, "ran1")) {
+    random_backend = RANDOM_BACKEND_RAN1;
+    mpi_bcast_parameter(FIELD_RANDOM_BACKEND);
+    return (TCL_OK);
+  }
+  if (argc >= 3 && ARG_IS_S(2, "philox")) {
+    if (argc < 4 || !ARG_IS_I(3, seed)) {
+      Tcl_AppendResult(interp, argv[0]," ",argv[1]," philox needs an INTEGER seed", (char *)NULL);
+      return (TCL_ERROR);
+    }
+    philox_seed = seed;
+    random_backend = RANDOM_BACKEND_PHILOX;
+    mpi_bcast_parameter(FIELD_PHILOX_SEED);
+    mpi_bcast_parameter(FIELD_RANDOM_BACKEND);
+    return (TCL_OK);
+  }
+  Tcl_AppendResult(interp, "wrong # args:  should be \n\"",
+		   argv[0]," ",argv[1]," ran1 | philox <seed>\"", (char *)NULL);
+  return (TCL_ERROR);
+}
+
+int tclcommand_thermostat_print_rng(Tcl_Interp *interp)
+{
+  char buffer[TCL_INTEGER_SPACE];
+
+  if (random_backend == RANDOM_BACKEND_PHILOX) {
+    sprintf(buffer, "%d", philox_seed);
+    Tcl_AppendResult(interp,"{ rng philox ",buffer, " } ", (char *)NULL);
+  }
+  return (TCL_OK);
+}
+
 #ifdef NPT
 int tclcommand_thermostat_parse_npt_isotropic(Tcl_Interp *interp, int argc, char **argv) 
 {
@@ -162,7 +198,7 @@ int tclcommand_thermostat_print_all(Tcl_Interp *interp)
   /* no thermostat on */
   if(thermo_switch == THERMO_OFF) {
     Tcl_AppendResult(interp,"{ off } ", (char *)NULL);
-    return (TCL_OK);
+    return tclcommand_thermostat_print_rng(interp);
   }
 
   /* langevin */
@@ -205,7 +241,7 @@ int tclcommand_thermostat_print_all(Tcl_Interp *interp)
     Tcl_AppendResult(interp,"{ inter_dpd ",buffer, " } ", (char *)NULL);
   }
 #endif
-  return (TCL_OK);
+  return tclcommand_thermostat_print_rng(interp);
 }
 
 int tclcommand_thermostat_print_usage(Tcl_Interp *interp, int argc, char **argv)
@@ -214,6 +250,7 @@ int tclcommand_thermostat_print_usage(Tcl_Interp *interp, int argc, char **argv)
   Tcl_AppendResult(interp, "'", argv[0], "' for status return or \n ", (char *)NULL);
   Tcl_AppendResult(interp, "'", argv[0], " set off' to deactivate it (=> NVE-ensemble) \n ", (char *)NULL);
   Tcl_AppendResult(interp, "'", argv[0], " set langevin <temp> <gamma>' or \n ", (char *)NULL);
+  Tcl_AppendResult(interp, "'", argv[0], " set rng { ran1 | philox <seed> }' to choose the noise generator or \n ", (char *)NULL);
 #ifdef DPD
   tclcommand_thermostat_print_usage_dpd(interp,argc,argv);
 #endif
@@ -250,6 +287,8 @@ int tclcommand_thermostat(ClientData data, Tcl_Interp *interp, int argc, char **
     err = tclcommand_thermostat_parse_off(interp, argc, argv);
   else if ( ARG1_IS_S("langevin"))
     err = tclcommand_thermostat_parse_langevin(interp, argc, argv);
+  else if ( ARG1_IS_S("rng"))
+    err = tclcommand_thermostat_parse_rng(interp, argc, argv);
 #ifdef DPD
   else if ( ARG1_IS_S("dpd") )
     err = tclcommand_thermostat_parse_dpd(interp, argc, argv);
@@ -130,6 +130,7 @@ MDINLINE void friction_thermo_langevin(Particle *p)
   extern double langevin_pref1, langevin_pref2;
 
   int j;
+  double noise[3];
 #ifdef MASS
   double massf = sqrt(PMASS(*p));
 #else
@@ -157,13 +158,14 @@ MDINLINE void friction_thermo_langevin(Particle *p)
  #endif
 #endif	  
 
+  noise_uniform(PHILOX_STREAM_LANGEVIN, p->p.identity, 0, 3, noise);
   for ( j = 0 ; j < 3 ; j++) {
 #ifdef EXTERNAL_FORCES
 //    if (!(p->l.ext_flag & COORD_FIXED(j)))
     if (1==1)
 #endif
       {
-      p->f.f[j] = langevin_pref1*p->m.v[j]*PMASS(*p) + langevin_pref2*(d_random()-0.5)*massf;
+      p->f.f[j] = langevin_pref1*p->m.v[j]*PMASS(*p) + langevin_pref2*noise[j]*massf;
     }
 #ifdef EXTERNAL_FORCES
     else p->f.f[j] = 0;
@@ -185,6 +187,7 @@ MDINLINE void friction_thermo_langevin_rotation(Particle *p)
   extern double langevin_pref2;
 
   int j;
+  double noise[3];
 #ifdef VIRTUAL_SITES
  #ifndef VIRTUAL_SITES_THERMOSTAT
     if (ifParticleIsVirtual(p))
@@ -204,9 +207,10 @@ MDINLINE void friction_thermo_langevin_rotation(Particle *p)
    }
  #endif
 #endif	  
+      noise_uniform(PHILOX_STREAM_LANGEVIN_ROT, p->p.identity, 0, 3, noise);
       for ( j = 0 ; j < 3 ; j++) 
       {
-	p->f.torque[j] = -langevin_gamma*p->m.omega[j] + langevin_pref2*(d_random()-0.5);
+	p->f.torque[j] = -langevin_gamma*p->m.omega[j] + langevin_pref2*noise[j];
       }
       ONEPART_TRACE(if(p->p.identity==check_id) fprintf(stderr,"%d: OPT: LANG f = (%.3e,%.3e,%.3e)\n",this_node,p->f.f[0],p->f.f[1],p->f.f[2]));
       THERMO_TRACE(fprintf(stderr,"%d: Thermo: P %d: force=(%.3e,%.3e,%.3e)\n",this_node,p->p.identity,p->f.f[0],p->f.f[1],p->f.f[2]));
@@ -0,0 +1,110 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file threads.c
+    Implementation of \ref threads.h "threads.h".
+*/
+#include <stdlib.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "utils.h"
+#include "threads.h"
+#include "global.h"
+#include "communication.h"
+#include "integrate.h"
+#include "thermostat.h"
+#include "random.h"
+#include "interaction_data.h"
+#include "forces.h"
+
+int n_threads = 1;
+
+void threads_init()
+{
+#ifdef _OPENMP
+  /* without an explicit request, stay on one thread, since typically
+     there is already one MPI task per core */
+  if (getenv("OMP_NUM_THREADS"))
+    n_threads = omp_get_max_threads();
+  else
+    n_threads = 1;
+#endif
+  threads_set_num_threads();
+}
+
+void threads_set_num_threads()
+{
+#ifdef _OPENMP
+  omp_set_num_threads(n_threads);
+#endif
+}
+
+int threads_active()
+{
+#ifdef _OPENMP
+  if (n_threads <= 1)
+    return 0;
+#ifdef NPT
+  /* the virial is accumulated in a global variable */
+  if (integ_switch == INTEG_METHOD_NPT_ISO)
+    return 0;
+#endif
+  /* the pair thermostats share the state of the ran1 generator */
+  if (thermo_switch & (THERMO_DPD | THERMO_INTER_DPD) &&
+      random_backend == RANDOM_BACKEND_RAN1)
+    return 0;
+#ifdef LJ_ANGLE
+  /* the angular Lennard-Jones acts also on the bond partners */
+  if (nb_potentials_used & NB_POT_LJANGLE)
+    return 0;
+#endif
+#ifdef ADRESS
+  return 0;
+#endif
+  /* the fused observables are accumulated in global variables */
+  if (obs_fused_step)
+    return 0;
+#ifdef ADDITIONAL_CHECKS
+  /* the integrator checks keep track of global maxima */
+  return 0;
+#endif
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+int tclcallback_n_threads(Tcl_Interp *interp, void *_data)
+{
+  int data = *(int *)_data;
+
+  if (data < 1) {
+    Tcl_AppendResult(interp, "number of threads must be positive.", (char *) NULL);
+    return (TCL_ERROR);
+  }
+#ifndef _OPENMP
+  if (data != 1) {
+    Tcl_AppendResult(interp, "more than one thread requires compilation with OpenMP (configure --with-openmp).", (char *) NULL);
+    return (TCL_ERROR);
+  }
+#endif
+  n_threads = data;
+  mpi_bcast_parameter(FIELD_NTHREADS);
+  return (TCL_OK);
+}
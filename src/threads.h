@@ -0,0 +1,71 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef THREADS_H
+#define THREADS_H
+/** \file threads.h
+    Shared memory parallelization of the force loops within one MPI
+    task via OpenMP (configure option --with-openmp).
+
+    Only the domain decomposition cell system is threaded. The pair
+    force loops run over the local cells in the order of a conflict
+    free colouring (see \ref dd_loop_cells_colored): the cells of one
+    colour are at least three cells apart in one direction, so that
+    their interacting neighbor cells do not overlap, and can be
+    processed concurrently without locking. The bonded forces are
+    calculated in a separate loop over the particles, the forces on
+    the bond partners are added atomically (see \ref
+    add_bonded_force_generic). The integrator steps that run over the
+    particles are threaded as well.
+
+    Some methods write to shared data in the pair loop, e.g. the NpT
+    virial, or the DPD thermostat if it uses the ran1 generator (see
+    \ref RANDOM_BACKEND_PHILOX for the alternative).
+    If one of them is active, \ref threads_active returns false and
+    everything runs on a single thread.
+*/
+
+#include <tcl.h>
+
+/************************************************
+ * exported variables
+ ************************************************/
+
+/** number of threads per MPI task. Always 1 if compiled without
+    OpenMP. */
+extern int n_threads;
+
+/************************************************
+ * functions
+ ************************************************/
+
+/** set the initial number of threads, either from OMP_NUM_THREADS or
+    to 1. Called from \ref on_program_start. */
+void threads_init();
+
+/** pass \ref n_threads on to the OpenMP runtime. */
+void threads_set_num_threads();
+
+/** check whether the force loops can currently be run with several
+    threads. */
+int threads_active();
+
+/** callback for \ref n_threads */
+int tclcallback_n_threads(Tcl_Interp *interp, void *data);
+
+#endif
@@ -0,0 +1,223 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file timers.c
+    Implementation of \ref timers.h "timers.h".
+*/
+#include <stdio.h>
+#include <string.h>
+#include <mpi.h>
+#include "utils.h"
+#include "timers.h"
+#include "communication.h"
+#include "parser.h"
+
+Timer timers[TIMER_N];
+
+const char *timer_names[TIMER_N] = {
+  "integrate",
+  "force_calc",
+  "verlet_build",
+  "ghost_comm",
+  "resort",
+  "p3m_kspace",
+  "fft",
+  "lb_fluid"
+};
+
+/** the output formats of the timers command */
+enum { TIMERS_TCL, TIMERS_JSON, TIMERS_CSV };
+
+void timers_reset()
+{
+  int t;
+  for (t = 0; t < TIMER_N; t++) {
+    timers[t].total = 0;
+    timers[t].calls = 0;
+    /* a running timer only counts from now on */
+    if (timers[t].depth > 0)
+      timers[t].start = timer_wtime();
+  }
+}
+
+void timers_reduce(double *result)
+{
+  double total[TIMER_N], calls[TIMER_N];
+  double min[TIMER_N], max[TIMER_N], sum[TIMER_N], max_calls[TIMER_N];
+  int t;
+
+  for (t = 0; t < TIMER_N; t++) {
+    total[t] = timers[t].total;
+    calls[t] = timers[t].calls;
+  }
+
+  MPI_Reduce(total, min, TIMER_N, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+  MPI_Reduce(total, max, TIMER_N, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+  MPI_Reduce(total, sum, TIMER_N, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(calls, max_calls, TIMER_N, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+  if (this_node != 0)
+    return;
+
+  for (t = 0; t < TIMER_N; t++) {
+    result[TIMER_STATS*t    ] = min[t];
+    result[TIMER_STATS*t + 1] = max[t];
+    result[TIMER_STATS*t + 2] = sum[t];
+    result[TIMER_STATS*t + 3] = max_calls[t];
+  }
+}
+
+/************************************************************/
+
+/** append the reduced timers in the given format to str.
+    The load imbalance is the maximal time over the average time minus
+    one, i.e. the fraction of the average time that the slowest node
+    takes longer. */
+static void timers_format(Tcl_DString *str, double *stats, int format)
+{
+  char buffer[TCL_DOUBLE_SPACE + TCL_INTEGER_SPACE];
+  double min, max, avg, imbalance;
+  int t, calls;
+
+  if (format == TIMERS_JSON)
+    Tcl_DStringAppend(str, "{", -1);
+  else if (format == TIMERS_CSV)
+    Tcl_DStringAppend(str, "name,calls,min,max,avg,imbalance\n", -1);
+
+  for (t = 0; t < TIMER_N; t++) {
+    double values[4];
+    int i;
+
+    min   = stats[TIMER_STATS*t];
+    max   = stats[TIMER_STATS*t + 1];
+    avg   = stats[TIMER_STATS*t + 2]/n_nodes;
+    calls = (int)stats[TIMER_STATS*t + 3];
+    imbalance = (avg > 0) ? max/avg - 1 : 0;
+    values[0] = min; values[1] = max; values[2] = avg; values[3] = imbalance;
+
+    switch (format) {
+    case TIMERS_TCL:
+      Tcl_DStringStartSublist(str);
+      Tcl_DStringAppendElement(str, timer_names[t]);
+      sprintf(buffer, "%d", calls);
+      Tcl_DStringAppendElement(str, buffer);
+      for (i = 0; i < 4; i++) {
+	Tcl_PrintDouble(NULL, values[i], buffer);
+	Tcl_DStringAppendElement(str, buffer);
+      }
+      Tcl_DStringEndSublist(str);
+      break;
+    case TIMERS_JSON:
+      if (t > 0)
+	Tcl_DStringAppend(str, ",", -1);
+      Tcl_DStringAppend(str, "\n  \"", -1);
+      Tcl_DStringAppend(str, timer_names[t], -1);
+      sprintf(buffer, "\": {\"calls\": %d", calls);
+      Tcl_DStringAppend(str, buffer, -1);
+      for (i = 0; i < 4; i++) {
+	static const char *keys[4] = { "min", "max", "avg", "imbalance" };
+	Tcl_DStringAppend(str, ", \"", -1);
+	Tcl_DStringAppend(str, keys[i], -1);
+	Tcl_DStringAppend(str, "\": ", -1);
+	Tcl_PrintDouble(NULL, values[i], buffer);
+	Tcl_DStringAppend(str, buffer, -1);
+      }
+      Tcl_DStringAppend(str, "}", -1);
+      break;
+    case TIMERS_CSV:
+      Tcl_DStringAppend(str, timer_names[t], -1);
+      sprintf(buffer, ",%d", calls);
+      Tcl_DStringAppend(str, buffer, -1);
+      for (i = 0; i < 4; i++) {
+	Tcl_DStringAppend(str, ",", -1);
+	Tcl_PrintDouble(NULL, values[i], buffer);
+	Tcl_DStringAppend(str, buffer, -1);
+      }
+      Tcl_DStringAppend(str, "\n", -1);
+      break;
+    }
+  }
+
+  if (format == TIMERS_JSON)
+    Tcl_DStringAppend(str, "\n}\n", -1);
+}
+
+/** the timers command.
+    <ul>
+    <li> timers [print]: the timers as a list of { name calls min max avg imbalance }
+    <li> timers json|csv [\<file\>]: the timers as JSON or CSV text,
+    returned or written to the file
+    <li> timers reset: reset the timers on all nodes
+    </ul>
+    The times are wall clock seconds, minimum, maximum and average over
+    the nodes. */
+int tclcommand_timers(ClientData data, Tcl_Interp *interp,
+		      int argc, char **argv)
+{
+#ifdef TIMERS
+  double stats[TIMER_STATS*TIMER_N];
+  Tcl_DString str;
+  int format;
+
+  if (argc == 1 || ARG1_IS_S("print"))
+    format = TIMERS_TCL;
+  else if (ARG1_IS_S("json"))
+    format = TIMERS_JSON;
+  else if (ARG1_IS_S("csv"))
+    format = TIMERS_CSV;
+  else if (ARG1_IS_S("reset")) {
+    if (argc != 2) {
+      Tcl_AppendResult(interp, "timers reset takes no arguments", (char *) NULL);
+      return TCL_ERROR;
+    }
+    mpi_timers(1, NULL);
+    return TCL_OK;
+  }
+  else {
+    Tcl_AppendResult(interp, "usage: timers [print | json [<file>] | csv [<file>] | reset]",
+		     (char *) NULL);
+    return TCL_ERROR;
+  }
+  if (argc > (format == TIMERS_TCL ? 2 : 3)) {
+    Tcl_AppendResult(interp, "too many arguments to timers ", argv[1], (char *) NULL);
+    return TCL_ERROR;
+  }
+
+  mpi_timers(0, stats);
+
+  Tcl_DStringInit(&str);
+  timers_format(&str, stats, format);
+  if (argc == 3) {
+    FILE *f = fopen(argv[2], "w");
+    if (!f) {
+      Tcl_DStringFree(&str);
+      Tcl_AppendResult(interp, "could not open \"", argv[2], "\" for writing", (char *) NULL);
+      return TCL_ERROR;
+    }
+    fwrite(Tcl_DStringValue(&str), 1, Tcl_DStringLength(&str), f);
+    fclose(f);
+    Tcl_DStringFree(&str);
+  }
+  else
+    Tcl_DStringResult(interp, &str);
+  return TCL_OK;
+#else
+  Tcl_AppendResult(interp, "TIMERS not compiled in!", (char *) NULL);
+  return TCL_ERROR;
+#endif
+}
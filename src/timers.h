@@ -0,0 +1,140 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TIMERS_H
+#define TIMERS_H
+/** \file timers.h
+    Wall clock timers of the phases of the integration.
+
+    Every node accumulates the wall clock time spent in a fixed set of
+    named regions, e.g. the force calculation or the ghost
+    communication, see the \ref TIMER_INTEGRATE "timer codes". A
+    region is entered via \ref timer_start and left via \ref
+    timer_stop. Regions can be nested
+    into each other, and a region that is entered again while it is
+    running, e.g. \ref ghost_communicator waiting for a pending
+    communication, is only counted once. The regions are coarse
+    (at most a few per time step and region), so that the two calls
+    of the clock per region do not matter, and the timers can stay
+    compiled in. Without the feature TIMERS, \ref timer_start and
+    \ref timer_stop are empty.
+
+    The tcl command \ref tclcommand_timers "timers" reduces the times
+    over the nodes and reports minimum, maximum, average and the load
+    imbalance, as Tcl list, JSON or CSV.
+
+    In contrast to \ref markTime, the timers measure wall clock time,
+    i.e. include the time spent waiting for other nodes.
+*/
+
+#include <tcl.h>
+#include <time.h>
+#include "utils.h"
+
+/** \name Timer Codes */
+/*@{*/
+/** the time step loop of \ref integrate_vv */
+#define TIMER_INTEGRATE  0
+/** \ref force_calc */
+#define TIMER_FORCE_CALC 1
+/** building the Verlet lists. Where the lists are
+    built along with the forces, this includes the pair forces. */
+#define TIMER_VERLET     2
+/** \ref ghost_communicator, including the waiting for nonblocking
+    communications */
+#define TIMER_GHOSTS     3
+/** \ref dd_exchange_and_sort_particles */
+#define TIMER_RESORT     4
+/** the k-space part of P3M for charges, including its FFTs, and the
+    charge assignment started before the short ranged forces, see
+    \ref kspace_overlap */
+#define TIMER_P3M_KSPACE 5
+/** the forward and backward 3D-FFTs of \ref fft.h */
+#define TIMER_FFT        6
+/** the collision and streaming of the lattice Boltzmann fluid */
+#define TIMER_LB         7
+/** number of timers */
+#define TIMER_N          8
+/*@}*/
+
+/** a wall clock timer of a region on one node */
+typedef struct {
+  /** accumulated time in seconds */
+  double total;
+  /** time when the region was entered */
+  double start;
+  /** how often the region was left */
+  int calls;
+  /** nesting depth, the time only runs for the outermost call */
+  int depth;
+} Timer;
+
+/** the timers of this node, indexed by the timer codes */
+extern Timer timers[TIMER_N];
+
+/** the names of the timer codes, as reported by the timers command */
+extern const char *timer_names[TIMER_N];
+
+/** number of doubles per timer in the result of \ref timers_reduce */
+#define TIMER_STATS 4
+
+/** the current wall clock time in seconds */
+MDINLINE double timer_wtime()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+#ifdef TIMERS
+/** enter a region.
+    @param t the timer code of the region */
+MDINLINE void timer_start(int t)
+{
+  if (timers[t].depth++ == 0)
+    timers[t].start = timer_wtime();
+}
+
+/** leave a region, which has to be entered via \ref timer_start.
+    @param t the timer code of the region */
+MDINLINE void timer_stop(int t)
+{
+  if (--timers[t].depth == 0) {
+    timers[t].total += timer_wtime() - timers[t].start;
+    timers[t].calls++;
+  }
+}
+#else
+MDINLINE void timer_start(int t) {}
+MDINLINE void timer_stop(int t) {}
+#endif
+
+/** reset the timers of this node. Running timers keep running. */
+void timers_reset();
+
+/** reduce the timers over all nodes. Called on all nodes.
+    @param result non-zero only on the master node; \ref TIMER_STATS
+    values per timer: the minimal, maximal and summed up time over the
+    nodes in seconds, and the maximal number of calls. */
+void timers_reduce(double *result);
+
+/** Implementation of the tcl command \ref tclcommand_timers. */
+int tclcommand_timers(ClientData data, Tcl_Interp *interp,
+		      int argc, char **argv);
+
+#endif
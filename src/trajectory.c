@@ -0,0 +1,896 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/** \file trajectory.c
+    Implementation of \ref trajectory.h "trajectory.h".
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include "utils.h"
+#include "trajectory.h"
+#include "global.h"
+#include "communication.h"
+#include "particle_data.h"
+#include "cells.h"
+#include "grid.h"
+#include "integrate.h"
+#include "parser.h"
+#include "statistics.h"
+
+/** names of the columns, as used in the Tcl command */
+static char *traj_column_names[TRAJ_N_CODES] = {
+  "pos", "v", "f", "q", "type", "mol", "mass", "dip"
+};
+
+/** \name Master node only: the trajectory open for writing */
+/*@{*/
+/** the file, NULL if none is open */
+static FILE *traj_file = NULL;
+/** its name */
+static char *traj_name = NULL;
+/** its header */
+static TrajHeader traj_header;
+/** file offsets of the frames */
+static long long *traj_offsets = NULL;
+/** number of frames */
+static int traj_n_frames = 0;
+/** capacity of \ref traj_offsets */
+static int traj_max_frames = 0;
+/*@}*/
+
+/************************************************************/
+
+/** whether this build can write a column. Charges and dipoles need
+    the corresponding features. */
+static int traj_column_compiled(int column)
+{
+  switch (column) {
+#ifndef ELECTROSTATICS
+  case TRAJ_Q:
+    return 0;
+#endif
+#ifndef DIPOLES
+  case TRAJ_DIP:
+    return 0;
+#endif
+  default:
+    return column >= 0 && column < TRAJ_N_CODES;
+  }
+}
+
+int traj_column_width(int column)
+{
+  switch (column) {
+  case TRAJ_POS:
+  case TRAJ_V:
+  case TRAJ_F:
+  case TRAJ_DIP:
+    return 3;
+  default:
+    return 1;
+  }
+}
+
+int traj_element_size(int column, int flags)
+{
+  if (column == TRAJ_TYPE || column == TRAJ_MOL)
+    return sizeof(int);
+  return (flags & TRAJ_FLOAT) ? sizeof(float) : sizeof(double);
+}
+
+long long traj_column_offset(TrajHeader *header, int n_part, int column)
+{
+  long long offset = sizeof(TrajFrameHeader);
+  int c, code;
+
+  if (column < 0)
+    return offset;
+  /* identities */
+  offset += ((long long)n_part*sizeof(int) + TRAJ_ALIGN - 1)/TRAJ_ALIGN*TRAJ_ALIGN;
+  for (c = 0; c < column; c++) {
+    code = header->columns[c];
+    offset += ((long long)n_part*traj_column_width(code)*traj_element_size(code, header->flags) +
+	       TRAJ_ALIGN - 1)/TRAJ_ALIGN*TRAJ_ALIGN;
+  }
+  return offset;
+}
+
+/** size of one particle as packed by \ref traj_pack_local. */
+static int traj_record_size(int columns, int flags)
+{
+  int c, size = sizeof(int);
+  for (c = 0; c < TRAJ_N_CODES; c++)
+    if (columns & (1 << c))
+      size += traj_column_width(c)*traj_element_size(c, flags);
+  return size;
+}
+
+/** store a real as double or float, depending on the flags. */
+MDINLINE char *traj_put_real(char *b, double value, int flags)
+{
+  if (flags & TRAJ_FLOAT) {
+    float f = value;
+    memcpy(b, &f, sizeof(float));
+    return b + sizeof(float);
+  }
+  memcpy(b, &value, sizeof(double));
+  return b + sizeof(double);
+}
+
+int traj_pack_local(int columns, int flags, char **buffer)
+{
+  int c, i, j, np, size = traj_record_size(columns, flags);
+  double f_scale = 0.5*time_step*time_step;
+  char *b;
+  Particle *part;
+
+  b = *buffer = malloc(cells_get_n_particles()*size);
+
+  for (c = 0; c < local_cells.n; c++) {
+    part = local_cells.cell[c]->part;
+    np = local_cells.cell[c]->n;
+    for (i = 0; i < np; i++) {
+      Particle *p = &part[i];
+      memcpy(b, &p->p.identity, sizeof(int));
+      b += sizeof(int);
+
+      if (columns & (1 << TRAJ_POS)) {
+	double pos[3];
+	int img[3];
+	memcpy(pos, p->r.p, 3*sizeof(double));
+	memcpy(img, p->l.i, 3*sizeof(int));
+	unfold_position(pos, img);
+	for (j = 0; j < 3; j++)
+	  b = traj_put_real(b, pos[j], flags);
+      }
+      if (columns & (1 << TRAJ_V))
+	for (j = 0; j < 3; j++)
+	  b = traj_put_real(b, p->m.v[j]/time_step, flags);
+      if (columns & (1 << TRAJ_F))
+	for (j = 0; j < 3; j++)
+	  b = traj_put_real(b, p->f.f[j]/f_scale, flags);
+#ifdef ELECTROSTATICS
+      if (columns & (1 << TRAJ_Q))
+	b = traj_put_real(b, p->p.q, flags);
+#endif
+      if (columns & (1 << TRAJ_TYPE)) {
+	memcpy(b, &p->p.type, sizeof(int));
+	b += sizeof(int);
+      }
+      if (columns & (1 << TRAJ_MOL)) {
+	memcpy(b, &p->p.mol_id, sizeof(int));
+	b += sizeof(int);
+      }
+      if (columns & (1 << TRAJ_MASS))
+	b = traj_put_real(b, PMASS(*p), flags);
+#ifdef DIPOLES
+      if (columns & (1 << TRAJ_DIP))
+	for (j = 0; j < 3; j++)
+	  b = traj_put_real(b, p->r.dip[j], flags);
+#endif
+    }
+  }
+  return b - *buffer;
+}
+
+/************************************************************/
+
+/** add a frame offset to \ref traj_offsets. */
+static void traj_add_offset(long long offset)
+{
+  if (traj_n_frames == traj_max_frames) {
+    traj_max_frames += 1024;
+    traj_offsets = realloc(traj_offsets, traj_max_frames*sizeof(long long));
+  }
+  traj_offsets[traj_n_frames++] = offset;
+}
+
+/** find the frames of an existing file from its index or, if that
+    is missing, by walking the frames. Returns the end of the last
+    complete frame, where the next one is to be written. */
+static long long traj_find_frames(FILE *f)
+{
+  TrajIndexTail tail;
+  TrajFrameHeader frame;
+  long long end, offset;
+  int i;
+
+  fseeko(f, 0, SEEK_END);
+  end = ftello(f);
+
+  /* index present? */
+  if (end >= (long long)(sizeof(TrajHeader) + sizeof(TrajIndexTail))) {
+    fseeko(f, end - sizeof(TrajIndexTail), SEEK_SET);
+    if (fread(&tail, sizeof(TrajIndexTail), 1, f) == 1 &&
+	!strncmp(tail.magic, TRAJ_INDEX_MAGIC, 4) && tail.n_frames >= 0 &&
+	end - (long long)sizeof(TrajIndexTail) - tail.n_frames*(long long)sizeof(long long)
+	>= (long long)sizeof(TrajHeader)) {
+      offset = end - sizeof(TrajIndexTail) - tail.n_frames*sizeof(long long);
+      fseeko(f, offset, SEEK_SET);
+      for (i = 0; i < tail.n_frames; i++) {
+	long long o;
+	if (fread(&o, sizeof(long long), 1, f) != 1)
+	  break;
+	traj_add_offset(o);
+      }
+      if (i == tail.n_frames)
+	return offset;
+      traj_n_frames = 0;
+    }
+  }
+
+  /* no usable index, walk the frames */
+  offset = sizeof(TrajHeader);
+  for (;;) {
+    fseeko(f, offset, SEEK_SET);
+    if (fread(&frame, sizeof(TrajFrameHeader), 1, f) != 1 ||
+	strncmp(frame.magic, TRAJ_FRAME_MAGIC, 4) ||
+	frame.size < (long long)sizeof(TrajFrameHeader) ||
+	offset + frame.size > end)
+      break;
+    traj_add_offset(offset);
+    offset += frame.size;
+  }
+  return offset;
+}
+
+static int traj_open(Tcl_Interp *interp, char *name, int append,
+		     int flags, int n_columns, int *columns)
+{
+  FILE *f = NULL;
+  long long end;
+  int i;
+
+  if (append)
+    f = fopen(name, "r+b");
+
+  if (f) {
+    TrajHeader header;
+    if (fread(&header, sizeof(TrajHeader), 1, f) != 1 ||
+	strncmp(header.magic, TRAJ_MAGIC, 4) ||
+	header.byte_order != TRAJ_BYTE_ORDER) {
+      fclose(f);
+      Tcl_AppendResult(interp, "\"", name, "\" is not a trajectory of this machine",
+		       (char *) NULL);
+      return TCL_ERROR;
+    }
+    if (n_columns > 0 &&
+	(n_columns != header.n_columns || flags != header.flags ||
+	 memcmp(columns, header.columns, n_columns*sizeof(int)))) {
+      fclose(f);
+      Tcl_AppendResult(interp, "columns do not match those of \"", name, "\"",
+		       (char *) NULL);
+      return TCL_ERROR;
+    }
+    /* the columns taken from the header must be writable, too */
+    if (header.n_columns <= 0 || header.n_columns > TRAJ_MAX_COLUMNS) {
+      fclose(f);
+      Tcl_AppendResult(interp, "\"", name, "\" has a corrupt header", (char *) NULL);
+      return TCL_ERROR;
+    }
+    for (i = 0; i < header.n_columns; i++) {
+      int code = header.columns[i];
+      if (code < 0 || code >= TRAJ_N_CODES) {
+	fclose(f);
+	Tcl_AppendResult(interp, "\"", name, "\" has a corrupt header", (char *) NULL);
+	return TCL_ERROR;
+      }
+      if (!traj_column_compiled(code)) {
+	fclose(f);
+	Tcl_AppendResult(interp, "cannot append to \"", name, "\", its column \"",
+			 traj_column_names[code], "\" is not compiled in", (char *) NULL);
+	return TCL_ERROR;
+      }
+    }
+    traj_header = header;
+
+    traj_n_frames = 0;
+    end = traj_find_frames(f);
+    /* drop the index and possibly an incomplete frame */
+    fflush(f);
+    if (ftruncate(fileno(f), end)) {
+      fclose(f);
+      Tcl_AppendResult(interp, "could not truncate \"", name, "\"", (char *) NULL);
+      return TCL_ERROR;
+    }
+    fseeko(f, end, SEEK_SET);
+  }
+  else {
+    if (n_columns == 0) {
+      Tcl_AppendResult(interp, "no columns given for trajectory \"", name, "\"",
+		       (char *) NULL);
+      return TCL_ERROR;
+    }
+    if (!(f = fopen(name, "wb"))) {
+      Tcl_AppendResult(interp, "could not open \"", name, "\" for writing",
+		       (char *) NULL);
+      return TCL_ERROR;
+    }
+
+    memset(&traj_header, 0, sizeof(TrajHeader));
+    memcpy(traj_header.magic, TRAJ_MAGIC, 4);
+    traj_header.byte_order = TRAJ_BYTE_ORDER;
+    traj_header.flags = flags;
+    traj_header.n_columns = n_columns;
+    for (i = 0; i < n_columns; i++)
+      traj_header.columns[i] = columns[i];
+    fwrite(&traj_header, sizeof(TrajHeader), 1, f);
+    traj_n_frames = 0;
+  }
+
+  traj_file = f;
+  traj_name = strdup(name);
+  return TCL_OK;
+}
+
+/** write the index and close the file. */
+static int traj_close(Tcl_Interp *interp)
+{
+  TrajIndexTail tail;
+  int ok;
+
+  tail.n_frames = traj_n_frames;
+  memcpy(tail.magic, TRAJ_INDEX_MAGIC, 4);
+  tail.unused = 0;
+
+  ok = fwrite(traj_offsets, sizeof(long long), traj_n_frames, traj_file) == traj_n_frames &&
+    fwrite(&tail, sizeof(TrajIndexTail), 1, traj_file) == 1;
+  ok = (fclose(traj_file) == 0) && ok;
+
+  traj_file = NULL;
+  free(traj_name);
+  traj_name = NULL;
+  free(traj_offsets);
+  traj_offsets = NULL;
+  traj_n_frames = traj_max_frames = 0;
+
+  if (!ok) {
+    Tcl_AppendResult(interp, "error while writing the trajectory index", (char *) NULL);
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+
+/** gather the particles and write one frame in ascending particle order. */
+static int traj_write_frame(Tcl_Interp *interp)
+{
+  TrajFrameHeader frame;
+  int c, i, n_part, mask = 0, rec_size, max_id = -1;
+  int offset[TRAJ_N_CODES];
+  int *order;
+  char *data, *column;
+  static char padding[TRAJ_ALIGN];
+  int ok = 1;
+
+  for (c = 0; c < traj_header.n_columns; c++)
+    mask |= 1 << traj_header.columns[c];
+
+  /* offsets of the columns within the packed records */
+  rec_size = sizeof(int);
+  for (c = 0; c < TRAJ_N_CODES; c++)
+    if (mask & (1 << c)) {
+      offset[c] = rec_size;
+      rec_size += traj_column_width(c)*traj_element_size(c, traj_header.flags);
+    }
+
+  n_part = mpi_gather_trajectory_frame(mask, traj_header.flags, &data)/rec_size;
+
+  /* ascending particle order */
+  for (i = 0; i < n_part; i++) {
+    int id;
+    memcpy(&id, data + i*rec_size, sizeof(int));
+    if (id > max_id)
+      max_id = id;
+  }
+  order = malloc((max_id + 1)*sizeof(int));
+  for (i = 0; i <= max_id; i++)
+    order[i] = -1;
+  for (i = 0; i < n_part; i++) {
+    int id;
+    memcpy(&id, data + i*rec_size, sizeof(int));
+    order[id] = i;
+  }
+  for (i = 0, c = 0; i <= max_id; i++)
+    if (order[i] != -1)
+      order[c++] = order[i];
+
+  memcpy(frame.magic, TRAJ_FRAME_MAGIC, 4);
+  frame.n_part = n_part;
+  frame.time = sim_time;
+  memcpy(frame.box_l, box_l, 3*sizeof(double));
+  frame.size = traj_column_offset(&traj_header, n_part, traj_header.n_columns);
+
+  traj_add_offset(ftello(traj_file));
+  ok = fwrite(&frame, sizeof(TrajFrameHeader), 1, traj_file) == 1;
+
+  /* identities and columns */
+  column = malloc(n_part*3*sizeof(double));
+  for (c = -1; c < traj_header.n_columns && ok; c++) {
+    int off, el_size;
+    if (c == -1) {
+      off = 0;
+      el_size = sizeof(int);
+    }
+    else {
+      int code = traj_header.columns[c];
+      off = offset[code];
+      el_size = traj_column_width(code)*traj_element_size(code, traj_header.flags);
+    }
+    for (i = 0; i < n_part; i++)
+      memcpy(column + i*el_size, data + order[i]*rec_size + off, el_size);
+    ok = fwrite(column, el_size, n_part, traj_file) == n_part;
+    /* pad the block, so that all columns are aligned in the file */
+    el_size = traj_column_offset(&traj_header, n_part, c + 1) -
+      traj_column_offset(&traj_header, n_part, c) - n_part*el_size;
+    if (el_size > 0 && ok)
+      ok = fwrite(padding, el_size, 1, traj_file) == 1;
+  }
+  ok = ok && fflush(traj_file) == 0;
+
+  free(column);
+  free(order);
+  free(data);
+
+  if (!ok) {
+    Tcl_AppendResult(interp, "error while writing to trajectory \"", traj_name, "\"",
+		     (char *) NULL);
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+
+/************************************************************/
+
+int traj_reader_open(TrajReader *reader, char *name)
+{
+  struct stat st;
+  TrajIndexTail *tail;
+  long long offset;
+  int fd;
+
+  reader->map = NULL;
+  reader->offsets = NULL;
+  reader->own_offsets = 0;
+  reader->n_frames = 0;
+
+  if ((fd = open(name, O_RDONLY)) < 0)
+    return -1;
+  if (fstat(fd, &st)) {
+    close(fd);
+    return -1;
+  }
+  if (st.st_size < (off_t)sizeof(TrajHeader)) {
+    close(fd);
+    return -2;
+  }
+  reader->size = st.st_size;
+  reader->map = mmap(NULL, reader->size, PROT_READ, MAP_SHARED, fd, 0);
+  /* the mapping stays valid after closing */
+  close(fd);
+  if (reader->map == MAP_FAILED) {
+    reader->map = NULL;
+    return -1;
+  }
+
+  reader->header = (TrajHeader *)reader->map;
+  if (strncmp(reader->header->magic, TRAJ_MAGIC, 4) ||
+      reader->header->byte_order != TRAJ_BYTE_ORDER ||
+      reader->header->n_columns < 0 || reader->header->n_columns > TRAJ_MAX_COLUMNS) {
+    traj_reader_close(reader);
+    return -2;
+  }
+
+  /* index present? */
+  tail = (TrajIndexTail *)(reader->map + reader->size - sizeof(TrajIndexTail));
+  if (reader->size >= (long long)(sizeof(TrajHeader) + sizeof(TrajIndexTail)) &&
+      !strncmp(tail->magic, TRAJ_INDEX_MAGIC, 4) && tail->n_frames >= 0 &&
+      reader->size - (long long)sizeof(TrajIndexTail) -
+      tail->n_frames*(long long)sizeof(long long) >= (long long)sizeof(TrajHeader)) {
+    reader->n_frames = tail->n_frames;
+    reader->offsets = (long long *)((char *)tail - reader->n_frames*sizeof(long long));
+    return 0;
+  }
+
+  /* no index, e.g. still being written, walk the frames */
+  offset = sizeof(TrajHeader);
+  while (offset + (long long)sizeof(TrajFrameHeader) <= reader->size) {
+    TrajFrameHeader *frame = (TrajFrameHeader *)(reader->map + offset);
+    if (strncmp(frame->magic, TRAJ_FRAME_MAGIC, 4) ||
+	frame->size < (long long)sizeof(TrajFrameHeader) ||
+	offset + frame->size > reader->size)
+      break;
+    if (reader->n_frames % 1024 == 0)
+      reader->offsets = realloc(reader->offsets, (reader->n_frames + 1024)*sizeof(long long));
+    reader->offsets[reader->n_frames++] = offset;
+    offset += frame->size;
+  }
+  reader->own_offsets = 1;
+  return 0;
+}
+
+void traj_reader_close(TrajReader *reader)
+{
+  if (reader->own_offsets)
+    free(reader->offsets);
+  if (reader->map)
+    munmap(reader->map, reader->size);
+  reader->map = NULL;
+  reader->offsets = NULL;
+  reader->own_offsets = 0;
+  reader->n_frames = 0;
+}
+
+void *traj_reader_column(TrajReader *reader, int frame, int code)
+{
+  int c;
+  for (c = 0; c < reader->header->n_columns; c++)
+    if (reader->header->columns[c] == code)
+      return reader->map + reader->offsets[frame] +
+	traj_column_offset(reader->header, traj_reader_frame(reader, frame)->n_part, c);
+  return NULL;
+}
+
+/** element i of a real valued column as double. */
+MDINLINE double traj_get_real(void *column, int i, int flags)
+{
+  return (flags & TRAJ_FLOAT) ? ((float *)column)[i] : ((double *)column)[i];
+}
+
+/** open a trajectory for reading, with error message. */
+static int traj_reader_open_tcl(Tcl_Interp *interp, TrajReader *reader, char *name)
+{
+  switch (traj_reader_open(reader, name)) {
+  case -1:
+    Tcl_AppendResult(interp, "could not open \"", name, "\" for reading", (char *) NULL);
+    return TCL_ERROR;
+  case -2:
+    Tcl_AppendResult(interp, "\"", name, "\" is not a trajectory of this machine",
+		     (char *) NULL);
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+
+/** parse a frame number, and check its range. */
+static int traj_parse_frame(Tcl_Interp *interp, TrajReader *reader, char *arg, int *frame)
+{
+  if (Tcl_GetInt(interp, arg, frame) == TCL_ERROR)
+    return TCL_ERROR;
+  if (*frame < 0 || *frame >= reader->n_frames) {
+    Tcl_AppendResult(interp, "frame ", arg, " does not exist", (char *) NULL);
+    return TCL_ERROR;
+  }
+  return TCL_OK;
+}
+
+/** trajectory read <file> <frame> time|box_l|ids|<column> [<id>...] */
+static int traj_read_tcl(Tcl_Interp *interp, int argc, char **argv)
+{
+  char buffer[TCL_DOUBLE_SPACE + TCL_INTEGER_SPACE];
+  TrajReader reader;
+  TrajFrameHeader *frame;
+  int f, code, i, j, n, *ids, width, flags;
+  void *column;
+
+  if (argc < 3) {
+    Tcl_AppendResult(interp, "usage: trajectory read <file> <frame> time|box_l|ids|<column> [<id>...]",
+		     (char *) NULL);
+    return TCL_ERROR;
+  }
+  if (traj_reader_open_tcl(interp, &reader, argv[0]) == TCL_ERROR)
+    return TCL_ERROR;
+  if (traj_parse_frame(interp, &reader, argv[1], &f) == TCL_ERROR) {
+    traj_reader_close(&reader);
+    return TCL_ERROR;
+  }
+  frame = traj_reader_frame(&reader, f);
+  n = frame->n_part;
+  ids = traj_reader_ids(&reader, f);
+  flags = reader.header->flags;
+
+  if (!strcmp(argv[2], "time")) {
+    Tcl_PrintDouble(interp, frame->time, buffer);
+    Tcl_AppendResult(interp, buffer, (char *) NULL);
+    traj_reader_close(&reader);
+    return TCL_OK;
+  }
+  if (!strcmp(argv[2], "box_l")) {
+    for (j = 0; j < 3; j++) {
+      Tcl_PrintDouble(interp, frame->box_l[j], buffer);
+      Tcl_AppendResult(interp, j ? " " : "", buffer, (char *) NULL);
+    }
+    traj_reader_close(&reader);
+    return TCL_OK;
+  }
+  if (!strcmp(argv[2], "ids")) {
+    /* printed like the integer columns */
+    column = ids;
+    code = TRAJ_MOL;
+  }
+  else {
+    for (code = 0; code < TRAJ_N_CODES; code++)
+      if (!strcmp(argv[2], traj_column_names[code]))
+	break;
+    if (code == TRAJ_N_CODES ||
+	!(column = traj_reader_column(&reader, f, code))) {
+      Tcl_AppendResult(interp, "trajectory \"", argv[0], "\" has no column \"",
+		       argv[2], "\"", (char *) NULL);
+      traj_reader_close(&reader);
+      return TCL_ERROR;
+    }
+  }
+  width = traj_column_width(code);
+
+  /* all particles or the given ones, which are found by bisection */
+  for (i = 0; i < (argc > 3 ? argc - 3 : n); i++) {
+    int p = i;
+    if (argc > 3) {
+      int id, lo = 0, hi = n;
+      if (Tcl_GetInt(interp, argv[3 + i], &id) == TCL_ERROR) {
+	traj_reader_close(&reader);
+	return TCL_ERROR;
+      }
+      while (lo < hi) {
+	int mid = (lo + hi)/2;
+	if (ids[mid] < id) lo = mid + 1; else hi = mid;
+      }
+      if (lo == n || ids[lo] != id) {
+	Tcl_ResetResult(interp);
+	Tcl_AppendResult(interp, "particle ", argv[3 + i], " is not in frame ", argv[1],
+			 (char *) NULL);
+	traj_reader_close(&reader);
+	return TCL_ERROR;
+      }
+      p = lo;
+    }
+    Tcl_AppendResult(interp, i ? " " : "", width > 1 ? "{" : "", (char *) NULL);
+    for (j = 0; j < width; j++) {
+      if (code == TRAJ_TYPE || code == TRAJ_MOL)
+	sprintf(buffer, "%d", ((int *)column)[p]);
+      else
+	Tcl_PrintDouble(interp, traj_get_real(column, width*p + j, flags), buffer);
+      Tcl_AppendResult(interp, j ? " " : "", buffer, (char *) NULL);
+    }
+    if (width > 1)
+      Tcl_AppendResult(interp, "}", (char *) NULL);
+  }
+  traj_reader_close(&reader);
+  return TCL_OK;
+}
+
+/** trajectory load <file> [first <f>] [last <l>] [stride <s>]:
+    append the positions of the frames to the stored configurations. */
+static int traj_load_tcl(Tcl_Interp *interp, int argc, char **argv)
+{
+  char buffer[TCL_INTEGER_SPACE];
+  TrajReader reader;
+  int first = 0, last = -1, stride = 1, f, i, n, n_loaded = 0;
+  double *config;
+  void *pos;
+  char *name;
+
+  if (argc < 1) {
+    Tcl_AppendResult(interp, "usage: trajectory load <file> [first <f>] [last <l>] [stride <s>]",
+		     (char *) NULL);
+    return TCL_ERROR;
+  }
+  name = argv[0];
+  argc--; argv++;
+  while (argc > 0) {
+    if (argc < 2) {
+      Tcl_AppendResult(interp, "option \"", argv[0], "\" needs a value", (char *) NULL);
+      return TCL_ERROR;
+    }
+    if (ARG0_IS_S("first")) {
+      if (!ARG1_IS_I(first)) return TCL_ERROR;
+    }
+    else if (ARG0_IS_S("last")) {
+      if (!ARG1_IS_I(last)) return TCL_ERROR;
+    }
+    else if (ARG0_IS_S("stride")) {
+      if (!ARG1_IS_I(stride)) return TCL_ERROR;
+    }
+    else {
+      Tcl_AppendResult(interp, "unknown option \"", argv[0], "\"", (char *) NULL);
+      return TCL_ERROR;
+    }
+    argc -= 2; argv += 2;
+  }
+  if (first < 0 || stride < 1) {
+    Tcl_AppendResult(interp, "first must not be negative and stride positive", (char *) NULL);
+    return TCL_ERROR;
+  }
+
+  if (traj_reader_open_tcl(interp, &reader, name) == TCL_ERROR)
+    return TCL_ERROR;
+  if (last < 0 || last >= reader.n_frames)
+    last = reader.n_frames - 1;
+
+  for (f = first; f <= last; f += stride) {
+    n = traj_reader_frame(&reader, f)->n_part;
+    if (!(pos = traj_reader_column(&reader, f, TRAJ_POS))) {
+      Tcl_AppendResult(interp, "trajectory \"", name, "\" has no positions", (char *) NULL);
+      traj_reader_close(&reader);
+      return TCL_ERROR;
+    }
+    if (n_configs > 0 && n != n_part_conf) {
+      Tcl_AppendResult(interp, "frames have a different number of particles than the stored configurations",
+		       (char *) NULL);
+      traj_reader_close(&reader);
+      return TCL_ERROR;
+    }
+    if (reader.header->flags & TRAJ_FLOAT) {
+      config = malloc(3*n*sizeof(double));
+      for (i = 0; i < 3*n; i++)
+	config[i] = ((float *)pos)[i];
+      analyze_configs(config, n);
+      free(config);
+    }
+    else
+      analyze_configs((double *)pos, n);
+    n_loaded++;
+  }
+  traj_reader_close(&reader);
+
+  sprintf(buffer, "%d", n_loaded);
+  Tcl_AppendResult(interp, buffer, (char *) NULL);
+  return TCL_OK;
+}
+
+/** trajectory info <file> */
+static int traj_info_tcl(Tcl_Interp *interp, int argc, char **argv)
+{
+  char buffer[TCL_INTEGER_SPACE];
+  TrajReader reader;
+  int c;
+
+  if (argc != 1) {
+    Tcl_AppendResult(interp, "usage: trajectory info <file>", (char *) NULL);
+    return TCL_ERROR;
+  }
+  if (traj_reader_open_tcl(interp, &reader, argv[0]) == TCL_ERROR)
+    return TCL_ERROR;
+
+  sprintf(buffer, "%d", reader.n_frames);
+  Tcl_AppendResult(interp, "frames ", buffer, " columns {", (char *) NULL);
+  for (c = 0; c < reader.header->n_columns; c++) {
+    int code = reader.header->columns[c];
+    Tcl_AppendResult(interp, c ? " " : "",
+		     (code >= 0 && code < TRAJ_N_CODES) ? traj_column_names[code] : "?",
+		     (char *) NULL);
+  }
+  Tcl_AppendResult(interp, "}", (reader.header->flags & TRAJ_FLOAT) ? " float" : "",
+		   (char *) NULL);
+  traj_reader_close(&reader);
+  return TCL_OK;
+}
+
+/** print the open trajectory, if any. */
+static void traj_print(Tcl_Interp *interp)
+{
+  char buffer[TCL_INTEGER_SPACE];
+  int c;
+
+  if (!traj_file)
+    return;
+  sprintf(buffer, "%d", traj_n_frames);
+  Tcl_AppendResult(interp, "file ", (char *) NULL);
+  Tcl_AppendElement(interp, traj_name);
+  Tcl_AppendResult(interp, " frames ", buffer, " columns {", (char *) NULL);
+  for (c = 0; c < traj_header.n_columns; c++)
+    Tcl_AppendResult(interp, c ? " " : "", traj_column_names[traj_header.columns[c]],
+		     (char *) NULL);
+  Tcl_AppendResult(interp, "}", (traj_header.flags & TRAJ_FLOAT) ? " float" : "",
+		   (char *) NULL);
+}
+
+int tclcommand_trajectory(ClientData data, Tcl_Interp *interp,
+			  int argc, char **argv)
+{
+  if (argc == 1) {
+    traj_print(interp);
+    return TCL_OK;
+  }
+
+  if (ARG1_IS_S("open")) {
+    int append = 0, flags = 0, n_columns = 0, c;
+    int columns[TRAJ_MAX_COLUMNS], have = 0;
+    char *name;
+
+    if (argc < 3) {
+      Tcl_AppendResult(interp, "usage: trajectory open <file> [append] [float] <column>...",
+		       (char *) NULL);
+      return TCL_ERROR;
+    }
+    if (traj_file) {
+      Tcl_AppendResult(interp, "trajectory \"", traj_name, "\" is still open",
+		       (char *) NULL);
+      return TCL_ERROR;
+    }
+    name = argv[2];
+    argc -= 3; argv += 3;
+
+    for (; argc > 0; argc--, argv++) {
+      if (ARG0_IS_S("append"))
+	append = 1;
+      else if (ARG0_IS_S("float"))
+	flags |= TRAJ_FLOAT;
+      else {
+	for (c = 0; c < TRAJ_N_CODES; c++)
+	  if (!strcmp(argv[0], traj_column_names[c]))
+	    break;
+	if (!traj_column_compiled(c)) {
+	  Tcl_AppendResult(interp, "unknown trajectory column \"", argv[0], "\"",
+			   (char *) NULL);
+	  return TCL_ERROR;
+	}
+	if (have & (1 << c)) {
+	  Tcl_AppendResult(interp, "trajectory column \"", argv[0], "\" given twice",
+			   (char *) NULL);
+	  return TCL_ERROR;
+	}
+	have |= 1 << c;
+	columns[n_columns++] = c;
+      }
+    }
+    /* the flags are checked together with the columns */
+    if (append && n_columns == 0 && flags) {
+      Tcl_AppendResult(interp, "float requires the columns to be given", (char *) NULL);
+      return TCL_ERROR;
+    }
+    return traj_open(interp, name, append, flags, n_columns, columns);
+  }
+  else if (ARG1_IS_S("write")) {
+    if (argc != 2) {
+      Tcl_AppendResult(interp, "trajectory write takes no arguments", (char *) NULL);
+      return TCL_ERROR;
+    }
+    if (!traj_file) {
+      Tcl_AppendResult(interp, "no trajectory open", (char *) NULL);
+      return TCL_ERROR;
+    }
+    return traj_write_frame(interp);
+  }
+  else if (ARG1_IS_S("close")) {
+    if (argc != 2) {
+      Tcl_AppendResult(interp, "trajectory close takes no arguments", (char *) NULL);
+      return TCL_ERROR;
+    }
+    if (!traj_file) {
+      Tcl_AppendResult(interp, "no trajectory open", (char *) NULL);
+      return TCL_ERROR;
+    }
+    return traj_close(interp);
+  }
+
+  else if (ARG1_IS_S("info"))
+    return traj_info_tcl(interp, argc - 2, argv + 2);
+  else if (ARG1_IS_S("read"))
+    return traj_read_tcl(interp, argc - 2, argv + 2);
+  else if (ARG1_IS_S("load"))
+    return traj_load_tcl(interp, argc - 2, argv + 2);
+
+  Tcl_AppendResult(interp, "unknown trajectory command \"", argv[1], "\"", (char *) NULL);
+  return TCL_ERROR;
+}
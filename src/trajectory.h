@@ -0,0 +1,228 @@
+/*
+  Copyright (C) 2012 The ESPResSo project
+
+  This file is part of ESPResSo.
+
+  ESPResSo is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  ESPResSo is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+/** \file trajectory.h
+    Binary trajectory files with random access to the frames.
+
+    In contrast to \ref binary_file.h "writemd", which fetches the
+    particles one by one, every node packs the chosen columns of its
+    local particles, and the master collects them with a single
+    gather and writes the frame. THE FILE FORMAT IS HARDWARE
+    DEPENDENT, SINCE RAW DATA TYPES ARE WRITTEN, but the byte order
+    can be checked via \ref TrajHeader::byte_order.
+
+    <p>
+    The file format consists of the following:
+    <ol>
+    <li> \ref TrajHeader, which describes the columns stored for each
+    particle.
+    <li> the frames, each consisting of a \ref TrajFrameHeader, the
+    identities of the particles in ascending order as integers, and
+    then the columns in the order of \ref TrajHeader::columns, each
+    one for all particles of the frame. The elements of the
+    columns are integers for \ref TRAJ_TYPE and \ref TRAJ_MOL, and
+    doubles or, if \ref TRAJ_FLOAT is set, floats for all others.
+    The identities and each column are padded with zeros to a multiple
+    of \ref TRAJ_ALIGN bytes, see \ref traj_column_offset.
+    <li> the index, which is written when the file is closed: the
+    file offsets of all frames as long long, followed by a \ref
+    TrajIndexTail. If the index is missing, e.g. after a crash, the
+    frames can still be found via \ref TrajFrameHeader::size.
+    </ol>
+    For appending, the index is removed and written anew on closing.
+
+    Since all blocks are aligned, the files can be read via mmap
+    without copying (see \ref TrajReader). Only the pages of the
+    frames and columns actually accessed are read from disk.
+*/
+
+#include <stdio.h>
+#include <tcl.h>
+#include "utils.h"
+
+/************************************************
+ * defines
+ ************************************************/
+
+/** magic of \ref TrajHeader, without trailing 0. */
+#define TRAJ_MAGIC "MDT1"
+/** magic of \ref TrajFrameHeader, without trailing 0. */
+#define TRAJ_FRAME_MAGIC "FRM1"
+/** magic of \ref TrajIndexTail, without trailing 0. */
+#define TRAJ_INDEX_MAGIC "IDX1"
+/** value of \ref TrajHeader::byte_order as written. */
+#define TRAJ_BYTE_ORDER 0x01020304
+
+/** alignment of the blocks of a frame in bytes */
+#define TRAJ_ALIGN 8
+
+/** maximal number of columns in a trajectory */
+#define TRAJ_MAX_COLUMNS 16
+
+/** \name Column codes */
+/*@{*/
+/** unfolded position, 3 reals */
+#define TRAJ_POS  0
+/** velocity, 3 reals */
+#define TRAJ_V    1
+/** force, 3 reals */
+#define TRAJ_F    2
+/** charge, 1 real */
+#define TRAJ_Q    3
+/** type, 1 integer */
+#define TRAJ_TYPE 4
+/** molecule id, 1 integer */
+#define TRAJ_MOL  5
+/** mass, 1 real */
+#define TRAJ_MASS 6
+/** dipole moment, 3 reals */
+#define TRAJ_DIP  7
+/** number of column codes */
+#define TRAJ_N_CODES 8
+/*@}*/
+
+/** \ref TrajHeader::flags: real columns are stored as float. */
+#define TRAJ_FLOAT 1
+
+/************************************************
+ * data types
+ ************************************************/
+
+/** The header of a trajectory file. */
+typedef struct {
+  /** Must be \ref TRAJ_MAGIC ("MDT1") without trailing 0. */
+  char magic[4];
+  /** \ref TRAJ_BYTE_ORDER in the byte order of the writer. */
+  int byte_order;
+  /** or of the flags, i.e. \ref TRAJ_FLOAT. */
+  int flags;
+  /** number of columns. */
+  int n_columns;
+  /** the column codes, TRAJ_POS... */
+  int columns[TRAJ_MAX_COLUMNS];
+} TrajHeader;
+
+/** The header of one frame. */
+typedef struct {
+  /** Must be \ref TRAJ_FRAME_MAGIC ("FRM1") without trailing 0. */
+  char magic[4];
+  /** number of particles in this frame. */
+  int n_part;
+  /** size of the frame in bytes, including this header. */
+  long long size;
+  /** simulation time of the frame. */
+  double time;
+  /** box length of the frame. */
+  double box_l[3];
+} TrajFrameHeader;
+
+/** The end of the frame index. */
+typedef struct {
+  /** number of frames, i.e. of offsets before this. */
+  long long n_frames;
+  /** Must be \ref TRAJ_INDEX_MAGIC ("IDX1") without trailing 0. */
+  char magic[4];
+  /** padding, 0. */
+  int unused;
+} TrajIndexTail;
+
+/** A trajectory file mapped into memory for reading. */
+typedef struct {
+  /** the mapped file */
+  char *map;
+  /** its size */
+  long long size;
+  /** its header, within \ref map */
+  TrajHeader *header;
+  /** the file offsets of the frames, either within \ref map or, if
+      the file has no index, malloced */
+  long long *offsets;
+  /** whether \ref offsets was malloced */
+  int own_offsets;
+  /** number of frames */
+  int n_frames;
+} TrajReader;
+
+/************************************************
+ * functions
+ ************************************************/
+
+/** number of values of a column, e.g. 3 for \ref TRAJ_POS. */
+int traj_column_width(int column);
+
+/** size of one element of a column in bytes.
+    @param column the column code
+    @param flags  the \ref TrajHeader::flags of the file */
+int traj_element_size(int column, int flags);
+
+/** offset of a column within a frame.
+    @param header the header of the file
+    @param n_part the number of particles in the frame
+    @param column index into \ref TrajHeader::columns, -1 for the
+                  identities, \ref TrajHeader::n_columns for the
+                  size of the frame */
+long long traj_column_offset(TrajHeader *header, int n_part, int column);
+
+/** Pack the local particles for a frame: for each particle, its
+    identity followed by the columns in the order of their codes.
+    Used by \ref mpi_gather_trajectory_frame.
+    @param columns or of (1 << column code) of the columns to pack
+    @param flags   the \ref TrajHeader::flags of the file
+    @param buffer  where to store the malloced data
+    @return the size of the data in bytes */
+int traj_pack_local(int columns, int flags, char **buffer);
+
+/** map a trajectory file for reading.
+    @param reader the reader to initialize
+    @param name   the file name
+    @return 0 on success, otherwise -1 if the file cannot be mapped
+    and -2 if it is not a trajectory of this machine */
+int traj_reader_open(TrajReader *reader, char *name);
+
+/** unmap a trajectory file. */
+void traj_reader_close(TrajReader *reader);
+
+/** header of a frame, no range check. */
+MDINLINE TrajFrameHeader *traj_reader_frame(TrajReader *reader, int frame)
+{
+  return (TrajFrameHeader *)(reader->map + reader->offsets[frame]);
+}
+
+/** identities of the particles of a frame, in ascending order. */
+MDINLINE int *traj_reader_ids(TrajReader *reader, int frame)
+{
+  return (int *)(reader->map + reader->offsets[frame] + sizeof(TrajFrameHeader));
+}
+
+/** data of a column in a frame, without copying.
+    @param reader the reader
+    @param frame  the frame
+    @param code   the column code, e.g. \ref TRAJ_POS
+    @return the column, which contains floats, doubles or ints, see
+    \ref traj_element_size, or NULL if the file does not contain the
+    column. */
+void *traj_reader_column(TrajReader *reader, int frame, int code);
+
+/** Implementation of the Tcl command trajectory, which writes and
+    reads binary trajectory files. */
+int tclcommand_trajectory(ClientData data, Tcl_Interp *interp,
+			  int argc, char **argv);
+
+#endif
@@ -36,9 +36,12 @@
 #include "pressure.h"
 #include "domain_decomposition.h"
 #include "constraint.h"
+#include "soa.h"
+#include "threads.h"
+#include "timers.h"
 
-/** Granularity of the verlet list */
-#define LIST_INCREMENT 20
+/** Minimal size of the verlet list payload */
+#define LIST_MIN_SIZE 64
 
 /*****************************************
  * Variables 
@@ -48,235 +51,358 @@ int rebuild_verletlist = 1;
 
 
 
-/** \name Privat Functions */
-/************************************************************/
-/*@{*/
+/*******************  exported functions  *******************/
 
-/** Add a particle pair to a verlet pair list.
-    Checks verlet pair list size and reallocates memory if necessary.
- *  \param p1 Pointer to paricle one.
- *  \param p2 Pointer to paricle two.
- *  \param pl Pointer to the verlet pair list.
- */
-MDINLINE void add_pair(PairList *pl, Particle *p1, Particle *p2)
+void grow_verlet_list(PairList *pl)
 {
-  /* check size of verlet List */
-  if(pl->n+1 >= pl->max) {
-    pl->max += LIST_INCREMENT;
-    pl->pair = (Particle **)realloc(pl->pair, 2*pl->max*sizeof(Particle *));
-  }
-  /* add pair */
-  pl->pair[(2*pl->n)  ] = p1;
-  pl->pair[(2*pl->n)+1] = p2;
-  /* increase number of pairs */
-  pl->n++;
+  pl->max = (pl->max < LIST_MIN_SIZE) ? LIST_MIN_SIZE : 2*pl->max;
+  pl->pair = (unsigned int *)realloc(pl->pair, pl->max*sizeof(unsigned int));
 }
 
-/** Resizes a verlet pair list according to the actual content (*vl).n. 
-    \param pl Pointer to the verlet pair list. */
-void resize_verlet_list(PairList *pl);
-
-/*@}*/
+void start_verlet_list(PairList *pl, int np)
+{
+  if(np > pl->max_part) {
+    pl->max_part = np + np/2;
+    pl->n_partners = (int *)realloc(pl->n_partners, pl->max_part*sizeof(int));
+  }
+  pl->n_part = np;
+  pl->n = 0;
+}
 
-/*******************  exported functions  *******************/
+void finish_verlet_list(PairList *pl)
+{
+  if(pl->max > LIST_MIN_SIZE && 4*pl->n < pl->max) {
+    pl->max /= 2;
+    pl->pair = (unsigned int *)realloc(pl->pair, pl->max*sizeof(unsigned int));
+  }
+}
 
 void init_pairList(PairList *list)
 {
-  list->n       = 0;
-  list->max     = 0;
-  list->pair = NULL;
+  list->n          = 0;
+  list->max        = 0;
+  list->pair       = NULL;
+  list->n_part     = 0;
+  list->max_part   = 0;
+  list->n_partners = NULL;
 }
 
 void free_pairList(PairList *list)
 {
-  list->n       = 0;
-  list->max     = 0;
-  list->pair = (Particle **)realloc(list->pair, 0);
+  free(list->pair);
+  free(list->n_partners);
+  init_pairList(list);
 }
 
-void build_verlet_lists()
+/** Verlet list of local cell c, without force calculation. */
+static void build_verlet_list_cell(int c)
 {
-  int c, np1, n, np2, i ,j, j_start;
+  int np1, n, np2, i ,j, j_start, n_start;
   Cell *cell;
-  IA_Neighbor *neighbor;
+  IA_Neighbor_List *nl;
   Particle *p1, *p2;
   PairList *pl;
   double dist2;
-
-#ifdef VERLET_DEBUG 
-  int estimate, sum=0;
-  fprintf(stderr,"%d: build_verlet_list_and_force_calc:\n",this_node);
-  /* estimate number of interactions: (0.5*n_part*ia_volume*density)/n_nodes */
-  estimate = 0.5*n_total_particles*(4.0/3.0*PI*pow(max_range_non_bonded,3.0))*(n_total_particles/(box_l[0]*box_l[1]*box_l[2]))/n_nodes;
-
-  if (!dd.use_vList) { fprintf(stderr, "%d: build_verlet_lists, but use_vList == 0\n", this_node); errexit(); }
-#endif
-   
-  /* Loop local cells */
-  for (c = 0; c < local_cells.n; c++) {
-    VERLET_TRACE(fprintf(stderr,"%d: cell %d with %d neighbors\n",this_node,c, dd.cell_inter[c].n_neighbors));
-
-    cell = local_cells.cell[c];
-    p1   = cell->part;
-    np1  = cell->n;
+  IA_parameters *ia_row;
+
+  VERLET_TRACE(fprintf(stderr,"%d: cell %d with %d neighbors\n",this_node,c, dd.cell_inter[c].n_neighbors));
+
+  cell = local_cells.cell[c];
+  p1   = cell->part;
+  np1  = cell->n;
+  nl   = &dd.cell_inter[c];
+  /* init pair list */
+  pl   = &nl->vList;
+  start_verlet_list(pl, np1);
+  /* Loop cell particles */
+  for(i=0; i < np1; i++) {
+    /* Tasks within cell: store old position */
+    memcpy(p1[i].l.p_old, p1[i].r.p, 3*sizeof(double));
+    n_start = pl->n;
+    /* the Verlet ranges of the type pairs, negative if the types
+       do not interact at all */
+    ia_row = get_ia_param(p1[i].p.type, 0);
     /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      neighbor = &dd.cell_inter[c].nList[n];
-      p2  = neighbor->pList->part;
-      np2 = neighbor->pList->n;
-      /* init pair list */
-      pl  = &neighbor->vList;
-      pl->n = 0;
-      /* Loop cell particles */
-      for(i=0; i < np1; i++) {
-	j_start = 0;
-	/* Tasks within cell: store old position, avoid double counting */
-	if(n == 0) {
-	   memcpy(p1[i].l.p_old, p1[i].r.p, 3*sizeof(double));
-	   j_start = i+1;
-	}
-	/* Loop neighbor cell particles */
-	for(j = j_start; j < np2; j++) {
+    for (n = 0; n < nl->n_neighbors; n++) {
+      p2  = nl->nList[n].pList->part;
+      np2 = nl->nList[n].pList->n;
+      /* avoid double counting within the cell */
+      j_start = (n == 0) ? i+1 : 0;
+      /* Loop neighbor cell particles */
+      for(j = j_start; j < np2; j++) {
 #ifdef EXCLUSIONS
-          if(do_nonbonded(&p1[i], &p2[j]))
+	if(do_nonbonded(&p1[i], &p2[j]))
 #endif
 	  {
 	    dist2 = distance2(p1[i].r.p, p2[j].r.p);
-	    if(dist2 <= max_range_non_bonded2) add_pair(pl, &p1[i], &p2[j]);
+	    if(dist2 <= ia_row[p2[j].p.type].nb_range2) add_pair(pl, n, j);
 	  }
-	}
       }
-      resize_verlet_list(pl);
-      VERLET_TRACE(fprintf(stderr,"%d: neighbor %d has %d particles\n",this_node,n,pl->n));
-      VERLET_TRACE(sum += pl->n);
     }
+    pl->n_partners[i] = pl->n - n_start;
   }
+  finish_verlet_list(pl);
+  VERLET_TRACE(fprintf(stderr,"%d: cell %d has %d pairs\n",this_node,c,pl->n));
+}
+
+/** print the total number of Verlet pairs and a rough estimate. */
+static void trace_verlet_pairs(const char *caller)
+{
+#ifdef VERLET_DEBUG 
+  int c, sum = 0;
+  /* estimate number of interactions: (0.5*n_part*ia_volume*density)/n_nodes */
+  int estimate = 0.5*n_total_particles*(4.0/3.0*PI*pow(max_range_non_bonded,3.0))*(n_total_particles/(box_l[0]*box_l[1]*box_l[2]))/n_nodes;
 
-  VERLET_TRACE(fprintf(stderr,"%d: total number of interaction pairs: %d (should be around %d)\n",this_node,sum,estimate));
+  if (!dd.use_vList) { fprintf(stderr, "%d: %s, but use_vList == 0\n", this_node, caller); errexit(); }
+  for (c = 0; c < local_cells.n; c++)
+    sum += dd.cell_inter[c].vList.n;
+  fprintf(stderr,"%d: %s: total number of interaction pairs: %d (should be around %d)\n",this_node,caller,sum,estimate);
+#endif
+}
 
+void build_verlet_lists()
+{
+  timer_start(TIMER_VERLET);
+  dd_loop_cells_colored(build_verlet_list_cell, DD_CELLS_ALL);
+  trace_verlet_pairs("build_verlet_lists");
+  timer_stop(TIMER_VERLET);
   rebuild_verletlist = 0;
 }
 
-void calculate_verlet_ia()
+/** non bonded forces of local cell c from its Verlet list. */
+static void calculate_verlet_ia_cell(int c)
 {
-  int c, np, n, i;
+  int i, k, m;
   Cell *cell;
-  Particle *p1, *p2, **pairs;
+  IA_Neighbor_List *nl;
+  Particle *p1, *p2;
+  PairList *pl;
   double dist2, vec21[3];
 
-  /* Loop local cells */
-  for (c = 0; c < local_cells.n; c++) {
-    cell = local_cells.cell[c];
-    p1   = cell->part;
-    np  = cell->n;
-    /* calculate bonded interactions (loop local particles) */
-    for(i = 0; i < np; i++)  {
-      add_bonded_force(&p1[i]);
-#ifdef CONSTRAINTS
-      add_constraints_forces(&p1[i]);
-#endif
+  cell = local_cells.cell[c];
+  p1   = cell->part;
+  nl = &dd.cell_inter[c];
+  pl = &nl->vList;
+  for(i = 0, k = 0; i < pl->n_part; i++) {
+    for(m = pl->n_partners[i]; m > 0; m--, k++) {
+      p2 = dd_verlet_partner(nl, pl->pair[k]);
+      dist2 = distance2vec(p1[i].r.p, p2->r.p, vec21);
+      add_non_bonded_pair_force(&p1[i], p2, vec21, sqrt(dist2), dist2);
     }
+  }
+}
 
-    /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      pairs = dd.cell_inter[c].nList[n].vList.pair;
-      np    = dd.cell_inter[c].nList[n].vList.n;
-      /* verlet list loop */
-      for(i=0; i<2*np; i+=2) {
-	p1 = pairs[i];                    /* pointer to particle 1 */
-	p2 = pairs[i+1];                  /* pointer to particle 2 */
-	dist2 = distance2vec(p1->r.p, p2->r.p, vec21);
-	add_non_bonded_pair_force(p1, p2, vec21, sqrt(dist2), dist2);
-      }
-    }
+void calculate_verlet_ia()
+{
+  GhostCommunicator *gc = &cell_structure.update_ghost_pos_comm;
+
+  if (gc->started) {
+    /* the ghost positions are still in flight, see
+       cells_start_update_ghosts. The inner cells do not need them. */
+    dd_loop_cells_colored(calculate_verlet_ia_cell, DD_CELLS_INNER);
+    ghost_communicator_wait(gc);
+    init_forces_ghosts();
+    calc_local_bonded_forces();
+    dd_loop_cells_colored(calculate_verlet_ia_cell, DD_CELLS_BORDER);
+    return;
   }
+
+  calc_local_bonded_forces();
+  dd_loop_cells_colored(calculate_verlet_ia_cell, DD_CELLS_ALL);
 }
 
-void build_verlet_lists_and_calc_verlet_ia()
+/** Verlet list and non bonded forces of local cell c. */
+static void build_verlet_list_and_calc_ia_cell(int c)
 {
-  int c, np1, n, np2, i ,j, j_start;
+  int np1, n, np2, i ,j, j_start, n_start;
   Cell *cell;
-  IA_Neighbor *neighbor;
+  IA_Neighbor_List *nl;
   Particle *p1, *p2;
   PairList *pl;
   double dist2, vec21[3];
- 
-#ifdef VERLET_DEBUG 
-  int estimate, sum=0;
-  fprintf(stderr,"%d: build_verlet_list_and_calc_verlet_ia:\n",this_node);
-  /* estimate number of interactions: (0.5*n_part*ia_volume*density)/n_nodes */
-  estimate = 0.5*n_total_particles*(4.0/3.0*PI*pow(max_range_non_bonded,3.0))*(n_total_particles/(box_l[0]*box_l[1]*box_l[2]))/n_nodes;
+  IA_parameters *ia_row;
 
-  if (!dd.use_vList) { fprintf(stderr, "%d: build_verlet_lists, but use_vList == 0\n", this_node); errexit(); }
-#endif
- 
-  /* Loop local cells */
-  for (c = 0; c < local_cells.n; c++) {
-    VERLET_TRACE(fprintf(stderr,"%d: cell %d with %d neighbors\n",this_node,c, dd.cell_inter[c].n_neighbors));
+  VERLET_TRACE(fprintf(stderr,"%d: cell %d with %d neighbors\n",this_node,c, dd.cell_inter[c].n_neighbors));
+
+  cell = local_cells.cell[c];
+  p1   = cell->part;
+  np1  = cell->n;
+  nl   = &dd.cell_inter[c];
+  /* init pair list */
+  pl   = &nl->vList;
+  start_verlet_list(pl, np1);
+
+  /* Loop cell particles */
+  for(i=0; i < np1; i++) {
+    /* Tasks within cell: store old position */
+    memcpy(p1[i].l.p_old, p1[i].r.p, 3*sizeof(double));
+    n_start = pl->n;
+    ia_row = get_ia_param(p1[i].p.type, 0);
 
-    cell = local_cells.cell[c];
-    p1   = cell->part;
-    np1  = cell->n;
-    
     /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      neighbor = &dd.cell_inter[c].nList[n];
-      p2  = neighbor->pList->part;
-      np2 = neighbor->pList->n;
-      VERLET_TRACE(fprintf(stderr,"%d: neighbor %d contains %d parts\n",this_node,n,np2));
-      /* init pair list */
-      pl  = &neighbor->vList;
-      pl->n = 0;
-      /* Loop cell particles */
-      for(i=0; i < np1; i++) {
-	j_start = 0;
-	/* Tasks within cell: bonded forces, store old position, avoid double counting */
-	if(n == 0) {
-	  add_bonded_force(&p1[i]);
-#ifdef CONSTRAINTS
-	  add_constraints_forces(&p1[i]);
-#endif
-	  memcpy(p1[i].l.p_old, p1[i].r.p, 3*sizeof(double));
-	  j_start = i+1;
-	}
-	/* Loop neighbor cell particles */
-	for(j = j_start; j < np2; j++) {
+    for (n = 0; n < nl->n_neighbors; n++) {
+      p2  = nl->nList[n].pList->part;
+      np2 = nl->nList[n].pList->n;
+      /* avoid double counting within the cell */
+      j_start = (n == 0) ? i+1 : 0;
+      /* Loop neighbor cell particles */
+      for(j = j_start; j < np2; j++) {
 #ifdef EXCLUSIONS
-          if(do_nonbonded(&p1[i], &p2[j]))
+	if(do_nonbonded(&p1[i], &p2[j]))
 #endif
 	  {
-	  dist2 = distance2vec(p1[i].r.p, p2[j].r.p, vec21);
+	    dist2 = distance2vec(p1[i].r.p, p2[j].r.p, vec21);
 
-	  VERLET_TRACE(fprintf(stderr,"%d: pair %d %d has distance %f\n",this_node,p1[i].p.identity,p2[j].p.identity,sqrt(dist2)));
-	  if(dist2 <= max_range_non_bonded2) {
-	    ONEPART_TRACE(if(p1[i].p.identity==check_id) fprintf(stderr,"%d: OPT: Verlet Pair %d %d (Cells %d,%d %d,%d dist %f)\n",this_node,p1[i].p.identity,p2[j].p.identity,c,i,n,j,sqrt(dist2)));
-	    ONEPART_TRACE(if(p2[j].p.identity==check_id) fprintf(stderr,"%d: OPT: Verlet Pair %d %d (Cells %d %d dist %f)\n",this_node,p1[i].p.identity,p2[j].p.identity,c,n,sqrt(dist2)));
+	    VERLET_TRACE(fprintf(stderr,"%d: pair %d %d has distance %f\n",this_node,p1[i].p.identity,p2[j].p.identity,sqrt(dist2)));
+	    if(dist2 <= ia_row[p2[j].p.type].nb_range2) {
+	      ONEPART_TRACE(if(p1[i].p.identity==check_id) fprintf(stderr,"%d: OPT: Verlet Pair %d %d (Cells %d,%d %d,%d dist %f)\n",this_node,p1[i].p.identity,p2[j].p.identity,c,i,n,j,sqrt(dist2)));
+	      ONEPART_TRACE(if(p2[j].p.identity==check_id) fprintf(stderr,"%d: OPT: Verlet Pair %d %d (Cells %d %d dist %f)\n",this_node,p1[i].p.identity,p2[j].p.identity,c,n,sqrt(dist2)));
 
-	    add_pair(pl, &p1[i], &p2[j]);
-	    /* calc non bonded interactions */
-	    add_non_bonded_pair_force(&(p1[i]), &(p2[j]), vec21, sqrt(dist2), dist2);
+	      add_pair(pl, n, j);
+	      /* calc non bonded interactions */
+	      add_non_bonded_pair_force(&(p1[i]), &(p2[j]), vec21, sqrt(dist2), dist2);
+	    }
 	  }
-	 }
-	}
       }
-      resize_verlet_list(pl);
-      VERLET_TRACE(fprintf(stderr,"%d: neighbor %d has %d pairs\n",this_node,n,pl->n));
-      VERLET_TRACE(sum += pl->n);
     }
+    pl->n_partners[i] = pl->n - n_start;
   }
+  finish_verlet_list(pl);
+  VERLET_TRACE(fprintf(stderr,"%d: cell %d has %d pairs\n",this_node,c,pl->n));
+}
+
+void build_verlet_lists_and_calc_verlet_ia()
+{
+  calc_local_bonded_forces();
+  timer_start(TIMER_VERLET);
+  dd_loop_cells_colored(build_verlet_list_and_calc_ia_cell, DD_CELLS_ALL);
+  timer_stop(TIMER_VERLET);
+  trace_verlet_pairs("build_verlet_lists_and_calc_verlet_ia");
 
-  VERLET_TRACE(fprintf(stderr,"%d: total number of interaction pairs: %d (should be around %d)\n",this_node,sum,estimate));
- 
   rebuild_verletlist = 0;
 }
 
-/************************************************************/
+/** Variant of \ref calculate_verlet_ia_cell working on the cell
+    mirrors. */
+static void calculate_verlet_ia_soa_cell(int c)
+{
+  int n, i, j, k, m;
+  Cell *cell;
+  IA_Neighbor_List *nl;
+  CellSoA *s1, *s2[CELLS_MAX_NEIGHBORS];
+  Particle *p1, *p2[CELLS_MAX_NEIGHBORS];
+  PairList *pl;
+  unsigned int pair;
+  double dist2, vec21[3], x1, y1, z1;
+
+  cell = local_cells.cell[c];
+  p1   = cell->part;
+  s1   = cell_soa(cell);
+
+  nl = &dd.cell_inter[c];
+  for (n = 0; n < nl->n_neighbors; n++) {
+    p2[n] = nl->nList[n].pList->part;
+    s2[n] = cell_soa(nl->nList[n].pList);
+  }
+
+  /* verlet list loop */
+  pl = &nl->vList;
+  for(i = 0, k = 0; i < pl->n_part; i++) {
+    x1 = s1->x[i]; y1 = s1->y[i]; z1 = s1->z[i];
+    for(m = pl->n_partners[i]; m > 0; m--, k++) {
+      pair = pl->pair[k];
+      n = VERLET_PAIR_CELL(pair);
+      j = VERLET_PAIR_INDEX(pair);
+      vec21[0] = x1 - s2[n]->x[j];
+      vec21[1] = y1 - s2[n]->y[j];
+      vec21[2] = z1 - s2[n]->z[j];
+      dist2 = SQR(vec21[0]) + SQR(vec21[1]) + SQR(vec21[2]);
+      add_non_bonded_pair_force_soa(&p1[i], s1, i, &p2[n][j], s2[n], j, vec21, dist2);
+    }
+  }
+}
+
+void calculate_verlet_ia_soa()
+{
+  calc_local_bonded_forces();
+  dd_loop_cells_colored(calculate_verlet_ia_soa_cell, DD_CELLS_ALL);
+}
+
+/** Variant of \ref build_verlet_list_and_calc_ia_cell working on the
+    cell mirrors. */
+static void build_verlet_list_and_calc_ia_soa_cell(int c)
+{
+  int np1, n, np2, i ,j, j_start, n_start;
+  Cell *cell;
+  CellSoA *s1, *s2;
+  IA_Neighbor_List *nl;
+  Particle *p1, *p2;
+  PairList *pl;
+  double dist2, vec21[3], x1, y1, z1;
+  IA_parameters *ia_row;
+
+  cell = local_cells.cell[c];
+  p1   = cell->part;
+  np1  = cell->n;
+  s1   = cell_soa(cell);
+  nl   = &dd.cell_inter[c];
+  /* init pair list */
+  pl   = &nl->vList;
+  start_verlet_list(pl, np1);
+
+  /* Loop cell particles */
+  for(i=0; i < np1; i++) {
+    /* Tasks within cell: store old position */
+    memcpy(p1[i].l.p_old, p1[i].r.p, 3*sizeof(double));
+    n_start = pl->n;
+    x1 = s1->x[i]; y1 = s1->y[i]; z1 = s1->z[i];
+    ia_row = get_ia_param(s1->type[i], 0);
+
+    /* Loop cell neighbors */
+    for (n = 0; n < nl->n_neighbors; n++) {
+      p2  = nl->nList[n].pList->part;
+      np2 = nl->nList[n].pList->n;
+      s2  = cell_soa(nl->nList[n].pList);
+      /* avoid double counting within the cell */
+      j_start = (n == 0) ? i+1 : 0;
+      /* Loop neighbor cell particles */
+      for(j = j_start; j < np2; j++) {
+	vec21[0] = x1 - s2->x[j];
+	vec21[1] = y1 - s2->y[j];
+	vec21[2] = z1 - s2->z[j];
+	dist2 = SQR(vec21[0]) + SQR(vec21[1]) + SQR(vec21[2]);
+	if(dist2 <= ia_row[s2->type[j]].nb_range2) {
+#ifdef EXCLUSIONS
+	  if(s1->n_excl[i] > 0 && !do_nonbonded(&p1[i], &p2[j]))
+	    continue;
+#endif
+	  add_pair(pl, n, j);
+	  add_non_bonded_pair_force_soa(&p1[i], s1, i, &p2[j], s2, j, vec21, dist2);
+	}
+      }
+    }
+    pl->n_partners[i] = pl->n - n_start;
+  }
+  finish_verlet_list(pl);
+}
+
+void build_verlet_lists_and_calc_verlet_ia_soa()
+{
+  calc_local_bonded_forces();
+  timer_start(TIMER_VERLET);
+  dd_loop_cells_colored(build_verlet_list_and_calc_ia_soa_cell, DD_CELLS_ALL);
+  timer_stop(TIMER_VERLET);
+
+  rebuild_verletlist = 0;
+}
 
 void calculate_verlet_energies()
 {
-  int c, np, n, i;
+  int c, np, i, k, m;
   Cell *cell;
-  Particle *p1, *p2, **pairs;
+  IA_Neighbor_List *nl;
+  Particle *p1, *p2;
+  PairList *pl;
   double dist2, vec21[3];
 
   VERLET_TRACE(fprintf(stderr,"%d: calculate verlet energies\n",this_node));
@@ -295,20 +421,17 @@ void calculate_verlet_energies()
 #endif
     }
 
-    VERLET_TRACE(fprintf(stderr,"%d: cell %d with %d neighbors\n",this_node,c, dd.cell_inter[c].n_neighbors));
-    /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      pairs = dd.cell_inter[c].nList[n].vList.pair;
-      np    = dd.cell_inter[c].nList[n].vList.n;
-      VERLET_TRACE(fprintf(stderr,"%d: neighbor %d has %d particles\n",this_node,n,np));
-
-      /* verlet list loop */
-      for(i=0; i<2*np; i+=2) {
-	p1 = pairs[i];                    /* pointer to particle 1 */
-	p2 = pairs[i+1];                  /* pointer to particle 2 */
-	dist2 = distance2vec(p1->r.p, p2->r.p, vec21);
-	VERLET_TRACE(fprintf(stderr, "%d: %d <-> %d: dist2 dist2\n",this_node,p1->p.identity,p2->p.identity));
-	add_non_bonded_pair_energy(p1, p2, vec21, sqrt(dist2), dist2);
+    nl = &dd.cell_inter[c];
+    pl = &nl->vList;
+    VERLET_TRACE(fprintf(stderr,"%d: cell %d has %d pairs\n",this_node,c,pl->n));
+
+    /* verlet list loop */
+    for(i = 0, k = 0; i < pl->n_part; i++) {
+      for(m = pl->n_partners[i]; m > 0; m--, k++) {
+	p2 = dd_verlet_partner(nl, pl->pair[k]);
+	dist2 = distance2vec(p1[i].r.p, p2->r.p, vec21);
+	VERLET_TRACE(fprintf(stderr, "%d: %d <-> %d: dist2 dist2\n",this_node,p1[i].p.identity,p2->p.identity));
+	add_non_bonded_pair_energy(&p1[i], p2, vec21, sqrt(dist2), dist2);
       }
     }
   }
@@ -318,9 +441,11 @@ void calculate_verlet_energies()
 
 void calculate_verlet_virials(int v_comp)
 {
-  int c, np, n, i;
+  int c, np, i, k, m;
   Cell *cell;
-  Particle *p1, *p2, **pairs;
+  IA_Neighbor_List *nl;
+  Particle *p1, *p2;
+  PairList *pl;
   double dist2, vec21[3];
 
   VERLET_TRACE(fprintf(stderr,"%d: calculate verlet pressure\n",this_node));
@@ -340,19 +465,16 @@ void calculate_verlet_virials(int v_comp)
 
     }
 
-    VERLET_TRACE(fprintf(stderr,"%d: cell %d with %d neighbors\n",this_node,c, dd.cell_inter[c].n_neighbors));
-    /* Loop cell neighbors */
-    for (n = 0; n < dd.cell_inter[c].n_neighbors; n++) {
-      pairs = dd.cell_inter[c].nList[n].vList.pair;
-      np    = dd.cell_inter[c].nList[n].vList.n;
-      VERLET_TRACE(fprintf(stderr,"%d: neighbor %d has %d particles\n",this_node,n,np));
-
-      /* verlet list loop */
-      for(i=0; i<2*np; i+=2) {
-	p1 = pairs[i];                    /* pointer to particle 1 */
-	p2 = pairs[i+1];                  /* pointer to particle 2 */
-	dist2 = distance2vec(p1->r.p, p2->r.p, vec21);
-	add_non_bonded_pair_virials(p1, p2, vec21, sqrt(dist2), dist2);
+    nl = &dd.cell_inter[c];
+    pl = &nl->vList;
+    VERLET_TRACE(fprintf(stderr,"%d: cell %d has %d pairs\n",this_node,c,pl->n));
+
+    /* verlet list loop */
+    for(i = 0, k = 0; i < pl->n_part; i++) {
+      for(m = pl->n_partners[i]; m > 0; m--, k++) {
+	p2 = dd_verlet_partner(nl, pl->pair[k]);
+	dist2 = distance2vec(p1[i].r.p, p2->r.p, vec21);
+	add_non_bonded_pair_virials(&p1[i], p2, vec21, sqrt(dist2), dist2);
       }
     }
   }
@@ -360,17 +482,6 @@ void calculate_verlet_virials(int v_comp)
 
 /************************************************************/
 
-void resize_verlet_list(PairList *pl)
-{
-  int diff;
-  diff = pl->max - pl->n;
-  if( diff > 2*LIST_INCREMENT ) {
-    diff = (diff/LIST_INCREMENT)-1;
-    pl->max -= diff*LIST_INCREMENT;
-    pl->pair = (Particle **)realloc(pl->pair, 2*pl->max*sizeof(Particle *));
-  }
-}
-
 void announce_rebuild_vlist()
 {
   int sum;
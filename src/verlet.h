@@ -38,7 +38,10 @@
  *  have been reused with \ref tclcommand_setmd \ref verlet_reuse.
  *
  *  The verlet algorithm uses the data type \ref PairList to store
- *  interacting particle pairs.
+ *  interacting particle pairs, one list per local cell. A pair is
+ *  only stored if it is within the Verlet range of its two types, \ref
+ *  IA_parameters::nb_range2, so pairs of types that do not interact
+ *  at all never enter the lists.
  *
  *  To use verlet pair lists for the force calculation you can either
  *  use the functions \ref build_verlet_lists and \ref
@@ -57,19 +60,42 @@
  * data types
  ************************************************/
 
-/** Verlet pair list. The verlet pair list array is resized using a
-    sophisticated (we hope) algorithm to avoid unnecessary resizes.
-    Access using \ref resize_verlet_list.
+/** Verlet pair list of one local cell in compressed sparse row
+    format. For each particle i of the cell, n_partners[i] consecutive
+    entries of pair hold its interaction partners. Each entry is a 32
+    bit word, containing the number of the neighbor cell in the
+    interacting neighbor cell list (see \ref IA_Neighbor_List) in the
+    upper bits and the index of the partner within that cell in the
+    lower \ref VERLET_INDEX_BITS bits. Use \ref VERLET_PAIR, \ref
+    VERLET_PAIR_CELL and \ref VERLET_PAIR_INDEX to access it. The
+    arrays grow geometrically and are reused across rebuilds.
 */
 typedef struct {
-  /** The pair payload (two pointers per pair) */
-  Particle **pair;
+  /** The pair payload (one encoded partner per pair) */
+  unsigned int *pair;
   /** Number of pairs contained */
   int n;
   /** Number of pairs that fit in until a resize is needed */
   int max;
+  /** Number of partners of each particle of the cell */
+  int *n_partners;
+  /** Number of particles the list was built for */
+  int n_part;
+  /** Number of particles that fit in n_partners */
+  int max_part;
 } PairList;
 
+/** Number of bits of a \ref PairList entry used for the particle index */
+#define VERLET_INDEX_BITS 27
+
+/** Encode partner particle index in neighbor cell cell. */
+#define VERLET_PAIR(cell, index) \
+  (((unsigned int)(cell) << VERLET_INDEX_BITS) | (unsigned int)(index))
+/** neighbor cell number of an encoded partner */
+#define VERLET_PAIR_CELL(pair)  ((pair) >> VERLET_INDEX_BITS)
+/** particle index of an encoded partner within its cell */
+#define VERLET_PAIR_INDEX(pair) ((pair) & ((1u << VERLET_INDEX_BITS) - 1))
+
 
 /** \name Exported Variables */
 /************************************************************/
@@ -91,6 +117,33 @@ void init_pairList(PairList *list);
 /** Free a Pair List . */
 void free_pairList(PairList *list);
 
+/** Prepare the verlet pair list of a cell for a rebuild. The pair
+    payload is kept, the partner counts are resized for np particles.
+    @param pl the verlet pair list.
+    @param np number of particles in the cell. */
+void start_verlet_list(PairList *pl, int np);
+
+/** Grow the payload of a verlet pair list geometrically.
+    @param pl the verlet pair list. */
+void grow_verlet_list(PairList *pl);
+
+/** Add a partner of the current particle to a verlet pair list.
+    Checks verlet pair list size and reallocates memory if necessary.
+    @param pl    the verlet pair list.
+    @param n     number of the neighbor cell of the partner.
+    @param index index of the partner in its cell. */
+MDINLINE void add_pair(PairList *pl, int n, int index)
+{
+  if(pl->n >= pl->max)
+    grow_verlet_list(pl);
+  pl->pair[pl->n++] = VERLET_PAIR(n, index);
+}
+
+/** Shrink the payload of a verlet pair list after a rebuild if it is
+    mostly unused, e. g. after a cell has emptied.
+    @param pl the verlet pair list. */
+void finish_verlet_list(PairList *pl);
+
 /** Fill verlet tables. */
 void build_verlet_lists();
 
@@ -103,6 +156,14 @@ void calculate_verlet_ia();
 */
 void build_verlet_lists_and_calc_verlet_ia();
 
+/** Variant of \ref calculate_verlet_ia that takes positions from and
+    accumulates forces into the cell mirrors, see \ref soa.h. */
+void calculate_verlet_ia_soa();
+
+/** Variant of \ref build_verlet_lists_and_calc_verlet_ia that works
+    on the cell mirrors, see \ref soa.h. */
+void build_verlet_lists_and_calc_verlet_ia_soa();
+
 /** Nonbonded and bonded energy calculation using the verlet list */
 void calculate_verlet_energies();
 
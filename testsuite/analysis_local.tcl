@@ -0,0 +1,188 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the observables that are calculated node locally and then
+# reduced (center of mass, angular momentum, kinetic energy, density
+# profile, distributions) against the same quantities calculated
+# from the particle data in Tcl.
+source "tests_common.tcl"
+
+puts "------------------------------------------------"
+puts "- Testcase analysis_local.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set epsilon 1e-5
+set n_part 200
+set box 10.0
+set dt 0.01
+
+proc check_value {what got exp} {
+    global epsilon
+    if { abs($got - $exp) > $epsilon*(1 + abs($exp)) } {
+	error "$what is $got, should be $exp"
+    }
+}
+
+proc check_vector {what got exp} {
+    if { [llength $got] != [llength $exp] } {
+	error "$what has [llength $got] elements, should have [llength $exp]"
+    }
+    foreach g $got e $exp { check_value $what $g $e }
+}
+
+# the mass of a particle, 1 without MASS
+proc mass {id} {
+    if { [has_feature "MASS"] } { return [part $id print mass] }
+    return 1.0
+}
+
+# bin of a linear histogram, clamped like the C code
+proc bin {x min max bins} {
+    set ind [expr int(($x - $min)*(1.0/(($max - $min)/$bins)))]
+    if { $ind < 0 } { return 0 }
+    if { $ind >= $bins } { return [expr $bins - 1] }
+    return $ind
+}
+
+proc min_dist2 {p1 p2} {
+    global box
+    set d2 0
+    foreach a $p1 b $p2 {
+	set d [expr $a - $b]
+	set d [expr $d - round($d/$box)*$box]
+	set d2 [expr $d2 + $d*$d]
+    }
+    return $d2
+}
+
+if { [catch {
+    setmd box_l $box $box $box
+    setmd time_step $dt
+    setmd skin 0.3
+    thermostat off
+
+    # particles in several images of the box
+    expr srand(17)
+    for { set i 0 } { $i < $n_part } { incr i } {
+	part $i pos [expr 30*rand()-10] [expr 30*rand()-10] [expr 30*rand()-10] \
+	    v [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5] type [expr $i % 3]
+	if { [has_feature "MASS"] } { part $i mass [expr 0.5 + rand()] }
+    }
+    integrate 0
+
+    ############## center of mass, angular momentum, kinetic energy
+    foreach type {-1 0 1 2} {
+	set com {0 0 0}; set am {0 0 0}; set M 0; set ekin 0
+	for { set i 0 } { $i < $n_part } { incr i } {
+	    if { $type != -1 && [part $i print type] != $type } { continue }
+	    set m [mass $i]
+	    foreach {x y z} [part $i print pos] break
+	    foreach {vx vy vz} [part $i print v] break
+	    set com [list [expr [lindex $com 0] + $m*$x] [expr [lindex $com 1] + $m*$y] [expr [lindex $com 2] + $m*$z]]
+	    # the angular momentum is in internal units, i.e. scaled by the time step
+	    set am [list [expr [lindex $am 0] + $m*($y*$vz - $z*$vy)*$dt] \
+			[expr [lindex $am 1] + $m*($z*$vx - $x*$vz)*$dt] \
+			[expr [lindex $am 2] + $m*($x*$vy - $y*$vx)*$dt]]
+	    set M [expr $M + $m]
+	    set ekin [expr $ekin + 0.5*$m*($vx*$vx + $vy*$vy + $vz*$vz)]
+	}
+	set com [list [expr [lindex $com 0]/$M] [expr [lindex $com 1]/$M] [expr [lindex $com 2]/$M]]
+	check_vector "centermass $type" [analyze centermass $type] $com
+	check_vector "angularmomentum $type" [analyze angularmomentum $type] $am
+	check_value "energy_kinetic $type" [analyze energy_kinetic $type] $ekin
+    }
+
+    ############## density profile
+    set bins 7
+    foreach dir {0 1 2} {
+	set ref {}
+	for { set b 0 } { $b < $bins } { incr b } { lappend ref 0 }
+	for { set i 0 } { $i < $n_part } { incr i } {
+	    if { [part $i print type] == 2 } { continue }
+	    set x [lindex [part $i print folded_position] $dir]
+	    set b [bin $x 0 $box $bins]
+	    lset ref $b [expr [lindex $ref $b] + $bins/pow($box, 3)]
+	}
+	set got {}
+	foreach r [lindex [analyze density_profile $bins $dir {0 1}] 0] { lappend got [lindex $r 1] }
+	check_vector "density_profile $dir" $got $ref
+    }
+
+    ############## minimal distance distribution
+    foreach {r_min r_max r_bins log_flag} {0.0 2.0 10 0  0.3 3.0 8 1} {
+	set ref {}
+	for { set b 0 } { $b < $r_bins } { incr b } { lappend ref 0 }
+	set cnt 0
+	for { set i 0 } { $i < $n_part } { incr i } {
+	    if { [part $i print type] != 0 } { continue }
+	    set pi [part $i print pos]
+	    set md2 [expr pow(3*$box, 2)]
+	    for { set j 0 } { $j < $n_part } { incr j } {
+		if { $j == $i || [part $j print type] == 0 } { continue }
+		set d2 [min_dist2 $pi [part $j print pos]]
+		if { $d2 < $md2 } { set md2 $d2 }
+	    }
+	    set d [expr sqrt($md2)]
+	    if { $d >= $r_min && $d <= $r_max } {
+		if { $log_flag } {
+		    set b [expr int((log($d) - log($r_min))*($r_bins/(log($r_max) - log($r_min))))]
+		} else {
+		    set b [expr int(($d - $r_min)*($r_bins/($r_max - $r_min)))]
+		}
+		if { $b < $r_bins } { lset ref $b [expr [lindex $ref $b] + 1] }
+	    }
+	    incr cnt
+	}
+	set got {}
+	foreach r [lindex [analyze distribution {0} {1 2} $r_min $r_max $r_bins $log_flag] 1] {
+	    lappend got [expr round([lindex $r 1]*$cnt)]
+	}
+	check_vector "distribution $log_flag" $got $ref
+    }
+
+    ############## velocity distribution
+    set bins 9
+    set cv {0 0 0}; set cnt 0
+    for { set i 1 } { $i < $n_part } { incr i 3 } {
+	foreach c {0 1 2} { lset cv $c [expr [lindex $cv $c] + [lindex [part $i print v] $c]] }
+	incr cnt
+    }
+    set max 0.2
+    foreach c {0 1 2} { lset cv $c [expr [lindex $cv $c]/$cnt] }
+    for { set i 1 } { $i < $n_part } { incr i 3 } {
+	foreach v [part $i print v] c $cv {
+	    if { abs($v - $c) > $max } { set max [expr abs($v - $c)] }
+	}
+    }
+    set ref {}
+    for { set b 0 } { $b < $bins } { incr b } { lappend ref 0 }
+    for { set i 1 } { $i < $n_part } { incr i 3 } {
+	foreach v [part $i print v] c $cv {
+	    set b [bin [expr $v - $c] [expr -$max] $max $bins]
+	    lset ref $b [expr [lindex $ref $b] + 1.0/(3*$cnt)]
+	}
+    }
+    set res [lindex [analyze vel_distr 1 $bins 0.2] 1]
+    set got {}
+    foreach r $res { lappend got [lindex $r 1] }
+    check_vector "vel_distr" $got $ref
+    check_value "vel_distr range" [lindex [lindex $res 0] 0] [expr -$max*(1 - 1.0/$bins)]
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,92 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check that overlapping the ghost communication with the force
+# calculation (cellsystem domain_decomposition -async_ghosts) gives the
+# same forces and trajectories as the blocking communication, for a
+# polymer melt with bonded and non bonded interactions
+source "tests_common.tcl"
+
+require_feature "LENNARD_JONES"
+
+# the virtual sites are updated on the ghosts after the communication,
+# so the overlap has to be refused
+if { [has_feature "VIRTUAL_SITES_COM"] || [has_feature "VIRTUAL_SITES_RELATIVE"] } {
+    if { ![catch {cellsystem domain_decomposition -async_ghosts}] } {
+	error_exit "-async_ghosts accepted with virtual sites"
+    }
+    require_feature "VIRTUAL_SITES_COM" off
+    require_feature "VIRTUAL_SITES_RELATIVE" off
+}
+
+puts "---------------------------------------------"
+puts "- Testcase async_ghosts.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "---------------------------------------------"
+
+set epsilon 1e-8
+thermostat off
+
+if { [catch {
+    set L 14.0
+    setmd box_l $L $L $L
+    setmd time_step 0.005
+    setmd skin 0.4
+
+    inter 0 fene 7.0 2.0
+    inter 0 0 lennard-jones 1.0 1.0 1.12246 auto 0.0
+    expr srand(7)
+    polymer 30 10 0.97 mode SAW 0.8 types 0 0 FENE 0
+    set n [setmd n_part]
+    for { set i 0 } { $i < $n } { incr i } {
+	part $i v [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5]
+	set P0($i) [part $i pr pos]
+	set V0($i) [part $i pr v]
+    }
+    inter ljforcecap 50
+
+    ############## reference with blocking communication
+    cellsystem domain_decomposition
+    integrate 200
+    store_property pos P
+    store_property f F
+
+    ############## overlapped communication
+    # also with the threaded force loops, which progress the
+    # communication from the master thread
+    set threads 1
+    if { [regexp "OPENMP" [code_info]] } { lappend threads 3 }
+    foreach nt $threads {
+	setmd n_threads $nt
+	for { set i 0 } { $i < $n } { incr i } {
+	    eval part $i pos $P0($i) v $V0($i)
+	}
+	cellsystem domain_decomposition -async_ghosts
+	integrate 200
+	set devp [max_deviation pos P]
+	set devf [max_deviation f F]
+	puts "$nt threads: maximal relative deviations position $devp, force $devf after 200 steps"
+	if { $devp > $epsilon } { error "trajectory deviation too large" }
+	if { $devf > $epsilon } { error "force deviation too large" }
+    }
+
+    setmd n_threads 1
+    cellsystem domain_decomposition
+} res ] } {
+    error_exit $res
+}
+
+exit 0
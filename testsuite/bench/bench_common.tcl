@@ -0,0 +1,90 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# common procedures of the benchmarks. A benchmark sets up its system,
+# equilibrates it and then calls bench_run, which times the integration
+# and appends a line to the CSV file given as first argument
+# (default bench_results.csv).
+source [file join [file dirname [info script]] .. tests_common.tcl]
+
+# the phases of the timers command that are reported per step
+set bench_phases {force_calc verlet_build ghost_comm resort p3m_kspace fft lb_fluid}
+
+# the columns of the results
+proc bench_header {} {
+    global bench_phases
+    set header {system ranks n_part steps tau_per_day us_per_part_step}
+    foreach p $bench_phases { lappend header "${p}_ms" }
+    lappend header "force_imbalance"
+    return [join $header ","]
+}
+
+# place n particles of type 0 on a simple cubic lattice in the box
+proc bench_lattice {n {start 0}} {
+    set box [setmd box_l]
+    set per_side [expr int(ceil(pow($n, 1.0/3.0)))]
+    for { set i 0 } { $i < $n } { incr i } {
+	set x [expr $i % $per_side]
+	set y [expr ($i / $per_side) % $per_side]
+	set z [expr $i / ($per_side*$per_side)]
+	part [expr $start + $i] pos \
+	    [expr ($x + 0.5)*[lindex $box 0]/$per_side] \
+	    [expr ($y + 0.5)*[lindex $box 1]/$per_side] \
+	    [expr ($z + 0.5)*[lindex $box 2]/$per_side] type 0
+    }
+}
+
+# time steps integration steps of the system and report them as
+# system name
+proc bench_run {name steps} {
+    global argv bench_phases
+
+    set file "bench_results.csv"
+    if { [llength $argv] > 0 } { set file [lindex $argv 0] }
+
+    # the first force calculation and the resort are not timed
+    integrate 0
+    if { [has_feature "TIMERS"] } { timers reset }
+    set start [clock microseconds]
+    integrate $steps
+    set seconds [expr ([clock microseconds] - $start)*1e-6]
+
+    set n_part [setmd n_part]
+    set line [list $name [setmd n_nodes] $n_part $steps \
+		  [format %.6g [expr $steps*[setmd time_step]/$seconds*86400]] \
+		  [format %.6g [expr $seconds*1e6/($n_part*$steps)]]]
+
+    # the phase breakdown in ms per step, the slowest node counts
+    if { [has_feature "TIMERS"] } {
+	foreach t [timers] { set timer([lindex $t 0]) [lrange $t 1 end] }
+	foreach p $bench_phases {
+	    lappend line [format %.6g [expr [lindex $timer($p) 2]*1e3/$steps]]
+	}
+	lappend line [format %.4f [lindex $timer(force_calc) 4]]
+    } {
+	foreach p $bench_phases { lappend line "" }
+	lappend line ""
+    }
+
+    set new [expr ![file exists $file]]
+    set f [open $file "a"]
+    if { $new } { puts $f [bench_header] }
+    puts $f [join $line ","]
+    close $f
+
+    puts "$name on [setmd n_nodes] tasks: [lindex $line 4] tau/day, [lindex $line 5] us per particle step"
+}
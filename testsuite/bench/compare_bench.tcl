@@ -0,0 +1,84 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# compare benchmark results against baselines. Usage:
+#
+#   Espresso compare_bench.tcl <results> <baseline> [<tolerance>]
+#
+# Both files are CSV files as written by bench_run. For every system
+# and number of tasks in both files, the time per particle step is
+# compared. If it is slower than the baseline by more than the
+# relative tolerance (default 0.1), the script fails. Results without
+# a baseline are only listed.
+
+if { [llength $argv] < 2 } {
+    puts stderr "usage: compare_bench.tcl <results> <baseline> \[<tolerance>\]"
+    exit 2
+}
+foreach {results baseline tolerance} $argv break
+if { $tolerance == "" } { set tolerance 0.1 }
+
+# read the time per particle step of a CSV file into the array res
+# indexed by system,ranks. Later lines replace earlier ones.
+proc read_csv {file array} {
+    upvar $array res
+    set f [open $file "r"]
+    set header [split [gets $f] ","]
+    set c_sys  [lsearch $header "system"]
+    set c_rank [lsearch $header "ranks"]
+    set c_time [lsearch $header "us_per_part_step"]
+    if { $c_sys < 0 || $c_rank < 0 || $c_time < 0 } {
+	error "$file is not a benchmark result"
+    }
+    while { [gets $f line] >= 0 } {
+	if { [string trim $line] == "" || [string index $line 0] == "#" } continue
+	set fields [split $line ","]
+	set res([lindex $fields $c_sys],[lindex $fields $c_rank]) [lindex $fields $c_time]
+    }
+    close $f
+}
+
+if { [catch {
+    read_csv $results now
+    read_csv $baseline base
+} err] } {
+    puts stderr $err
+    exit 2
+}
+
+set regressions 0
+puts [format "%-16s %5s %12s %12s %8s" system ranks baseline result change]
+foreach key [lsort [array names now]] {
+    foreach {sys ranks} [split $key ","] break
+    if { ![info exists base($key)] } {
+	puts [format "%-16s %5s %12s %12.4g %8s" $sys $ranks "-" $now($key) "new"]
+	continue
+    }
+    set change [expr $now($key)/$base($key) - 1]
+    set line [format "%-16s %5s %12.4g %12.4g %+7.1f%%" $sys $ranks $base($key) $now($key) [expr 100*$change]]
+    if { $change > $tolerance } {
+	append line "  REGRESSION"
+	incr regressions
+    }
+    puts $line
+}
+
+if { $regressions > 0 } {
+    puts "$regressions benchmarks are more than [expr 100*$tolerance]% slower than the baseline"
+    exit 1
+}
+exit 0
@@ -0,0 +1,55 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# benchmark: Kremer-Grest melt of chains of 50 beads with FENE bonds
+# and purely repulsive Lennard-Jones, with the Langevin thermostat.
+source [file join [file dirname [info script]] bench_common.tcl]
+
+require_feature "LENNARD_JONES"
+
+set n_chains     80
+set chain_length 50
+set density      0.85
+set bond_length  0.97
+
+# the chains start stretched along x, in rows on a square grid in y/z
+set box_x   [expr $chain_length*$bond_length]
+set per_row [expr int(ceil(sqrt($n_chains)))]
+set box_yz  [expr sqrt($n_chains*$chain_length/($density*$box_x))]
+
+setmd box_l $box_x $box_yz $box_yz
+setmd time_step 0.01
+setmd skin 0.4
+inter 0 0 lennard-jones 1.0 1.0 1.12246 auto 0
+inter 0 fene 30.0 1.5
+
+set spacing [expr $box_yz/$per_row]
+for { set c 0 } { $c < $n_chains } { incr c } {
+    set y [expr ($c % $per_row + 0.5)*$spacing]
+    set z [expr ($c / $per_row + 0.5)*$spacing]
+    for { set i 0 } { $i < $chain_length } { incr i } {
+	set id [expr $c*$chain_length + $i]
+	part $id pos [expr ($i + 0.5)*$bond_length] $y $z type 0
+	if { $i > 0 } { part $id bond 0 [expr $id - 1] }
+    }
+}
+
+thermostat langevin 1.0 0.5
+integrate 500
+
+bench_run kremer_grest 1000
+exit 0
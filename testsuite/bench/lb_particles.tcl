@@ -0,0 +1,43 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# benchmark: Lennard-Jones particles coupled to a lattice Boltzmann
+# fluid.
+source [file join [file dirname [info script]] bench_common.tcl]
+
+require_feature "LENNARD_JONES"
+require_feature "LB"
+
+set n_part 1000
+set box_l  16.0
+
+setmd box_l $box_l $box_l $box_l
+setmd time_step 0.01
+setmd skin 0.4
+# LB requires the domain decomposition without Verlet lists
+cellsystem domain_decomposition -no_verlet_list
+inter 0 0 lennard-jones 1.0 1.0 1.12246 auto 0
+
+bench_lattice $n_part
+
+lbfluid cpu dens 1.0 visc 1.0 agrid 1.0 tau 0.01
+lbfluid friction 20.0
+thermostat lb 1.0
+integrate 100
+
+bench_run lb_particles 500
+exit 0
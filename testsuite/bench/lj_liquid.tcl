@@ -0,0 +1,40 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# benchmark: Lennard-Jones liquid at the triple point, with the full
+# cutoff of 2.5, integrated microcanonically.
+source [file join [file dirname [info script]] bench_common.tcl]
+
+require_feature "LENNARD_JONES"
+
+set n_part  4000
+set density 0.8442
+set box_l   [expr pow($n_part/$density, 1.0/3.0)]
+
+setmd box_l $box_l $box_l $box_l
+setmd time_step 0.005
+setmd skin 0.4
+inter 0 0 lennard-jones 1.0 1.0 2.5 auto 0
+
+bench_lattice $n_part
+
+thermostat langevin 1.0 1.0
+integrate 200
+thermostat off
+
+bench_run lj_liquid 1000
+exit 0
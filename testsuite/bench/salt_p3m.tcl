@@ -0,0 +1,49 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# benchmark: 1:1 salt solution of charged soft spheres with P3M.
+source [file join [file dirname [info script]] bench_common.tcl]
+
+require_feature "LENNARD_JONES"
+require_feature "ELECTROSTATICS"
+require_feature "FFTW"
+
+set n_part  2000
+set density 0.1
+set box_l   [expr pow($n_part/$density, 1.0/3.0)]
+
+setmd box_l $box_l $box_l $box_l
+setmd time_step 0.01
+setmd skin 0.4
+inter 0 0 lennard-jones 1.0 1.0 1.12246 auto 0
+
+bench_lattice $n_part
+# neighbouring lattice sites have opposite charges
+set per_side [expr int(ceil(pow($n_part, 1.0/3.0)))]
+for { set i 0 } { $i < $n_part } { incr i } {
+    set parity [expr ($i % $per_side + ($i/$per_side) % $per_side + $i/($per_side*$per_side)) % 2]
+    part $i q [expr $parity ? 1 : -1]
+}
+
+# fixed parameters instead of tuning, so that the timings compare
+inter coulomb 2.0 p3m 5.0 32 5 0.6
+
+thermostat langevin 1.0 1.0
+integrate 200
+
+bench_run salt_p3m 500
+exit 0
@@ -0,0 +1,59 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# benchmark: charged soft spheres in a slab between two walls, with
+# P3M and the ELC correction for the two dimensional periodicity.
+source [file join [file dirname [info script]] bench_common.tcl]
+
+require_feature "LENNARD_JONES"
+require_feature "ELECTROSTATICS"
+require_feature "CONSTRAINTS"
+require_feature "PARTIAL_PERIODIC"
+require_feature "FFTW"
+
+set n_part 1000
+set box_l  30.0
+set height 20.0
+set gap    [expr $box_l - $height]
+
+setmd box_l $box_l $box_l $box_l
+setmd time_step 0.01
+setmd skin 0.4
+inter 0 0 lennard-jones 1.0 1.0 1.12246 auto 0
+inter 0 1 lennard-jones 1.0 1.0 1.12246 auto 0
+
+constraint wall normal 0 0 1 dist 0 type 1
+constraint wall normal 0 0 -1 dist [expr -$height] type 1
+
+expr srand(4)
+for { set i 0 } { $i < $n_part } { incr i } {
+    part $i pos [expr $box_l*rand()] [expr $box_l*rand()] [expr 1.0 + ($height - 2.0)*rand()] \
+	type 0 q [expr ($i % 2) ? 1 : -1]
+}
+
+thermostat langevin 1.0 1.0
+inter ljforcecap 20
+integrate 200
+inter ljforcecap 0
+
+inter coulomb 1.0 p3m 6.0 32 5 0.5
+inter coulomb epsilon metallic
+inter coulomb elc 1e-4 [expr $gap - 1.0]
+integrate 100
+
+bench_run slab_elc 500
+exit 0
@@ -0,0 +1,205 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the particle clusters and the aggregates of molecules, which
+# are joined in disjoint-set forests on the nodes, against a plain
+# flood fill over all pairs in Tcl.
+source "tests_common.tcl"
+
+require_feature "LENNARD_JONES"
+
+puts "------------------------------------------------"
+puts "- Testcase clusters.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set n_mol 60
+set mol_len 3
+set box 12.0
+
+proc min_dist {p1 p2} {
+    global box
+    set d2 0
+    foreach a $p1 b $p2 {
+	set d [expr $a - $b]
+	set d [expr $d - round($d/$box)*$box]
+	set d2 [expr $d2 + $d*$d]
+    }
+    return [expr sqrt($d2)]
+}
+
+# the clusters of the elements, given the neighbors of each, ordered
+# as by analyze clusters
+proc flood_fill {elements nbs} {
+    array set nb $nbs
+    foreach e $elements { set seen($e) 0 }
+    set clusters {}
+    foreach e [lsort -integer $elements] {
+	if { $seen($e) } { continue }
+	set seen($e) 1
+	set cluster {}
+	set todo [list $e]
+	while { [llength $todo] } {
+	    set x [lindex $todo end]
+	    set todo [lrange $todo 0 end-1]
+	    lappend cluster $x
+	    foreach y $nb($x) {
+		if { !$seen($y) } { set seen($y) 1; lappend todo $y }
+	    }
+	}
+	lappend clusters [lsort -integer $cluster]
+    }
+    return $clusters
+}
+
+# the clusters of the particles of a type
+proc tcl_clusters {type dist} {
+    set ids {}
+    for { set i 0 } { $i <= [setmd max_part] } { incr i } {
+	if { [part $i print type] == $type } {
+	    lappend ids $i
+	    set pos($i) [part $i print pos]
+	}
+    }
+    foreach i $ids { set nb($i) {} }
+    foreach i $ids {
+	foreach j $ids {
+	    if { $j > $i && [min_dist $pos($i) $pos($j)] < $dist } {
+		lappend nb($i) $j; lappend nb($j) $i
+	    }
+	}
+    }
+    return [flood_fill $ids [array get nb]]
+}
+
+# the aggregates of the molecules s to f, with at least min_contact
+# close pairs, optionally only between opposite charges
+proc tcl_aggregates {dist s f min_contact charge} {
+    set ids {}
+    for { set i 0 } { $i <= [setmd max_part] } { incr i } {
+	set m [part $i print mol]
+	if { $m >= $s && $m <= $f } {
+	    lappend ids $i
+	    set pos($i) [part $i print pos]
+	    set mol($i) $m
+	    if { $charge } { set q($i) [part $i print q] }
+	}
+    }
+    for { set m $s } { $m <= $f } { incr m } { set nb($m) {} }
+    foreach i $ids {
+	foreach j $ids {
+	    if { $j <= $i || $mol($i) == $mol($j) } { continue }
+	    if { $charge && $q($i)*$q($j) >= 0 } { continue }
+	    if { [min_dist $pos($i) $pos($j)] < $dist } {
+		set key "[expr min($mol($i),$mol($j))],[expr max($mol($i),$mol($j))]"
+		if { [info exists cnt($key)] } { incr cnt($key) } { set cnt($key) 1 }
+	    }
+	}
+    }
+    foreach key [array names cnt] {
+	if { $cnt($key) >= $min_contact } {
+	    foreach {a b} [split $key ","] break
+	    lappend nb($a) $b; lappend nb($b) $a
+	}
+    }
+    set mols {}
+    for { set m $s } { $m <= $f } { incr m } { lappend mols $m }
+    return [flood_fill $mols [array get nb]]
+}
+
+proc check_clusters {what got exp} {
+    if { [llength $got] != [llength $exp] } {
+	error "$what: found [llength $got] clusters, should be [llength $exp]"
+    }
+    foreach g $got e $exp {
+	if { [concat $g] != $e } { error "$what: found cluster {$g}, should be {$e}" }
+    }
+}
+
+if { [catch {
+    setmd box_l $box $box $box
+    setmd time_step 0.01
+    setmd skin 0.3
+    thermostat off
+    # only for the cell size of at least 1.5
+    inter 0 0 lennard-jones 0 1 1.2
+
+    # small molecules, placed in a few aggregates that cross the box
+    # and node boundaries, and a loose gas
+    expr srand(5)
+    set id 0
+    for { set m 0 } { $m < $n_mol } { incr m } {
+	if { $m < 40 } {
+	    set c [lindex {{0.5 0.5 0.5} {6 6 11.5} {3 9 6} {9 3 3}} [expr $m % 4]]
+	    set r 2.0
+	} {
+	    set c {6 6 6}
+	    set r 6.0
+	}
+	set p {}
+	foreach x $c { lappend p [expr $x + $r*(2*rand() - 1)] }
+	for { set i 0 } { $i < $mol_len } { incr i } {
+	    eval part $id pos $p type [expr $id % 2] mol $m
+	    if { [has_feature "ELECTROSTATICS"] } { part $id q [expr ($i % 2) ? -1 : 1] }
+	    set p [list [expr [lindex $p 0] + 0.5] [lindex $p 1] [expr [lindex $p 2] + 0.3]]
+	    incr id
+	}
+    }
+    analyze set chains 0 $n_mol $mol_len
+    integrate 0
+
+    ############## particle clusters, on the nodes and on the master
+    foreach {type dist} {0 1.0 1 1.3 0 2.5 1 0.7} {
+	set got [analyze clusters $type $dist]
+	check_clusters "clusters $type $dist" $got [tcl_clusters $type $dist]
+
+	set sizes {}
+	foreach c $got { lappend sizes [llength $c] }
+	set distr {}
+	foreach s [lsort -integer -unique $sizes] {
+	    lappend distr [list $s [llength [lsearch -all $sizes $s]]]
+	}
+	set got {}
+	foreach e [lindex [analyze cluster_size_dist $type $dist] 1] { lappend got [concat $e] }
+	if { $got != $distr } {
+	    error "cluster_size_dist $type $dist is {$got}, should be {$distr}"
+	}
+    }
+
+    ############## aggregates
+    set params {1.0 0 59 1 0   1.2 10 49 1 0   1.2 0 59 2 0   1.5 0 59 3 0}
+    if { [has_feature "ELECTROSTATICS"] } { lappend params 1.2 0 59 1 1   1.5 5 50 2 1 }
+    foreach {dist s f min_contact charge} $params {
+	set res [analyze aggregation $dist $s $f $min_contact $charge]
+	set exp [tcl_aggregates $dist $s $f $min_contact $charge]
+	set sizes {}
+	foreach a $exp { lappend sizes [llength $a] }
+	set sizes [lsort -integer $sizes]
+	if { [lindex $res 1] != [lindex $sizes end] || [lindex $res 3] != [lindex $sizes 0] ||
+	     [lindex $res 9] != [llength $exp] } {
+	    error "aggregation $dist $s $f $min_contact $charge: wrong statistics $res"
+	}
+	check_clusters "aggregation $dist $s $f $min_contact $charge" [lrange $res 11 end] $exp
+    }
+
+    if { ![catch { analyze aggregation 2.5 0 59 } res] || ![string match "*cell size*" $res] } {
+	error "aggregation beyond the cell size was accepted"
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
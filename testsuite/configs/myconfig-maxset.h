@@ -17,6 +17,7 @@
 
 #define NEMD
 #define NPT 
+#define TIMERS
 
 #define LB
 #define LB_BOUNDARIES
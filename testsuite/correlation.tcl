@@ -0,0 +1,172 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the multiple tau correlator: the lags and pairs of the sample
+# hierarchy against a direct calculation for values given in Tcl, and
+# the MSD, velocity and stress autocorrelations of freely moving
+# particles, which are sampled during the integration.
+source "tests_common.tcl"
+
+puts "------------------------------------------------"
+puts "- Testcase correlation.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set epsilon 1e-6
+set n_part 50
+set box 10.0
+set dt 0.01
+
+proc check_value {what got exp} {
+    global epsilon
+    if { abs($got - $exp) > $epsilon*(1 + abs($exp)) } {
+	error "$what is $got, should be $exp"
+    }
+}
+
+# the correlation of the Tcl values A and B with discarding compression,
+# where level k keeps the samples 0, 2^k, 2*2^k..., and a sample of
+# level k is available 2^k samples after it was taken.
+proc discard_ref {A B tau_lin n_levels} {
+    set T [llength $A]
+    set res {}
+    for { set k 0 } { $k < $n_levels } { incr k } {
+	set step [expr 1 << $k]
+	for { set j [expr $k ? $tau_lin/2 : 0] } { $j < $tau_lin } { incr j } {
+	    set lag [expr $j*$step]
+	    set sum 0; set cnt 0
+	    for { set s 0 } { $s + $lag + $step <= $T } { incr s $step } {
+		foreach a [lindex $A $s] b [lindex $B [expr $s + $lag]] {
+		    set sum [expr $sum + $a*$b]
+		}
+		incr cnt
+	    }
+	    if { $cnt > 0 } { lappend res [list $lag $cnt [expr $sum/$cnt]] }
+	}
+    }
+    return $res
+}
+
+if { [catch {
+    setmd box_l $box $box $box
+    setmd time_step $dt
+    setmd skin 0.3
+    thermostat off
+
+    ############## lags and pairs, values given in Tcl
+    expr srand(31)
+    set A {}; set B {}
+    for { set t 0 } { $t < 100 } { incr t } {
+	lappend A [list [expr rand()] [expr rand()-0.5]]
+	lappend B [list [expr rand()] [expr 2*rand()]]
+    }
+
+    set auto [correlation new obs1 tcl 2 corr_operation scalar_product \
+		  tau_lin 4 tau_max 40 dt 1 compress discard]
+    set cross [correlation new obs1 tcl 2 obs2 tcl 2 corr_operation scalar_product \
+		   tau_lin 4 tau_max 40 dt 1 compress discard]
+    foreach a $A b $B {
+	correlation $auto update $a
+	correlation $cross update $a $b
+    }
+    # lags up to 3*2^4 = 48 >= 40, i.e. 5 levels
+    foreach id [list $auto $cross] ref [list [discard_ref $A $A 4 5] [discard_ref $A $B 4 5]] {
+	set got [correlation $id print]
+	if { [llength $got] != [llength $ref] } {
+	    error "correlation $id has [llength $got] lags, should have [llength $ref]"
+	}
+	foreach g $got r $ref {
+	    foreach {tau n c} $g break
+	    foreach {tau_r n_r c_r} $r break
+	    if { $tau != $tau_r || $n != $n_r } {
+		error "correlation $id: lag $tau with $n samples, should be $tau_r with $n_r"
+	    }
+	    check_value "correlation $id at lag $tau" $c $c_r
+	}
+	correlation $id free
+    }
+    if { [correlation] != "" } { error "correlations [correlation] were not freed" }
+
+    ############## freely moving particles, sampled during the integration
+    set v2 0
+    for { set i 0 } { $i < $n_part } { incr i } {
+	set v [list [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5]]
+	eval part $i pos [expr $box*rand()] [expr $box*rand()] [expr $box*rand()] v $v type [expr $i % 2]
+	foreach c $v { set v2 [expr $v2 + $c*$c] }
+    }
+    set v2 [expr $v2/$n_part]
+
+    set stride 2
+    set msd [correlation new obs1 particle_positions corr_operation square_distance \
+		 tau_lin 8 tau_max 1.0 stride $stride]
+    set vacf [correlation new obs1 particle_velocities corr_operation scalar_product \
+		  tau_lin 8 tau_max 1.0 stride $stride]
+    set stress [correlation new obs1 stress_tensor corr_operation componentwise_product \
+		    tau_lin 8 tau_max 1.0 stride $stride]
+    set msd_0 [correlation new obs1 particle_positions types 0 \
+		   corr_operation square_distance_componentwise tau_lin 8 tau_max 1.0 stride $stride]
+    foreach id [list $msd $vacf $stress $msd_0] { correlation $id autoupdate start }
+    integrate 200
+    foreach id [list $msd $vacf $stress $msd_0] { correlation $id autoupdate stop }
+    integrate 10
+
+    if { [lindex [correlation $msd] end] != 100 } {
+	error "[lindex [correlation $msd] end] samples taken, should be 100"
+    }
+
+    # positions move linearly, which the averaging keeps
+    foreach r [correlation $msd print] {
+	foreach {tau n c} $r break
+	check_value "MSD at $tau" $c [expr $v2*$tau*$tau]
+    }
+    foreach r [correlation $vacf print] {
+	foreach {tau n c} $r break
+	check_value "VACF at $tau" $c $v2
+    }
+
+    set v2_0 {0 0 0}; set n_0 0
+    for { set i 0 } { $i < $n_part } { incr i 2 } {
+	foreach c [part $i print v] d {0 1 2} {
+	    lset v2_0 $d [expr [lindex $v2_0 $d] + $c*$c]
+	}
+	incr n_0
+    }
+    foreach r [correlation $msd_0 print] {
+	foreach {tau n cx cy cz} $r break
+	foreach c [list $cx $cy $cz] d {0 1 2} {
+	    check_value "MSD of type 0 at $tau" $c [expr [lindex $v2_0 $d]/$n_0*$tau*$tau]
+	}
+    }
+
+    # the stress tensor is constant without interactions
+    set p [lrange [lindex [analyze stress_tensor] 0] 1 end]
+    foreach r [correlation $stress print] {
+	foreach c [lrange $r 2 end] p_kl $p {
+	    check_value "stress autocorrelation at [lindex $r 0]" $c [expr $p_kl*$p_kl]
+	}
+    }
+
+    ############## the particles must not change
+    correlation $msd autoupdate start
+    part $n_part pos 0 0 0
+    if { ![catch { integrate 4 } res] || ![string match "*310*" $res] } {
+	error "adding a particle was not detected"
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
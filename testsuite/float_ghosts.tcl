@@ -0,0 +1,96 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the single precision ghost communication (cellsystem
+# domain_decomposition -float_ghosts): the forces of a polymer melt
+# have to agree with the double precision ones within the float
+# accuracy, but must not be exact also on a single node, where only
+# the local copies are rounded. The error guard has to trigger if it
+# is too tight.
+source "tests_common.tcl"
+
+require_feature "LENNARD_JONES"
+
+puts "---------------------------------------------"
+puts "- Testcase float_ghosts.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "---------------------------------------------"
+
+set epsilon 1e-5
+thermostat off
+
+if { [catch {
+    set L 14.0
+    setmd box_l $L $L $L
+    setmd time_step 0.005
+    setmd skin 0.4
+
+    inter 0 fene 7.0 2.0
+    inter 0 0 lennard-jones 1.0 1.0 1.12246 auto 0.0
+    expr srand(11)
+    polymer 30 10 0.97 mode SAW 0.8 types 0 0 FENE 0
+    set n [setmd n_part]
+    for { set i 0 } { $i < $n } { incr i } {
+	part $i v [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5]
+    }
+    inter ljforcecap 50
+    integrate 100
+    inter ljforcecap 0
+    store_property pos P0
+    store_property v V0
+
+    ############## reference in double precision
+    cellsystem domain_decomposition
+    integrate 0
+    store_property f F
+    integrate 20
+    store_property pos P
+
+    ############## single precision
+    set systems { {-float_ghosts 1e-4} }
+    if { ![has_feature "VIRTUAL_SITES_COM"] && ![has_feature "VIRTUAL_SITES_RELATIVE"] } {
+	lappend systems {-async_ghosts -float_ghosts 1e-4}
+    }
+    foreach cs $systems {
+	for { set i 0 } { $i < $n } { incr i } {
+	    eval part $i pos $P0($i) v $V0($i)
+	}
+	eval cellsystem domain_decomposition $cs
+	integrate 0
+	set devf [max_deviation f F max]
+	integrate 20
+	set devp [max_deviation pos P max]
+	puts "cellsystem $cs: maximal relative deviations force $devf, position $devp after 20 steps"
+	if { $devf > $epsilon } { error "force deviation too large for $cs" }
+	if { $devf == 0 } { error "forces are exact for $cs, ghosts not rounded" }
+	if { $devp > $epsilon } { error "trajectory deviation too large for $cs" }
+    }
+
+    ############## error guard
+    cellsystem domain_decomposition -float_ghosts 1e-12
+    if { ![catch { integrate 2 } msg] } {
+	error "too small maximal error was not detected"
+    }
+    if { ![regexp "single precision ghost positions" $msg] } {
+	error "unexpected error $msg"
+    }
+
+    cellsystem domain_decomposition
+} res ] } {
+    error_exit $res
+}
+
+exit 0
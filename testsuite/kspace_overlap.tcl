@@ -0,0 +1,130 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check that the P3M forces and the trajectory do not change if the
+# charge mesh is gathered during the short ranged forces (setmd
+# kspace_overlap 1), for the variants of the domain decomposition and
+# with interlacing. With timers, also check that the charges were
+# actually assigned before the short ranged forces.
+source "tests_common.tcl"
+
+require_feature "ELECTROSTATICS"
+require_feature "FFTW"
+require_feature "LENNARD_JONES"
+
+puts "----------------------------------------"
+puts "- Testcase kspace_overlap.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "----------------------------------------"
+
+set epsilon 1e-10
+set n_part 200
+set box 10.0
+
+proc restore_state {} {
+    global n_part pos vel
+    for { set i 0 } { $i < $n_part } { incr i } {
+	eval part $i pos $pos($i) v $vel($i)
+    }
+}
+
+# forces and positions of all particles
+proc state {} {
+    global n_part
+    set res {}
+    for { set i 0 } { $i < $n_part } { incr i } {
+	eval lappend res [part $i print f] [part $i print pos]
+    }
+    return $res
+}
+
+proc compare {what got exp} {
+    global epsilon
+    foreach g $got e $exp {
+	if { abs($g - $e) > $epsilon*(abs($e) + 1.0) } {
+	    error "$what: $g, should be $e"
+	}
+    }
+}
+
+# the charge assignment before the short ranged forces is a separate
+# call of the p3m_kspace timer
+proc check_kspace_calls {what overlap} {
+    foreach t [timers] { set calls([lindex $t 0]) [lindex $t 1] }
+    set exp [expr (1 + $overlap)*$calls(force_calc)]
+    if { $calls(p3m_kspace) != $exp } {
+	error "$what, kspace_overlap $overlap: $calls(p3m_kspace) p3m_kspace calls for $calls(force_calc) force calculations, should be $exp"
+    }
+}
+
+set timers [has_feature "TIMERS"]
+
+if { [catch {
+    setmd box_l $box $box $box
+    setmd time_step 0.005
+    setmd skin 0.3
+    thermostat langevin 1.0 1.0
+
+    expr srand(3)
+    for { set i 0 } { $i < $n_part } { incr i } {
+	part $i pos [expr $box*rand()] [expr $box*rand()] [expr $box*rand()] \
+	    q [expr ($i % 2) ? 1 : -1]
+    }
+    inter 0 0 lennard-jones 1 1 1.12246 0.25 0
+    foreach cap {5 10 20 50 100} {
+	inter ljforcecap $cap
+	integrate 100
+    }
+    inter ljforcecap 0
+
+    for { set i 0 } { $i < $n_part } { incr i } {
+	set pos($i) [part $i print pos]
+	set vel($i) [part $i print v]
+    }
+    thermostat off
+
+    set cellsystems {
+	{domain_decomposition}
+	{domain_decomposition -no_verlet_list}
+	{domain_decomposition -soa}
+    }
+    foreach cs $cellsystems {
+	eval cellsystem $cs
+	foreach interlace {0 1} {
+	    inter coulomb 1.0 p3m 3.0 16 5 1.0
+	    inter coulomb interlace $interlace
+	    foreach overlap {0 1} {
+		restore_state
+		setmd kspace_overlap $overlap
+		if { $timers } { timers reset }
+		integrate 20
+		set st($overlap) [state]
+		if { $timers } { check_kspace_calls "cellsystem $cs, interlace $interlace" $overlap }
+	    }
+	    compare "cellsystem $cs, interlace $interlace" $st(1) $st(0)
+	    setmd kspace_overlap 0
+	    inter coulomb 0.0
+	}
+    }
+
+    if { ![catch { setmd kspace_overlap 2 }] } {
+	error "kspace_overlap 2 was accepted"
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,164 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check that the energies, pressures and stress tensors accumulated
+# during the force calculation (setmd obs_fused 1) are the same as the
+# ones of the separate loops, for all cell systems and with
+# electrostatics, and that the stress tensor sampled during the
+# integration does not change.
+source "tests_common.tcl"
+
+require_feature "LENNARD_JONES"
+require_feature "ADRESS" off
+
+puts "----------------------------------------"
+puts "- Testcase obs_fused.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "----------------------------------------"
+
+set epsilon 1e-8
+set n_part 200
+set box 10.0
+
+# all numbers of the energies, pressures and stress tensors
+proc observables {} {
+    set res {}
+    foreach obs [list [analyze energy] [analyze pressure] [analyze stress_tensor]] {
+	foreach x [string map {"\{" " " "\}" " "} $obs] {
+	    if { [string is double -strict $x] } { lappend res $x }
+	}
+    }
+    return $res
+}
+
+proc compare {what got exp} {
+    global epsilon
+    if { [llength $got] != [llength $exp] } {
+	error "$what: [llength $got] values, should be [llength $exp]"
+    }
+    foreach g $got e $exp {
+	if { abs($g - $e) > $epsilon*(abs($e) + 1.0) } {
+	    error "$what: $g, should be $e"
+	}
+    }
+}
+
+proc restore_state {} {
+    global n_part pos vel
+    for { set i 0 } { $i < $n_part } { incr i } {
+	eval part $i pos $pos($i) v $vel($i)
+    }
+}
+
+if { [catch {
+    setmd box_l $box $box $box
+    setmd time_step 0.002
+    setmd skin 0.3
+    thermostat langevin 1.0 1.0
+
+    # charged chains of four particles
+    expr srand(1)
+    inter 0 fene 30 1.5
+    for { set i 0 } { $i < $n_part } { incr i } {
+	if { $i % 4 == 0 } {
+	    set p [list [expr $box*rand()] [expr $box*rand()] [expr $box*rand()]]
+	} {
+	    set p [list [expr [lindex $p 0] + 0.9] [expr [lindex $p 1] + 0.3*rand()] [lindex $p 2]]
+	}
+	eval part $i pos $p type [expr $i % 2] mol [expr $i/4]
+	if { [has_feature "ELECTROSTATICS"] } { part $i q [expr ($i % 2) ? 1 : -1] }
+	if { $i % 4 } { part $i bond 0 [expr $i - 1] }
+    }
+    if { [has_feature "BOND_ANGLE"] } {
+	inter 1 angle 5.0
+	for { set i 0 } { $i < $n_part } { incr i } {
+	    if { $i % 4 == 1 || $i % 4 == 2 } { part $i bond 1 [expr $i - 1] [expr $i + 1] }
+	}
+    }
+    inter 0 0 lennard-jones 1 1 1.12246 0.25 0
+    inter 0 1 lennard-jones 1 1 2.5 auto 0
+    inter 1 1 lennard-jones 1 1 1.12246 0.25 0
+
+    foreach cap {5 10 20 50 100 200} {
+	inter ljforcecap $cap
+	integrate 200
+    }
+    inter ljforcecap 0
+    integrate 200
+
+    for { set i 0 } { $i < $n_part } { incr i } {
+	set pos($i) [part $i print pos]
+	set vel($i) [part $i print v]
+    }
+    thermostat off
+
+    ############## the observables after an integration
+    set cellsystems {
+	{domain_decomposition}
+	{domain_decomposition -no_verlet_list}
+	{domain_decomposition -soa}
+	{nsquare}
+    }
+    # resorting the particles into layers only works on a single node
+    if { [setmd n_nodes] == 1 } { lappend cellsystems {layered 1} }
+    foreach cs $cellsystems {
+	set methods {{}}
+	if { [has_feature "ELECTROSTATICS"] } {
+	    lappend methods {dh 1.0 2.5}
+	    if { [has_feature "FFTW"] && [lindex $cs 0] == "domain_decomposition" } {
+		lappend methods {p3m 3.0 16 5 1.0}
+	    }
+	}
+	foreach method $methods {
+	    restore_state
+	    eval cellsystem $cs
+	    if { $method != "" } { eval inter coulomb 1.0 $method }
+	    setmd obs_fused 1
+	    integrate 10
+	    set fused [observables]
+	    # the particles have to be checked again
+	    invalidate_system
+	    compare "cellsystem $cs, coulomb {$method}" $fused [observables]
+	    setmd obs_fused 0
+	    if { $method != "" } { inter coulomb 0.0 }
+	}
+    }
+
+    ############## the stress tensor sampled during the integration
+    cellsystem domain_decomposition
+    foreach fused {0 1} {
+	restore_state
+	setmd obs_fused $fused
+	set stress [correlation new obs1 stress_tensor corr_operation componentwise_product \
+			tau_lin 4 tau_max 0.06 stride 3]
+	correlation $stress autoupdate start
+	integrate 30
+	correlation $stress autoupdate stop
+	set corr($fused) {}
+	foreach r [correlation $stress print] { eval lappend corr($fused) $r }
+	correlation $stress free
+    }
+    compare "stress autocorrelation" $corr(1) $corr(0)
+    setmd obs_fused 0
+
+    if { ![catch { setmd obs_fused 2 }] } {
+	error "obs_fused 2 was accepted"
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
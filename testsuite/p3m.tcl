@@ -60,65 +60,73 @@ if { [catch {
     ############## P3M-specific part
     # the P3M parameters are stored in p3m_system.data
 
-    # to ensure force recalculation
-    invalidate_system
-    integrate 0
+    # the reference forces were obtained with the ik differentiation,
+    # the analytical differentiation and the interlaced meshes have
+    # to reproduce them as well
+    foreach {diff interlace} {ik 0 ad 0 ik 1 ad 1} {
+        puts "differentiation $diff, interlace $interlace"
+        inter coulomb diff $diff interlace $interlace
 
-    # here you can create the necessary snapshot
-    if { 0 } {
-	inter coulomb 1.0 p3m tune accuracy 1e-4
-	integrate 0
-
-	write_data "p3m_system.data"
-    }
-
-    ############## end
-
-    puts [analyze energy]
-    puts [analyze pressure]
-
-    set cureng [lindex [analyze   energy coulomb] 0]
-    set curprs [lindex [analyze pressure coulomb] 0]
+        # to ensure force recalculation
+        invalidate_system
+        integrate 0
 
+        # here you can create the necessary snapshot
+        if { 0 } {
+	    inter coulomb 1.0 p3m tune accuracy 1e-4
+	    integrate 0
 
-    #energy ...............
-    
-    set rel_eng_error [expr abs(($cureng - $energy)/$energy)]
-    puts "p3m-charges: relative energy deviations: $rel_eng_error"
-    if { $rel_eng_error > $epsilon } {
-      error "p3m-charges: relative energy error too large"
-    }
+	    write_data "p3m_system.data"
+        }
 
-   #pressure ................
+        ############## end
 
-    set rel_prs_error [expr abs(($curprs - $pressure)/$pressure)]
-    puts "p3m-charges: relative pressure deviations: $rel_prs_error"
-#    if { $rel_prs_error > $epsilon } {
-#	error "p3m charges: relative pressure error too large"
-#    }
+        puts [analyze energy]
+        puts [analyze pressure]
 
+        set cureng [lindex [analyze   energy coulomb] 0]
+        set curprs [lindex [analyze pressure coulomb] 0]
 
-    ############## end, here RMS force error for P3M
 
-    set rmsf 0
-    set tot 0
-    for { set i 0 } { $i <= [setmd max_part] } { incr i } {
-	set resF [part $i pr f]
-	set tgtF $F($i)
-	set dx [expr abs(([lindex $resF 0] - [lindex $tgtF 0]))]
-	set dy [expr abs(([lindex $resF 1] - [lindex $tgtF 1]))]
-	set dz [expr abs(([lindex $resF 2] - [lindex $tgtF 2]))]
-        set tot [expr $tot + [lindex $tgtF 0] * [lindex $tgtF 0] + [lindex $tgtF 1] * [lindex $tgtF 1] + [lindex $tgtF 2] * [lindex $tgtF 2] ]
-
-	set rmsf [expr $rmsf + $dx*$dx + $dy*$dy + $dz*$dz]
+        #energy ...............
+    
+        set rel_eng_error [expr abs(($cureng - $energy)/$energy)]
+        puts "p3m-charges: relative energy deviations: $rel_eng_error"
+        if { $rel_eng_error > $epsilon } {
+          error "p3m-charges: relative energy error too large with $diff, interlace $interlace"
+        }
+
+       #pressure ................
+
+        set rel_prs_error [expr abs(($curprs - $pressure)/$pressure)]
+        puts "p3m-charges: relative pressure deviations: $rel_prs_error"
+    #    if { $rel_prs_error > $epsilon } {
+    #	error "p3m charges: relative pressure error too large"
+    #    }
+
+
+        ############## end, here RMS force error for P3M
+
+        set rmsf 0
+        set tot 0
+        for { set i 0 } { $i <= [setmd max_part] } { incr i } {
+	    set resF [part $i pr f]
+	    set tgtF $F($i)
+	    set dx [expr abs(([lindex $resF 0] - [lindex $tgtF 0]))]
+	    set dy [expr abs(([lindex $resF 1] - [lindex $tgtF 1]))]
+	    set dz [expr abs(([lindex $resF 2] - [lindex $tgtF 2]))]
+            set tot [expr $tot + [lindex $tgtF 0] * [lindex $tgtF 0] + [lindex $tgtF 1] * [lindex $tgtF 1] + [lindex $tgtF 2] * [lindex $tgtF 2] ]
+
+	    set rmsf [expr $rmsf + $dx*$dx + $dy*$dy + $dz*$dz]
+        }
+
+        set rfe [expr $rmsf]
+        set rmsf [expr sqrt($rmsf/[setmd n_part])]
+        puts "p3m-charges: rms force deviation $rmsf ($rfe $tot)"
+        if { $rmsf > $epsilon } {
+	    error "p3m-charges: force error too large with $diff, interlace $interlace"
+       }
     }
-
-    set rfe [expr $rmsf]
-    set rmsf [expr sqrt($rmsf/[setmd n_part])]
-    puts "p3m-charges: rms force deviation $rmsf ($rfe $tot)"
-    if { $rmsf > $epsilon } {
-	error "p3m-charges: force error too large"
-   }
    
    
      #end this part of the p3m-checks by cleaning the system .... 
@@ -0,0 +1,164 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the per type pair force kernels: a mixture where the type
+# pairs use different potentials and cutoffs, and one pair does not
+# interact at all, compared to forces calculated directly in Tcl and
+# to the nsquare cellsystem, which does not use Verlet lists
+source "tests_common.tcl"
+
+require_feature "LENNARD_JONES"
+require_feature "ADRESS" off
+
+puts "----------------------------------------"
+puts "- Testcase pair_kernels.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "----------------------------------------"
+
+set epsilon 1e-8
+thermostat off
+
+# force on particle 1 from particle 2, d is the minimum image distance
+proc lj_force {eps sig cut d r} {
+    if { $r >= $cut } { return 0 }
+    set f6 [expr pow($sig/$r, 6)]
+    return [expr 48.0*$eps*$f6*($f6 - 0.5)/($r*$r)]
+}
+
+proc morse_force {eps alpha rmin cut r} {
+    if { $r >= $cut } { return 0 }
+    set add1 [expr exp(-2.0*$alpha*($r - $rmin))]
+    set add2 [expr exp(-$alpha*($r - $rmin))]
+    return [expr -$eps*2.0*$alpha*($add2 - $add1)/$r]
+}
+
+if { [catch {
+    set L 9.0
+    set n 200
+    setmd box_l $L $L $L
+    setmd time_step 0.002
+    setmd skin 0.4
+
+    # 0-0: LJ with a long cutoff, 1-1: WCA (+ Morse), 0-1: nothing
+    inter 0 0 lennard-jones 1.0 1.0 2.5 auto 0.0
+    inter 1 1 lennard-jones 1.0 1.0 1.12246 auto 0.0
+    set morse [has_feature "MORSE"]
+    if { $morse } {
+	inter 1 1 morse 0.5 2.0 1.2 2.0
+    }
+
+    # random configuration without overlaps
+    expr srand(17)
+    set i 0
+    while { $i < $n } {
+	set p [list [expr $L*rand()] [expr $L*rand()] [expr $L*rand()]]
+	set ok 1
+	for { set j 0 } { $j < $i } { incr j } {
+	    set r2 0
+	    for { set k 0 } { $k < 3 } { incr k } {
+		set d [expr [lindex $p $k] - [lindex $P($j) $k]]
+		set d [expr $d - $L*round($d/$L)]
+		set r2 [expr $r2 + $d*$d]
+	    }
+	    if { $r2 < 1.1*1.1 } { set ok 0; break }
+	}
+	if { !$ok } { continue }
+	set P($i) $p
+	set T($i) [expr $i % 2]
+	eval part $i pos $p type $T($i)
+	incr i
+    }
+
+    ############## forces compared to a direct calculation
+    for { set i 0 } { $i < $n } { incr i } { set F($i) {0 0 0} }
+    for { set i 0 } { $i < $n } { incr i } {
+	for { set j [expr $i + 1] } { $j < $n } { incr j } {
+	    if { $T($i) != $T($j) } { continue }
+	    set d {}
+	    set r2 0
+	    for { set k 0 } { $k < 3 } { incr k } {
+		set dk [expr [lindex $P($i) $k] - [lindex $P($j) $k]]
+		set dk [expr $dk - $L*round($dk/$L)]
+		lappend d $dk
+		set r2 [expr $r2 + $dk*$dk]
+	    }
+	    set r [expr sqrt($r2)]
+	    if { $T($i) == 0 } {
+		set fac [lj_force 1.0 1.0 2.5 $d $r]
+	    } else {
+		set fac [lj_force 1.0 1.0 1.12246 $d $r]
+		if { $morse } {
+		    set fac [expr $fac + [morse_force 0.5 2.0 1.2 2.0 $r]]
+		}
+	    }
+	    set fi {}
+	    set fj {}
+	    for { set k 0 } { $k < 3 } { incr k } {
+		lappend fi [expr [lindex $F($i) $k] + $fac*[lindex $d $k]]
+		lappend fj [expr [lindex $F($j) $k] - $fac*[lindex $d $k]]
+	    }
+	    set F($i) $fi
+	    set F($j) $fj
+	}
+    }
+
+    foreach cs { {domain_decomposition} {domain_decomposition -no_verlet_list} {nsquare} } {
+	eval cellsystem $cs
+	integrate 0
+	set dev [max_deviation f F]
+	puts "cellsystem $cs: maximal relative force deviation $dev"
+	if { $dev > $epsilon } { error "force deviation too large for cellsystem $cs" }
+    }
+
+    ############## trajectory with Verlet list reuse
+    for { set i 0 } { $i < $n } { incr i } {
+	part $i v [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5]
+	set V0($i) [part $i pr v]
+    }
+    cellsystem nsquare
+    integrate 200
+    for { set i 0 } { $i < $n } { incr i } {
+	set Pend($i) [part $i pr pos]
+	eval part $i pos $P($i) v $V0($i)
+    }
+    cellsystem domain_decomposition
+    integrate 200
+    set dev [max_deviation pos Pend]
+    puts "domain_decomposition: maximal relative position deviation $dev after 200 steps, verlet reuse [setmd verlet_reuse]"
+    if { $dev > $epsilon } { error "trajectory deviation too large" }
+
+    ############## the non-interacting pair has to stay in the Verlet lists
+    ############## if a method acts on all pairs
+    if { [has_feature "ELECTROSTATICS"] } {
+	for { set i 0 } { $i < $n } { incr i } {
+	    eval part $i pos $P($i) q [expr 1 - 2*($i % 3 == 0)]
+	}
+	inter coulomb 1.0 dh 0.5 2.0
+	cellsystem nsquare
+	integrate 0
+	store_property f F
+	cellsystem domain_decomposition
+	integrate 0
+	set dev [max_deviation f F]
+	puts "domain_decomposition: maximal relative force deviation $dev with Debye-Hueckel"
+	if { $dev > $epsilon } { error "force deviation too large with Debye-Hueckel" }
+	inter coulomb 0.0
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,140 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the bulk particle setup (part bulk): the particles have to
+# end up with the same properties and the same energy as when set
+# up one by one, both from a list and from binary data.
+source "tests_common.tcl"
+
+require_feature "LENNARD_JONES"
+
+puts "------------------------------------------------"
+puts "- Testcase part_bulk.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set epsilon 1e-10
+set n_part 300
+
+proc check_particles {what} {
+    global ref epsilon n_part
+    if { [setmd n_part] != $n_part } {
+	error "$what: [setmd n_part] particles, should be $n_part"
+    }
+    foreach {id pos v type} $ref {
+	set got [part $id pr pos v type]
+	set exp [concat $pos $v $type]
+	for { set j 0 } { $j < 7 } { incr j } {
+	    if { abs([lindex $got $j] - [lindex $exp $j]) > $epsilon } {
+		error "$what: particle $id is $got, should be $exp"
+	    }
+	}
+    }
+}
+
+if { [catch {
+    setmd box_l 10 10 10
+    setmd time_step 0.01
+    setmd skin 0.3
+    thermostat off
+    inter 0 0 lennard-jones 1.0 1.0 1.12246 0.25 0
+    inter 0 1 lennard-jones 1.0 1.0 2.5 0 0
+    inter 1 1 lennard-jones 1.0 1.0 1.12246 0.25 0
+
+    # reference system, ids with gaps and in random order
+    expr srand(42)
+    set ref {}
+    set data {}
+    for { set i 0 } { $i < $n_part } { incr i } {
+	set id [expr 3*(($i*7) % $n_part)]
+	set pos [list [expr 10*rand()] [expr 10*rand()] [expr 10*rand()]]
+	set v [list [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5]]
+	set type [expr $i % 2]
+	lappend ref $id $pos $v $type
+	eval lappend data $id $pos $v $type
+	eval part $id pos $pos v $v type $type
+    }
+    integrate 0
+    set energy [analyze energy total]
+    set pressure [analyze pressure total]
+    check_particles "one by one"
+    part deleteall
+
+    ############## from a list
+    part bulk pos v type $data
+    check_particles "list"
+    integrate 0
+    if { abs([analyze energy total] - $energy) > $epsilon*abs($energy) ||
+	 abs([analyze pressure total] - $pressure) > $epsilon*abs($pressure) } {
+	error "energy or pressure differ after bulk setup"
+    }
+    part deleteall
+
+    ############## binary, in two steps
+    set pos_data {}
+    set v_data {}
+    foreach {id pos v type} $ref {
+	eval lappend pos_data $id $pos $type
+	eval lappend v_data $id $v
+    }
+    part bulk binary pos type [binary format d* $pos_data]
+    part bulk binary v [binary format d* $v_data]
+    check_particles "binary"
+    integrate 0
+    if { abs([analyze energy total] - $energy) > $epsilon*abs($energy) } {
+	error "energy differs after binary bulk setup"
+    }
+
+    ############## errors leave everything unchanged
+    set new_id [expr 3*$n_part + 1]
+    if { ![catch {part bulk v [list 0 1 1 1 $new_id 1 1 1]}] } {
+	error "velocity of a particle without position accepted"
+    }
+    if { ![catch {part bulk pos type {0 1 1 1}}] } {
+	error "incomplete record accepted"
+    }
+    if { ![catch {part bulk pos {-1 1 1 1}}] } {
+	error "negative particle id accepted"
+    }
+    check_particles "after errors"
+
+    ############## a particle given twice is created once
+    part bulk pos [list $new_id 1 1 1 $new_id 2 2 2]
+    if { [setmd n_part] != $n_part + 1 } {
+	error "duplicate particle counted twice"
+    }
+    set pos [part $new_id pr pos]
+    if { [lindex $pos 0] != 2 } {
+	error "last occurrence of a duplicate particle did not win, position is $pos"
+    }
+    part $new_id delete
+    check_particles "after duplicates"
+
+    ############## a type not used before has to exist afterwards
+    set new_type [expr [setmd n_part_types] + 5]
+    part bulk pos type [list $new_id 5 5 5 $new_type]
+    if { [setmd n_part_types] != $new_type + 1 } {
+	error "[setmd n_part_types] particle types after bulk setup of type $new_type"
+    }
+    inter $new_type $new_type lennard-jones 1.0 1.0 1.12246 0.25 0
+    integrate 0
+    part $new_id delete
+    check_particles "after new type"
+} res ] } {
+    error_exit $res
+}
+
+exit 0
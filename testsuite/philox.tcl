@@ -0,0 +1,186 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the counter based generator of the thermostats (thermostat rng
+# philox): the Langevin and DPD noise must only depend on seed,
+# particles and step, not on the number of nodes or the particle or
+# pair order, and the thermostat must still reach the right
+# temperature.
+source "tests_common.tcl"
+
+puts "------------------------------------------------"
+puts "- Testcase philox.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set epsilon 1e-8
+set temp_epsilon 3e-2
+
+# Langevin forces of the particles at rest for seed 42 and
+# philox_counter 1, these are independent of the node grid
+set f_ref {
+    {-41.5728855859575 -31.7137514961751 -22.7349395729584}
+    {-31.4889091097463 41.7040853141114 -33.4629004278404}
+    {-24.3707754906803 -32.0053843227114 -5.1026560219935}
+    {-32.2991474748765 15.3225445074398 -24.2477453034929}
+    {42.1485388662298 6.6510335280351 -23.5878571539797}
+    {-16.3716590334417 39.5589396481652 12.6310239956505}
+    {7.0889792643003 -3.6224202301207 5.2161555752542}
+    {-17.0793644684645 -15.0789792791806 -33.7235332924073}
+    {15.1449149614439 35.1031081262057 36.8108876079808}
+    {-36.0174580514105 -10.9308164257009 -28.4683490867656}
+}
+
+proc read_data {file} {
+    set f [open $file "r"]
+    while {![eof $f]} { blockfile $f read auto}
+    close $f
+}
+
+proc check_forces {what} {
+    global f_ref epsilon
+    for { set i 0 } { $i < [llength $f_ref] } { incr i } {
+	set f [part $i pr f]
+	for { set j 0 } { $j < 3 } { incr j } {
+	    set ref [lindex $f_ref $i $j]
+	    if { abs([lindex $f $j] - $ref) > $epsilon*abs($ref) } {
+		error "$what: force of particle $i is $f, should be [lindex $f_ref $i]"
+	    }
+	}
+    }
+}
+
+if { [catch {
+    setmd box_l 10 10 10
+    setmd time_step 0.01
+    setmd skin 0.5
+    thermostat langevin 1.0 1.0
+
+    if { [regexp "rng philox" [thermostat]] } {
+	error "counter based generator should be off by default"
+    }
+    thermostat rng philox 42
+    if { ![regexp "rng philox 42" [thermostat]] } {
+	error "counter based generator not reported by thermostat"
+    }
+
+    expr srand(17)
+    for { set i 0 } { $i < [llength $f_ref] } { incr i } {
+	part $i pos [expr 10*rand()] [expr 10*rand()] [expr 10*rand()] v 0 0 0
+    }
+
+    ############## reference values
+    setmd philox_counter 0
+    integrate 0
+    check_forces "domain decomposition"
+    if { [setmd philox_counter] != 1 } {
+	error "counter not advanced by the force calculation"
+    }
+
+    ############## different particle order
+    cellsystem nsquare
+    setmd philox_counter 0
+    integrate 0
+    check_forces "nsquare"
+
+    # reversed storage order of the particles
+    cellsystem domain_decomposition
+    for { set i [expr [llength $f_ref] - 1] } { $i >= 0 } { incr i -1 } {
+	set p [part $i pr pos]
+	part $i delete
+	eval part $i pos $p v 0 0 0
+    }
+    setmd philox_counter 0
+    integrate 0
+    check_forces "reversed order"
+
+    ############## new noise in the next step
+    integrate 0
+    if { [lindex [part 0 pr f] 0] == [lindex $f_ref 0 0] } {
+	error "noise does not change with the step"
+    }
+    part deleteall
+
+    ############## DPD noise, independent of the pair order
+    if { [has_feature "DPD"] && [has_feature "LENNARD_JONES"] } {
+	# with the transversal part, which has an antisymmetric noise.
+	# The pairs are only visited if there is an interaction.
+	thermostat off
+	inter 0 0 lennard-jones 0.0 1.0 1.0 0.0 0.0
+	if { [has_feature "TRANS_DPD"] } {
+	    thermostat dpd 1.0 1.0 1.0 1.0 1.0
+	} else {
+	    thermostat dpd 1.0 1.0 1.0
+	}
+	expr srand(23)
+	for { set i 0 } { $i < 50 } { incr i } {
+	    part $i pos [expr 3*rand()] [expr 3*rand()] [expr 3*rand()] v 0 0 0
+	}
+	cellsystem nsquare
+	setmd philox_counter 10
+	integrate 0
+	store_property f F
+	if { [lindex $F(0) 0] == 0 } { error "no DPD noise" }
+
+	# reversed storage order of the particles, so that the pairs are
+	# visited the other way round
+	for { set i 49 } { $i >= 0 } { incr i -1 } {
+	    set p [part $i pr pos]
+	    part $i delete
+	    eval part $i pos $p v 0 0 0
+	}
+	foreach cs { nsquare domain_decomposition } {
+	    eval cellsystem $cs
+	    setmd philox_counter 10
+	    integrate 0
+	    set dev [max_deviation f F]
+	    if { $dev > $epsilon } {
+		error "DPD forces differ with cellsystem $cs, relative deviation $dev"
+	    }
+	}
+	part deleteall
+	inter 0 0 lennard-jones 0.0 0.0 0.0 0.0 0.0
+	thermostat off
+	thermostat langevin 1.0 1.0
+    }
+
+    ############## temperature, as in thermostat.tcl
+    if { [regexp "ROTATION" [code_info]] } {
+	set deg_free 6
+	read_data "thermostat_rot.data"
+    } else {
+	set deg_free 3
+	read_data "thermostat.data"
+    }
+    set n_part [setmd n_part]
+    set curtemp 0
+    for {set i 0} { $i < 100} { incr i } {
+	integrate 50
+	set curtemp [expr $curtemp + [analyze energy kin]/$n_part/($deg_free/2.)]
+    }
+    set curtemp [expr $curtemp/100]
+    set rel_temp_error [expr abs(([setmd temp] - $curtemp)/$curtemp)]
+    puts "measured temperature $curtemp, relative deviation $rel_temp_error"
+    if { $rel_temp_error > $temp_epsilon } {
+	error "relative temperature error too large"
+    }
+
+    thermostat rng ran1
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,131 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the radial distribution functions of the current and of the
+# stored configurations, which are calculated via cells, against a
+# plain double loop over all pairs in Tcl.
+source "tests_common.tcl"
+
+puts "------------------------------------------------"
+puts "- Testcase rdf.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set epsilon 1e-5
+set n_part 150
+set box {8.0 8.0 9.0}
+set n_conf 3
+
+proc min_dist {p1 p2} {
+    global box
+    set d2 0
+    foreach a $p1 b $p2 l $box {
+	set d [expr $a - $b]
+	set d [expr $d - round($d/$l)*$l]
+	set d2 [expr $d2 + $d*$d]
+    }
+    return [expr sqrt($d2)]
+}
+
+# the RDF of the given configurations, via all pairs
+proc rdf_ref {confs types1 types2 r_min r_max bins intermol} {
+    global box n_part
+    set same [expr {$types1 == $types2}]
+    set bin_width [expr ($r_max - $r_min)/double($bins)]
+    set volume [expr [lindex $box 0]*[lindex $box 1]*[lindex $box 2]]
+    set rdf {}
+    for { set b 0 } { $b < $bins } { incr b } { lappend rdf 0 }
+    foreach conf $confs {
+	set hist {}
+	for { set b 0 } { $b < $bins } { incr b } { lappend hist 0 }
+	set cnt 0
+	for { set i 0 } { $i < $n_part } { incr i } {
+	    if { [lsearch $types1 [part $i print type]] == -1 } { continue }
+	    for { set j [expr $same ? $i + 1 : 0] } { $j < $n_part } { incr j } {
+		if { [lsearch $types2 [part $j print type]] == -1 } { continue }
+		if { $intermol && [part $i print mol] == [part $j print mol] } { continue }
+		set d [min_dist [lindex $conf $i] [lindex $conf $j]]
+		if { $d > $r_min && $d < $r_max } {
+		    set b [expr int(($d - $r_min)/$bin_width)]
+		    lset hist $b [expr [lindex $hist $b] + 1]
+		}
+		incr cnt
+	    }
+	}
+	for { set b 0 } { $b < $bins } { incr b } {
+	    set r_in [expr $b*$bin_width + $r_min]
+	    set r_out [expr $r_in + $bin_width]
+	    set bin_volume [expr 4.0/3.0*[PI]*(pow($r_out, 3) - pow($r_in, 3))]
+	    lset rdf $b [expr [lindex $rdf $b] + [lindex $hist $b]*$volume/($bin_volume*$cnt)/[llength $confs]]
+	}
+    }
+    return $rdf
+}
+
+proc check_rdf {what got exp} {
+    global epsilon
+    set i 0
+    foreach r [lindex $got 1] e $exp {
+	if { abs([lindex $r 1] - $e) > $epsilon*(1 + abs($e)) } {
+	    error "$what: bin $i is [lindex $r 1], should be $e"
+	}
+	incr i
+    }
+}
+
+proc PI {} { return 3.14159265358979323846264338328 }
+
+if { [catch {
+    eval setmd box_l $box
+    setmd time_step 0.01
+    setmd skin 0.3
+    thermostat off
+
+    # particles outside the box, in small molecules
+    expr srand(23)
+    set confs {}
+    for { set k 0 } { $k < $n_conf } { incr k } {
+	set conf {}
+	for { set i 0 } { $i < $n_part } { incr i } {
+	    set pos [list [expr 24*rand()-8] [expr 24*rand()-8] [expr 27*rand()-9]]
+	    eval part $i pos $pos type [expr $i % 3] mol [expr $i/3]
+	    lappend conf $pos
+	}
+	lappend confs $conf
+	integrate 0
+	analyze append
+    }
+
+    foreach {types1 types2 r_min r_max bins} {
+	{0} {0}     0.0 3.0 15
+	{0} {1 2}   0.5 3.5 12
+	{0 1} {0 1} 0.0 5.0 20
+	{1} {0 1}   0.0 1.5  6
+    } {
+	set exp [rdf_ref [list [lindex $confs end]] $types1 $types2 $r_min $r_max $bins 0]
+	check_rdf "rdf $types1 $types2" [analyze rdf $types1 $types2 $r_min $r_max $bins] $exp
+
+	set exp [rdf_ref $confs $types1 $types2 $r_min $r_max $bins 0]
+	check_rdf "<rdf> $types1 $types2" [analyze <rdf> $types1 $types2 $r_min $r_max $bins $n_conf] $exp
+
+	set exp [rdf_ref $confs $types1 $types2 $r_min $r_max $bins 1]
+	check_rdf "<rdf-intermol> $types1 $types2" [analyze <rdf-intermol> $types1 $types2 $r_min $r_max $bins $n_conf] $exp
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,129 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check that the force loops on the structure-of-arrays cell mirrors
+# (cellsystem ... -soa) give the same results as the ones on the
+# particle structs
+source "tests_common.tcl"
+
+require_feature "LENNARD_JONES"
+require_feature "ADRESS" off
+
+puts "----------------------------------------"
+puts "- Testcase soa.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "----------------------------------------"
+
+set epsilon 1e-8
+thermostat off
+
+proc read_data {file} {
+    set f [open $file "r"]
+    while {![eof $f]} { blockfile $f read auto}
+    close $f
+}
+
+set cellsystems {
+    {domain_decomposition -soa}
+    {domain_decomposition -no_verlet_list -soa}
+    {nsquare -soa}
+}
+
+if { [catch {
+    ############## forces of a dense system
+    read_data "lj_system.data"
+    setmd time_step 1
+    setmd skin 0
+
+    inter 0 0 lennard-jones 1.0 1.0 1.12246
+    inter 1 1 lennard-jones 1.3 0.5 2 auto 0.0
+    inter 0 1 lennard-jones 2.2 1.0 1.12246 0.0 0.5
+    # some pairs have to take the path via the particle structs
+    if { [has_feature "MORSE"] } {
+	inter 1 1 morse 0.1 1.0 1.0 1.5
+    }
+    if { [has_feature "EXCLUSIONS"] } {
+	part 0 exclude 1 2 3
+    }
+
+    cellsystem domain_decomposition
+    integrate 0
+    store_property f F
+
+    foreach cs $cellsystems {
+	eval cellsystem $cs
+	integrate 0
+	set dev [max_deviation f F]
+	puts "cellsystem $cs: maximal relative force deviation $dev"
+	if { $dev > $epsilon } { error "force deviation too large for cellsystem $cs" }
+    }
+
+    ############## trajectory of a dilute system, with Verlet list reuse
+    part deleteall
+    setmd box_l 8.0 8.0 8.0
+    setmd time_step 0.005
+    setmd skin 0.3
+    inter ljforcecap 50
+    expr srand(42)
+    for { set i 0 } { $i < 200 } { incr i } {
+	part $i pos [expr 8.0*rand()] [expr 8.0*rand()] [expr 8.0*rand()] \
+	    type [expr $i % 2] v [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5]
+	set P0($i) [part $i pr pos]
+	set V0($i) [part $i pr v]
+    }
+
+    cellsystem domain_decomposition
+    integrate 100
+    store_property pos P
+
+    foreach cs $cellsystems {
+	for { set i 0 } { $i < 200 } { incr i } {
+	    eval part $i pos $P0($i) v $V0($i)
+	}
+	eval cellsystem $cs
+	integrate 100
+	set dev [max_deviation pos P]
+	puts "cellsystem $cs: maximal relative position deviation $dev after 100 steps"
+	if { $dev > $epsilon } { error "trajectory deviation too large for cellsystem $cs" }
+    }
+
+    ############## forces of a charged system, P3M real space part
+    if { [has_feature "ELECTROSTATICS"] && [has_feature "FFTW"] } {
+	inter ljforcecap 0
+	for { set i 0 } { $i < 200 } { incr i } {
+	    eval part $i pos $P0($i) q [expr 1 - 2*($i % 2)]
+	}
+	cellsystem domain_decomposition
+	inter coulomb 1.0 p3m 2.0 16 5 1.5
+	integrate 0
+	store_property f F
+
+	foreach cs $cellsystems {
+	    # P3M requires the domain decomposition
+	    if { [lindex $cs 0] != "domain_decomposition" } { continue }
+	    eval cellsystem $cs
+	    integrate 0
+	    set dev [max_deviation f F]
+	    puts "cellsystem $cs: maximal relative force deviation $dev with P3M"
+	    if { $dev > $epsilon } { error "force deviation too large for cellsystem $cs with P3M" }
+	}
+	inter coulomb 0.0
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,116 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the structure factor via the FFT of the particle density
+# against the explicit sum over the wave vectors, which is checked
+# against a sum in Tcl for a few wave vectors.
+source "tests_common.tcl"
+
+require_feature "ELECTROSTATICS"
+require_feature "FFTW"
+
+puts "------------------------------------------------"
+puts "- Testcase structurefactor.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set epsilon 1e-3
+set n_part 300
+set box 9.0
+
+proc PI {} { return 3.14159265358979323846264338328 }
+
+proc check_sf {what got exp} {
+    global epsilon
+    if { [llength $got] != [llength $exp] } {
+	error "$what has [llength $got] wave vectors, should have [llength $exp]"
+    }
+    foreach g $got e $exp {
+	foreach {q s} $g break
+	foreach {q_e s_e} $e break
+	if { abs($q - $q_e) > 1e-6 } { error "$what: q is $q, should be $q_e" }
+	if { abs($s - $s_e) > $epsilon*(1 + abs($s_e)) } {
+	    error "$what: S($q) is $s, should be $s_e"
+	}
+    }
+}
+
+if { [catch {
+    setmd box_l $box $box $box
+    setmd time_step 0.01
+    setmd skin 0.3
+    thermostat off
+
+    # particles outside the box, and a dense cluster of type 1
+    expr srand(17)
+    for { set i 0 } { $i < $n_part } { incr i } {
+	if { $i % 3 } {
+	    set pos [list [expr 3*$box*rand()-$box] [expr 3*$box*rand()-$box] [expr 3*$box*rand()-$box]]
+	    set type 0
+	} {
+	    set pos [list [expr 2 + 2*rand()] [expr 3 + 2*rand()] [expr 4 + 2*rand()]]
+	    set type 1
+	}
+	eval part $i pos $pos type $type
+    }
+    integrate 0
+
+    ############## the explicit sum for |n|^2 = 1, 2 in Tcl
+    set exact [analyze structurefactor 0 3 exact]
+    set sum1 0; set sum2 0; set n 0
+    for { set i 0 } { $i < $n_part } { incr i } { if { [part $i print type] == 0 } { incr n } }
+    foreach n_v {{1 0 0} {0 1 0} {0 -1 0} {0 0 1} {0 0 -1} {1 1 0} {1 -1 0} {1 0 1} {1 0 -1} {0 1 1} {0 1 -1} {0 -1 1} {0 -1 -1}} {
+	set c 0; set s 0
+	for { set i 0 } { $i < $n_part } { incr i } {
+	    if { [part $i print type] != 0 } { continue }
+	    set qr 0
+	    foreach x [part $i print pos] n_d $n_v { set qr [expr $qr + 2*[PI]/$box*$n_d*$x] }
+	    set c [expr $c + cos($qr)]; set s [expr $s + sin($qr)]
+	}
+	set s2 [expr $c*$c + $s*$s]
+	if { [llength [lsearch -all $n_v 0]] == 2 } {
+	    set sum1 [expr $sum1 + $s2]
+	} {
+	    set sum2 [expr $sum2 + $s2]
+	}
+    }
+    check_sf "explicit sum" [lrange $exact 0 1] [list \
+	[list [expr 2*[PI]/$box] [expr $sum1/(5*$n)]] \
+	[list [expr 2*[PI]/$box*sqrt(2)] [expr $sum2/(8*$n)]]]
+
+    ############## via the mesh
+    foreach {type order options} {
+	0 3 {}
+	1 4 {}
+	0 5 {mesh 48 cao 5}
+	1 2 {mesh 20 cao 7}
+    } {
+	set exp [analyze structurefactor $type $order exact]
+	check_sf "structurefactor $type $order $options" [eval analyze structurefactor $type $order $options] $exp
+    }
+
+    ############## wrong parameters
+    if { ![catch { analyze structurefactor 0 5 mesh 10 } res] || ![string match "*larger than 2*order*" $res] } {
+	error "a mesh of at most 2*order was accepted"
+    }
+    if { ![catch { analyze structurefactor 0 5 cao 8 } res] } {
+	error "cao 8 was accepted"
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -45,6 +45,37 @@ proc require_feature {feature {off ""}} {
     }
 }
 
+# store a property of all particles in the array ref, indexed by the
+# particle identity
+proc store_property {prop ref} {
+    upvar $ref R
+    for { set i 0 } { $i <= [setmd max_part] } { incr i } {
+	set R($i) [part $i pr $prop]
+    }
+}
+
+# maximal relative deviation of a particle property from the one
+# stored in ref by store_property. Each component is compared relative
+# to the magnitude of the stored value plus one, or with scale "max"
+# relative to the largest stored value.
+proc max_deviation {prop ref {scale "component"}} {
+    upvar $ref R
+    set maxd 0
+    set maxv 0
+    for { set i 0 } { $i <= [setmd max_part] } { incr i } {
+	set cur [part $i pr $prop]
+	set tgt $R($i)
+	for { set j 0 } { $j < 3 } { incr j } {
+	    set d [expr abs([lindex $cur $j] - [lindex $tgt $j])]
+	    if { $scale != "max" } { set d [expr $d/(abs([lindex $tgt $j]) + 1.0)] }
+	    if { $d > $maxd } { set maxd $d }
+	    if { abs([lindex $tgt $j]) > $maxv } { set maxv [expr abs([lindex $tgt $j])] }
+	}
+    }
+    if { $scale == "max" } { return [expr $maxd/$maxv] }
+    return $maxd
+}
+
 proc require_max_nodes_per_side {n} {
     foreach s [setmd node_grid] {
 	if {$s > $n} {
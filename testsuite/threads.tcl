@@ -0,0 +1,87 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check that the threaded force loops (setmd n_threads) give the same
+# forces and trajectories as a single thread, for a polymer melt with
+# bonded and non bonded interactions in all domain decomposition
+# variants
+source "tests_common.tcl"
+
+require_feature "OPENMP"
+require_feature "LENNARD_JONES"
+require_feature "ADRESS" off
+
+puts "----------------------------------------"
+puts "- Testcase threads.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "----------------------------------------"
+
+set epsilon 1e-8
+thermostat off
+
+set cellsystems {
+    {domain_decomposition}
+    {domain_decomposition -no_verlet_list}
+    {domain_decomposition -soa}
+}
+
+if { [catch {
+    set L 14.0
+    setmd box_l $L $L $L
+    setmd time_step 0.005
+    setmd skin 0.4
+
+    inter 0 fene 7.0 2.0
+    inter 0 0 lennard-jones 1.0 1.0 1.12246 auto 0.0
+    expr srand(5)
+    polymer 30 10 0.97 mode SAW 0.8 types 0 0 FENE 0
+    set n [setmd n_part]
+    for { set i 0 } { $i < $n } { incr i } {
+	part $i v [expr rand()-0.5] [expr rand()-0.5] [expr rand()-0.5]
+	set P0($i) [part $i pr pos]
+	set V0($i) [part $i pr v]
+    }
+    # the forces of the initial configuration are large
+    inter ljforcecap 50
+
+    ############## reference on a single thread
+    setmd n_threads 1
+    cellsystem domain_decomposition
+    integrate 0
+    store_property f F
+    integrate 100
+    store_property pos P
+
+    setmd n_threads 4
+    foreach cs $cellsystems {
+	for { set i 0 } { $i < $n } { incr i } {
+	    eval part $i pos $P0($i) v $V0($i)
+	}
+	eval cellsystem $cs
+	integrate 0
+	set devf [max_deviation f F]
+	integrate 100
+	set devp [max_deviation pos P]
+	puts "cellsystem $cs: maximal relative deviations force $devf, position $devp after 100 steps"
+	if { $devf > $epsilon } { error "force deviation too large for cellsystem $cs" }
+	if { $devp > $epsilon } { error "trajectory deviation too large for cellsystem $cs" }
+    }
+    setmd n_threads 1
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,114 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the wall clock timers of the integration phases: the number of
+# calls, the consistency of minimum, maximum and average over the
+# nodes, the JSON and CSV output and the reset.
+source "tests_common.tcl"
+
+require_feature "TIMERS"
+require_feature "LENNARD_JONES"
+
+puts "----------------------------------------"
+puts "- Testcase timers.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "----------------------------------------"
+
+set names {integrate force_calc verlet_build ghost_comm resort p3m_kspace fft lb_fluid}
+
+# the timers as array name -> {calls min max avg imbalance}
+proc get_timers {} {
+    global timer
+    array unset timer
+    foreach t [timers] { set timer([lindex $t 0]) [lrange $t 1 end] }
+}
+
+if { [catch {
+    setmd box_l 8.0 8.0 8.0
+    setmd time_step 0.005
+    setmd skin 0.4
+    thermostat langevin 1.0 1.0
+    inter 0 0 lennard-jones 1.0 1.0 1.12246 0.25 0
+
+    expr srand(7)
+    for { set i 0 } { $i < 200 } { incr i } {
+	part $i pos [expr 8*rand()] [expr 8*rand()] [expr 8*rand()]
+    }
+    inter ljforcecap 20
+    integrate 100
+    inter ljforcecap 0
+
+    timers reset
+    get_timers
+    foreach n $names {
+	if { ![info exists timer($n)] } { error "timer $n missing" }
+	if { [lindex $timer($n) 0] != 0 || [lindex $timer($n) 3] != 0.0 } {
+	    error "timer $n not reset: $timer($n)"
+	}
+    }
+
+    integrate 50
+    get_timers
+    if { [lindex $timer(integrate) 0] != 1 } {
+	error "integrate was run [lindex $timer(integrate) 0] times, should be 1"
+    }
+    # one force calculation per step, and maybe one before
+    set fc [lindex $timer(force_calc) 0]
+    if { $fc < 50 || $fc > 51 } {
+	error "force_calc was run $fc times, should be 50 or 51"
+    }
+    foreach n {integrate force_calc} {
+	foreach {calls min max avg imbalance} $timer($n) break
+	if { $min <= 0 || $min > $avg || $avg > $max || $imbalance < 0 } {
+	    error "inconsistent timer $n: $timer($n)"
+	}
+    }
+
+    # the CSV table has a header and a line per timer
+    set csv [split [string trim [timers csv]] "\n"]
+    if { [lindex $csv 0] != "name,calls,min,max,avg,imbalance" || [llength $csv] != [llength $names] + 1 } {
+	error "wrong CSV output $csv"
+    }
+    foreach line [lrange $csv 1 end] n $names {
+	set fields [split $line ","]
+	if { [lindex $fields 0] != $n || [llength $fields] != 6 } {
+	    error "wrong CSV line $line"
+	}
+    }
+
+    # the JSON object, written to a file
+    timers json "timers.json"
+    set f [open "timers.json" "r"]
+    set json [read $f]
+    close $f
+    file delete "timers.json"
+    foreach n $names {
+	if { ![regexp "\"$n\": \\{\"calls\": (\[0-9\]+), \"min\": \[^,\]+, \"max\": \[^,\]+, \"avg\": \[^,\]+, \"imbalance\": \[^\}\]+\\}" $json all calls] } {
+	    error "timer $n missing in JSON output $json"
+	}
+	if { $calls != [lindex $timer($n) 0] } {
+	    error "JSON calls $calls of timer $n differ from $timer($n)"
+	}
+    }
+
+    if { ![catch { timers foo }] } {
+	error "timers foo was accepted"
+    }
+} res ] } {
+    error_exit $res
+}
+
+exit 0
@@ -0,0 +1,248 @@
+# Copyright (C) 2012 The ESPResSo project
+#
+# This file is part of ESPResSo.
+#
+# ESPResSo is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# ESPResSo is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# check the binary trajectory writer (trajectory): the frames are
+# read back with binary scan, via the index and, after the index has
+# been cut off, by appending to the file.
+source "tests_common.tcl"
+
+puts "------------------------------------------------"
+puts "- Testcase trajectory.tcl running on [format %02d [setmd n_nodes]] nodes: -"
+puts "------------------------------------------------"
+
+set epsilon 1e-12
+set float_epsilon 1e-6
+set n_part 100
+set file "trajectory.tmp"
+
+# returns the frame offsets of a trajectory file from its index
+proc read_index {file} {
+    set f [open $file "r"]
+    fconfigure $f -translation binary
+    seek $f -16 end
+    binary scan [read $f 16] wa4 n magic
+    if { $magic != "IDX1" } {
+	error "index of $file missing"
+    }
+    seek $f [expr -16 - 8*$n] end
+    binary scan [read $f [expr 8*$n]] w$n offsets
+    close $f
+    return $offsets
+}
+
+# returns the particle data of a frame as list of
+# {id x y z vx vy vz type} and checks time and box length
+proc read_frame {file offset float} {
+    set f [open $file "r"]
+    fconfigure $f -translation binary
+    binary scan [read $f 80] a4iiii3 magic order flags n_cols cols
+    if { $magic != "MDT1" || $flags != $float || $n_cols != 3 || $cols != {0 1 4} } {
+	error "wrong file header $magic $flags $n_cols $cols"
+    }
+    seek $f $offset
+    binary scan [read $f 48] a4iwdd3 magic n size time box
+    if { $magic != "FRM1" || $size != 48 + $n*(4 + 6*($float ? 4 : 8) + 4) } {
+	error "wrong frame header $magic $n $size"
+    }
+    if { abs($time - [setmd time]) > 1e-10 || $box != [setmd box_l] } {
+	error "wrong time $time or box $box of frame"
+    }
+    if { $float } {
+	set r "f"; set rs 4
+    } else {
+	set r "d"; set rs 8
+    }
+    binary scan [read $f [expr 4*$n]] i$n ids
+    binary scan [read $f [expr 3*$rs*$n]] $r[expr 3*$n] pos
+    binary scan [read $f [expr 3*$rs*$n]] $r[expr 3*$n] v
+    binary scan [read $f [expr 4*$n]] i$n types
+    close $f
+    set res {}
+    for { set i 0 } { $i < $n } { incr i } {
+	lappend res [concat [lindex $ids $i] [lrange $pos [expr 3*$i] [expr 3*$i+2]] \
+			 [lrange $v [expr 3*$i] [expr 3*$i+2]] [lindex $types $i]]
+    }
+    return $res
+}
+
+proc check_frame {frame eps what} {
+    global n_part
+    if { [llength $frame] != $n_part } {
+	error "$what: [llength $frame] particles in frame, should be $n_part"
+    }
+    set last -1
+    foreach p $frame {
+	set id [lindex $p 0]
+	if { $id <= $last } {
+	    error "$what: particles not ordered"
+	}
+	set last $id
+	set exp [concat $id [part $id pr pos v type]]
+	for { set j 1 } { $j < 8 } { incr j } {
+	    set d [expr abs([lindex $p $j] - [lindex $exp $j])]
+	    if { $d > $eps*(1 + abs([lindex $exp $j])) } {
+		error "$what: particle $id is $p, should be $exp"
+	    }
+	}
+    }
+}
+
+if { [catch {
+    setmd box_l 8 8 8
+    setmd time_step 0.01
+    setmd skin 0.3
+    thermostat langevin 1.0 1.0
+
+    expr srand(7)
+    for { set i 0 } { $i < $n_part } { incr i } {
+	part [expr 2*$i] pos [expr 8*rand()] [expr 8*rand()] [expr 8*rand()] \
+	    v [expr rand()] [expr rand()] [expr rand()] type [expr $i % 3]
+    }
+
+    ############## write and read back
+    if { [trajectory] != "" } {
+	error "trajectory open from the start"
+    }
+    trajectory open $file pos v type
+    trajectory write
+    check_frame [read_frame $file 80 0] $epsilon "first frame"
+    integrate 20
+    trajectory write
+    if { [trajectory] != "file $file frames 2 columns {pos v type}" } {
+	error "wrong trajectory status [trajectory]"
+    }
+    trajectory close
+    set offsets [read_index $file]
+    if { [llength $offsets] != 2 || [lindex $offsets 0] != 80 } {
+	error "wrong index $offsets"
+    }
+    check_frame [read_frame $file [lindex $offsets 1] 0] $epsilon "second frame"
+
+    ############## append
+    integrate 20
+    trajectory open $file append
+    trajectory write
+    trajectory close
+    set offsets2 [read_index $file]
+    if { [lrange $offsets2 0 1] != $offsets || [llength $offsets2] != 3 } {
+	error "wrong index $offsets2 after appending"
+    }
+    check_frame [read_frame $file [lindex $offsets2 2] 0] $epsilon "appended frame"
+
+    ############## append without index, e.g. after a crash
+    set f [open $file "r+"]
+    chan truncate $f [expr [file size $file] - 16 - 8*3]
+    close $f
+    integrate 20
+    trajectory open $file append pos v type
+    trajectory write
+    trajectory close
+    set offsets3 [read_index $file]
+    if { [lrange $offsets3 0 2] != $offsets2 || [llength $offsets3] != 4 } {
+	error "wrong index $offsets3 after recovery"
+    }
+    check_frame [read_frame $file [lindex $offsets3 3] 0] $epsilon "recovered frame"
+
+    if { ![catch {trajectory open $file append pos v}] } {
+	error "appending with different columns accepted"
+    }
+
+    # a file with a charge or dipole column, which cannot be written
+    # without the feature
+    foreach {name code feature} {q 3 ELECTROSTATICS dip 7 DIPOLES} {
+	if { [has_feature $feature] } { continue }
+	set f [open $file "r"]
+	fconfigure $f -translation binary
+	binary scan [read $f 8] a4i magic order
+	close $f
+	set f [open $file.x "w"]
+	fconfigure $f -translation binary
+	puts -nonewline $f [binary format a4iiii16 MDT1 $order 0 2 \
+				[list 0 $code 0 0 0 0 0 0 0 0 0 0 0 0 0 0]]
+	close $f
+	if { ![catch {trajectory open $file.x append} msg] } {
+	    trajectory close
+	    error "appending to a trajectory with column $name accepted"
+	}
+	if { ![regexp "column \"$name\" is not compiled in" $msg] } {
+	    error "unexpected error $msg"
+	}
+	file delete $file.x
+    }
+
+    ############## random access reading
+    if { [trajectory info $file] != "frames 4 columns {pos v type}" } {
+	error "wrong trajectory info [trajectory info $file]"
+    }
+    set frame [read_frame $file [lindex $offsets3 3] 0]
+    set ids {}
+    foreach p $frame { lappend ids [lindex $p 0] }
+    if { [trajectory read $file 3 ids] != $ids } {
+	error "wrong ids from trajectory read"
+    }
+    if { abs([trajectory read $file 3 time] - [setmd time]) > 1e-10 } {
+	error "wrong time from trajectory read"
+    }
+    set sel [trajectory read $file 3 pos 6 198]
+    if { $sel != [list [lrange [lindex $frame 3] 1 3] [lrange [lindex $frame 99] 1 3]] } {
+	error "wrong positions $sel from trajectory read"
+    }
+    if { [trajectory read $file 3 type 4] != [lindex $frame 2 7] } {
+	error "wrong type from trajectory read"
+    }
+    if { ![catch {trajectory read $file 4 pos}] || ![catch {trajectory read $file 0 f}] ||
+	 ![catch {trajectory read $file 0 pos 1}] } {
+	error "trajectory read of missing data accepted"
+    }
+
+    # every second frame into the stored configurations
+    if { [trajectory load $file first 1 stride 2] != 2 || [analyze stored] != 2 } {
+	error "wrong number of frames loaded"
+    }
+    set config {}
+    foreach p $frame {
+	foreach x [lrange $p 1 3] { lappend config [format %f $x] }
+    }
+    if { [lrange [analyze configs 1] 0 end] != $config } {
+	error "wrong stored configuration from trajectory load"
+    }
+
+    # reading while the trajectory is still being written
+    trajectory open $file append
+    trajectory write
+    if { [lindex [trajectory info $file] 1] != 5 } {
+	error "unfinished trajectory not readable"
+    }
+    trajectory close
+
+    ############## single precision
+    trajectory open $file float pos v type
+    trajectory write
+    trajectory close
+    check_frame [read_frame $file 80 1] $float_epsilon "float frame"
+    set x [lindex [part 8 pr pos] 0]
+    if { abs([lindex [trajectory read $file 0 pos 8] 0 0] - $x) > $float_epsilon*abs($x) } {
+	error "wrong position from single precision trajectory"
+    }
+
+    file delete $file
+} res ] } {
+    catch {file delete $file $file.x}
+    error_exit $res
+}
+
+exit 0